@@ -0,0 +1,141 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <algostats.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <pow.h>
+
+#include <algorithm>
+
+CAlgoStats algoStats;
+
+CAlgoStats::CAlgoStats() : pindexTip(nullptr), fStale(true)
+{
+    snapshot.nHeight = -1;
+    snapshot.nHeaders = -1;
+    snapshot.nTipAlgo = 0;
+}
+
+/** Whether GetLastBlockIndexForAlgo walks through a block with this time for this algo. */
+static bool IsAlgoCounted(uint32_t nTime, uint8_t nAlgo, const Consensus::Params& params)
+{
+    if (!params.Hardfork1.IsActivated(nTime) && nAlgo != ALGO_SHA256D)
+        return false;
+    if (!params.Hardfork2.IsActivated(nTime) && !IsAlgoAllowedBeforeHF2(nAlgo))
+        return false;
+    return true;
+}
+
+void CAlgoStats::UpdateHashrate(uint8_t nAlgo)
+{
+    // The same estimate as GetNetworkHashPS(nAlgo, ALGO_STATS_HASHRATE_LOOKUP, -1)
+    CAlgoChainStats& stats = snapshot.algos[nAlgo];
+    stats.dNetworkHashPS = 0;
+    if (snapshot.nHeight <= 0 || windows[nAlgo].empty())
+        return;
+
+    const size_t nBlocks = std::min<size_t>(windows[nAlgo].size(), std::min(ALGO_STATS_HASHRATE_LOOKUP, snapshot.nHeight) + 1);
+    arith_uint256 totalAlgoWork;
+    int64_t minTime = windows[nAlgo][0].second;
+    int64_t maxTime = minTime;
+    for (size_t i = 0; i < nBlocks; i++) {
+        totalAlgoWork += windows[nAlgo][i].first;
+        minTime = std::min(windows[nAlgo][i].second, minTime);
+        maxTime = std::max(windows[nAlgo][i].second, maxTime);
+    }
+    if (minTime != maxTime)
+        stats.dNetworkHashPS = totalAlgoWork.getdouble() / (maxTime - minTime);
+}
+
+void CAlgoStats::RecomputeAlgo(uint8_t nAlgo, const Consensus::Params& params)
+{
+    CAlgoChainStats& stats = snapshot.algos[nAlgo];
+    const CBlockIndex* pindexAlgo = GetLastBlockIndexForAlgo(pindexTip, nAlgo, params);
+
+    windows[nAlgo].clear();
+    for (const CBlockIndex* pindex = pindexAlgo; pindex != nullptr && windows[nAlgo].size() <= (size_t)ALGO_STATS_HASHRATE_LOOKUP;
+         pindex = pindex->pprev ? GetLastBlockIndexForAlgo(pindex->pprev, nAlgo, params) : nullptr) {
+        windows[nAlgo].emplace_back(GetBlockProofBase(*pindex), pindex->GetBlockTime());
+    }
+
+    stats.nLastBlock = pindexAlgo ? pindexAlgo->nHeight : -1;
+    stats.nBits = pindexAlgo ? pindexAlgo->nBits : params.aPOWAlgos[nAlgo].GetArithPowLimit().GetCompact();
+    stats.nLastDiffRet = CalculateDiffRetargetingBlock(pindexTip, RETARGETING_LAST, nAlgo, params);
+    stats.nNextDiffRet = CalculateDiffRetargetingBlock(pindexTip, RETARGETING_NEXT, nAlgo, params);
+    UpdateHashrate(nAlgo);
+}
+
+void CAlgoStats::Recompute(const Consensus::Params& params)
+{
+    // Block index entries are never freed and the fields read here do not
+    // change once a block is connected, so the walk does not need cs_main.
+    snapshot.nHeight = pindexTip ? pindexTip->nHeight : -1;
+    snapshot.hashTip = pindexTip ? pindexTip->GetBlockHash() : uint256();
+    snapshot.nTipAlgo = pindexTip ? pindexTip->GetAlgo() : 0;
+    for (uint8_t i = 0; i < NUM_ALGOS; i++)
+        RecomputeAlgo(i, params);
+    fStale = false;
+}
+
+bool CAlgoStats::Advance(const CBlockIndex* pindexNew, const Consensus::Params& params)
+{
+    if (fStale || pindexNew == nullptr || pindexTip == nullptr || pindexNew->pprev != pindexTip)
+        return false;
+
+    pindexTip = pindexNew;
+    snapshot.nHeight = pindexNew->nHeight;
+    snapshot.hashTip = pindexNew->GetBlockHash();
+    snapshot.nTipAlgo = pindexNew->GetAlgo();
+
+    for (uint8_t i = 0; i < NUM_ALGOS; i++) {
+        CAlgoChainStats& stats = snapshot.algos[i];
+        if (!IsAlgoCounted(pindexNew->nTime, i, params)) {
+            // The walk stops at the new tip, so there is nothing left to reuse
+            RecomputeAlgo(i, params);
+        } else if (i == snapshot.nTipAlgo) {
+            if (!params.fPowNoRetargeting && (stats.nLastBlock < 0 || stats.nBits != pindexNew->nBits))
+                stats.nLastDiffRet = pindexNew->nHeight;
+            stats.nLastBlock = pindexNew->nHeight;
+            stats.nBits = pindexNew->nBits;
+            stats.nNextDiffRet = CalculateDiffRetargetingBlock(pindexNew, RETARGETING_NEXT, i, params);
+            windows[i].emplace_front(GetBlockProofBase(*pindexNew), pindexNew->GetBlockTime());
+            if (windows[i].size() > (size_t)ALGO_STATS_HASHRATE_LOOKUP + 1)
+                windows[i].pop_back();
+            UpdateHashrate(i);
+        } else {
+            // The algo's blocks are unchanged, and a next retargeting height
+            // counts from the tip (the negative ones are error codes).
+            if (stats.nNextDiffRet >= 0 && !params.fPowNoRetargeting)
+                stats.nNextDiffRet++;
+        }
+    }
+    return true;
+}
+
+void CAlgoStats::UpdatedBlockTip(const CBlockIndex* pindexNew, bool fInitialDownload)
+{
+    LOCK(cs);
+    // Blocks come too fast during initial block download to be worth
+    // following one by one, so the first read after it recomputes them.
+    if (fInitialDownload || !Advance(pindexNew, Params().GetConsensus())) {
+        pindexTip = pindexNew;
+        fStale = true;
+    }
+}
+
+void CAlgoStats::NotifyHeaderTip(const CBlockIndex* pindexNew)
+{
+    LOCK(cs);
+    snapshot.nHeaders = pindexNew ? pindexNew->nHeight : -1;
+}
+
+CAlgoStatsSnapshot CAlgoStats::GetSnapshot()
+{
+    LOCK(cs);
+    if (fStale)
+        Recompute(Params().GetConsensus());
+    return snapshot;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBALTOKEN_ALGOSTATS_H
+#define GLOBALTOKEN_ALGOSTATS_H
+
+#include <arith_uint256.h>
+#include <globaltoken/powalgorithm.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <deque>
+#include <stdint.h>
+#include <utility>
+
+class CBlockIndex;
+
+namespace Consensus { struct Params; }
+
+//! Earlier blocks of an algo that its network hashrate is averaged over, like getnetworkhashps 24
+static const int ALGO_STATS_HASHRATE_LOOKUP = 24;
+
+/** Chain statistics of one mining algorithm, as shown by getalgoinfo and getmininginfo. */
+struct CAlgoChainStats
+{
+    int nLastBlock;         //!< Height of the last block of the algo, -1 if there is none
+    unsigned int nBits;     //!< nBits of that block, or the algo's proof of work limit
+    double dNetworkHashPS;  //!< Over the last ALGO_STATS_HASHRATE_LOOKUP + 1 blocks of the algo
+    int nLastDiffRet;       //!< CalculateDiffRetargetingBlock(RETARGETING_LAST)
+    int nNextDiffRet;       //!< CalculateDiffRetargetingBlock(RETARGETING_NEXT)
+};
+
+/** The statistics of every algo at one chain tip. */
+struct CAlgoStatsSnapshot
+{
+    int nHeight;            //!< -1 before the genesis block is connected
+    int nHeaders;           //!< Height of the best header, -1 if unknown
+    uint256 hashTip;
+    uint8_t nTipAlgo;
+    CAlgoChainStats algos[NUM_ALGOS];
+};
+
+/**
+ * Per algo statistics of the active chain, kept up to date from the
+ * validation interface so that the mining RPCs can read them without
+ * cs_main and without walking the chain for every algo on every call.
+ *
+ * A block that extends the tip only changes the algo it was mined with: its
+ * last block, nBits, hashrate window and retargeting heights are advanced
+ * from the previous values, and every other algo just has its next
+ * retargeting height moved along with the tip. Anything else (a reorg,
+ * several blocks connected at once, a tip across a hardfork boundary, or
+ * blocks connected during initial block download) marks the statistics
+ * stale, and the next read recomputes them from the chain.
+ *
+ * The statistics follow the validation interface queue, so they can lag the
+ * active chain by the notifications that are still queued.
+ */
+class CAlgoStats
+{
+private:
+    CCriticalSection cs;
+    const CBlockIndex* pindexTip;
+    bool fStale;
+    CAlgoStatsSnapshot snapshot;
+    //! Work and time of the last blocks of each algo, newest first
+    std::deque<std::pair<arith_uint256, int64_t>> windows[NUM_ALGOS];
+
+    void Recompute(const Consensus::Params& params);
+    void RecomputeAlgo(uint8_t nAlgo, const Consensus::Params& params);
+    bool Advance(const CBlockIndex* pindexNew, const Consensus::Params& params);
+    void UpdateHashrate(uint8_t nAlgo);
+
+public:
+    CAlgoStats();
+
+    void UpdatedBlockTip(const CBlockIndex* pindexNew, bool fInitialDownload);
+    void NotifyHeaderTip(const CBlockIndex* pindexNew);
+
+    /** The statistics at the last tip that was notified, recomputed first if they are stale. */
+    CAlgoStatsSnapshot GetSnapshot();
+};
+
+extern CAlgoStats algoStats;
+
+#endif // GLOBALTOKEN_ALGOSTATS_H
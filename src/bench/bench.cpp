@@ -40,7 +40,10 @@ void benchmark::ConsolePrinter::result(const State& state)
     }
 
     std::cout << std::setprecision(6);
-    std::cout << state.m_name << ", " << state.m_num_evals << ", " << state.m_num_iters << ", " << total << ", " << front << ", " << back << ", " << median << std::endl;
+    std::cout << state.m_name << ", " << state.m_num_evals << ", " << state.m_num_iters << ", " << total << ", " << front << ", " << back << ", " << median;
+    for (const auto& counter : state.counters)
+        std::cout << ", " << counter.first << "=" << counter.second;
+    std::cout << std::endl;
 }
 
 void benchmark::ConsolePrinter::footer() {}
@@ -60,6 +60,8 @@ public:
     const uint64_t m_num_evals;
     std::vector<double> m_elapsed_results;
     time_point m_start_time;
+    //! Figures other than time a benchmark reports, like the counters of Google Benchmark
+    std::map<std::string, double> counters;
 
     bool UpdateTimer(time_point finish_time);
 
@@ -4,6 +4,13 @@
 
 #include <bench/bench.h>
 
+#include <crypto/algos/argon2/argon2.h>
+#include <crypto/algos/hashlib/hashchain.h>
+#include <crypto/algos/hashlib/sph_aesni.h>
+#include <crypto/algos/neoscrypt/neoscrypt.h>
+#include <crypto/algos/scrypt/scrypt.h>
+#include <crypto/algos/yescrypt/yescrypt.h>
+#include <crypto/algos/yespower/yespower.h>
 #include <crypto/sha256.h>
 #include <key.h>
 #include <validation.h>
@@ -43,6 +50,13 @@ main(int argc, char** argv)
     }
 
     SHA256AutoDetect();
+    sph_aesni_autodetect();
+    yescrypt_autodetect();
+    yespower_autodetect();
+    argon2_autodetect();
+    scrypt_multi_autodetect();
+    neoscrypt_multi_autodetect();
+    hashchain_multi_autodetect();
     RandomInit();
     ECC_Start();
     SetupEnvironment();
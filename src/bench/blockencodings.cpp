@@ -0,0 +1,157 @@
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <auxpow.h>
+#include <blockencodings.h>
+#include <chainparams.h>
+#include <consensus/merkle.h>
+#include <policy/policy.h>
+#include <random.h>
+#include <streams.h>
+#include <txmempool.h>
+
+// Compares compact block relay (cmpctblock + getblocktxn/blocktxn when
+// needed) with plain block relay for the two header types that are much
+// larger than 80 bytes on this chain. Bytes and round trips per block are
+// reported as counters of the benchmark, the timing covers encode, decode and
+// reconstruction on the receiving side.
+
+static const int RELAY_BENCH_TXS = 250;
+static const int RELAY_BENCH_MISSING = 5;
+
+static void AddTx(const CTransactionRef& tx, CTxMemPool& pool)
+{
+    LockPoints lp;
+    pool.addUnchecked(tx->GetHash(), CTxMemPoolEntry(tx, 1000, 0, 1, false, 4, lp));
+}
+
+static CBlock BuildRelayBlock(bool fEquihash)
+{
+    CBlock block;
+    if (fEquihash)
+        block.SetAlgo(ALGO_EQUIHASH);
+    block.hashPrevBlock = GetRandHash();
+    block.nBits = 0x207fffff;
+
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].scriptSig = CScript() << OP_1 << OP_1;
+    coinbase.vout.resize(1);
+    coinbase.vout[0].nValue = 42;
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+
+    for (int i = 0; i < RELAY_BENCH_TXS; i++) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout.hash = GetRandHash();
+        tx.vin[0].scriptSig = CScript() << std::vector<unsigned char>(72, 1) << std::vector<unsigned char>(33, 2);
+        tx.vout.resize(2);
+        tx.vout[0].scriptPubKey = CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 3) << OP_EQUALVERIFY << OP_CHECKSIG;
+        tx.vout[0].nValue = i + 1;
+        tx.vout[1].scriptPubKey = tx.vout[0].scriptPubKey;
+        tx.vout[1].nValue = i + 2;
+        block.vtx.push_back(MakeTransactionRef(tx));
+    }
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+
+    if (fEquihash) {
+        block.hashReserved = GetRandHash();
+        block.nBigNonce = GetRandHash();
+        block.nSolution.resize(1344);
+        GetRandBytes(block.nSolution.data(), block.nSolution.size());
+    } else {
+        CAuxPow::initAuxPow(block, CURRENT_AUXPOW_VERSION);
+    }
+    return block;
+}
+
+static void CompactBlockRelay(benchmark::State& state, bool fEquihash)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const CBlock block = BuildRelayBlock(fEquihash);
+
+    // The receiver has seen all but a few of the block's transactions
+    CTxMemPool pool;
+    for (size_t i = 1 + RELAY_BENCH_MISSING; i < block.vtx.size(); i++)
+        AddTx(block.vtx[i], pool);
+    std::vector<std::pair<uint256, CTransactionRef>> extra_txn;
+
+    size_t nBytes = 0;
+    int nRoundTrips = 0;
+    while (state.KeepRunning()) {
+        nBytes = 0;
+        nRoundTrips = 1;
+
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+        stream << CBlockHeaderAndShortTxIDs(block, false);
+        nBytes += stream.size();
+
+        CBlockHeaderAndShortTxIDs cmpctblock;
+        stream >> cmpctblock;
+
+        PartiallyDownloadedBlock partialBlock(&pool);
+        ReadStatus status = partialBlock.InitData(cmpctblock, extra_txn);
+        assert(status == READ_STATUS_OK);
+
+        BlockTransactionsRequest req;
+        for (size_t i = 0; i < cmpctblock.BlockTxCount(); i++) {
+            if (!partialBlock.IsTxAvailable(i))
+                req.indexes.push_back(i);
+        }
+
+        BlockTransactions resp;
+        if (!req.indexes.empty()) {
+            nRoundTrips++;
+            req.blockhash = cmpctblock.header.GetHash();
+            stream << req;
+            nBytes += stream.size();
+            stream >> req;
+
+            BlockTransactions blocktxn(req);
+            for (size_t i = 0; i < req.indexes.size(); i++)
+                blocktxn.txn[i] = block.vtx[req.indexes[i]];
+            stream << blocktxn;
+            nBytes += stream.size();
+            stream >> resp;
+        }
+
+        CBlock block2;
+        status = partialBlock.FillBlock(block2, resp.txn);
+        assert(status == READ_STATUS_OK);
+    }
+
+    state.counters["bytes"] = nBytes;
+    state.counters["roundtrips"] = nRoundTrips;
+}
+
+static void FullBlockRelay(benchmark::State& state, bool fEquihash)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const CBlock block = BuildRelayBlock(fEquihash);
+
+    size_t nBytes = 0;
+    while (state.KeepRunning()) {
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+        stream << block;
+        nBytes = stream.size();
+
+        CBlock block2;
+        stream >> block2;
+    }
+
+    state.counters["bytes"] = nBytes;
+    state.counters["roundtrips"] = 1;
+}
+
+static void CompactBlockRelayAuxpow(benchmark::State& state) { CompactBlockRelay(state, false); }
+static void CompactBlockRelayEquihash(benchmark::State& state) { CompactBlockRelay(state, true); }
+static void FullBlockRelayAuxpow(benchmark::State& state) { FullBlockRelay(state, false); }
+static void FullBlockRelayEquihash(benchmark::State& state) { FullBlockRelay(state, true); }
+
+BENCHMARK(CompactBlockRelayAuxpow, 500);
+BENCHMARK(CompactBlockRelayEquihash, 500);
+BENCHMARK(FullBlockRelayAuxpow, 500);
+BENCHMARK(FullBlockRelayEquihash, 500);
@@ -10,6 +10,16 @@
 #include <random.h>
 #include <uint256.h>
 #include <utiltime.h>
+#include <crypto/algos/argon2/argon2.h>
+#include <crypto/algos/argon2/hashargon.h>
+#include <crypto/algos/hashlib/sph_aesni.h>
+#include <crypto/algos/hashlib/sph_echo.h>
+#include <crypto/algos/hashlib/sph_groestl.h>
+#include <crypto/algos/hashlib/sph_shavite.h>
+#include <crypto/algos/neoscrypt/neoscrypt.h>
+#include <crypto/algos/scrypt/scrypt.h>
+#include <crypto/algos/yescrypt/yescrypt.h>
+#include <crypto/algos/yespower/yespower.h>
 #include <crypto/ripemd160.h>
 #include <crypto/sha1.h>
 #include <crypto/sha256.h>
@@ -52,6 +62,270 @@ static void SHA256_32b(benchmark::State& state)
     }
 }
 
+/* 64-byte inputs, the size hashed by each stage of the chained algorithms */
+static void GROESTL512_64b(benchmark::State& state)
+{
+    std::vector<uint8_t> in(64,0);
+    sph_groestl512_context ctx;
+    while (state.KeepRunning()) {
+        sph_groestl512_init(&ctx);
+        sph_groestl512(&ctx, in.data(), in.size());
+        sph_groestl512_close(&ctx, in.data());
+    }
+}
+
+static void GROESTL512_BASE_64b(benchmark::State& state)
+{
+    std::vector<uint8_t> in(64,0);
+    sph_groestl512_context ctx;
+    sph_aesni_use_base();
+    while (state.KeepRunning()) {
+        sph_groestl512_init(&ctx);
+        sph_groestl512(&ctx, in.data(), in.size());
+        sph_groestl512_close(&ctx, in.data());
+    }
+    sph_aesni_autodetect();
+}
+
+static void ECHO512_64b(benchmark::State& state)
+{
+    std::vector<uint8_t> in(64,0);
+    sph_echo512_context ctx;
+    while (state.KeepRunning()) {
+        sph_echo512_init(&ctx);
+        sph_echo512(&ctx, in.data(), in.size());
+        sph_echo512_close(&ctx, in.data());
+    }
+}
+
+static void ECHO512_BASE_64b(benchmark::State& state)
+{
+    std::vector<uint8_t> in(64,0);
+    sph_echo512_context ctx;
+    sph_aesni_use_base();
+    while (state.KeepRunning()) {
+        sph_echo512_init(&ctx);
+        sph_echo512(&ctx, in.data(), in.size());
+        sph_echo512_close(&ctx, in.data());
+    }
+    sph_aesni_autodetect();
+}
+
+static void SHAVITE512_64b(benchmark::State& state)
+{
+    std::vector<uint8_t> in(64,0);
+    sph_shavite512_context ctx;
+    while (state.KeepRunning()) {
+        sph_shavite512_init(&ctx);
+        sph_shavite512(&ctx, in.data(), in.size());
+        sph_shavite512_close(&ctx, in.data());
+    }
+}
+
+static void SHAVITE512_BASE_64b(benchmark::State& state)
+{
+    std::vector<uint8_t> in(64,0);
+    sph_shavite512_context ctx;
+    sph_aesni_use_base();
+    while (state.KeepRunning()) {
+        sph_shavite512_init(&ctx);
+        sph_shavite512(&ctx, in.data(), in.size());
+        sph_shavite512_close(&ctx, in.data());
+    }
+    sph_aesni_autodetect();
+}
+
+/* 80-byte block headers through the memory-hard proof of work algorithms */
+static void SCRYPT_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    while (state.KeepRunning())
+        scrypt_1024_1_1_256(in.data(), (char*)hash.begin());
+}
+
+#if defined(USE_SSE2)
+static void SCRYPT_SSE2_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    std::vector<char> scratchpad(SCRYPT_SCRATCHPAD_SIZE);
+    uint256 hash;
+    while (state.KeepRunning())
+        scrypt_1024_1_1_256_sp_sse2(in.data(), (char*)hash.begin(), scratchpad.data());
+}
+#endif
+
+static void SCRYPT_GENERIC_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    std::vector<char> scratchpad(SCRYPT_SCRATCHPAD_SIZE);
+    uint256 hash;
+    while (state.KeepRunning())
+        scrypt_1024_1_1_256_sp_generic(in.data(), (char*)hash.begin(), scratchpad.data());
+}
+
+/* Groups of headers through the multi-buffer kernels; divide by the group
+ * size for the per-header cost to compare with the single-header benches */
+template <unsigned int N>
+static void SCRYPT_MULTI_80b(benchmark::State& state)
+{
+    std::vector<char> in(80 * N,0);
+    std::vector<const char*> pin;
+    for (unsigned int i = 0; i < N; i++)
+        pin.push_back(&in[80 * i]);
+    std::vector<uint256> hashes(N);
+    while (state.KeepRunning())
+        scrypt_1024_1_1_256_multi(pin.data(), (char*)hashes.data(), N);
+}
+
+static void SCRYPT_4x80b(benchmark::State& state) { SCRYPT_MULTI_80b<4>(state); }
+static void SCRYPT_8x80b(benchmark::State& state) { SCRYPT_MULTI_80b<8>(state); }
+
+static void NEOSCRYPT_80b(benchmark::State& state)
+{
+    std::vector<unsigned char> in(80,0);
+    uint256 hash;
+    while (state.KeepRunning())
+        neoscrypt(in.data(), hash.begin(), 0);
+}
+
+template <unsigned int N>
+static void NEOSCRYPT_MULTI_80b(benchmark::State& state)
+{
+    std::vector<unsigned char> in(80 * N,0);
+    std::vector<const unsigned char*> pin;
+    for (unsigned int i = 0; i < N; i++)
+        pin.push_back(&in[80 * i]);
+    std::vector<uint256> hashes(N);
+    while (state.KeepRunning())
+        neoscrypt_multi(pin.data(), (unsigned char*)hashes.data(), 0, N);
+}
+
+static void NEOSCRYPT_4x80b(benchmark::State& state) { NEOSCRYPT_MULTI_80b<4>(state); }
+static void NEOSCRYPT_8x80b(benchmark::State& state) { NEOSCRYPT_MULTI_80b<8>(state); }
+
+static void YESCRYPT_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    while (state.KeepRunning())
+        yescrypt_hash(in.data(), (char*)hash.begin());
+}
+
+static void YESCRYPT_BASE_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    yescrypt_use_base();
+    while (state.KeepRunning())
+        yescrypt_hash(in.data(), (char*)hash.begin());
+    yescrypt_autodetect();
+}
+
+static void YESCRYPT_REF_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    yescrypt_use_ref();
+    while (state.KeepRunning())
+        yescrypt_hash(in.data(), (char*)hash.begin());
+    yescrypt_autodetect();
+}
+
+static void YESPOWER_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    while (state.KeepRunning())
+        yespower_hash(in.data(), (char*)hash.begin());
+}
+
+static void YESPOWER_BASE_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    yespower_use_base();
+    while (state.KeepRunning())
+        yespower_hash(in.data(), (char*)hash.begin());
+    yespower_autodetect();
+}
+
+static void YESPOWER_REF_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    yespower_use_ref();
+    while (state.KeepRunning())
+        yespower_hash(in.data(), (char*)hash.begin());
+    yespower_autodetect();
+}
+
+static void ARGON2D_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    while (state.KeepRunning())
+        Argon2dHash(in.data(), in.size(), hash.begin(), 32, in.data(), in.size(), in.data(), in.size());
+}
+
+static void ARGON2D_BASE_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    argon2_use_base();
+    while (state.KeepRunning())
+        Argon2dHash(in.data(), in.size(), hash.begin(), 32, in.data(), in.size(), in.data(), in.size());
+    argon2_autodetect();
+}
+
+static void ARGON2D_REF_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    argon2_use_ref();
+    while (state.KeepRunning())
+        Argon2dHash(in.data(), in.size(), hash.begin(), 32, in.data(), in.size(), in.data(), in.size());
+    argon2_autodetect();
+}
+
+static void ARGON2D_LANES_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    Argon2StartLaneThreads(1);
+    while (state.KeepRunning())
+        Argon2dHash(in.data(), in.size(), hash.begin(), 32, in.data(), in.size(), in.data(), in.size());
+    Argon2StopLaneThreads();
+}
+
+static void ARGON2I_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    while (state.KeepRunning())
+        Argon2iHash(in.data(), in.size(), hash.begin(), 32, in.data(), in.size(), in.data(), in.size());
+}
+
+static void ARGON2I_BASE_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    argon2_use_base();
+    while (state.KeepRunning())
+        Argon2iHash(in.data(), in.size(), hash.begin(), 32, in.data(), in.size(), in.data(), in.size());
+    argon2_autodetect();
+}
+
+static void ARGON2I_REF_80b(benchmark::State& state)
+{
+    std::vector<char> in(80,0);
+    uint256 hash;
+    argon2_use_ref();
+    while (state.KeepRunning())
+        Argon2iHash(in.data(), in.size(), hash.begin(), 32, in.data(), in.size(), in.data(), in.size());
+    argon2_autodetect();
+}
+
 static void SHA512(benchmark::State& state)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -93,6 +367,35 @@ BENCHMARK(SHA256, 340);
 BENCHMARK(SHA512, 330);
 
 BENCHMARK(SHA256_32b, 4700 * 1000);
+BENCHMARK(GROESTL512_64b, 1000 * 1000);
+BENCHMARK(GROESTL512_BASE_64b, 500 * 1000);
+BENCHMARK(ECHO512_64b, 2000 * 1000);
+BENCHMARK(ECHO512_BASE_64b, 500 * 1000);
+BENCHMARK(SHAVITE512_64b, 2000 * 1000);
+BENCHMARK(SHAVITE512_BASE_64b, 500 * 1000);
+BENCHMARK(SCRYPT_80b, 8 * 1000);
+#if defined(USE_SSE2)
+BENCHMARK(SCRYPT_SSE2_80b, 4 * 1000);
+#endif
+BENCHMARK(SCRYPT_GENERIC_80b, 8 * 1000);
+BENCHMARK(SCRYPT_4x80b, 2 * 1000);
+BENCHMARK(SCRYPT_8x80b, 1 * 1000);
+BENCHMARK(NEOSCRYPT_80b, 6 * 1000);
+BENCHMARK(NEOSCRYPT_4x80b, 2 * 1000);
+BENCHMARK(NEOSCRYPT_8x80b, 1 * 1000);
+BENCHMARK(YESCRYPT_80b, 1000);
+BENCHMARK(YESCRYPT_BASE_80b, 1000);
+BENCHMARK(YESCRYPT_REF_80b, 500);
+BENCHMARK(YESPOWER_80b, 350);
+BENCHMARK(YESPOWER_BASE_80b, 350);
+BENCHMARK(YESPOWER_REF_80b, 20);
+BENCHMARK(ARGON2D_80b, 4 * 1000);
+BENCHMARK(ARGON2D_BASE_80b, 2 * 1000);
+BENCHMARK(ARGON2D_REF_80b, 2 * 1000);
+BENCHMARK(ARGON2D_LANES_80b, 4 * 1000);
+BENCHMARK(ARGON2I_80b, 4 * 1000);
+BENCHMARK(ARGON2I_BASE_80b, 2 * 1000);
+BENCHMARK(ARGON2I_REF_80b, 2 * 1000);
 BENCHMARK(SipHash_32b, 40 * 1000 * 1000);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
@@ -0,0 +1,121 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <crypto/algos/hashlib/multihash.h>
+#include <globaltoken/multihasher.h>
+#include <hash.h>
+#include <primitives/mining_block.h>
+#include <random.h>
+#include <uint256.h>
+
+#include <vector>
+
+/* Algorithms whose stage order comes from the previous block hash. The _REF
+ * benches run the original hash functions, which pick every stage through a
+ * switch while hashing. The others run the hash chain engine: a miner rolling
+ * the nonce reuses the order decoded for its parent, alone or 8 headers at a
+ * time, while _NEWPREV decodes it for every header as when checking a chain
+ * of headers. */
+template <uint8_t nAlgo>
+static void PREVORDERED_80b(benchmark::State& state)
+{
+    CDefaultBlockHeader header;
+    header.hashPrevBlock = GetRandHash();
+    while (state.KeepRunning()) {
+        header.nNonce++;
+        SerializeMultiAlgoHash(header, nAlgo);
+    }
+}
+
+template <uint8_t nAlgo>
+static void PREVORDERED_NEWPREV_80b(benchmark::State& state)
+{
+    CDefaultBlockHeader header;
+    header.hashPrevBlock = GetRandHash();
+    while (state.KeepRunning()) {
+        header.hashPrevBlock = Hash(header.hashPrevBlock.begin(), header.hashPrevBlock.end());
+        SerializeMultiAlgoHash(header, nAlgo);
+    }
+}
+
+template <uint8_t nAlgo>
+static void PREVORDERED_8x80b(benchmark::State& state)
+{
+    std::vector<CDefaultBlockHeader> headers(8);
+    std::vector<const CDefaultBlockHeader*> pheaders;
+    const uint256 hashPrevBlock = GetRandHash();
+    for (CDefaultBlockHeader& header : headers) {
+        header.hashPrevBlock = hashPrevBlock;
+        pheaders.push_back(&header);
+    }
+    uint256 hashes[8];
+    while (state.KeepRunning()) {
+        for (CDefaultBlockHeader& header : headers)
+            header.nNonce += 8;
+        SerializeMultiAlgoHashBatch(pheaders.data(), pheaders.size(), nAlgo, hashes);
+    }
+}
+
+static void X16R_REF_80b(benchmark::State& state)
+{
+    std::vector<unsigned char> in(80,0);
+    const uint256 hashPrevBlock = GetRandHash();
+    while (state.KeepRunning())
+        HashX16R(in.begin(), in.end(), hashPrevBlock);
+}
+
+static void X16S_REF_80b(benchmark::State& state)
+{
+    std::vector<unsigned char> in(80,0);
+    const uint256 hashPrevBlock = GetRandHash();
+    while (state.KeepRunning())
+        HashX16s(in.begin(), in.end(), hashPrevBlock);
+}
+
+static void X21S_REF_80b(benchmark::State& state)
+{
+    std::vector<unsigned char> in(80,0);
+    const uint256 hashPrevBlock = GetRandHash();
+    while (state.KeepRunning())
+        HashX21S(in.begin(), in.end(), hashPrevBlock);
+}
+
+static void CPU23R_REF_80b(benchmark::State& state)
+{
+    std::vector<unsigned char> in(80,0);
+    const uint256 hashPrevBlock = GetRandHash();
+    while (state.KeepRunning())
+        HashCPU23R(in.begin(), in.end(), hashPrevBlock);
+}
+
+static void X16R_80b(benchmark::State& state) { PREVORDERED_80b<ALGO_X16R>(state); }
+static void X16R_NEWPREV_80b(benchmark::State& state) { PREVORDERED_NEWPREV_80b<ALGO_X16R>(state); }
+static void X16R_8x80b(benchmark::State& state) { PREVORDERED_8x80b<ALGO_X16R>(state); }
+static void X16S_80b(benchmark::State& state) { PREVORDERED_80b<ALGO_X16S>(state); }
+static void X16S_NEWPREV_80b(benchmark::State& state) { PREVORDERED_NEWPREV_80b<ALGO_X16S>(state); }
+static void X16S_8x80b(benchmark::State& state) { PREVORDERED_8x80b<ALGO_X16S>(state); }
+static void X21S_80b(benchmark::State& state) { PREVORDERED_80b<ALGO_X21S>(state); }
+static void X21S_NEWPREV_80b(benchmark::State& state) { PREVORDERED_NEWPREV_80b<ALGO_X21S>(state); }
+static void X21S_8x80b(benchmark::State& state) { PREVORDERED_8x80b<ALGO_X21S>(state); }
+static void CPU23R_80b(benchmark::State& state) { PREVORDERED_80b<ALGO_CPU23R>(state); }
+static void CPU23R_NEWPREV_80b(benchmark::State& state) { PREVORDERED_NEWPREV_80b<ALGO_CPU23R>(state); }
+static void CPU23R_8x80b(benchmark::State& state) { PREVORDERED_8x80b<ALGO_CPU23R>(state); }
+
+BENCHMARK(X16R_REF_80b, 10 * 1000);
+BENCHMARK(X16R_80b, 10 * 1000);
+BENCHMARK(X16R_NEWPREV_80b, 10 * 1000);
+BENCHMARK(X16R_8x80b, 2 * 1000);
+BENCHMARK(X16S_REF_80b, 10 * 1000);
+BENCHMARK(X16S_80b, 10 * 1000);
+BENCHMARK(X16S_NEWPREV_80b, 10 * 1000);
+BENCHMARK(X16S_8x80b, 2 * 1000);
+BENCHMARK(X21S_REF_80b, 1000);
+BENCHMARK(X21S_80b, 1000);
+BENCHMARK(X21S_NEWPREV_80b, 1000);
+BENCHMARK(X21S_8x80b, 200);
+BENCHMARK(CPU23R_REF_80b, 100);
+BENCHMARK(CPU23R_80b, 100);
+BENCHMARK(CPU23R_NEWPREV_80b, 100);
+BENCHMARK(CPU23R_8x80b, 20);
@@ -0,0 +1,150 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <bench/bench.h>
+#include <hash.h>
+#include <rpc/register.h>
+#include <rpc/server.h>
+#include <uint256.h>
+#include <util.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+static const size_t BATCH_ENTRIES = 1000;
+static const int BATCH_THREADS = 3;
+
+/** About the work of serializing and hex encoding a transaction for getrawtransaction */
+static UniValue benchbatchwork(const JSONRPCRequest& request)
+{
+    uint256 hash = ParseHashV(request.params[0], "hash");
+    for (int i = 0; i < 200; i++)
+        hash = Hash(hash.begin(), hash.end());
+    return hash.GetHex();
+}
+
+static const CRPCCommand benchCommands[] =
+{ //  category              name                      actor (function)         argNames
+  //  --------------------- ------------------------  -----------------------  ----------
+    { "hidden",             "benchbatchwork",         &benchbatchwork,         {"hash"} },
+};
+
+/** A few threads standing in for the HTTP workers */
+class BenchBatchInterface : public RPCBatchInterface
+{
+public:
+    explicit BenchBatchInterface(int nThreads) : fStop(false)
+    {
+        for (int i = 0; i < nThreads; i++)
+            threads.emplace_back([this] { Run(); });
+    }
+    ~BenchBatchInterface()
+    {
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            fStop = true;
+        }
+        cond.notify_all();
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+    const char* Name() override
+    {
+        return "bench";
+    }
+    bool Dispatch(const std::function<void(void)>& func) override
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        queue.push_back(func);
+        cond.notify_one();
+        return true;
+    }
+
+private:
+    std::mutex cs;
+    std::condition_variable cond;
+    std::deque<std::function<void(void)>> queue;
+    std::vector<std::thread> threads;
+    bool fStop;
+
+    void Run()
+    {
+        while (true) {
+            std::function<void(void)> func;
+            {
+                std::unique_lock<std::mutex> lock(cs);
+                cond.wait(lock, [this] { return fStop || !queue.empty(); });
+                if (fStop)
+                    return;
+                func = std::move(queue.front());
+                queue.pop_front();
+            }
+            func();
+        }
+    }
+};
+
+static UniValue MakeBatch(const std::string& strMethod)
+{
+    UniValue vReq(UniValue::VARR);
+    for (size_t i = 0; i < BATCH_ENTRIES; i++) {
+        UniValue req(UniValue::VOBJ);
+        req.pushKV("id", (uint64_t)i);
+        req.pushKV("method", strMethod);
+        UniValue params(UniValue::VARR);
+        if (strMethod == "benchbatchwork")
+            params.push_back(ArithToUint256(arith_uint256(i)).GetHex());
+        req.pushKV("params", params);
+        vReq.push_back(req);
+    }
+    return vReq;
+}
+
+static void RunBatch(benchmark::State& state, const std::string& strMethod, int nThreads, bool fLockGroups)
+{
+    // Registering again fails without harm
+    for (const CRPCCommand& command : benchCommands)
+        tableRPC.appendCommand(command.name, &command);
+    RegisterBlockchainRPCCommands(tableRPC);
+    if (RPCIsInWarmup(nullptr))
+        SetRPCWarmupFinished();
+    gArgs.ForceSetArg("-rpcbatchthreads", std::to_string(nThreads));
+    gArgs.ForceSetArg("-rpcbatchlockgroups", fLockGroups ? "1" : "0");
+
+    BenchBatchInterface batchInterface(nThreads);
+    RPCSetBatchInterface(&batchInterface);
+    const UniValue vReq = MakeBatch(strMethod);
+    JSONRPCRequest jreq;
+    while (state.KeepRunning())
+        JSONRPCExecBatch(jreq, vReq);
+    RPCUnsetBatchInterface(&batchInterface);
+}
+
+static void RPCBatchSequential(benchmark::State& state)
+{
+    RunBatch(state, "benchbatchwork", 0, false);
+}
+
+static void RPCBatchParallel(benchmark::State& state)
+{
+    RunBatch(state, "benchbatchwork", BATCH_THREADS, false);
+}
+
+static void RPCBatchLockMain(benchmark::State& state)
+{
+    RunBatch(state, "getblockcount", 0, false);
+}
+
+static void RPCBatchLockGroups(benchmark::State& state)
+{
+    RunBatch(state, "getblockcount", 0, true);
+}
+
+BENCHMARK(RPCBatchSequential, 20);
+BENCHMARK(RPCBatchParallel, 50);
+BENCHMARK(RPCBatchLockMain, 500);
+BENCHMARK(RPCBatchLockGroups, 500);
@@ -0,0 +1,96 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <miner.h>
+#include <rpc/jsonstream.h>
+#include <rpc/mining.h>
+#include <streams.h>
+#include <version.h>
+
+namespace block_bench {
+#include <bench/data/block413567.raw.h>
+} // namespace block_bench
+
+/** A template with the transactions of a full block */
+static CBlockTemplate MakeFullTemplate()
+{
+    CDataStream stream((const char*)block_bench::block413567,
+            (const char*)&block_bench::block413567[sizeof(block_bench::block413567)],
+            SER_NETWORK, PROTOCOL_VERSION);
+    CBlockTemplate blocktemplate;
+    stream >> blocktemplate.block;
+    blocktemplate.vTxFees.assign(blocktemplate.block.vtx.size(), 1000);
+    blocktemplate.vTxSigOpsCost.assign(blocktemplate.block.vtx.size(), 4);
+    return blocktemplate;
+}
+
+/**
+ * getblocktemplate replies for nAlgos algos asked for in turn, with a full
+ * mempool. Without fCache there is one template for all algos, as before
+ * the templates were kept per algo, so every call remakes it.
+ */
+static void BlockTemplateReply(benchmark::State& state, size_t nAlgos, bool fCache)
+{
+    const CBlockTemplate blocktemplate = MakeFullTemplate();
+    std::vector<CGBTTemplate> templates(fCache ? nAlgos : 1);
+    std::vector<size_t> vTemplateAlgo(templates.size(), nAlgos);
+    size_t nCall = 0;
+    std::string strReply;
+    while (state.KeepRunning()) {
+        const size_t nAlgo = nCall++ % nAlgos;
+        const size_t nSlot = fCache ? nAlgo : 0;
+        CGBTTemplate& gbt = templates[nSlot];
+        if (vTemplateAlgo[nSlot] != nAlgo) {
+            gbt.Set(std::unique_ptr<CBlockTemplate>(new CBlockTemplate(blocktemplate)), false);
+            vTemplateAlgo[nSlot] = nAlgo;
+        }
+
+        // What changes from call to call, around the serialized transactions
+        strReply.clear();
+        JSONStreamWriter writer([&strReply](const char* data, size_t size) { strReply.append(data, size); });
+        writer.BeginObject();
+        writer.Key("previousblockhash");
+        writer.Value(gbt.pblocktemplate->block.hashPrevBlock.GetHex());
+        writer.Key("transactions");
+        writer.RawValue(gbt.GetTransactionsJSON());
+        writer.Key("coinbasevalue");
+        writer.Value((int64_t)gbt.pblocktemplate->block.vtx[0]->GetValueOut());
+        writer.Key("curtime");
+        writer.Value((int64_t)nCall);
+        writer.EndObject();
+        writer.Flush();
+    }
+}
+
+static void BlockTemplateOneAlgo(benchmark::State& state)
+{
+    BlockTemplateReply(state, 1, true);
+}
+
+static void BlockTemplateTenAlgos(benchmark::State& state)
+{
+    BlockTemplateReply(state, 10, true);
+}
+
+static void BlockTemplateSixtyAlgos(benchmark::State& state)
+{
+    BlockTemplateReply(state, 60, true);
+}
+
+static void BlockTemplateTenAlgosUncached(benchmark::State& state)
+{
+    BlockTemplateReply(state, 10, false);
+}
+
+static void BlockTemplateSixtyAlgosUncached(benchmark::State& state)
+{
+    BlockTemplateReply(state, 60, false);
+}
+
+BENCHMARK(BlockTemplateOneAlgo, 500);
+BENCHMARK(BlockTemplateTenAlgos, 500);
+BENCHMARK(BlockTemplateSixtyAlgos, 500);
+BENCHMARK(BlockTemplateTenAlgosUncached, 10);
+BENCHMARK(BlockTemplateSixtyAlgosUncached, 10);
@@ -196,8 +196,12 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
     if (vtx_missing.size() != tx_missing_offset)
         return READ_STATUS_INVALID;
 
+    // The header (including its auxpow or Equihash solution) was already
+    // checked when it was accepted, and ProcessNewBlock checks it again, so
+    // skip the proof of work here to avoid verifying it a third time.
+    // CheckBlock does not cache its result when fCheckPOW is false.
     CValidationState state;
-    if (!CheckBlock(block, state, Params().GetConsensus())) {
+    if (!CheckBlock(block, state, Params().GetConsensus(), /*fCheckPOW=*/false)) {
         // TODO: We really want to just check merkle tree manually here,
         // but that is expensive, and CheckBlock caches a block's
         // "checked-status" (in the CBlock?). CBlock should be able to
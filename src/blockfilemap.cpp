@@ -0,0 +1,121 @@
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockfilemap.h>
+
+#include <util.h>
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CMappedBlockFile::~CMappedBlockFile()
+{
+#ifndef WIN32
+    munmap(const_cast<unsigned char*>(pdata), nSize);
+#endif
+}
+
+static std::shared_ptr<const CMappedBlockFile> MapFile(const fs::path& path)
+{
+#ifndef WIN32
+    int fd = open(path.string().c_str(), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        LogPrintf("Unable to map %s: %s\n", path.string(), strerror(errno));
+        return nullptr;
+    }
+    return std::make_shared<const CMappedBlockFile>(static_cast<const unsigned char*>(p), st.st_size);
+#else
+    return nullptr;
+#endif
+}
+
+CBlockFileMapCache::CBlockFileMapCache(int nMaxFilesIn) : nMaxFiles(nMaxFilesIn)
+{
+}
+
+void CBlockFileMapCache::SetMaxFiles(int nMaxFilesIn)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    nMaxFiles = nMaxFilesIn;
+    while ((int)mapFiles.size() > std::max(nMaxFiles, 0)) {
+        mapFiles.erase(lruFiles.back());
+        lruFiles.pop_back();
+    }
+}
+
+std::shared_ptr<const CMappedBlockFile> CBlockFileMapCache::Get(int nFile, const fs::path& path, uint64_t nEnd)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    if (nMaxFiles <= 0)
+        return nullptr;
+
+    auto it = mapFiles.find(nFile);
+    if (it != mapFiles.end()) {
+        lruFiles.splice(lruFiles.begin(), lruFiles, it->second.itLRU);
+        if (nEnd <= it->second.mapping->size())
+            return it->second.mapping;
+        // The file has grown since it was mapped
+        lruFiles.erase(it->second.itLRU);
+        mapFiles.erase(it);
+    }
+
+    std::shared_ptr<const CMappedBlockFile> mapping = MapFile(path);
+    if (!mapping)
+        return nullptr;
+
+    if ((int)mapFiles.size() >= nMaxFiles) {
+        mapFiles.erase(lruFiles.back());
+        lruFiles.pop_back();
+    }
+    lruFiles.push_front(nFile);
+    Entry& entry = mapFiles[nFile];
+    entry.mapping = mapping;
+    entry.itLRU = lruFiles.begin();
+
+    if (nEnd > mapping->size())
+        return nullptr;
+    return mapping;
+}
+
+void CBlockFileMapCache::Invalidate(int nFile)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = mapFiles.find(nFile);
+    if (it != mapFiles.end()) {
+        lruFiles.erase(it->second.itLRU);
+        mapFiles.erase(it);
+    }
+}
+
+void CBlockFileMapCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(cs);
+    mapFiles.clear();
+    lruFiles.clear();
+}
+
+size_t CBlockFileMapCache::Size() const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    return mapFiles.size();
+}
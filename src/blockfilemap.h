@@ -0,0 +1,86 @@
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BLOCKFILEMAP_H
+#define BITCOIN_BLOCKFILEMAP_H
+
+#include <fs.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+/** Default for -blockmapfiles, number of block files kept memory mapped for reading */
+static const int DEFAULT_BLOCK_MAP_FILES = 16;
+/** Maximum for -blockmapfiles */
+static const int MAX_BLOCK_MAP_FILES = 1024;
+
+/** A read-only memory mapping of a complete block file. */
+class CMappedBlockFile
+{
+public:
+    CMappedBlockFile(const unsigned char* pdataIn, size_t nSizeIn) : pdata(pdataIn), nSize(nSizeIn) {}
+    ~CMappedBlockFile();
+
+    CMappedBlockFile(const CMappedBlockFile&) = delete;
+    CMappedBlockFile& operator=(const CMappedBlockFile&) = delete;
+
+    const unsigned char* data() const { return pdata; }
+    size_t size() const { return nSize; }
+
+private:
+    const unsigned char* pdata;
+    size_t nSize;
+};
+
+/**
+ * Cache of memory mapped block files, used to read blocks without going
+ * through fopen/fseek and stdio buffering for every request.
+ *
+ * A mapping covers the file as it was when it was mapped. The file that is
+ * currently being written to keeps growing, so a request for a range past
+ * the end of an existing mapping remaps the file. Readers hold a shared_ptr
+ * to the mapping, so evicting or invalidating an entry never unmaps memory
+ * that is still being read.
+ *
+ * Memory mapping is not used on Windows; Get() always returns nullptr there
+ * and callers fall back to regular file reads.
+ */
+class CBlockFileMapCache
+{
+public:
+    explicit CBlockFileMapCache(int nMaxFilesIn);
+
+    /** Set the maximum number of mapped files (0 disables mapping). */
+    void SetMaxFiles(int nMaxFilesIn);
+
+    /**
+     * Return a mapping of block file nFile at path that is at least nEnd
+     * bytes long, or nullptr if the file could not be mapped or is shorter.
+     */
+    std::shared_ptr<const CMappedBlockFile> Get(int nFile, const fs::path& path, uint64_t nEnd);
+
+    /** Forget the mapping of nFile, e.g. after the file was pruned. */
+    void Invalidate(int nFile);
+    void Clear();
+
+    size_t Size() const;
+
+private:
+    typedef std::list<int> LRUList;
+    struct Entry
+    {
+        std::shared_ptr<const CMappedBlockFile> mapping;
+        LRUList::iterator itLRU;
+    };
+
+    mutable std::mutex cs;
+    int nMaxFiles;
+    std::map<int, Entry> mapFiles;
+    LRUList lruFiles; // most recently used at the front
+};
+
+#endif // BITCOIN_BLOCKFILEMAP_H
@@ -6,6 +6,8 @@
 #include <chain.h>
 #include <bignum.h>
 #include <globaltoken/hardfork.h>
+#include <globaltoken/multihasher.h>
+#include <powcache.h>
 #include <validation.h>
 
 CBlockHeader CBlockIndex::GetBlockHeader(const Consensus::Params& consensusParams) const
@@ -32,6 +34,19 @@ CBlockHeader CBlockIndex::GetBlockHeader(const Consensus::Params& consensusParam
     return block;
 }
 
+uint256 CBlockIndex::GetBlockPoWHash() const
+{
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    const int powHashFlags = LoadMultiHasherVersionFlags(consensusParams.Hardfork3.IsActivated(nTime));
+    // Looked up by the index hash, so auxpow headers are only read from disk on a miss
+    uint256 hashPoW;
+    if (GetCachedPoWHash(GetBlockHash(), GetAlgo(), powHashFlags, hashPoW))
+        return hashPoW;
+    hashPoW = GetBlockHeader(consensusParams).GetPoWHash(SER_GETHASH, powHashFlags);
+    AddCachedPoWHash(GetBlockHash(), GetAlgo(), powHashFlags, hashPoW);
+    return hashPoW;
+}
+
 /**
  * CChain implementation
  */
@@ -294,12 +294,8 @@ public:
         return *phashBlock;
     }
 	
-	uint256 GetBlockPoWHash() const
-    {
-        const Consensus::Params& consensusParams = Params().GetConsensus();
-        CBlockHeader block = GetBlockHeader(consensusParams);
-        return block.GetPoWHash(SER_GETHASH, LoadMultiHasherVersionFlags(consensusParams.Hardfork3.IsActivated(block.nTime)));
-    }
+	//! PoW hash of the header itself, through the PoW cache
+	uint256 GetBlockPoWHash() const;
 
     uint8_t GetAlgo() const
     {
@@ -387,6 +383,8 @@ public:
 
 arith_uint256 GetBlockProof(const CBlockIndex& block);
 arith_uint256 GetBlockProof(const CBlockIndex& block, const Consensus::Params&);
+/** Work implied by the block's own nBits, as summed by CalculateAlgoHashrate. */
+arith_uint256 GetBlockProofBase(const CBlockIndex& block);
 double CalculateAlgoHashrate(const CBlockIndex& block, int algo, int lookup, const Consensus::Params&);
 /** Return the time it would take to redo the work difference between from and to, assuming the current hashrate corresponds to the difficulty at tip, in seconds. */
 int64_t GetBlockProofEquivalentTime(const CBlockIndex& to, const CBlockIndex& from, const CBlockIndex& tip, const Consensus::Params&);
@@ -0,0 +1,7 @@
+/*
+ * The Argon2 segment filler built with AVX2 enabled, as fill_segment_avx2.
+ * Selected at runtime by argon2_autodetect() in argon2-helper.c.
+ */
+#define fill_segment fill_segment_avx2
+#define fill_block fill_block_avx2
+#include "opt.c"
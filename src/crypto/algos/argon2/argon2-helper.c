@@ -1,5 +1,107 @@
+/*
+ * The segment filler for the compiler's baseline instruction set is built
+ * here as fill_segment_base. fill_segment() runs the one installed by
+ * argon2_autodetect(), which may be the AVX2 build in argon2-avx2.c.
+ */
+#define fill_segment fill_segment_base
 #if defined (__SSE2__)
 #include "opt.c"
 #else
 #include "ref.c"
-#endif
\ No newline at end of file
+#endif
+#undef fill_segment
+
+#include <assert.h>
+
+#include "../cpufeatures.h"
+
+#if defined(__x86_64__) && defined(ALGOS_HAVE_CPUID)
+#define ARGON2_DISPATCH 1
+#else
+#define ARGON2_DISPATCH 0
+#endif
+
+#if defined(__AVX2__)
+#define ARGON2_BASE_NAME "avx2"
+#elif defined(__SSE2__)
+#define ARGON2_BASE_NAME "sse2"
+#else
+#define ARGON2_BASE_NAME "standard"
+#endif
+
+typedef void fill_segment_fn(const argon2_instance_t *instance,
+                             argon2_position_t position);
+
+#if ARGON2_DISPATCH && defined(ENABLE_AVX2)
+extern fill_segment_fn fill_segment_avx2;
+#endif
+
+extern fill_segment_fn fill_segment_ref;
+
+static fill_segment_fn *fill_segment_selected = fill_segment_base;
+
+void fill_segment(const argon2_instance_t *instance,
+                  argon2_position_t position) {
+    fill_segment_selected(instance, position);
+}
+
+#if ARGON2_DISPATCH && defined(ENABLE_AVX2)
+static int argon2_self_test_hash(argon2_type type, uint8_t *out, size_t outlen) {
+    static const char pwd[] = "argon2 self test";
+    static const char salt[] = "globaltoken";
+    argon2_context context;
+
+    memset(&context, 0, sizeof(context));
+    context.out = out;
+    context.outlen = (uint32_t)outlen;
+    context.pwd = (uint8_t *)pwd;
+    context.pwdlen = sizeof(pwd) - 1;
+    context.salt = (uint8_t *)salt;
+    context.saltlen = sizeof(salt) - 1;
+    context.t_cost = 2;
+    context.m_cost = 64;
+    context.lanes = 2;
+    context.threads = 1;
+    context.version = ARGON2_VERSION_13;
+    context.flags = ARGON2_DEFAULT_FLAGS;
+    return argon2_ctx(&context, type);
+}
+
+/* Compare a segment filler with the baseline one on small instances. */
+static int argon2_self_test(fill_segment_fn *fill) {
+    static const argon2_type types[] = {Argon2_d, Argon2_i};
+    uint8_t expected[32], actual[32];
+    size_t i;
+    int ok = 1;
+
+    for (i = 0; ok && i < sizeof(types) / sizeof(types[0]); i++) {
+        fill_segment_selected = fill_segment_base;
+        ok = argon2_self_test_hash(types[i], expected, sizeof(expected)) == ARGON2_OK;
+        fill_segment_selected = fill;
+        ok = ok && argon2_self_test_hash(types[i], actual, sizeof(actual)) == ARGON2_OK &&
+             !memcmp(expected, actual, sizeof(expected));
+    }
+    return ok;
+}
+#endif
+
+const char *argon2_autodetect(void) {
+#if ARGON2_DISPATCH && defined(ENABLE_AVX2)
+    if (algos_cpu_has_avx2()) {
+        assert(argon2_self_test(fill_segment_avx2));
+        fill_segment_selected = fill_segment_avx2;
+        return "avx2";
+    }
+#endif
+    return argon2_use_base();
+}
+
+const char *argon2_use_base(void) {
+    fill_segment_selected = fill_segment_base;
+    return ARGON2_BASE_NAME;
+}
+
+const char *argon2_use_ref(void) {
+    fill_segment_selected = fill_segment_ref;
+    return "ref";
+}
@@ -0,0 +1,7 @@
+/*
+ * The reference Argon2 segment filler, as fill_segment_ref. Selected by
+ * argon2_use_ref() in argon2-helper.c to cross-check the SIMD kernels.
+ */
+#define fill_segment fill_segment_ref
+#define fill_block fill_block_ref
+#include "ref.c"
@@ -428,6 +428,31 @@ ARGON2_PUBLIC size_t argon2_encodedlen(uint32_t t_cost, uint32_t m_cost,
                                        uint32_t parallelism, uint32_t saltlen,
                                        uint32_t hashlen, argon2_type type);
 
+/*
+ * Make the memory fill use the segment filler built for the newest
+ * instruction set the CPU supports, after checking it against the baseline
+ * one. Returns the name of the instruction set used.
+ *
+ * MT-unsafe: call once at startup, before any hashing.
+ */
+const char *argon2_autodetect(void);
+
+/*
+ * Make the memory fill use the segment filler built for the compiler's
+ * baseline instruction set. Returns its name.
+ *
+ * MT-unsafe.
+ */
+const char *argon2_use_base(void);
+
+/*
+ * Make the memory fill use the segment filler from ref.c, the reference the
+ * SIMD kernels are tested against. Returns "ref".
+ *
+ * MT-unsafe.
+ */
+const char *argon2_use_ref(void);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -20,6 +20,134 @@
 
 #include <crypto/algos/blake/blake2-impl.h>
 
+#if defined(__AVX2__)
+
+/*
+ * BlaMka rounds on four 64-bit words per register. The first pass keeps two
+ * 16 word columns in A0..D0 and A1..D1, one row of four words each; the
+ * second pass keeps two rows of the block interleaved, two words of each
+ * per register.
+ */
+#include <immintrin.h>
+
+#define rotr32(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define rotr24(x)                                                              \
+    _mm256_shuffle_epi8((x), _mm256_setr_epi8(                                 \
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,                  \
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10))
+#define rotr16(x)                                                              \
+    _mm256_shuffle_epi8((x), _mm256_setr_epi8(                                 \
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,                  \
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9))
+#define rotr63(x) _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+static BLAKE2_INLINE __m256i fBlaMka_avx2(__m256i x, __m256i y) {
+    const __m256i z = _mm256_mul_epu32(x, y);
+    return _mm256_add_epi64(_mm256_add_epi64(x, y), _mm256_add_epi64(z, z));
+}
+
+#define G1_AVX2(A0, B0, C0, D0, A1, B1, C1, D1)                                \
+    do {                                                                       \
+        A0 = fBlaMka_avx2(A0, B0);                                             \
+        A1 = fBlaMka_avx2(A1, B1);                                             \
+        D0 = rotr32(_mm256_xor_si256(D0, A0));                                 \
+        D1 = rotr32(_mm256_xor_si256(D1, A1));                                 \
+        C0 = fBlaMka_avx2(C0, D0);                                             \
+        C1 = fBlaMka_avx2(C1, D1);                                             \
+        B0 = rotr24(_mm256_xor_si256(B0, C0));                                 \
+        B1 = rotr24(_mm256_xor_si256(B1, C1));                                 \
+    } while ((void)0, 0)
+
+#define G2_AVX2(A0, B0, C0, D0, A1, B1, C1, D1)                                \
+    do {                                                                       \
+        A0 = fBlaMka_avx2(A0, B0);                                             \
+        A1 = fBlaMka_avx2(A1, B1);                                             \
+        D0 = rotr16(_mm256_xor_si256(D0, A0));                                 \
+        D1 = rotr16(_mm256_xor_si256(D1, A1));                                 \
+        C0 = fBlaMka_avx2(C0, D0);                                             \
+        C1 = fBlaMka_avx2(C1, D1);                                             \
+        B0 = rotr63(_mm256_xor_si256(B0, C0));                                 \
+        B1 = rotr63(_mm256_xor_si256(B1, C1));                                 \
+    } while ((void)0, 0)
+
+/* Columns: rotate the words of B, C and D by one, two and three. */
+#define DIAGONALIZE_1(A0, B0, C0, D0, A1, B1, C1, D1)                          \
+    do {                                                                       \
+        B0 = _mm256_permute4x64_epi64(B0, _MM_SHUFFLE(0, 3, 2, 1));            \
+        C0 = _mm256_permute4x64_epi64(C0, _MM_SHUFFLE(1, 0, 3, 2));            \
+        D0 = _mm256_permute4x64_epi64(D0, _MM_SHUFFLE(2, 1, 0, 3));            \
+        B1 = _mm256_permute4x64_epi64(B1, _MM_SHUFFLE(0, 3, 2, 1));            \
+        C1 = _mm256_permute4x64_epi64(C1, _MM_SHUFFLE(1, 0, 3, 2));            \
+        D1 = _mm256_permute4x64_epi64(D1, _MM_SHUFFLE(2, 1, 0, 3));            \
+    } while ((void)0, 0)
+
+#define UNDIAGONALIZE_1(A0, B0, C0, D0, A1, B1, C1, D1)                        \
+    do {                                                                       \
+        B0 = _mm256_permute4x64_epi64(B0, _MM_SHUFFLE(2, 1, 0, 3));            \
+        C0 = _mm256_permute4x64_epi64(C0, _MM_SHUFFLE(1, 0, 3, 2));            \
+        D0 = _mm256_permute4x64_epi64(D0, _MM_SHUFFLE(0, 3, 2, 1));            \
+        B1 = _mm256_permute4x64_epi64(B1, _MM_SHUFFLE(2, 1, 0, 3));            \
+        C1 = _mm256_permute4x64_epi64(C1, _MM_SHUFFLE(1, 0, 3, 2));            \
+        D1 = _mm256_permute4x64_epi64(D1, _MM_SHUFFLE(0, 3, 2, 1));            \
+    } while ((void)0, 0)
+
+/* Rows: the words of B and D move between the two registers of a row. */
+#define DIAGONALIZE_2(A0, B0, C0, D0, A1, B1, C1, D1)                          \
+    do {                                                                       \
+        __m256i t0 = _mm256_blend_epi32(B0, B1, 0xCC);                         \
+        __m256i t1 = _mm256_blend_epi32(B0, B1, 0x33);                         \
+        B1 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2, 3, 0, 1));            \
+        B0 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2, 3, 0, 1));            \
+                                                                               \
+        t0 = C0;                                                               \
+        C0 = C1;                                                               \
+        C1 = t0;                                                               \
+                                                                               \
+        t0 = _mm256_blend_epi32(D0, D1, 0xCC);                                 \
+        t1 = _mm256_blend_epi32(D0, D1, 0x33);                                 \
+        D0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2, 3, 0, 1));            \
+        D1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2, 3, 0, 1));            \
+    } while ((void)0, 0)
+
+#define UNDIAGONALIZE_2(A0, B0, C0, D0, A1, B1, C1, D1)                        \
+    do {                                                                       \
+        __m256i t0 = _mm256_blend_epi32(B0, B1, 0xCC);                         \
+        __m256i t1 = _mm256_blend_epi32(B0, B1, 0x33);                         \
+        B0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2, 3, 0, 1));            \
+        B1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2, 3, 0, 1));            \
+                                                                               \
+        t0 = C0;                                                               \
+        C0 = C1;                                                               \
+        C1 = t0;                                                               \
+                                                                               \
+        t0 = _mm256_blend_epi32(D0, D1, 0x33);                                 \
+        t1 = _mm256_blend_epi32(D0, D1, 0xCC);                                 \
+        D0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2, 3, 0, 1));            \
+        D1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2, 3, 0, 1));            \
+    } while ((void)0, 0)
+
+#define BLAKE2_ROUND_1(A0, B0, C0, D0, A1, B1, C1, D1)                         \
+    do {                                                                       \
+        G1_AVX2(A0, B0, C0, D0, A1, B1, C1, D1);                               \
+        G2_AVX2(A0, B0, C0, D0, A1, B1, C1, D1);                               \
+        DIAGONALIZE_1(A0, B0, C0, D0, A1, B1, C1, D1);                         \
+        G1_AVX2(A0, B0, C0, D0, A1, B1, C1, D1);                               \
+        G2_AVX2(A0, B0, C0, D0, A1, B1, C1, D1);                               \
+        UNDIAGONALIZE_1(A0, B0, C0, D0, A1, B1, C1, D1);                       \
+    } while ((void)0, 0)
+
+#define BLAKE2_ROUND_2(A0, B0, C0, D0, A1, B1, C1, D1)                         \
+    do {                                                                       \
+        G1_AVX2(A0, B0, C0, D0, A1, B1, C1, D1);                               \
+        G2_AVX2(A0, B0, C0, D0, A1, B1, C1, D1);                               \
+        DIAGONALIZE_2(A0, B0, C0, D0, A1, B1, C1, D1);                         \
+        G1_AVX2(A0, B0, C0, D0, A1, B1, C1, D1);                               \
+        G2_AVX2(A0, B0, C0, D0, A1, B1, C1, D1);                               \
+        UNDIAGONALIZE_2(A0, B0, C0, D0, A1, B1, C1, D1);                       \
+    } while ((void)0, 0)
+
+#else /* SSE2 */
+
 #include <emmintrin.h>
 #if defined(__SSSE3__)
 #include <tmmintrin.h> /* for _mm_shuffle_epi8 and _mm_alignr_epi8 */
@@ -177,4 +305,6 @@ static BLAKE2_INLINE __m128i fBlaMka(__m128i x, __m128i y) {
         UNDIAGONALIZE(A0, B0, C0, D0, A1, B1, C1, D1);                         \
     } while ((void)0, 0)
 
+#endif /* __AVX2__ */
+
 #endif
@@ -247,11 +247,18 @@ uint32_t glt_argon2_index_alpha(const argon2_instance_t *instance,
 }
 
 /* Single-threaded version for p=1 case */
+int (*glt_argon2_fill_slice)(const argon2_instance_t *instance,
+                             uint32_t pass, uint8_t slice) = NULL;
+
 static int glt_argon2_fill_memory_blocks_st(argon2_instance_t *instance) {
     uint32_t r, s, l;
 
     for (r = 0; r < instance->passes; ++r) {
         for (s = 0; s < ARGON2_SYNC_POINTS; ++s) {
+            if (instance->lanes > 1 && glt_argon2_fill_slice != NULL &&
+                glt_argon2_fill_slice(instance, r, (uint8_t)s)) {
+                continue;
+            }
             for (l = 0; l < instance->lanes; ++l) {
                 argon2_position_t position = {r, l, (uint8_t)s, 0};
                 fill_segment(instance, position);
@@ -37,6 +37,7 @@ enum argon2_core_constants {
     ARGON2_BLOCK_SIZE = 1024,
     ARGON2_QWORDS_IN_BLOCK = ARGON2_BLOCK_SIZE / 8,
     ARGON2_OWORDS_IN_BLOCK = ARGON2_BLOCK_SIZE / 16,
+    ARGON2_HWORDS_IN_BLOCK = ARGON2_BLOCK_SIZE / 32,
 
     /* Number of pseudo-random values generated by one call to Blake in Argon2i
        to
@@ -223,6 +224,15 @@ void glt_argon2_finalize(const argon2_context *context, argon2_instance_t *insta
 void fill_segment(const argon2_instance_t *instance,
                   argon2_position_t position);
 
+/*
+ * Optional hook for the single-threaded fill: fills the segments of every lane
+ * in one slice, for a caller that runs lanes on threads of its own. Returns
+ * nonzero if it filled them; otherwise the lanes are filled one after another
+ * on the calling thread.
+ */
+extern int (*glt_argon2_fill_slice)(const argon2_instance_t *instance,
+                                    uint32_t pass, uint8_t slice);
+
 /*
  * Function that fills the entire memory t_cost times based on the first two
  * blocks in each lane
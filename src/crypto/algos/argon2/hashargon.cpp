@@ -3,14 +3,248 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#if defined(HAVE_CONFIG_H)
+#include <config/bitcoin-config.h>
+#endif
+
 #include "argon2.h"
 #include "hashargon.h"
 
+extern "C" {
+#include "core.h"
+}
+
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <cstdlib>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 #include <assert.h>
 
+namespace {
+#if defined(HAVE_THREAD_LOCAL)
+/**
+ * The Argon2 memory of the hashes run on one thread. Each algorithm hashes
+ * with fixed costs, so the memory is allocated once, aligned for the SIMD
+ * kernels, and handed out again to every later hash. Argon2 still wipes it
+ * when a hash is done.
+ */
+class CArgon2Arena
+{
+private:
+    void* pAlloc = nullptr;
+    uint8_t* pMemory = nullptr;
+    size_t nSize = 0;
+
+public:
+    ~CArgon2Arena() { free(pAlloc); }
+
+    uint8_t* Get(size_t nBytes)
+    {
+        if (nBytes > nSize) {
+            free(pAlloc);
+            pAlloc = malloc(nBytes + ARGON2_ARENA_ALIGN - 1);
+            if (!pAlloc) {
+                nSize = 0;
+                return pMemory = nullptr;
+            }
+            pMemory = (uint8_t*)(((uintptr_t)pAlloc + ARGON2_ARENA_ALIGN - 1) & ~(uintptr_t)(ARGON2_ARENA_ALIGN - 1));
+            nSize = nBytes;
+        }
+        return pMemory;
+    }
+
+    static const size_t ARGON2_ARENA_ALIGN = 64;
+};
+
+thread_local CArgon2Arena argon2Arena;
+
+int AllocateArena(uint8_t** memory, size_t nBytes)
+{
+    *memory = argon2Arena.Get(nBytes);
+    return *memory ? ARGON2_OK : ARGON2_MEMORY_ALLOCATION_ERROR;
+}
+
+void FreeArena(uint8_t*, size_t)
+{
+}
+#else
+// Without thread_local every hash allocates its own memory
+const allocate_fptr AllocateArena = nullptr;
+const deallocate_fptr FreeArena = nullptr;
+#endif
+
+inline void SpinPause()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/**
+ * Helper threads that fill the lanes of an Argon2 slice next to the hashing
+ * thread. Lanes only read each other's blocks from finished slices, so all
+ * segments of a slice can be filled at once. One hash runs its slices on the
+ * pool at a time; a hash that finds the pool busy, such as one of several
+ * miner threads, fills its lanes itself.
+ *
+ * Slices take microseconds, so the hashing thread never waits for a helper
+ * to wake up: it claims lanes like the helpers do and only waits for lanes
+ * that were claimed. Helpers spin for LANE_SPIN_COUNT rounds after a slice
+ * before going back to sleep.
+ */
+class CArgon2LanePool
+{
+private:
+    //! Slices with shorter segments are filled on the hashing thread, where they cost less than the hand-off
+    static const uint32_t MIN_SEGMENT_LENGTH = 16;
+    static const int LANE_SPIN_COUNT = 1 << 12;
+
+    std::mutex cs_owner; //!< Held by the hash filling a slice on the pool
+    std::mutex cs_wake;
+    std::condition_variable condWake;
+    bool fStop = false; //!< Guarded by cs_wake
+    std::vector<std::thread> threads;
+
+    // The slice being filled. nGeneration is odd while the owner rewrites
+    // it, which waits until no helper is between checking nGeneration and
+    // claiming a lane (nBusy).
+    const argon2_instance_t* instance = nullptr;
+    uint32_t nLanes = 0;
+    uint32_t nPass = 0;
+    uint8_t nSlice = 0;
+    std::atomic<uint32_t> nGeneration{0};
+    std::atomic<uint32_t> nBusy{0};
+    std::atomic<uint32_t> nNextLane{0};
+    std::atomic<uint32_t> nLanesDone{0};
+
+    void FillLanes()
+    {
+        uint32_t nLane;
+        while ((nLane = nNextLane.fetch_add(1)) < nLanes) {
+            argon2_position_t position = {nPass, nLane, nSlice, 0};
+            fill_segment(instance, position);
+            nLanesDone.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void Helper()
+    {
+        uint32_t nSeen = nGeneration.load();
+        int nSpins = 0;
+        while (true) {
+            const uint32_t nCurrent = nGeneration.load();
+            if (nCurrent == nSeen || (nCurrent & 1)) {
+                if (++nSpins < LANE_SPIN_COUNT) {
+                    SpinPause();
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(cs_wake);
+                condWake.wait(lock, [&] { return fStop || nGeneration.load() != nSeen; });
+                if (fStop) return;
+                continue;
+            }
+            nSpins = 0;
+            nBusy.fetch_add(1);
+            if (nGeneration.load() == nCurrent) {
+                FillLanes();
+            }
+            nBusy.fetch_sub(1);
+            nSeen = nCurrent;
+        }
+    }
+
+    void StopLocked()
+    {
+        {
+            std::lock_guard<std::mutex> lock(cs_wake);
+            fStop = true;
+        }
+        condWake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+        fStop = false;
+    }
+
+public:
+    ~CArgon2LanePool() { Stop(); }
+
+    void Start(int nThreads)
+    {
+        std::lock_guard<std::mutex> lock(cs_owner);
+        StopLocked();
+        for (int i = 0; i < nThreads; i++) {
+            threads.emplace_back(&CArgon2LanePool::Helper, this);
+        }
+    }
+
+    void Stop()
+    {
+        std::lock_guard<std::mutex> lock(cs_owner);
+        StopLocked();
+    }
+
+    bool Fill(const argon2_instance_t* instanceIn, uint32_t nPassIn, uint8_t nSliceIn)
+    {
+        if (instanceIn->segment_length < MIN_SEGMENT_LENGTH) return false;
+        std::unique_lock<std::mutex> lockOwner(cs_owner, std::try_to_lock);
+        if (!lockOwner.owns_lock() || threads.empty()) return false;
+
+        nGeneration.fetch_add(1);
+        while (nBusy.load() != 0) {
+            SpinPause();
+        }
+        instance = instanceIn;
+        nLanes = instanceIn->lanes;
+        nPass = nPassIn;
+        nSlice = nSliceIn;
+        nNextLane.store(0);
+        nLanesDone.store(0);
+        {
+            std::lock_guard<std::mutex> lock(cs_wake);
+            nGeneration.fetch_add(1);
+        }
+        condWake.notify_all();
+
+        FillLanes();
+        while (nLanesDone.load(std::memory_order_acquire) != nLanes) {
+            SpinPause();
+        }
+        return true;
+    }
+};
+
+CArgon2LanePool argon2LanePool;
+
+int FillSliceOnPool(const argon2_instance_t* instance, uint32_t nPass, uint8_t nSlice)
+{
+    return argon2LanePool.Fill(instance, nPass, nSlice);
+}
+} // namespace
+
+void Argon2StartLaneThreads(int nThreads)
+{
+    glt_argon2_fill_slice = nullptr;
+    if (nThreads <= 0) {
+        argon2LanePool.Stop();
+        return;
+    }
+    argon2LanePool.Start(nThreads);
+    glt_argon2_fill_slice = FillSliceOnPool;
+}
+
+void Argon2StopLaneThreads()
+{
+    Argon2StartLaneThreads(0);
+}
+
 int cpu23R_hash_argon2i(void *out, size_t outlen, const void *in, size_t inlen,
                  const void *salt, size_t saltlen, unsigned int t_cost,
                  unsigned int m_cost) {
@@ -47,8 +281,8 @@ int cpu23R_hash_argon2i(void *out, size_t outlen, const void *in, size_t inlen,
     context.m_cost = m_cost;
     context.lanes = 1;
     context.threads = 1;
-    context.allocate_cbk = NULL;
-    context.free_cbk = NULL;
+    context.allocate_cbk = AllocateArena;
+    context.free_cbk = FreeArena;
     context.flags = ARGON2_DEFAULT_FLAGS;
 
     return argon2_ctx(&context, Argon2_i);
@@ -89,8 +323,8 @@ int cpu23R_hash_argon2d(void *out, size_t outlen, const void *in, size_t inlen,
     context.m_cost = m_cost;
     context.lanes = 1;
     context.threads = 1;
-    context.allocate_cbk = NULL;
-    context.free_cbk = NULL;
+    context.allocate_cbk = AllocateArena;
+    context.free_cbk = FreeArena;
     context.flags = ARGON2_DEFAULT_FLAGS;
 
     return argon2_ctx(&context, Argon2_d);
@@ -120,8 +354,8 @@ void Argon2dHash (const void* input, const size_t inlen, void* output, const siz
     ctx.lanes           = 2;
     ctx.threads         = 1;
 
-    ctx.allocate_cbk    = nullptr;
-    ctx.free_cbk        = nullptr;
+    ctx.allocate_cbk    = AllocateArena;
+    ctx.free_cbk        = FreeArena;
 
     const int result = argon2_ctx (&ctx, Argon2_d);
     assert (result == ARGON2_OK);
@@ -151,8 +385,8 @@ void Argon2iHash (const void* input, const size_t inlen, void* output, const siz
     ctx.lanes           = 6;
     ctx.threads         = 1;
 
-    ctx.allocate_cbk    = nullptr;
-    ctx.free_cbk        = nullptr;
+    ctx.allocate_cbk    = AllocateArena;
+    ctx.free_cbk        = FreeArena;
 
     const int result = argon2_ctx (&ctx, Argon2_i);
     assert (result == ARGON2_OK);
@@ -11,6 +11,19 @@
 void Argon2dHash(const void* input, const size_t inlen, void* output, const size_t outlen, const void *salthash, const size_t salthashlen, const void *secrethash, const size_t secrethashlen);
 void Argon2iHash(const void* input, const size_t inlen, void* output, const size_t outlen, const void *salthash, const size_t salthashlen, const void *secrethash, const size_t secrethashlen);
 
+//! Consensus Argon2 hashes use at most six lanes, one of them on the hashing thread
+static const int MAX_ARGON2_LANE_THREADS = 5;
+
+/**
+ * Fill the lanes of multi-lane Argon2 hashes (ALGO_ARGON2D, ALGO_ARGON2I) on
+ * nThreads helper threads as well as on the hashing thread, or on the hashing
+ * thread alone when nThreads is 0. Hashes stay identical either way.
+ *
+ * Not thread safe: call at startup and shutdown, while nothing is hashing.
+ */
+void Argon2StartLaneThreads(int nThreads);
+void Argon2StopLaneThreads();
+
 /**
  * Function to hash the inputs in the memory-hard fashion (uses Argon2i)
  * @param  out  Pointer to the memory where the hash digest will be written
@@ -26,6 +26,44 @@
 
 #include "blamka-round-opt.h"
 
+#if defined(__AVX2__)
+void fill_block(__m256i *state, const block *ref_block, block *next_block,
+                int with_xor) {
+    __m256i block_XY[ARGON2_HWORDS_IN_BLOCK];
+    unsigned int i;
+
+    if (with_xor) {
+        for (i = 0; i < ARGON2_HWORDS_IN_BLOCK; i++) {
+            state[i] = _mm256_xor_si256(
+                state[i], _mm256_loadu_si256((const __m256i *)ref_block->v + i));
+            block_XY[i] = _mm256_xor_si256(
+                state[i], _mm256_loadu_si256((const __m256i *)next_block->v + i));
+        }
+    } else {
+        for (i = 0; i < ARGON2_HWORDS_IN_BLOCK; i++) {
+            block_XY[i] = state[i] = _mm256_xor_si256(
+                state[i], _mm256_loadu_si256((const __m256i *)ref_block->v + i));
+        }
+    }
+
+    for (i = 0; i < 4; ++i) {
+        BLAKE2_ROUND_1(state[8 * i + 0], state[8 * i + 1], state[8 * i + 2],
+            state[8 * i + 3], state[8 * i + 4], state[8 * i + 5],
+            state[8 * i + 6], state[8 * i + 7]);
+    }
+
+    for (i = 0; i < 4; ++i) {
+        BLAKE2_ROUND_2(state[0 + i], state[8 + i], state[16 + i],
+            state[24 + i], state[4 + i], state[12 + i],
+            state[20 + i], state[28 + i]);
+    }
+
+    for (i = 0; i < ARGON2_HWORDS_IN_BLOCK; i++) {
+        state[i] = _mm256_xor_si256(state[i], block_XY[i]);
+        _mm256_storeu_si256((__m256i *)next_block->v + i, state[i]);
+    }
+}
+#else
 void fill_block(__m128i *state, const block *ref_block, block *next_block,
                 int with_xor) {
     __m128i block_XY[ARGON2_OWORDS_IN_BLOCK];
@@ -62,11 +100,12 @@ void fill_block(__m128i *state, const block *ref_block, block *next_block,
         _mm_storeu_si128((__m128i *)next_block->v + i, state[i]);
     }
 }
+#endif
 
 static void next_addresses(block *address_block, block *input_block) {
     /*Temporary zero-initialized blocks*/
-    __m128i zero_block[ARGON2_OWORDS_IN_BLOCK];
-    __m128i zero2_block[ARGON2_OWORDS_IN_BLOCK];
+    argon2_state_word zero_block[ARGON2_STATE_WORDS];
+    argon2_state_word zero2_block[ARGON2_STATE_WORDS];
 
     memset(zero_block, 0, sizeof(zero_block));
     memset(zero2_block, 0, sizeof(zero2_block));
@@ -88,7 +127,7 @@ void fill_segment(const argon2_instance_t *instance,
     uint64_t pseudo_rand, ref_index, ref_lane;
     uint32_t prev_offset, curr_offset;
     uint32_t starting_index, i;
-    __m128i state[64];
+    argon2_state_word state[ARGON2_STATE_WORDS];
     int data_independent_addressing;
 
     if (instance == NULL) {
@@ -19,7 +19,16 @@
 #define ARGON2_OPT_H
 
 #include "core.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+typedef __m256i argon2_state_word;
+#define ARGON2_STATE_WORDS ARGON2_HWORDS_IN_BLOCK
+#else
 #include <emmintrin.h>
+typedef __m128i argon2_state_word;
+#define ARGON2_STATE_WORDS ARGON2_OWORDS_IN_BLOCK
+#endif
 
 /*
  * Function fills a new memory block and optionally XORs the old block over the new one.
@@ -30,6 +39,6 @@
  * @param with_xor Whether to XOR into the new block (1) or just overwrite (0)
  * @pre all block pointers must be valid
  */
-void fill_block(__m128i *s, const block *ref_block, block *next_block, int with_xor);
+void fill_block(argon2_state_word *s, const block *ref_block, block *next_block, int with_xor);
 
 #endif /* ARGON2_OPT_H */
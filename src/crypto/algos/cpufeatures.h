@@ -0,0 +1,46 @@
+/*
+ * CPU feature checks used to select algorithm kernels built for newer
+ * instruction sets at runtime.
+ *
+ * Copyright (c) 2019 The Globaltoken Core developers
+ * Distributed under the MIT software license, see the accompanying
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.
+ */
+
+#ifndef GLOBALTOKEN_CRYPTO_ALGOS_CPUFEATURES_H
+#define GLOBALTOKEN_CRYPTO_ALGOS_CPUFEATURES_H
+
+#if defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
+#define ALGOS_HAVE_CPUID 1
+
+#include <cpuid.h>
+
+static inline int algos_cpu_has_sse41(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+	return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && ((ecx >> 19) & 1);
+}
+
+/* AVX also needs the OS to save the YMM registers, which XCR0 reports. */
+static inline int algos_cpu_has_avx(void)
+{
+	unsigned int eax, ebx, ecx, edx, xcr0, xcr0_hi;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return 0;
+	if (!((ecx >> 27) & 1) || !((ecx >> 28) & 1))
+		return 0;
+	__asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0_hi) : "c" (0));
+	return (xcr0 & 6) == 6;
+}
+
+static inline int algos_cpu_has_avx2(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+	if (!algos_cpu_has_avx() || __get_cpuid_max(0, NULL) < 7)
+		return 0;
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx >> 5) & 1;
+}
+#endif
+
+#endif
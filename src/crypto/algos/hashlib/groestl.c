@@ -2903,6 +2903,37 @@ groestl_big_init(sph_groestl_big_context *sc, unsigned out_size)
 #endif
 }
 
+static void
+groestl_big_compress(void *state, const unsigned char *buf)
+{
+#if SPH_GROESTL_64
+	sph_u64 *H = state;
+#else
+	sph_u32 *H = state;
+#endif
+
+	COMPRESS_BIG;
+}
+
+static void
+groestl_big_final(void *state)
+{
+#if SPH_GROESTL_64
+	sph_u64 *H = state;
+#else
+	sph_u32 *H = state;
+#endif
+
+	FINAL_BIG;
+}
+
+/* see sph_groestl.h */
+void (*sph_groestl_big_compress)(void *state, const unsigned char *buf)
+	= groestl_big_compress;
+
+/* see sph_groestl.h */
+void (*sph_groestl_big_final)(void *state) = groestl_big_final;
+
 static void
 groestl_big_core(sph_groestl_big_context *sc, const void *data, size_t len)
 {
@@ -2931,7 +2962,7 @@ groestl_big_core(sph_groestl_big_context *sc, const void *data, size_t len)
 		data = (const unsigned char *)data + clen;
 		len -= clen;
 		if (ptr == sizeof sc->buf) {
-			COMPRESS_BIG;
+			sph_groestl_big_compress(H, buf);
 #if SPH_64
 			sc->count ++;
 #else
@@ -2994,7 +3025,7 @@ groestl_big_close(sph_groestl_big_context *sc,
 #endif
 	groestl_big_core(sc, pad, pad_len);
 	READ_STATE_BIG(sc);
-	FINAL_BIG;
+	sph_groestl_big_final(H);
 #if SPH_GROESTL_64
 	for (u = 0; u < 8; u ++)
 		enc64e(pad + (u << 3), H[u + 8]);
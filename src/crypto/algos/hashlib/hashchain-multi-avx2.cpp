@@ -0,0 +1,30 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/algos/hashlib/hashchain-multi.h>
+
+#if defined(__AVX2__)
+namespace hashchain_avx2
+{
+void Blake512_4way(const unsigned char* const* in, size_t len, unsigned char* const* out)
+{
+    blake512_lanes<Lanes64AVX2>(in, len, out);
+}
+
+void Bmw512_4way(const unsigned char* const* in, size_t len, unsigned char* const* out)
+{
+    bmw512_lanes<Lanes64AVX2>(in, len, out);
+}
+
+void Keccak512_4way(const unsigned char* const* in, size_t len, unsigned char* const* out)
+{
+    keccak512_lanes<Lanes64AVX2>(in, len, out);
+}
+
+void Skein512_4way(const unsigned char* const* in, size_t len, unsigned char* const* out)
+{
+    skein512_lanes<Lanes64AVX2>(in, len, out);
+}
+}
+#endif
@@ -0,0 +1,148 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/algos/hashlib/hashchain-multi.h>
+#include <crypto/algos/hashlib/hashchain.h>
+#include <crypto/algos/cpufeatures.h>
+
+#include <crypto/algos/hashlib/sph_blake.h>
+#include <crypto/algos/hashlib/sph_bmw.h>
+#include <crypto/algos/hashlib/sph_keccak.h>
+#include <crypto/algos/hashlib/sph_skein.h>
+
+#include <assert.h>
+
+#if defined(__SSE2__)
+namespace hashchain_sse2
+{
+// Without a 64-bit rotate, two SSE2 lanes only beat the scalar code for
+// Keccak; the other three functions stay scalar without AVX2.
+void Keccak512_2way(const unsigned char* const* in, size_t len, unsigned char* const* out)
+{
+    keccak512_lanes<Lanes64SSE2>(in, len, out);
+}
+}
+#endif
+
+#if defined(ENABLE_AVX2)
+namespace hashchain_avx2
+{
+void Blake512_4way(const unsigned char* const* in, size_t len, unsigned char* const* out);
+void Bmw512_4way(const unsigned char* const* in, size_t len, unsigned char* const* out);
+void Keccak512_4way(const unsigned char* const* in, size_t len, unsigned char* const* out);
+void Skein512_4way(const unsigned char* const* in, size_t len, unsigned char* const* out);
+}
+#endif
+
+namespace {
+
+typedef void (*MultiFunc)(const unsigned char* const* in, size_t len, unsigned char* const* out);
+
+struct MultiKernel
+{
+    MultiFunc Run;
+    size_t nWidth;
+};
+
+/** Kernel of every HashChainFunc, empty where the scalar function is used */
+MultiKernel kernels[CHAIN_FUNC_COUNT];
+
+#if defined(ENABLE_AVX2)
+void HashSph(uint8_t nFunc, const unsigned char* in, size_t len, unsigned char* out)
+{
+    switch (nFunc) {
+    case CHAIN_BLAKE512: {
+        sph_blake512_context ctx;
+        sph_blake512_init(&ctx);
+        sph_blake512(&ctx, in, len);
+        sph_blake512_close(&ctx, out);
+        break;
+    }
+    case CHAIN_BMW512: {
+        sph_bmw512_context ctx;
+        sph_bmw512_init(&ctx);
+        sph_bmw512(&ctx, in, len);
+        sph_bmw512_close(&ctx, out);
+        break;
+    }
+    case CHAIN_KECCAK512: {
+        sph_keccak512_context ctx;
+        sph_keccak512_init(&ctx);
+        sph_keccak512(&ctx, in, len);
+        sph_keccak512_close(&ctx, out);
+        break;
+    }
+    case CHAIN_SKEIN512: {
+        sph_skein512_context ctx;
+        sph_skein512_init(&ctx);
+        sph_skein512(&ctx, in, len);
+        sph_skein512_close(&ctx, out);
+        break;
+    }
+    }
+}
+
+bool SelfTestAVX2()
+{
+    const MultiFunc funcs[] = {hashchain_avx2::Blake512_4way, hashchain_avx2::Bmw512_4way,
+                               hashchain_avx2::Keccak512_4way, hashchain_avx2::Skein512_4way};
+    const uint8_t nFuncs[] = {CHAIN_BLAKE512, CHAIN_BMW512, CHAIN_KECCAK512, CHAIN_SKEIN512};
+    unsigned char input[4][80];
+    const unsigned char* pinput[4];
+    unsigned char expected[4][64], actual[4][64];
+    unsigned char* poutput[4];
+    for (unsigned int l = 0; l < 4; l++) {
+        for (unsigned int i = 0; i < 80; i++)
+            input[l][i] = (unsigned char)(l * 80 + i);
+        pinput[l] = input[l];
+        poutput[l] = actual[l];
+    }
+    for (unsigned int f = 0; f < 4; f++) {
+        for (unsigned int l = 0; l < 4; l++)
+            HashSph(nFuncs[f], input[l], 80, expected[l]);
+        funcs[f](pinput, 80, poutput);
+        if (memcmp(expected, actual, sizeof(actual)) != 0)
+            return false;
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+std::string hashchain_multi_autodetect()
+{
+    for (MultiKernel& kernel : kernels)
+        kernel = MultiKernel{nullptr, 0};
+#if defined(__SSE2__)
+    kernels[CHAIN_KECCAK512] = MultiKernel{hashchain_sse2::Keccak512_2way, 2};
+#endif
+#if defined(ENABLE_AVX2) && defined(ALGOS_HAVE_CPUID)
+    if (algos_cpu_has_avx2()) {
+        assert(SelfTestAVX2());
+        kernels[CHAIN_BLAKE512] = MultiKernel{hashchain_avx2::Blake512_4way, 4};
+        kernels[CHAIN_BMW512] = MultiKernel{hashchain_avx2::Bmw512_4way, 4};
+        kernels[CHAIN_KECCAK512] = MultiKernel{hashchain_avx2::Keccak512_4way, 4};
+        kernels[CHAIN_SKEIN512] = MultiKernel{hashchain_avx2::Skein512_4way, 4};
+        return "avx2(4way)";
+    }
+#endif
+#if defined(__SSE2__)
+    return "sse2(2way keccak)";
+#else
+    return "standard";
+#endif
+}
+
+size_t HashChainMulti(uint8_t nFunc, const unsigned char* const* in, size_t len, unsigned char* const* out, size_t nLanes)
+{
+    assert(nFunc < CHAIN_FUNC_COUNT);
+    const MultiKernel& kernel = kernels[nFunc];
+    size_t i = 0;
+    if (kernel.Run) {
+        for (; nLanes - i >= kernel.nWidth; i += kernel.nWidth)
+            kernel.Run(in + i, len, out + i);
+    }
+    return i;
+}
@@ -0,0 +1,541 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBALTOKEN_CRYPTO_ALGOS_HASHLIB_HASHCHAIN_MULTI_H
+#define GLOBALTOKEN_CRYPTO_ALGOS_HASHLIB_HASHCHAIN_MULTI_H
+
+#include <crypto/algos/lanes.h>
+#include <crypto/common.h>
+
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * Multi-buffer versions of the 64-bit word hash chain functions. Each one
+ * hashes L::COUNT messages of the same length len, in[l] into the 64 bytes
+ * at out[l], and matches its sph_* function byte for byte. Equal lengths
+ * mean every lane pads the same way, so only the message words differ
+ * between lanes.
+ */
+
+/** Fill W[0..nWords) with the words of each lane's block at p[l] */
+template <typename L>
+static inline void LoadBlockLanes(typename L::Word* W, const unsigned char* const* p, unsigned int nWords, bool fBigEndian)
+{
+    const unsigned int n = L::COUNT;
+    alignas(L::ALIGN) uint64_t buf[16 * L::COUNT];
+    for (unsigned int l = 0; l < n; l++)
+        for (unsigned int k = 0; k < nWords; k++)
+            buf[k * n + l] = fBigEndian ? ReadBE64(p[l] + 8 * k) : ReadLE64(p[l] + 8 * k);
+    for (unsigned int k = 0; k < nWords; k++)
+        W[k] = L::Load(&buf[k * n]);
+}
+
+/** Write the first eight words of H to each lane's 64 byte out[l] */
+template <typename L>
+static inline void StoreHashLanes(unsigned char* const* out, const typename L::Word* H, bool fBigEndian)
+{
+    const unsigned int n = L::COUNT;
+    alignas(L::ALIGN) uint64_t buf[8 * L::COUNT];
+    for (unsigned int k = 0; k < 8; k++)
+        L::Store(&buf[k * n], H[k]);
+    for (unsigned int l = 0; l < n; l++) {
+        for (unsigned int k = 0; k < 8; k++) {
+            if (fBigEndian)
+                WriteBE64(out[l] + 8 * k, buf[k * n + l]);
+            else
+                WriteLE64(out[l] + 8 * k, buf[k * n + l]);
+        }
+    }
+}
+
+/**
+ * Padded tails of every lane, which share their length. Copies the last
+ * nTail message bytes of each lane into SIZE zeroed bytes; the caller adds
+ * the padding bytes through Set().
+ */
+template <typename L, size_t SIZE>
+class TailLanes
+{
+    unsigned char buf[L::COUNT][SIZE];
+    const unsigned char* ptr[L::COUNT];
+
+public:
+    TailLanes(const unsigned char* const* in, size_t nOffset, size_t nTail)
+    {
+        memset(buf, 0, sizeof(buf));
+        for (unsigned int l = 0; l < L::COUNT; l++)
+            memcpy(buf[l], in[l] + nOffset, nTail);
+    }
+
+    void Set(size_t nPos, unsigned char ch)
+    {
+        for (unsigned int l = 0; l < L::COUNT; l++)
+            buf[l][nPos] |= ch;
+    }
+
+    void SetBE64(size_t nPos, uint64_t x)
+    {
+        for (unsigned int l = 0; l < L::COUNT; l++)
+            WriteBE64(&buf[l][nPos], x);
+    }
+
+    void SetLE64(size_t nPos, uint64_t x)
+    {
+        for (unsigned int l = 0; l < L::COUNT; l++)
+            WriteLE64(&buf[l][nPos], x);
+    }
+
+    /** Per-lane pointers to the block at nPos */
+    const unsigned char* const* Block(size_t nPos)
+    {
+        for (unsigned int l = 0; l < L::COUNT; l++)
+            ptr[l] = buf[l] + nPos;
+        return ptr;
+    }
+};
+
+/** Per-lane pointers nOffset bytes into each message */
+template <typename L>
+class OffsetLanes
+{
+    const unsigned char* ptr[L::COUNT];
+
+public:
+    OffsetLanes(const unsigned char* const* in, size_t nOffset)
+    {
+        for (unsigned int l = 0; l < L::COUNT; l++)
+            ptr[l] = in[l] + nOffset;
+    }
+
+    operator const unsigned char* const*() const { return ptr; }
+};
+
+// BLAKE-512
+
+static const uint64_t BLAKE512_IV[8] = {
+    0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL, 0xA54FF53A5F1D36F1ULL,
+    0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL, 0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL,
+};
+
+static const uint64_t BLAKE512_C[16] = {
+    0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL, 0xA4093822299F31D0ULL, 0x082EFA98EC4E6C89ULL,
+    0x452821E638D01377ULL, 0xBE5466CF34E90C6CULL, 0xC0AC29B7C97C50DDULL, 0x3F84D5B5B5470917ULL,
+    0x9216D5D98979FB1BULL, 0xD1310BA698DFB5ACULL, 0x2FFD72DBD01ADFB7ULL, 0xB8E1AFED6A267E96ULL,
+    0xBA7C9045F12C7F99ULL, 0x24A19947B3916CF7ULL, 0x0801F2E2858EFC16ULL, 0x636920D871574E69ULL,
+};
+
+static const unsigned char BLAKE_SIGMA[10][16] = {
+    { 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15},
+    {14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3},
+    {11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4},
+    { 7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8},
+    { 9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13},
+    { 2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9},
+    {12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11},
+    {13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10},
+    { 6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5},
+    {10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0},
+};
+
+/** One BLAKE-512 compression of the block at p[l] with bit counter t */
+template <typename L>
+static inline void blake512_compress_lanes(typename L::Word* H, const unsigned char* const* p, uint64_t t)
+{
+    typedef typename L::Word Word;
+    Word M[16], v[16];
+
+    LoadBlockLanes<L>(M, p, 16, true);
+    for (unsigned int i = 0; i < 8; i++)
+        v[i] = H[i];
+    v[8] = L::Set1(BLAKE512_C[0]);
+    v[9] = L::Set1(BLAKE512_C[1]);
+    v[10] = L::Set1(BLAKE512_C[2]);
+    v[11] = L::Set1(BLAKE512_C[3]);
+    v[12] = L::Set1(t ^ BLAKE512_C[4]);
+    v[13] = L::Set1(t ^ BLAKE512_C[5]);
+    v[14] = L::Set1(BLAKE512_C[6]);
+    v[15] = L::Set1(BLAKE512_C[7]);
+
+#define BLAKE_G(a, b, c, d, i) do { \
+        v[a] = L::Add(L::Add(v[a], v[b]), L::Xor(M[s[2 * i]], L::Set1(BLAKE512_C[s[2 * i + 1]]))); \
+        v[d] = L::template Rotl<32>(L::Xor(v[d], v[a])); \
+        v[c] = L::Add(v[c], v[d]); \
+        v[b] = L::template Rotl<39>(L::Xor(v[b], v[c])); \
+        v[a] = L::Add(L::Add(v[a], v[b]), L::Xor(M[s[2 * i + 1]], L::Set1(BLAKE512_C[s[2 * i]]))); \
+        v[d] = L::template Rotl<48>(L::Xor(v[d], v[a])); \
+        v[c] = L::Add(v[c], v[d]); \
+        v[b] = L::template Rotl<53>(L::Xor(v[b], v[c])); \
+    } while (0)
+    for (unsigned int r = 0; r < 16; r++) {
+        const unsigned char* s = BLAKE_SIGMA[r % 10];
+        BLAKE_G(0, 4,  8, 12, 0);
+        BLAKE_G(1, 5,  9, 13, 1);
+        BLAKE_G(2, 6, 10, 14, 2);
+        BLAKE_G(3, 7, 11, 15, 3);
+        BLAKE_G(0, 5, 10, 15, 4);
+        BLAKE_G(1, 6, 11, 12, 5);
+        BLAKE_G(2, 7,  8, 13, 6);
+        BLAKE_G(3, 4,  9, 14, 7);
+    }
+#undef BLAKE_G
+
+    for (unsigned int i = 0; i < 8; i++)
+        H[i] = L::Xor(H[i], L::Xor(v[i], v[i + 8]));
+}
+
+/** sph_blake512() of L::COUNT messages of len bytes */
+template <typename L>
+void blake512_lanes(const unsigned char* const* in, size_t len, unsigned char* const* out)
+{
+    typename L::Word H[8];
+    for (unsigned int i = 0; i < 8; i++)
+        H[i] = L::Set1(BLAKE512_IV[i]);
+
+    size_t nOffset = 0;
+    for (; len - nOffset >= 128; nOffset += 128)
+        blake512_compress_lanes<L>(H, OffsetLanes<L>(in, nOffset), (uint64_t)(nOffset + 128) << 3);
+
+    // The counter of a block without message bits is zero.
+    const size_t nTail = len - nOffset;
+    const uint64_t nBits = (uint64_t)len << 3;
+    TailLanes<L, 256> tail(in, nOffset, nTail);
+    tail.Set(nTail, 0x80);
+    if (nTail <= 111) {
+        tail.Set(111, 0x01);
+        tail.SetBE64(120, nBits);
+        blake512_compress_lanes<L>(H, tail.Block(0), nTail ? nBits : 0);
+    } else {
+        tail.Set(128 + 111, 0x01);
+        tail.SetBE64(128 + 120, nBits);
+        blake512_compress_lanes<L>(H, tail.Block(0), nBits);
+        blake512_compress_lanes<L>(H, tail.Block(128), 0);
+    }
+    StoreHashLanes<L>(out, H, true);
+}
+
+// BMW-512
+
+template <typename L>
+struct BMW512Lanes
+{
+    typedef typename L::Word Word;
+
+    static Word s0(Word x) { return L::Xor(L::Xor(L::template Shr<1>(x), L::template Shl<3>(x)), L::Xor(L::template Rotl<4>(x), L::template Rotl<37>(x))); }
+    static Word s1(Word x) { return L::Xor(L::Xor(L::template Shr<1>(x), L::template Shl<2>(x)), L::Xor(L::template Rotl<13>(x), L::template Rotl<43>(x))); }
+    static Word s2(Word x) { return L::Xor(L::Xor(L::template Shr<2>(x), L::template Shl<1>(x)), L::Xor(L::template Rotl<19>(x), L::template Rotl<53>(x))); }
+    static Word s3(Word x) { return L::Xor(L::Xor(L::template Shr<2>(x), L::template Shl<2>(x)), L::Xor(L::template Rotl<28>(x), L::template Rotl<59>(x))); }
+    static Word s4(Word x) { return L::Xor(L::template Shr<1>(x), x); }
+    static Word s5(Word x) { return L::Xor(L::template Shr<2>(x), x); }
+
+    /** The message word term of Q[j + 16]; Mr[k] is M[k] rotated left by k + 1 */
+    static Word AddElement(const Word* Mr, const Word* H, unsigned int j)
+    {
+        const Word sum = L::Sub(L::Add(Mr[j & 15], Mr[(j + 3) & 15]), Mr[(j + 10) & 15]);
+        return L::Xor(L::Add(sum, L::Set1((uint64_t)(j + 16) * 0x0555555555555555ULL)), H[(j + 7) & 15]);
+    }
+
+    static void Compress(const Word* M, const Word* H, Word* dH)
+    {
+        Word X[16], W[16], Mr[16], Q[32];
+
+        for (unsigned int i = 0; i < 16; i++)
+            X[i] = L::Xor(M[i], H[i]);
+#define BMW_W(i, a, op1, b, op2, c, op3, d, op4, e) \
+        W[i] = op4(op3(op2(op1(X[a], X[b]), X[c]), X[d]), X[e])
+        BMW_W( 0,  5, L::Sub,  7, L::Add, 10, L::Add, 13, L::Add, 14);
+        BMW_W( 1,  6, L::Sub,  8, L::Add, 11, L::Add, 14, L::Sub, 15);
+        BMW_W( 2,  0, L::Add,  7, L::Add,  9, L::Sub, 12, L::Add, 15);
+        BMW_W( 3,  0, L::Sub,  1, L::Add,  8, L::Sub, 10, L::Add, 13);
+        BMW_W( 4,  1, L::Add,  2, L::Add,  9, L::Sub, 11, L::Sub, 14);
+        BMW_W( 5,  3, L::Sub,  2, L::Add, 10, L::Sub, 12, L::Add, 15);
+        BMW_W( 6,  4, L::Sub,  0, L::Sub,  3, L::Sub, 11, L::Add, 13);
+        BMW_W( 7,  1, L::Sub,  4, L::Sub,  5, L::Sub, 12, L::Sub, 14);
+        BMW_W( 8,  2, L::Sub,  5, L::Sub,  6, L::Add, 13, L::Sub, 15);
+        BMW_W( 9,  0, L::Sub,  3, L::Add,  6, L::Sub,  7, L::Add, 14);
+        BMW_W(10,  8, L::Sub,  1, L::Sub,  4, L::Sub,  7, L::Add, 15);
+        BMW_W(11,  8, L::Sub,  0, L::Sub,  2, L::Sub,  5, L::Add,  9);
+        BMW_W(12,  1, L::Add,  3, L::Sub,  6, L::Sub,  9, L::Add, 10);
+        BMW_W(13,  2, L::Add,  4, L::Add,  7, L::Add, 10, L::Add, 11);
+        BMW_W(14,  3, L::Sub,  5, L::Add,  8, L::Sub, 11, L::Sub, 12);
+        BMW_W(15, 12, L::Sub,  4, L::Sub,  6, L::Sub,  9, L::Add, 13);
+#undef BMW_W
+
+        for (unsigned int i = 0; i < 15; i += 5) {
+            Q[i + 0] = L::Add(s0(W[i + 0]), H[i + 1]);
+            Q[i + 1] = L::Add(s1(W[i + 1]), H[i + 2]);
+            Q[i + 2] = L::Add(s2(W[i + 2]), H[i + 3]);
+            Q[i + 3] = L::Add(s3(W[i + 3]), H[i + 4]);
+            Q[i + 4] = L::Add(s4(W[i + 4]), H[i + 5]);
+        }
+        Q[15] = L::Add(s0(W[15]), H[0]);
+
+#define BMW_MR(k) Mr[k] = L::template Rotl<k + 1>(M[k])
+        BMW_MR(0); BMW_MR(1); BMW_MR(2); BMW_MR(3); BMW_MR(4); BMW_MR(5); BMW_MR(6); BMW_MR(7);
+        BMW_MR(8); BMW_MR(9); BMW_MR(10); BMW_MR(11); BMW_MR(12); BMW_MR(13); BMW_MR(14); BMW_MR(15);
+#undef BMW_MR
+
+        for (unsigned int i = 16; i < 18; i++) {
+            Word sum = AddElement(Mr, H, i - 16);
+            for (unsigned int k = 0; k < 16; k += 4) {
+                sum = L::Add(sum, L::Add(L::Add(s1(Q[i - 16 + k]), s2(Q[i - 15 + k])),
+                                         L::Add(s3(Q[i - 14 + k]), s0(Q[i - 13 + k]))));
+            }
+            Q[i] = sum;
+        }
+        for (unsigned int i = 18; i < 32; i++) {
+            Word sum = L::Add(L::Add(Q[i - 16], L::template Rotl<5>(Q[i - 15])), L::Add(Q[i - 14], L::template Rotl<11>(Q[i - 13])));
+            sum = L::Add(sum, L::Add(L::Add(Q[i - 12], L::template Rotl<27>(Q[i - 11])), L::Add(Q[i - 10], L::template Rotl<32>(Q[i - 9]))));
+            sum = L::Add(sum, L::Add(L::Add(Q[i - 8], L::template Rotl<37>(Q[i - 7])), L::Add(Q[i - 6], L::template Rotl<43>(Q[i - 5]))));
+            sum = L::Add(sum, L::Add(L::Add(Q[i - 4], L::template Rotl<53>(Q[i - 3])), L::Add(s4(Q[i - 2]), s5(Q[i - 1]))));
+            Q[i] = L::Add(sum, AddElement(Mr, H, i - 16));
+        }
+
+        const Word xl = L::Xor(L::Xor(L::Xor(Q[16], Q[17]), L::Xor(Q[18], Q[19])), L::Xor(L::Xor(Q[20], Q[21]), L::Xor(Q[22], Q[23])));
+        const Word xh = L::Xor(xl, L::Xor(L::Xor(L::Xor(Q[24], Q[25]), L::Xor(Q[26], Q[27])), L::Xor(L::Xor(Q[28], Q[29]), L::Xor(Q[30], Q[31]))));
+
+#define BMW_FOLD_LO(i, xhs, qs) \
+        dH[i] = L::Add(L::Xor(L::Xor(xhs, qs), M[i]), L::Xor(L::Xor(xl, Q[24 + i]), Q[i]))
+        BMW_FOLD_LO(0, L::template Shl<5>(xh), L::template Shr<5>(Q[16]));
+        BMW_FOLD_LO(1, L::template Shr<7>(xh), L::template Shl<8>(Q[17]));
+        BMW_FOLD_LO(2, L::template Shr<5>(xh), L::template Shl<5>(Q[18]));
+        BMW_FOLD_LO(3, L::template Shr<1>(xh), L::template Shl<5>(Q[19]));
+        BMW_FOLD_LO(4, L::template Shr<3>(xh), Q[20]);
+        BMW_FOLD_LO(5, L::template Shl<6>(xh), L::template Shr<6>(Q[21]));
+        BMW_FOLD_LO(6, L::template Shr<4>(xh), L::template Shl<6>(Q[22]));
+        BMW_FOLD_LO(7, L::template Shr<11>(xh), L::template Shl<2>(Q[23]));
+#undef BMW_FOLD_LO
+
+#define BMW_FOLD_HI(i, r, xls, q) \
+        dH[i] = L::Add(L::Add(L::template Rotl<r>(dH[((i) - 4) & 7]), L::Xor(L::Xor(xh, Q[16 + (i)]), M[i])), L::Xor(L::Xor(xls, Q[q]), Q[i]))
+        BMW_FOLD_HI( 8,  9, L::template Shl<8>(xl), 23);
+        BMW_FOLD_HI( 9, 10, L::template Shr<6>(xl), 16);
+        BMW_FOLD_HI(10, 11, L::template Shl<6>(xl), 17);
+        BMW_FOLD_HI(11, 12, L::template Shl<4>(xl), 18);
+        BMW_FOLD_HI(12, 13, L::template Shr<3>(xl), 19);
+        BMW_FOLD_HI(13, 14, L::template Shr<4>(xl), 20);
+        BMW_FOLD_HI(14, 15, L::template Shr<7>(xl), 21);
+        BMW_FOLD_HI(15, 16, L::template Shr<2>(xl), 22);
+#undef BMW_FOLD_HI
+    }
+};
+
+/** sph_bmw512() of L::COUNT messages of len bytes */
+template <typename L>
+void bmw512_lanes(const unsigned char* const* in, size_t len, unsigned char* const* out)
+{
+    typedef typename L::Word Word;
+    Word H[16], M[16], dH[16];
+    for (unsigned int i = 0; i < 16; i++)
+        H[i] = L::Set1(0x8081828384858687ULL + i * 0x0808080808080808ULL);
+
+    size_t nOffset = 0;
+    for (; len - nOffset >= 128; nOffset += 128) {
+        LoadBlockLanes<L>(M, OffsetLanes<L>(in, nOffset), 16, false);
+        BMW512Lanes<L>::Compress(M, H, dH);
+        memcpy(H, dH, sizeof(H));
+    }
+
+    const size_t nTail = len - nOffset;
+    TailLanes<L, 256> tail(in, nOffset, nTail);
+    tail.Set(nTail, 0x80);
+    size_t nLast = 0;
+    if (nTail >= 120) {
+        LoadBlockLanes<L>(M, tail.Block(0), 16, false);
+        BMW512Lanes<L>::Compress(M, H, dH);
+        memcpy(H, dH, sizeof(H));
+        nLast = 128;
+    }
+    tail.SetLE64(nLast + 120, (uint64_t)len << 3);
+    LoadBlockLanes<L>(M, tail.Block(nLast), 16, false);
+    BMW512Lanes<L>::Compress(M, H, dH);
+
+    // Final compression of the chaining value under the constant key.
+    for (unsigned int i = 0; i < 16; i++)
+        H[i] = L::Set1(0xaaaaaaaaaaaaaaa0ULL + i);
+    BMW512Lanes<L>::Compress(dH, H, M);
+    StoreHashLanes<L>(out, M + 8, false);
+}
+
+// Keccak-512
+
+static const uint64_t KECCAK_RC[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL, 0x8000000080008000ULL,
+    0x000000000000808BULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008AULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+    0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800AULL, 0x800000008000000AULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+/** Keccak-f[1600] of every lane, A[x + 5 * y] */
+template <typename L>
+static inline void keccak_f1600_lanes(typename L::Word* A)
+{
+    typedef typename L::Word Word;
+    Word B[25], C[5], D[5];
+
+    for (unsigned int r = 0; r < 24; r++) {
+#define KECCAK_THETA(x) do { \
+        C[x] = L::Xor(L::Xor(L::Xor(A[x], A[(x) + 5]), L::Xor(A[(x) + 10], A[(x) + 15])), A[(x) + 20]); \
+    } while (0)
+        KECCAK_THETA(0); KECCAK_THETA(1); KECCAK_THETA(2); KECCAK_THETA(3); KECCAK_THETA(4);
+#undef KECCAK_THETA
+        D[0] = L::Xor(C[4], L::template Rotl<1>(C[1]));
+        D[1] = L::Xor(C[0], L::template Rotl<1>(C[2]));
+        D[2] = L::Xor(C[1], L::template Rotl<1>(C[3]));
+        D[3] = L::Xor(C[2], L::template Rotl<1>(C[4]));
+        D[4] = L::Xor(C[3], L::template Rotl<1>(C[0]));
+
+        // theta, rho and pi: B[y + 5 * ((2 * x + 3 * y) % 5)] = (A[x + 5 * y] ^ D[x]) <<< r[x][y]
+        B[0] = L::Xor(A[0], D[0]);
+#define KECCAK_RHO_PI(to, from, rot) B[to] = L::template Rotl<rot>(L::Xor(A[from], D[(from) % 5]))
+        KECCAK_RHO_PI(10,  1,  1); KECCAK_RHO_PI(20,  2, 62); KECCAK_RHO_PI( 5,  3, 28); KECCAK_RHO_PI(15,  4, 27);
+        KECCAK_RHO_PI(16,  5, 36); KECCAK_RHO_PI( 1,  6, 44); KECCAK_RHO_PI(11,  7,  6); KECCAK_RHO_PI(21,  8, 55);
+        KECCAK_RHO_PI( 6,  9, 20); KECCAK_RHO_PI( 7, 10,  3); KECCAK_RHO_PI(17, 11, 10); KECCAK_RHO_PI( 2, 12, 43);
+        KECCAK_RHO_PI(12, 13, 25); KECCAK_RHO_PI(22, 14, 39); KECCAK_RHO_PI(23, 15, 41); KECCAK_RHO_PI( 8, 16, 45);
+        KECCAK_RHO_PI(18, 17, 15); KECCAK_RHO_PI( 3, 18, 21); KECCAK_RHO_PI(13, 19,  8); KECCAK_RHO_PI(14, 20, 18);
+        KECCAK_RHO_PI(24, 21,  2); KECCAK_RHO_PI( 9, 22, 61); KECCAK_RHO_PI(19, 23, 56); KECCAK_RHO_PI( 4, 24, 14);
+#undef KECCAK_RHO_PI
+
+#define KECCAK_CHI(y) do { \
+        A[(y) + 0] = L::Xor(B[(y) + 0], L::AndNot(B[(y) + 1], B[(y) + 2])); \
+        A[(y) + 1] = L::Xor(B[(y) + 1], L::AndNot(B[(y) + 2], B[(y) + 3])); \
+        A[(y) + 2] = L::Xor(B[(y) + 2], L::AndNot(B[(y) + 3], B[(y) + 4])); \
+        A[(y) + 3] = L::Xor(B[(y) + 3], L::AndNot(B[(y) + 4], B[(y) + 0])); \
+        A[(y) + 4] = L::Xor(B[(y) + 4], L::AndNot(B[(y) + 0], B[(y) + 1])); \
+    } while (0)
+        KECCAK_CHI(0); KECCAK_CHI(5); KECCAK_CHI(10); KECCAK_CHI(15); KECCAK_CHI(20);
+#undef KECCAK_CHI
+        A[0] = L::Xor(A[0], L::Set1(KECCAK_RC[r]));
+    }
+}
+
+/** sph_keccak512() of L::COUNT messages of len bytes */
+template <typename L>
+void keccak512_lanes(const unsigned char* const* in, size_t len, unsigned char* const* out)
+{
+    typedef typename L::Word Word;
+    static const size_t RATE = 72;
+    Word A[25], M[9];
+    for (unsigned int i = 0; i < 25; i++)
+        A[i] = L::Set1(0);
+
+    size_t nOffset = 0;
+    for (; len - nOffset >= RATE; nOffset += RATE) {
+        LoadBlockLanes<L>(M, OffsetLanes<L>(in, nOffset), 9, false);
+        for (unsigned int i = 0; i < 9; i++)
+            A[i] = L::Xor(A[i], M[i]);
+        keccak_f1600_lanes<L>(A);
+    }
+
+    const size_t nTail = len - nOffset;
+    TailLanes<L, RATE> tail(in, nOffset, nTail);
+    tail.Set(nTail, 0x01);
+    tail.Set(RATE - 1, 0x80);
+    LoadBlockLanes<L>(M, tail.Block(0), 9, false);
+    for (unsigned int i = 0; i < 9; i++)
+        A[i] = L::Xor(A[i], M[i]);
+    keccak_f1600_lanes<L>(A);
+    StoreHashLanes<L>(out, A, false);
+}
+
+// Skein-512
+
+static const uint64_t SKEIN512_IV[8] = {
+    0x4903ADFF749C51CEULL, 0x0D95DE399746DF03ULL, 0x8FD1934127C79BCEULL, 0x9A255629FF352CB1ULL,
+    0x5DB62599DF6CA7B0ULL, 0xEABE394CA9D5C3F4ULL, 0x991112C71A75B523ULL, 0xAE18A40B660FCC33ULL,
+};
+
+static const uint64_t SKEIN_FLAG_FIRST = 1ULL << 62;
+static const uint64_t SKEIN_FLAG_FINAL = 1ULL << 63;
+static const uint64_t SKEIN_TYPE_MSG = 48ULL << 56;
+static const uint64_t SKEIN_TYPE_OUT = 63ULL << 56;
+
+/** One UBI block: H = Threefish-512(key H, tweak t0/t1, M) ^ M */
+template <typename L>
+static inline void skein512_ubi_lanes(typename L::Word* H, const typename L::Word* M, uint64_t t0, uint64_t t1)
+{
+    typedef typename L::Word Word;
+    Word X[8], K[9];
+    const Word TW[3] = {L::Set1(t0), L::Set1(t1), L::Set1(t0 ^ t1)};
+
+    K[8] = L::Set1(0x1BD11BDAA9FC1A22ULL);
+    for (unsigned int i = 0; i < 8; i++) {
+        K[i] = H[i];
+        K[8] = L::Xor(K[8], H[i]);
+        X[i] = M[i];
+    }
+
+#define SKEIN_INJECT(s) do { \
+        X[0] = L::Add(X[0], K[((s) + 0) % 9]); \
+        X[1] = L::Add(X[1], K[((s) + 1) % 9]); \
+        X[2] = L::Add(X[2], K[((s) + 2) % 9]); \
+        X[3] = L::Add(X[3], K[((s) + 3) % 9]); \
+        X[4] = L::Add(X[4], K[((s) + 4) % 9]); \
+        X[5] = L::Add(X[5], L::Add(K[((s) + 5) % 9], TW[(s) % 3])); \
+        X[6] = L::Add(X[6], L::Add(K[((s) + 6) % 9], TW[((s) + 1) % 3])); \
+        X[7] = L::Add(X[7], L::Add(K[((s) + 7) % 9], L::Set1(s))); \
+    } while (0)
+#define SKEIN_MIX(a, b, rot) do { \
+        X[a] = L::Add(X[a], X[b]); \
+        X[b] = L::Xor(L::template Rotl<rot>(X[b]), X[a]); \
+    } while (0)
+#define SKEIN_ROUND(p0, p1, p2, p3, p4, p5, p6, p7, r0, r1, r2, r3) do { \
+        SKEIN_MIX(p0, p1, r0); SKEIN_MIX(p2, p3, r1); \
+        SKEIN_MIX(p4, p5, r2); SKEIN_MIX(p6, p7, r3); \
+    } while (0)
+#define SKEIN_8ROUNDS(s) do { \
+        SKEIN_ROUND(0, 1, 2, 3, 4, 5, 6, 7, 46, 36, 19, 37); \
+        SKEIN_ROUND(2, 1, 4, 7, 6, 5, 0, 3, 33, 27, 14, 42); \
+        SKEIN_ROUND(4, 1, 6, 3, 0, 5, 2, 7, 17, 49, 36, 39); \
+        SKEIN_ROUND(6, 1, 0, 7, 2, 5, 4, 3, 44,  9, 54, 56); \
+        SKEIN_INJECT(s); \
+        SKEIN_ROUND(0, 1, 2, 3, 4, 5, 6, 7, 39, 30, 34, 24); \
+        SKEIN_ROUND(2, 1, 4, 7, 6, 5, 0, 3, 13, 50, 10, 17); \
+        SKEIN_ROUND(4, 1, 6, 3, 0, 5, 2, 7, 25, 29, 39, 43); \
+        SKEIN_ROUND(6, 1, 0, 7, 2, 5, 4, 3,  8, 35, 56, 22); \
+        SKEIN_INJECT((s) + 1); \
+    } while (0)
+    SKEIN_INJECT(0);
+    SKEIN_8ROUNDS(1); SKEIN_8ROUNDS(3); SKEIN_8ROUNDS(5);
+    SKEIN_8ROUNDS(7); SKEIN_8ROUNDS(9); SKEIN_8ROUNDS(11);
+    SKEIN_8ROUNDS(13); SKEIN_8ROUNDS(15); SKEIN_8ROUNDS(17);
+#undef SKEIN_8ROUNDS
+#undef SKEIN_ROUND
+#undef SKEIN_MIX
+#undef SKEIN_INJECT
+
+    for (unsigned int i = 0; i < 8; i++)
+        H[i] = L::Xor(X[i], M[i]);
+}
+
+/** sph_skein512() of L::COUNT messages of len bytes */
+template <typename L>
+void skein512_lanes(const unsigned char* const* in, size_t len, unsigned char* const* out)
+{
+    typedef typename L::Word Word;
+    Word H[8], M[8];
+    for (unsigned int i = 0; i < 8; i++)
+        H[i] = L::Set1(SKEIN512_IV[i]);
+
+    // Unlike the other functions, a message that fills its last block is
+    // not followed by a padding block.
+    size_t nOffset = 0;
+    for (; len - nOffset > 64; nOffset += 64) {
+        LoadBlockLanes<L>(M, OffsetLanes<L>(in, nOffset), 8, false);
+        skein512_ubi_lanes<L>(H, M, nOffset + 64, SKEIN_TYPE_MSG | (nOffset ? 0 : SKEIN_FLAG_FIRST));
+    }
+
+    TailLanes<L, 64> tail(in, nOffset, len - nOffset);
+    LoadBlockLanes<L>(M, tail.Block(0), 8, false);
+    skein512_ubi_lanes<L>(H, M, len, SKEIN_TYPE_MSG | SKEIN_FLAG_FINAL | (nOffset ? 0 : SKEIN_FLAG_FIRST));
+
+    for (unsigned int i = 0; i < 8; i++)
+        M[i] = L::Set1(0);
+    skein512_ubi_lanes<L>(H, M, 8, SKEIN_TYPE_OUT | SKEIN_FLAG_FIRST | SKEIN_FLAG_FINAL);
+    StoreHashLanes<L>(out, H, false);
+}
+
+#endif // GLOBALTOKEN_CRYPTO_ALGOS_HASHLIB_HASHCHAIN_MULTI_H
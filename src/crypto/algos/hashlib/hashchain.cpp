@@ -0,0 +1,392 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/algos/hashlib/hashchain.h>
+
+#include <crypto/algos/argon2/hashargon.h>
+#include <crypto/algos/hashlib/sph_blake.h>
+#include <crypto/algos/hashlib/sph_bmw.h>
+#include <crypto/algos/hashlib/sph_cubehash.h>
+#include <crypto/algos/hashlib/sph_echo.h>
+#include <crypto/algos/hashlib/sph_fugue.h>
+#include <crypto/algos/hashlib/sph_gost.h>
+#include <crypto/algos/hashlib/sph_groestl.h>
+#include <crypto/algos/hashlib/sph_hamsi.h>
+#include <crypto/algos/hashlib/sph_haval.h>
+#include <crypto/algos/hashlib/sph_jh.h>
+#include <crypto/algos/hashlib/sph_keccak.h>
+#include <crypto/algos/hashlib/sph_luffa.h>
+#include <crypto/algos/hashlib/sph_sha2.h>
+#include <crypto/algos/hashlib/sph_shabal.h>
+#include <crypto/algos/hashlib/sph_shavite.h>
+#include <crypto/algos/hashlib/sph_simd.h>
+#include <crypto/algos/hashlib/sph_skein.h>
+#include <crypto/algos/hashlib/sph_tiger.h>
+#include <crypto/algos/hashlib/sph_whirlpool.h>
+#include <crypto/algos/Lyra2RE/Lyra2.h>
+
+#include <assert.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#define STAGE(func) {func, 64, false}
+
+const CHashChain HASHCHAIN_X11 = {11, {
+    STAGE(CHAIN_BLAKE512), STAGE(CHAIN_BMW512), STAGE(CHAIN_GROESTL512), STAGE(CHAIN_SKEIN512),
+    STAGE(CHAIN_JH512), STAGE(CHAIN_KECCAK512), STAGE(CHAIN_LUFFA512), STAGE(CHAIN_CUBEHASH512),
+    STAGE(CHAIN_SHAVITE512), STAGE(CHAIN_SIMD512), STAGE(CHAIN_ECHO512)}};
+
+const CHashChain HASHCHAIN_X12 = {12, {
+    STAGE(CHAIN_BLAKE512), STAGE(CHAIN_BMW512), STAGE(CHAIN_LUFFA512), STAGE(CHAIN_CUBEHASH512),
+    STAGE(CHAIN_SHAVITE512), STAGE(CHAIN_SIMD512), STAGE(CHAIN_ECHO512), STAGE(CHAIN_GROESTL512),
+    STAGE(CHAIN_SKEIN512), STAGE(CHAIN_JH512), STAGE(CHAIN_KECCAK512), STAGE(CHAIN_HAMSI512)}};
+
+const CHashChain HASHCHAIN_X13 = {13, {
+    STAGE(CHAIN_BLAKE512), STAGE(CHAIN_BMW512), STAGE(CHAIN_GROESTL512), STAGE(CHAIN_SKEIN512),
+    STAGE(CHAIN_JH512), STAGE(CHAIN_KECCAK512), STAGE(CHAIN_LUFFA512), STAGE(CHAIN_CUBEHASH512),
+    STAGE(CHAIN_SHAVITE512), STAGE(CHAIN_SIMD512), STAGE(CHAIN_ECHO512), STAGE(CHAIN_HAMSI512),
+    STAGE(CHAIN_FUGUE512)}};
+
+const CHashChain HASHCHAIN_X14 = {14, {
+    STAGE(CHAIN_BLAKE512), STAGE(CHAIN_BMW512), STAGE(CHAIN_GROESTL512), STAGE(CHAIN_SKEIN512),
+    STAGE(CHAIN_JH512), STAGE(CHAIN_KECCAK512), STAGE(CHAIN_LUFFA512), STAGE(CHAIN_CUBEHASH512),
+    STAGE(CHAIN_SHAVITE512), STAGE(CHAIN_SIMD512), STAGE(CHAIN_ECHO512), STAGE(CHAIN_HAMSI512),
+    STAGE(CHAIN_FUGUE512), STAGE(CHAIN_SHABAL512)}};
+
+const CHashChain HASHCHAIN_X15 = {15, {
+    STAGE(CHAIN_BLAKE512), STAGE(CHAIN_BMW512), STAGE(CHAIN_GROESTL512), STAGE(CHAIN_SKEIN512),
+    STAGE(CHAIN_JH512), STAGE(CHAIN_KECCAK512), STAGE(CHAIN_LUFFA512), STAGE(CHAIN_CUBEHASH512),
+    STAGE(CHAIN_SHAVITE512), STAGE(CHAIN_SIMD512), STAGE(CHAIN_ECHO512), STAGE(CHAIN_HAMSI512),
+    STAGE(CHAIN_FUGUE512), STAGE(CHAIN_SHABAL512), STAGE(CHAIN_WHIRLPOOL)}};
+
+const CHashChain HASHCHAIN_X17 = {17, {
+    STAGE(CHAIN_BLAKE512), STAGE(CHAIN_BMW512), STAGE(CHAIN_GROESTL512), STAGE(CHAIN_SKEIN512),
+    STAGE(CHAIN_JH512), STAGE(CHAIN_KECCAK512), STAGE(CHAIN_LUFFA512), STAGE(CHAIN_CUBEHASH512),
+    STAGE(CHAIN_SHAVITE512), STAGE(CHAIN_SIMD512), STAGE(CHAIN_ECHO512), STAGE(CHAIN_HAMSI512),
+    STAGE(CHAIN_FUGUE512), STAGE(CHAIN_SHABAL512), STAGE(CHAIN_WHIRLPOOL), STAGE(CHAIN_SHA512),
+    STAGE(CHAIN_HAVAL256_5)}};
+
+const CHashChain HASHCHAIN_C11 = {11, {
+    STAGE(CHAIN_BLAKE512), STAGE(CHAIN_BMW512), STAGE(CHAIN_GROESTL512), STAGE(CHAIN_JH512),
+    STAGE(CHAIN_KECCAK512), STAGE(CHAIN_SKEIN512), STAGE(CHAIN_LUFFA512), STAGE(CHAIN_CUBEHASH512),
+    STAGE(CHAIN_SHAVITE512), STAGE(CHAIN_SIMD512), STAGE(CHAIN_ECHO512)}};
+
+const CHashChain HASHCHAIN_NIST5 = {5, {
+    STAGE(CHAIN_BLAKE512), STAGE(CHAIN_GROESTL512), STAGE(CHAIN_JH512), STAGE(CHAIN_KECCAK512),
+    STAGE(CHAIN_SKEIN512)}};
+
+const CHashChain HASHCHAIN_QUBIT = {5, {
+    STAGE(CHAIN_LUFFA512), STAGE(CHAIN_CUBEHASH512), STAGE(CHAIN_SHAVITE512), STAGE(CHAIN_SIMD512),
+    STAGE(CHAIN_ECHO512)}};
+
+const CHashChain HASHCHAIN_GROESTL = {2, {STAGE(CHAIN_GROESTL512), STAGE(CHAIN_SHA256)}};
+
+const CHashChain HASHCHAIN_SKEIN = {2, {STAGE(CHAIN_SKEIN512), STAGE(CHAIN_SHA256)}};
+
+const CHashChain HASHCHAIN_PHI1612 = {6, {
+    STAGE(CHAIN_SKEIN512), STAGE(CHAIN_JH512), STAGE(CHAIN_CUBEHASH512), STAGE(CHAIN_FUGUE512),
+    STAGE(CHAIN_GOST512), STAGE(CHAIN_ECHO512)}};
+
+const CHashChain HASHCHAIN_SKUNKHASH = {4, {
+    STAGE(CHAIN_SKEIN512), STAGE(CHAIN_CUBEHASH512), STAGE(CHAIN_FUGUE512), STAGE(CHAIN_GOST512)}};
+
+const CHashChain HASHCHAIN_TRIBUS = {3, {STAGE(CHAIN_JH512), STAGE(CHAIN_KECCAK512), STAGE(CHAIN_ECHO512)}};
+
+#undef STAGE
+
+namespace {
+
+/** Room for the state of any one stage */
+union HashChainContext
+{
+    sph_blake512_context blake512;
+    sph_bmw512_context bmw512;
+    sph_groestl512_context groestl512;
+    sph_jh512_context jh512;
+    sph_keccak512_context keccak512;
+    sph_skein512_context skein512;
+    sph_luffa512_context luffa512;
+    sph_cubehash512_context cubehash512;
+    sph_shavite512_context shavite512;
+    sph_simd512_context simd512;
+    sph_echo512_context echo512;
+    sph_hamsi512_context hamsi512;
+    sph_fugue512_context fugue512;
+    sph_shabal512_context shabal512;
+    sph_whirlpool_context whirlpool;
+    sph_sha512_context sha512;
+    sph_haval256_5_context haval256_5;
+    sph_blake256_context blake256;
+    sph_gost512_context gost512;
+    sph_sha256_context sha256;
+    sph_tiger_context tiger;
+};
+
+#define SPH_FUNC(name) \
+    void Run_##name(HashChainContext& ctx, const unsigned char* in, size_t len, unsigned char* out) \
+    { \
+        sph_##name##_init(&ctx.name); \
+        sph_##name(&ctx.name, in, len); \
+        sph_##name##_close(&ctx.name, out); \
+    }
+
+SPH_FUNC(blake512)
+SPH_FUNC(bmw512)
+SPH_FUNC(groestl512)
+SPH_FUNC(jh512)
+SPH_FUNC(keccak512)
+SPH_FUNC(skein512)
+SPH_FUNC(luffa512)
+SPH_FUNC(cubehash512)
+SPH_FUNC(shavite512)
+SPH_FUNC(simd512)
+SPH_FUNC(echo512)
+SPH_FUNC(hamsi512)
+SPH_FUNC(fugue512)
+SPH_FUNC(shabal512)
+SPH_FUNC(whirlpool)
+SPH_FUNC(sha512)
+SPH_FUNC(haval256_5)
+SPH_FUNC(blake256)
+SPH_FUNC(gost512)
+SPH_FUNC(sha256)
+SPH_FUNC(tiger)
+
+#undef SPH_FUNC
+
+void Run_lyra2(HashChainContext& ctx, const unsigned char* in, size_t len, unsigned char* out)
+{
+    LYRA2(out, len, in, len, in, len, 1, 4, 4);
+}
+
+void Run_argon2d(HashChainContext& ctx, const unsigned char* in, size_t len, unsigned char* out)
+{
+    cpu23R_hash_argon2d(out, len, in, len, in, len, 2, 16);
+}
+
+void Run_argon2i(HashChainContext& ctx, const unsigned char* in, size_t len, unsigned char* out)
+{
+    cpu23R_hash_argon2i(out, len, in, len, in, len, 2, 16);
+}
+
+struct HashChainFuncInfo
+{
+    void (*Run)(HashChainContext& ctx, const unsigned char* in, size_t len, unsigned char* out);
+    uint8_t nOutputSize; //!< 0 if the output is as long as the input
+};
+
+/**
+ * Every function by its HashChainFunc number, so a stage runs through one
+ * indexed call instead of switching on the function twice.
+ */
+const HashChainFuncInfo HASHCHAIN_FUNCS[] = {
+    {Run_blake512, 64},
+    {Run_bmw512, 64},
+    {Run_groestl512, 64},
+    {Run_jh512, 64},
+    {Run_keccak512, 64},
+    {Run_skein512, 64},
+    {Run_luffa512, 64},
+    {Run_cubehash512, 64},
+    {Run_shavite512, 64},
+    {Run_simd512, 64},
+    {Run_echo512, 64},
+    {Run_hamsi512, 64},
+    {Run_fugue512, 64},
+    {Run_shabal512, 64},
+    {Run_whirlpool, 64},
+    {Run_sha512, 64},
+    {Run_haval256_5, 32},
+    {Run_blake256, 32},
+    {Run_lyra2, 0},
+    {Run_gost512, 64},
+    {Run_sha256, 32},
+    {Run_argon2d, 0},
+    {Run_argon2i, 0},
+    {Run_tiger, 24},
+};
+
+static_assert(sizeof(HASHCHAIN_FUNCS) / sizeof(HASHCHAIN_FUNCS[0]) == CHAIN_FUNC_COUNT,
+              "every hash chain function needs a table entry");
+
+/**
+ * Run one stage into the 64 byte out. prev is the previous stage output,
+ * which in may point into, or nullptr for the first stage.
+ */
+void RunStage(const HashChainStage& stage, HashChainContext& ctx, const unsigned char* in, size_t len,
+              const unsigned char* prev, unsigned char* out)
+{
+    const HashChainFuncInfo& func = HASHCHAIN_FUNCS[stage.nFunc];
+    const size_t nOutputSize = func.nOutputSize ? func.nOutputSize : len;
+    if (nOutputSize < 64) {
+        assert(!stage.fInPlace || prev);
+        if (stage.fInPlace)
+            memcpy(out, prev, 64);
+        else
+            memset(out, 0, 64);
+    }
+    if (nOutputSize <= 64) {
+        func.Run(ctx, in, len, out);
+        return;
+    }
+
+    // Lyra2 or Argon2 as the first stage of a longer input: the output length
+    // is a parameter of the hash, so compute it in full and keep 64 bytes.
+    std::vector<unsigned char> vchOut(nOutputSize);
+    func.Run(ctx, in, len, vchOut.data());
+    memcpy(out, vchOut.data(), 64);
+}
+
+} // namespace
+
+void CHashChain::Push(uint8_t nFunc, uint8_t nInputSize, bool fInPlace)
+{
+    assert(nStages < MAX_STAGES);
+    assert(nFunc < CHAIN_FUNC_COUNT);
+    stages[nStages].nFunc = nFunc;
+    stages[nStages].nInputSize = nInputSize;
+    stages[nStages].fInPlace = fInPlace;
+    nStages++;
+}
+
+uint256 CHashChain::Hash(const unsigned char* data, size_t len, size_t nFirst) const
+{
+    assert(nFirst < nStages);
+    HashChainContext ctx;
+    unsigned char hash[2][64];
+
+    const unsigned char* prev = nullptr;
+    const unsigned char* in = data;
+    size_t nIn = len;
+    for (size_t i = nFirst; i < nStages; i++) {
+        unsigned char* out = hash[i & 1];
+        RunStage(stages[i], ctx, in, nIn, prev, out);
+        prev = in = out;
+        if (i + 1 < nStages)
+            nIn = stages[i + 1].nInputSize;
+    }
+
+    uint256 result;
+    memcpy(result.begin(), in, 32);
+    return result;
+}
+
+void CHashChain::HashBatch(const unsigned char* const* data, size_t len, uint256* out, size_t nLanes) const
+{
+    assert(nStages > 0);
+    HashChainContext ctx;
+    std::vector<unsigned char> vchHash(nLanes * 128);
+    std::vector<const unsigned char*> vIn(nLanes);
+    std::vector<unsigned char*> vOut(nLanes);
+
+    for (size_t i = 0; i < nStages; i++) {
+        for (size_t lane = 0; lane < nLanes; lane++) {
+            unsigned char* hash = vchHash.data() + lane * 128;
+            vIn[lane] = i == 0 ? data[lane] : hash + ((i + 1) & 1) * 64;
+            vOut[lane] = hash + (i & 1) * 64;
+        }
+        const size_t nIn = i == 0 ? len : stages[i].nInputSize;
+        size_t lane = HashChainMulti(stages[i].nFunc, vIn.data(), nIn, vOut.data(), nLanes);
+        for (; lane < nLanes; lane++)
+            RunStage(stages[i], ctx, vIn[lane], nIn, i == 0 ? nullptr : vIn[lane], vOut[lane]);
+    }
+
+    const size_t nLast = (nStages - 1) & 1;
+    for (size_t lane = 0; lane < nLanes; lane++) {
+        memcpy(out[lane].begin(), vchHash.data() + lane * 128 + nLast * 64, 32);
+    }
+}
+
+CHashChain GetX16RHashChain(const uint256& hashSelection)
+{
+    CHashChain chain;
+    chain.nStages = 0;
+    for (int i = 0; i < 16; i++) {
+        chain.Push(hashSelection.GetNibble(48 + i));
+    }
+    return chain;
+}
+
+CHashChain GetX16SHashChain(const uint256& hashPrevBlock)
+{
+    // Move each of the last 16 nibbles of the hex string to the front of
+    // "0123456789abcdef" in turn, as X16S defines it.
+    const std::string strHash = hashPrevBlock.GetHex();
+    const std::string strList = "0123456789abcdef";
+    std::string strOrder = strList;
+    for (int i = 0; i < 16; i++) {
+        const size_t nOffset = strList.find(strHash[48 + i]);
+        strOrder.insert(0, 1, strOrder[nOffset]);
+        strOrder.erase(nOffset + 1, 1);
+    }
+    return GetX16RHashChain(uint256S(strHash.substr(0, 48) + strOrder));
+}
+
+CHashChain GetX21SHashChain(const uint256& hashPrevBlock)
+{
+    CHashChain chain = GetX16SHashChain(hashPrevBlock);
+    chain.Push(CHAIN_HAVAL256_5, 64, true);
+    chain.Push(CHAIN_TIGER, 64, true);
+    chain.Push(CHAIN_LYRA2, 32, true);
+    chain.Push(CHAIN_GOST512, 64, true);
+    chain.Push(CHAIN_SHA256, 64, true);
+    return chain;
+}
+
+CHashChain GetCPU23RHashChain(const uint256& hashPrevBlock)
+{
+    CHashChain chain;
+    chain.nStages = 0;
+    for (int i = 0; i < 23; i++) {
+        const unsigned char nBits = *(hashPrevBlock.end() - 23 + i) & 0x1f;
+        chain.Push(nBits % 23);
+    }
+    return chain;
+}
+
+namespace {
+
+struct CachedHashChain
+{
+    bool fValid;
+    unsigned char hash[32];
+    CHashChain chain;
+};
+
+/** The chain GetChain built for the last hash this thread asked for */
+template <CHashChain (*GetChain)(const uint256&)>
+const CHashChain& GetCachedHashChain(const uint256& hash)
+{
+    static __thread CachedHashChain cached;
+    if (!cached.fValid || memcmp(cached.hash, hash.begin(), 32) != 0) {
+        cached.chain = GetChain(hash);
+        memcpy(cached.hash, hash.begin(), 32);
+        cached.fValid = true;
+    }
+    return cached.chain;
+}
+
+} // namespace
+
+const CHashChain& GetCachedX16RHashChain(const uint256& hashSelection)
+{
+    return GetCachedHashChain<GetX16RHashChain>(hashSelection);
+}
+
+const CHashChain& GetCachedX16SHashChain(const uint256& hashPrevBlock)
+{
+    return GetCachedHashChain<GetX16SHashChain>(hashPrevBlock);
+}
+
+const CHashChain& GetCachedX21SHashChain(const uint256& hashPrevBlock)
+{
+    return GetCachedHashChain<GetX21SHashChain>(hashPrevBlock);
+}
+
+const CHashChain& GetCachedCPU23RHashChain(const uint256& hashPrevBlock)
+{
+    return GetCachedHashChain<GetCPU23RHashChain>(hashPrevBlock);
+}
@@ -0,0 +1,129 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBALTOKEN_CRYPTO_HASHCHAIN_H
+#define GLOBALTOKEN_CRYPTO_HASHCHAIN_H
+
+#include <uint256.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+/**
+ * Functions a hash chain stage can run. The first 16 are numbered like the
+ * X16R nibbles and the first 23 like the CPU23R selection, so a selected
+ * index is the function itself.
+ */
+enum HashChainFunc : uint8_t
+{
+    CHAIN_BLAKE512 = 0,
+    CHAIN_BMW512,
+    CHAIN_GROESTL512,
+    CHAIN_JH512,
+    CHAIN_KECCAK512,
+    CHAIN_SKEIN512,
+    CHAIN_LUFFA512,
+    CHAIN_CUBEHASH512,
+    CHAIN_SHAVITE512,
+    CHAIN_SIMD512,
+    CHAIN_ECHO512,
+    CHAIN_HAMSI512,
+    CHAIN_FUGUE512,
+    CHAIN_SHABAL512,
+    CHAIN_WHIRLPOOL,
+    CHAIN_SHA512,
+    CHAIN_HAVAL256_5,   //!< 32 byte output
+    CHAIN_BLAKE256,     //!< 32 byte output
+    CHAIN_LYRA2,        //!< Lyra2 (1, 4, 4), output as long as the input
+    CHAIN_GOST512,
+    CHAIN_SHA256,       //!< 32 byte output
+    CHAIN_ARGON2D,      //!< CPU23R Argon2d, output as long as the input
+    CHAIN_ARGON2I,      //!< CPU23R Argon2i, output as long as the input
+    CHAIN_TIGER,        //!< 24 byte output
+    CHAIN_FUNC_COUNT
+};
+
+struct HashChainStage
+{
+    uint8_t nFunc;
+    uint8_t nInputSize; //!< Bytes of the previous output to hash, unused by the first stage
+    bool fInPlace;      //!< Bytes past a short output keep the previous output instead of being zeroed
+};
+
+/**
+ * A proof of work hash built from a sequence of stages, each hashing the
+ * 64 byte output of the previous one. The first stage hashes the input, and
+ * the result is the low 256 bits of the last output. Stages share a single
+ * context, so only the state of the stage being run is touched.
+ *
+ * Chains are aggregates: fixed chains are constant initialized tables and
+ * the prev-hash-ordered ones are filled per block.
+ */
+struct CHashChain
+{
+    static const size_t MAX_STAGES = 24;
+
+    size_t nStages;
+    HashChainStage stages[MAX_STAGES];
+
+    void Push(uint8_t nFunc, uint8_t nInputSize = 64, bool fInPlace = false);
+
+    /** Hash len bytes of data through the stages from nFirst on. */
+    uint256 Hash(const unsigned char* data, size_t len, size_t nFirst = 0) const;
+
+    /**
+     * Hash nLanes inputs of len bytes each. Every stage runs over all lanes
+     * before the next one starts, so its code and tables stay in cache, and
+     * stages with an interleaved kernel hash several lanes per call.
+     */
+    void HashBatch(const unsigned char* const* data, size_t len, uint256* out, size_t nLanes) const;
+};
+
+extern const CHashChain HASHCHAIN_X11;
+extern const CHashChain HASHCHAIN_X12;
+extern const CHashChain HASHCHAIN_X13;
+extern const CHashChain HASHCHAIN_X14;
+extern const CHashChain HASHCHAIN_X15;
+extern const CHashChain HASHCHAIN_X17;
+extern const CHashChain HASHCHAIN_C11;
+extern const CHashChain HASHCHAIN_NIST5;
+extern const CHashChain HASHCHAIN_QUBIT;
+extern const CHashChain HASHCHAIN_GROESTL;
+extern const CHashChain HASHCHAIN_SKEIN;
+extern const CHashChain HASHCHAIN_PHI1612;
+extern const CHashChain HASHCHAIN_SKUNKHASH;
+extern const CHashChain HASHCHAIN_TRIBUS;
+
+/**
+ * Hash nLanes messages of len bytes through the interleaved kernel of
+ * nFunc, in[l] into the 64 bytes at out[l]. Returns how many leading lanes
+ * it hashed: a multiple of the kernel width, or 0 when nFunc runs scalar.
+ */
+size_t HashChainMulti(uint8_t nFunc, const unsigned char* const* in, size_t len, unsigned char* const* out, size_t nLanes);
+/** Pick the kernels HashChainMulti() runs for this CPU. */
+std::string hashchain_multi_autodetect();
+
+/** X16R order: the last 16 nibbles of hashSelection pick the 16 stages. */
+CHashChain GetX16RHashChain(const uint256& hashSelection);
+/** X16S: X16R over a shuffled copy of the previous block hash. */
+CHashChain GetX16SHashChain(const uint256& hashPrevBlock);
+/** X21S: the X16S order followed by five fixed stages. */
+CHashChain GetX21SHashChain(const uint256& hashPrevBlock);
+/** CPU23R: the last 23 bytes of the previous block hash pick 23 stages. */
+CHashChain GetCPU23RHashChain(const uint256& hashPrevBlock);
+
+/**
+ * The chains above, decoded once per hash and thread: every header built on
+ * the same parent runs the same order, so mining or checking them only
+ * decodes it on the first one. A returned chain stays valid until the same
+ * thread asks for another hash of that kind.
+ */
+const CHashChain& GetCachedX16RHashChain(const uint256& hashSelection);
+const CHashChain& GetCachedX16SHashChain(const uint256& hashPrevBlock);
+const CHashChain& GetCachedX21SHashChain(const uint256& hashPrevBlock);
+const CHashChain& GetCachedCPU23RHashChain(const uint256& hashPrevBlock);
+
+#endif // GLOBALTOKEN_CRYPTO_HASHCHAIN_H
@@ -48,6 +48,8 @@
 #include <crypto/algos/dedal/dedal.h>
 #include <openssl/sha.h>
 
+#include <algorithm>
+
 #ifdef GLOBALDEFINED
 #define GLOBAL
 #else
@@ -1378,27 +1380,17 @@ inline uint256 SkunkHash5(const T1 pbegin, const T1 pend)
     return hash[3].trim256();
 }
 
-template<typename T1>
-inline uint256 HashQubit(const T1 pbegin, const T1 pend)
+/** Qubit from the output of its first (Luffa-512) stage */
+inline uint256 HashQubitTail(const uint512& first)
 {
-    sph_luffa512_context	 ctx_luffa;
     sph_cubehash512_context  ctx_cubehash;
     sph_shavite512_context	 ctx_shavite;
     sph_simd512_context		 ctx_simd;
     sph_echo512_context		 ctx_echo;
-    static unsigned char pblank[1];
-
-#ifndef QT_NO_DEBUG
-//std::string strhash;
-//strhash = "";
-#endif
-
 
     uint512 hash[5];
 
-    sph_luffa512_init(&ctx_luffa);
-    sph_luffa512 (&ctx_luffa, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
-    sph_luffa512_close(&ctx_luffa, static_cast<void*>(&hash[0]));
+    hash[0] = first;
 
     sph_cubehash512_init(&ctx_cubehash);
     sph_cubehash512 (&ctx_cubehash, static_cast<const void*>(&hash[0]), 64);
@@ -1419,6 +1411,28 @@ inline uint256 HashQubit(const T1 pbegin, const T1 pend)
     return hash[4].trim256();
 }
 
+template<typename T1>
+inline uint256 HashQubit(const T1 pbegin, const T1 pend)
+{
+    sph_luffa512_context ctx;
+    static unsigned char pblank[1];
+    uint512 first;
+
+    sph_luffa512_init(&ctx);
+    sph_luffa512(&ctx, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
+    sph_luffa512_close(&ctx, static_cast<void*>(&first));
+
+    return HashQubitTail(first);
+}
+
+/** Groestl from the output of its first (Groestl-512) stage */
+inline uint256 HashGroestlTail(const uint512& first)
+{
+    uint256 hash2;
+    SHA256((const unsigned char*)&first, 64, (unsigned char*)&hash2);
+    return hash2;
+}
+
 template<typename T1>
 inline uint256 HashGroestl(const T1 pbegin, const T1 pend)
 {
@@ -1426,14 +1440,19 @@ inline uint256 HashGroestl(const T1 pbegin, const T1 pend)
     static unsigned char pblank[1];
 
     uint512 hash1;
-    uint256 hash2;
 
     sph_groestl512_init(&ctx_groestl);
     sph_groestl512(&ctx_groestl, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
     sph_groestl512_close(&ctx_groestl, static_cast<void*>(&hash1));
 
-    SHA256((unsigned char*)&hash1, 64, (unsigned char*)&hash2);
+    return HashGroestlTail(hash1);
+}
 
+/** Skein from the output of its first (Skein-512) stage */
+inline uint256 HashSkeinTail(const uint512& first)
+{
+    uint256 hash2;
+    SHA256((const unsigned char*)&first, 64, (unsigned char*)&hash2);
     return hash2;
 }
 
@@ -1444,15 +1463,12 @@ inline uint256 HashSkein(const T1 pbegin, const T1 pend)
     static unsigned char pblank[1];
 
     uint512 hash1;
-    uint256 hash2;
 
     sph_skein512_init(&ctx_skein);
     sph_skein512(&ctx_skein, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
     sph_skein512_close(&ctx_skein, static_cast<void*>(&hash1));
 
-    SHA256((unsigned char*)&hash1, 64, (unsigned char*)&hash2);
-
-    return hash2;
+    return HashSkeinTail(hash1);
 }
 
 template<typename T1>
@@ -1791,10 +1807,9 @@ inline uint256 HMQ1725(const T1 pbegin, const T1 pend)
     return hash[24].trim256();
 }
 
-template<typename T1>
-inline uint256 HashX11(const T1 pbegin, const T1 pend)
+/** X11 from the output of its first (Blake-512) stage */
+inline uint256 HashX11Tail(const uint512& first)
 {
-    sph_blake512_context     ctx_blake;
     sph_bmw512_context       ctx_bmw;
     sph_groestl512_context   ctx_groestl;
     sph_jh512_context        ctx_jh;
@@ -1805,13 +1820,10 @@ inline uint256 HashX11(const T1 pbegin, const T1 pend)
     sph_shavite512_context   ctx_shavite;
     sph_simd512_context      ctx_simd;
     sph_echo512_context      ctx_echo;
-    static unsigned char pblank[1];
 
     uint512 hash[11];
 
-    sph_blake512_init(&ctx_blake);
-    sph_blake512 (&ctx_blake, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
-    sph_blake512_close(&ctx_blake, static_cast<void*>(&hash[0]));
+    hash[0] = first;
 
     sph_bmw512_init(&ctx_bmw);
     sph_bmw512 (&ctx_bmw, static_cast<const void*>(&hash[0]), 64);
@@ -1856,6 +1868,20 @@ inline uint256 HashX11(const T1 pbegin, const T1 pend)
     return hash[10].trim256();
 }
 
+template<typename T1>
+inline uint256 HashX11(const T1 pbegin, const T1 pend)
+{
+    sph_blake512_context ctx;
+    static unsigned char pblank[1];
+    uint512 first;
+
+    sph_blake512_init(&ctx);
+    sph_blake512(&ctx, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
+    sph_blake512_close(&ctx, static_cast<void*>(&first));
+
+    return HashX11Tail(first);
+}
+
 template<typename T1>
 inline uint256 HashX12(const T1 pbegin, const T1 pend)
 {
@@ -1931,11 +1957,9 @@ inline uint256 HashX12(const T1 pbegin, const T1 pend)
     return hash[11].trim256();
 }
 
-template<typename T1>
-inline uint256 HashX13(const T1 pbegin, const T1 pend)
-
+/** X13 from the output of its first (Blake-512) stage */
+inline uint256 HashX13Tail(const uint512& first)
 {
-    sph_blake512_context     ctx_blake;
     sph_bmw512_context       ctx_bmw;
     sph_groestl512_context   ctx_groestl;
     sph_jh512_context        ctx_jh;
@@ -1948,18 +1972,10 @@ inline uint256 HashX13(const T1 pbegin, const T1 pend)
     sph_echo512_context      ctx_echo;
     sph_hamsi512_context     ctx_hamsi;
     sph_fugue512_context     ctx_fugue;
-    static unsigned char pblank[1];
 
-#ifndef QT_NO_DEBUG
-    //std::string strhash;
-    //strhash = "";
-#endif
-    
     uint512 hash[13];
 
-    sph_blake512_init(&ctx_blake);
-    sph_blake512 (&ctx_blake, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
-    sph_blake512_close(&ctx_blake, static_cast<void*>(&hash[0]));
+    hash[0] = first;
     
     sph_bmw512_init(&ctx_bmw);
     sph_bmw512 (&ctx_bmw, static_cast<const void*>(&hash[0]), 64);
@@ -2013,10 +2029,22 @@ inline uint256 HashX13(const T1 pbegin, const T1 pend)
 }
 
 template<typename T1>
-inline uint256 HashX14(const T1 pbegin, const T1 pend)
+inline uint256 HashX13(const T1 pbegin, const T1 pend)
+{
+    sph_blake512_context ctx;
+    static unsigned char pblank[1];
+    uint512 first;
+
+    sph_blake512_init(&ctx);
+    sph_blake512(&ctx, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
+    sph_blake512_close(&ctx, static_cast<void*>(&first));
+
+    return HashX13Tail(first);
+}
 
+/** X14 from the output of its first (Blake-512) stage */
+inline uint256 HashX14Tail(const uint512& first)
 {
-    sph_blake512_context      ctx_blake;
     sph_bmw512_context        ctx_bmw;
     sph_groestl512_context    ctx_groestl;
     sph_jh512_context         ctx_jh;
@@ -2030,18 +2058,10 @@ inline uint256 HashX14(const T1 pbegin, const T1 pend)
     sph_hamsi512_context      ctx_hamsi;
     sph_fugue512_context      ctx_fugue;
     sph_shabal512_context     ctx_shabal;
-    static unsigned char pblank[1];
 
-#ifndef QT_NO_DEBUG
-    //std::string strhash;
-    //strhash = "";
-#endif
-    
     uint512 hash[14];
 
-    sph_blake512_init(&ctx_blake);
-    sph_blake512 (&ctx_blake, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
-    sph_blake512_close(&ctx_blake, static_cast<void*>(&hash[0]));
+    hash[0] = first;
     
     sph_bmw512_init(&ctx_bmw);
     sph_bmw512 (&ctx_bmw, static_cast<const void*>(&hash[0]), 64);
@@ -2099,10 +2119,22 @@ inline uint256 HashX14(const T1 pbegin, const T1 pend)
 }
 
 template<typename T1>
-inline uint256 HashX15(const T1 pbegin, const T1 pend)
+inline uint256 HashX14(const T1 pbegin, const T1 pend)
+{
+    sph_blake512_context ctx;
+    static unsigned char pblank[1];
+    uint512 first;
+
+    sph_blake512_init(&ctx);
+    sph_blake512(&ctx, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
+    sph_blake512_close(&ctx, static_cast<void*>(&first));
+
+    return HashX14Tail(first);
+}
 
+/** X15 from the output of its first (Blake-512) stage */
+inline uint256 HashX15Tail(const uint512& first)
 {
-    sph_blake512_context      ctx_blake;
     sph_bmw512_context        ctx_bmw;
     sph_groestl512_context    ctx_groestl;
     sph_jh512_context         ctx_jh;
@@ -2117,18 +2149,10 @@ inline uint256 HashX15(const T1 pbegin, const T1 pend)
     sph_fugue512_context      ctx_fugue;
     sph_shabal512_context     ctx_shabal;
     sph_whirlpool_context     ctx_whirlpool;
-    static unsigned char pblank[1];
 
-#ifndef QT_NO_DEBUG
-    //std::string strhash;
-    //strhash = "";
-#endif
-    
     uint512 hash[15];
 
-    sph_blake512_init(&ctx_blake);
-    sph_blake512 (&ctx_blake, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
-    sph_blake512_close(&ctx_blake, static_cast<void*>(&hash[0]));
+    hash[0] = first;
     
     sph_bmw512_init(&ctx_bmw);
     sph_bmw512 (&ctx_bmw, static_cast<const void*>(&hash[0]), 64);
@@ -2190,9 +2214,22 @@ inline uint256 HashX15(const T1 pbegin, const T1 pend)
 }
 
 template<typename T1>
-inline uint256 HashX17(const T1 pbegin, const T1 pend)
+inline uint256 HashX15(const T1 pbegin, const T1 pend)
+{
+    sph_blake512_context ctx;
+    static unsigned char pblank[1];
+    uint512 first;
+
+    sph_blake512_init(&ctx);
+    sph_blake512(&ctx, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
+    sph_blake512_close(&ctx, static_cast<void*>(&first));
+
+    return HashX15Tail(first);
+}
+
+/** X17 from the output of its first (Blake-512) stage */
+inline uint256 HashX17Tail(const uint512& first)
 {
-    sph_blake512_context      ctx_blake;
     sph_bmw512_context        ctx_bmw;
     sph_groestl512_context    ctx_groestl;
     sph_jh512_context         ctx_jh;
@@ -2209,18 +2246,10 @@ inline uint256 HashX17(const T1 pbegin, const T1 pend)
     sph_whirlpool_context     ctx_whirlpool;
     sph_sha512_context        ctx_sha2;
     sph_haval256_5_context    ctx_haval;
-static unsigned char pblank[1];
 
-#ifndef QT_NO_DEBUG
-    //std::string strhash;
-    //strhash = "";
-#endif
-    
     uint512 hash[17];
 
-    sph_blake512_init(&ctx_blake);
-    sph_blake512 (&ctx_blake, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
-    sph_blake512_close(&ctx_blake, static_cast<void*>(&hash[0]));
+    hash[0] = first;
     
     sph_bmw512_init(&ctx_bmw);
     sph_bmw512 (&ctx_bmw, static_cast<const void*>(&hash[0]), 64);
@@ -2286,10 +2315,23 @@ static unsigned char pblank[1];
     sph_haval256_5 (&ctx_haval, static_cast<const void*>(&hash[15]), 64);
     sph_haval256_5_close(&ctx_haval, static_cast<void*>(&hash[16]));
 
-
     return hash[16].trim256();
 }
 
+template<typename T1>
+inline uint256 HashX17(const T1 pbegin, const T1 pend)
+{
+    sph_blake512_context ctx;
+    static unsigned char pblank[1];
+    uint512 first;
+
+    sph_blake512_init(&ctx);
+    sph_blake512(&ctx, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
+    sph_blake512_close(&ctx, static_cast<void*>(&first));
+
+    return HashX17Tail(first);
+}
+
 template<typename T1>
 inline uint256 XEVAN(const T1 pbegin, const T1 pend)
 {
@@ -2455,21 +2497,17 @@ inline uint256 XEVAN(const T1 pbegin, const T1 pend)
     return hash[33].trim256();
 }
 
-template<typename T1>
-inline uint256 NIST5(const T1 pbegin, const T1 pend)
+/** NIST5 from the output of its first (Blake-512) stage */
+inline uint256 NIST5Tail(const uint512& first)
 {
-    sph_blake512_context     ctx_blake;
     sph_groestl512_context   ctx_groestl;
     sph_jh512_context        ctx_jh;
     sph_keccak512_context    ctx_keccak;
     sph_skein512_context     ctx_skein;
 
-    static unsigned char pblank[1];
     uint512 hash[5];
 
-    sph_blake512_init(&ctx_blake);
-    sph_blake512(&ctx_blake, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
-    sph_blake512_close(&ctx_blake, static_cast<void*>(&hash[0]));
+    hash[0] = first;
 
     sph_groestl512_init(&ctx_groestl);
     sph_groestl512(&ctx_groestl, static_cast<const void*>(&hash[0]), 64);
@@ -2490,6 +2528,20 @@ inline uint256 NIST5(const T1 pbegin, const T1 pend)
     return hash[4].trim256();
 }
 
+template<typename T1>
+inline uint256 NIST5(const T1 pbegin, const T1 pend)
+{
+    sph_blake512_context ctx;
+    static unsigned char pblank[1];
+    uint512 first;
+
+    sph_blake512_init(&ctx);
+    sph_blake512(&ctx, (pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0])), (pend - pbegin) * sizeof(pbegin[0]));
+    sph_blake512_close(&ctx, static_cast<void*>(&first));
+
+    return NIST5Tail(first);
+}
+
 template<typename T1>
 inline uint256 RickHash(const T1 pbegin, const T1 pend)
 {
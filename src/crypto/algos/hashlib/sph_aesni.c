@@ -0,0 +1,704 @@
+/*
+ * AES-NI implementations of the Groestl-512, ECHO-512 and SHAvite-512
+ * compression functions.
+ *
+ * All three functions are built from the AES round (or its S-box) and
+ * spend most of their time in table lookups when computed with the
+ * portable code. The routines below compute the same functions with the
+ * AESENC/AESENCLAST and PSHUFB instructions and are installed in place of
+ * the portable ones by sph_aesni_autodetect(), after checking the CPU and
+ * the known answers of the reference implementation.
+ *
+ * The kernels are compiled with per-function target attributes, so that
+ * the rest of the library keeps the baseline instruction set and runs on
+ * any x86 CPU.
+ *
+ * Copyright (c) 2018-2019 The Globaltoken Core developers
+ * Distributed under the MIT software license, see the accompanying
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "sph_aesni.h"
+#include "sph_echo.h"
+#include "sph_groestl.h"
+#include "sph_shavite.h"
+
+#if SPH_AESNI
+
+#include <cpuid.h>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+#define AESNI_TARGET   __attribute__((target("sse2,ssse3,aes")))
+
+/*
+ * The state arrays only stay in registers if the helpers are inlined into
+ * the compression functions, which -O2 does not do on its own.
+ */
+#define AESNI_INLINE   AESNI_TARGET static inline __attribute__((always_inline))
+
+/*
+ * Index of the byte which the AES ShiftRows step moves to position k;
+ * shuffling with it before AESENCLAST leaves only the S-box applied.
+ */
+#define ISR(k)   (4 * ((((k) >> 2) - ((k) & 3)) & 3) + ((k) & 3))
+
+/* ============================ Groestl-512 ============================ */
+
+/*
+ * The 1024-bit state is kept as eight rows of sixteen bytes, one byte per
+ * column. ShiftBytes rotates row i left by a row dependent amount; it is
+ * merged with the inverse ShiftRows in a single shuffle per row.
+ */
+#define GSM(k, s)   ((ISR(k) + (s)) & 15)
+#define GROESTL_SHIFT(s)   _mm_setr_epi8( \
+	GSM( 0, s), GSM( 1, s), GSM( 2, s), GSM( 3, s), \
+	GSM( 4, s), GSM( 5, s), GSM( 6, s), GSM( 7, s), \
+	GSM( 8, s), GSM( 9, s), GSM(10, s), GSM(11, s), \
+	GSM(12, s), GSM(13, s), GSM(14, s), GSM(15, s))
+
+AESNI_INLINE __m128i
+mul2(__m128i x)
+{
+	__m128i carry = _mm_cmpgt_epi8(_mm_setzero_si128(), x);
+
+	return _mm_xor_si128(_mm_add_epi8(x, x),
+		_mm_and_si128(carry, _mm_set1_epi8(0x1B)));
+}
+
+/*
+ * Transpose eight vectors of 16-bit words. Combined with a byte shuffle
+ * this converts between the column major byte order of the chaining
+ * value and the row vectors used by the permutations.
+ */
+AESNI_INLINE void
+transpose16(__m128i x[8])
+{
+	__m128i a0, a1, a2, a3, a4, a5, a6, a7;
+	__m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+	a0 = _mm_unpacklo_epi16(x[0], x[1]);
+	a1 = _mm_unpackhi_epi16(x[0], x[1]);
+	a2 = _mm_unpacklo_epi16(x[2], x[3]);
+	a3 = _mm_unpackhi_epi16(x[2], x[3]);
+	a4 = _mm_unpacklo_epi16(x[4], x[5]);
+	a5 = _mm_unpackhi_epi16(x[4], x[5]);
+	a6 = _mm_unpacklo_epi16(x[6], x[7]);
+	a7 = _mm_unpackhi_epi16(x[6], x[7]);
+	b0 = _mm_unpacklo_epi32(a0, a2);
+	b1 = _mm_unpackhi_epi32(a0, a2);
+	b2 = _mm_unpacklo_epi32(a1, a3);
+	b3 = _mm_unpackhi_epi32(a1, a3);
+	b4 = _mm_unpacklo_epi32(a4, a6);
+	b5 = _mm_unpackhi_epi32(a4, a6);
+	b6 = _mm_unpacklo_epi32(a5, a7);
+	b7 = _mm_unpackhi_epi32(a5, a7);
+	x[0] = _mm_unpacklo_epi64(b0, b4);
+	x[1] = _mm_unpackhi_epi64(b0, b4);
+	x[2] = _mm_unpacklo_epi64(b1, b5);
+	x[3] = _mm_unpackhi_epi64(b1, b5);
+	x[4] = _mm_unpacklo_epi64(b2, b6);
+	x[5] = _mm_unpackhi_epi64(b2, b6);
+	x[6] = _mm_unpacklo_epi64(b3, b7);
+	x[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+AESNI_INLINE void
+groestl_to_rows(__m128i x[8], const unsigned char *src)
+{
+	const __m128i interleave = _mm_setr_epi8(
+		0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+	int i;
+
+	for (i = 0; i < 8; i ++)
+		x[i] = _mm_shuffle_epi8(_mm_loadu_si128(
+			(const __m128i *)(src + 16 * i)), interleave);
+	transpose16(x);
+}
+
+AESNI_INLINE void
+groestl_from_rows(unsigned char *dst, __m128i x[8])
+{
+	const __m128i deinterleave = _mm_setr_epi8(
+		0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+	int i;
+
+	transpose16(x);
+	for (i = 0; i < 8; i ++)
+		_mm_storeu_si128((__m128i *)(dst + 16 * i),
+			_mm_shuffle_epi8(x[i], deinterleave));
+}
+
+/*
+ * MixBytes: row i of the result is the sum over k of B[k] times row i + k,
+ * with B = (02, 02, 03, 04, 05, 03, 05, 07), split by the bits of the
+ * coefficients. Written out in full so that the rows stay in registers.
+ */
+#define GROESTL_MIX_ROW(i)   do { \
+		__m128i s1, s2, s4; \
+		s1 = _mm_xor_si128(_mm_xor_si128(a[((i) + 2) & 7], \
+			a[((i) + 4) & 7]), _mm_xor_si128(_mm_xor_si128( \
+			a[((i) + 5) & 7], a[((i) + 6) & 7]), a[((i) + 7) & 7])); \
+		s2 = _mm_xor_si128(_mm_xor_si128(a[i], a[((i) + 1) & 7]), \
+			_mm_xor_si128(_mm_xor_si128(a[((i) + 2) & 7], \
+			a[((i) + 5) & 7]), a[((i) + 7) & 7])); \
+		s4 = _mm_xor_si128(_mm_xor_si128(a[((i) + 3) & 7], \
+			a[((i) + 4) & 7]), _mm_xor_si128(a[((i) + 6) & 7], \
+			a[((i) + 7) & 7])); \
+		x[i] = _mm_xor_si128(s1, mul2(_mm_xor_si128(s2, mul2(s4)))); \
+	} while (0)
+
+/* SubBytes and ShiftBytes of one row, with the shift given in bytes. */
+#define GROESTL_SUB_SHIFT(i, s) \
+	x[i] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[i], GROESTL_SHIFT(s)), \
+		_mm_setzero_si128())
+
+AESNI_INLINE void
+groestl_mix_bytes(__m128i x[8])
+{
+	__m128i a[8];
+
+	a[0] = x[0];
+	a[1] = x[1];
+	a[2] = x[2];
+	a[3] = x[3];
+	a[4] = x[4];
+	a[5] = x[5];
+	a[6] = x[6];
+	a[7] = x[7];
+	GROESTL_MIX_ROW(0);
+	GROESTL_MIX_ROW(1);
+	GROESTL_MIX_ROW(2);
+	GROESTL_MIX_ROW(3);
+	GROESTL_MIX_ROW(4);
+	GROESTL_MIX_ROW(5);
+	GROESTL_MIX_ROW(6);
+	GROESTL_MIX_ROW(7);
+}
+
+#define GROESTL_ROUND_P(r)   do { \
+		x[0] = _mm_xor_si128(x[0], _mm_xor_si128(rc, _mm_set1_epi8(r))); \
+		GROESTL_SUB_SHIFT(0, 0); \
+		GROESTL_SUB_SHIFT(1, 1); \
+		GROESTL_SUB_SHIFT(2, 2); \
+		GROESTL_SUB_SHIFT(3, 3); \
+		GROESTL_SUB_SHIFT(4, 4); \
+		GROESTL_SUB_SHIFT(5, 5); \
+		GROESTL_SUB_SHIFT(6, 6); \
+		GROESTL_SUB_SHIFT(7, 11); \
+		groestl_mix_bytes(x); \
+	} while (0)
+
+#define GROESTL_ROUND_Q(r)   do { \
+		x[0] = _mm_xor_si128(x[0], ones); \
+		x[1] = _mm_xor_si128(x[1], ones); \
+		x[2] = _mm_xor_si128(x[2], ones); \
+		x[3] = _mm_xor_si128(x[3], ones); \
+		x[4] = _mm_xor_si128(x[4], ones); \
+		x[5] = _mm_xor_si128(x[5], ones); \
+		x[6] = _mm_xor_si128(x[6], ones); \
+		x[7] = _mm_xor_si128(x[7], _mm_xor_si128(rc, _mm_set1_epi8(r))); \
+		GROESTL_SUB_SHIFT(0, 1); \
+		GROESTL_SUB_SHIFT(1, 3); \
+		GROESTL_SUB_SHIFT(2, 5); \
+		GROESTL_SUB_SHIFT(3, 11); \
+		GROESTL_SUB_SHIFT(4, 0); \
+		GROESTL_SUB_SHIFT(5, 2); \
+		GROESTL_SUB_SHIFT(6, 4); \
+		GROESTL_SUB_SHIFT(7, 6); \
+		groestl_mix_bytes(x); \
+	} while (0)
+
+AESNI_INLINE void
+groestl_perm_p(__m128i x[8])
+{
+	const __m128i rc = _mm_setr_epi8(
+		0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70,
+		(char)0x80, (char)0x90, (char)0xA0, (char)0xB0,
+		(char)0xC0, (char)0xD0, (char)0xE0, (char)0xF0);
+	int r;
+
+	for (r = 0; r < 14; r += 2) {
+		GROESTL_ROUND_P(r);
+		GROESTL_ROUND_P(r + 1);
+	}
+}
+
+AESNI_INLINE void
+groestl_perm_q(__m128i x[8])
+{
+	const __m128i ones = _mm_set1_epi8(-1);
+	const __m128i rc = _mm_setr_epi8(
+		(char)0xFF, (char)0xEF, (char)0xDF, (char)0xCF,
+		(char)0xBF, (char)0xAF, (char)0x9F, (char)0x8F,
+		0x7F, 0x6F, 0x5F, 0x4F, 0x3F, 0x2F, 0x1F, 0x0F);
+	int r;
+
+	for (r = 0; r < 14; r += 2) {
+		GROESTL_ROUND_Q(r);
+		GROESTL_ROUND_Q(r + 1);
+	}
+}
+
+AESNI_TARGET static void
+groestl_big_compress_aesni(void *state, const unsigned char *buf)
+{
+	__m128i h[8], g[8], m[8];
+	int i;
+
+	groestl_to_rows(h, state);
+	groestl_to_rows(m, buf);
+	for (i = 0; i < 8; i ++)
+		g[i] = _mm_xor_si128(h[i], m[i]);
+	groestl_perm_p(g);
+	groestl_perm_q(m);
+	for (i = 0; i < 8; i ++)
+		h[i] = _mm_xor_si128(h[i], _mm_xor_si128(g[i], m[i]));
+	groestl_from_rows(state, h);
+}
+
+AESNI_TARGET static void
+groestl_big_final_aesni(void *state)
+{
+	__m128i h[8], x[8];
+	int i;
+
+	groestl_to_rows(h, state);
+	memcpy(x, h, sizeof x);
+	groestl_perm_p(x);
+	for (i = 0; i < 8; i ++)
+		h[i] = _mm_xor_si128(h[i], x[i]);
+	groestl_from_rows(state, h);
+}
+
+/* ============================= ECHO-512 ============================== */
+
+/*
+ * One ECHO-512 compression: the sixteen 128-bit words are the chaining
+ * value followed by the message block, and every round applies two AES
+ * rounds to each word (the first one keyed by the running counter), then
+ * permutes and mixes the words like the AES ShiftRows and MixColumns.
+ */
+/* Two AES rounds on word n, the first keyed by the counter. */
+#define ECHO_2ROUNDS(n)   do { \
+		W[n] = _mm_aesenc_si128(_mm_aesenc_si128(W[n], _mm_set_epi32( \
+			(int)K3, (int)K2, (int)K1, (int)K0)), zero); \
+		if ((K0 = SPH_T32(K0 + 1)) == 0) { \
+			if ((K1 = SPH_T32(K1 + 1)) == 0) \
+				if ((K2 = SPH_T32(K2 + 1)) == 0) \
+					K3 = SPH_T32(K3 + 1); \
+		} \
+	} while (0)
+
+#define ECHO_MIX_COLUMN(ia, ib, ic, id)   do { \
+		__m128i a = W[ia], b = W[ib], c = W[ic], d = W[id]; \
+		__m128i ab = _mm_xor_si128(a, b); \
+		__m128i bc = _mm_xor_si128(b, c); \
+		__m128i cd = _mm_xor_si128(c, d); \
+		__m128i abx = mul2(ab); \
+		__m128i bcx = mul2(bc); \
+		__m128i cdx = mul2(cd); \
+		W[ia] = _mm_xor_si128(abx, _mm_xor_si128(bc, d)); \
+		W[ib] = _mm_xor_si128(bcx, _mm_xor_si128(a, cd)); \
+		W[ic] = _mm_xor_si128(cdx, _mm_xor_si128(ab, d)); \
+		W[id] = _mm_xor_si128(_mm_xor_si128(abx, bcx), \
+			_mm_xor_si128(_mm_xor_si128(cdx, ab), c)); \
+	} while (0)
+
+AESNI_TARGET static void
+echo_big_compress_aesni(sph_echo_big_context *sc)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i W[16];
+	sph_u32 K0, K1, K2, K3;
+	int r, n;
+
+	K0 = sc->C0;
+	K1 = sc->C1;
+	K2 = sc->C2;
+	K3 = sc->C3;
+	for (n = 0; n < 8; n ++) {
+		W[n] = _mm_loadu_si128((const __m128i *)sc->u.Vb[n]);
+		W[n + 8] = _mm_loadu_si128((const __m128i *)(sc->buf + 16 * n));
+	}
+	for (r = 0; r < 10; r ++) {
+		__m128i tmp;
+
+		ECHO_2ROUNDS(0);
+		ECHO_2ROUNDS(1);
+		ECHO_2ROUNDS(2);
+		ECHO_2ROUNDS(3);
+		ECHO_2ROUNDS(4);
+		ECHO_2ROUNDS(5);
+		ECHO_2ROUNDS(6);
+		ECHO_2ROUNDS(7);
+		ECHO_2ROUNDS(8);
+		ECHO_2ROUNDS(9);
+		ECHO_2ROUNDS(10);
+		ECHO_2ROUNDS(11);
+		ECHO_2ROUNDS(12);
+		ECHO_2ROUNDS(13);
+		ECHO_2ROUNDS(14);
+		ECHO_2ROUNDS(15);
+
+		tmp = W[1];
+		W[1] = W[5];
+		W[5] = W[9];
+		W[9] = W[13];
+		W[13] = tmp;
+		tmp = W[2];
+		W[2] = W[10];
+		W[10] = tmp;
+		tmp = W[6];
+		W[6] = W[14];
+		W[14] = tmp;
+		tmp = W[15];
+		W[15] = W[11];
+		W[11] = W[7];
+		W[7] = W[3];
+		W[3] = tmp;
+
+		ECHO_MIX_COLUMN(0, 1, 2, 3);
+		ECHO_MIX_COLUMN(4, 5, 6, 7);
+		ECHO_MIX_COLUMN(8, 9, 10, 11);
+		ECHO_MIX_COLUMN(12, 13, 14, 15);
+	}
+	for (n = 0; n < 8; n ++) {
+		__m128i v = _mm_loadu_si128((const __m128i *)sc->u.Vb[n]);
+		__m128i m = _mm_loadu_si128((const __m128i *)(sc->buf + 16 * n));
+
+		v = _mm_xor_si128(v, _mm_xor_si128(m,
+			_mm_xor_si128(W[n], W[n + 8])));
+		_mm_storeu_si128((__m128i *)sc->u.Vb[n], v);
+	}
+}
+
+/* =========================== SHAvite-512 ============================= */
+
+/* Nonlinear and linear steps of the key expansion, four words each. */
+#define SHAVITE_NL(k) \
+	rk[k] = _mm_xor_si128(_mm_aesenc_si128( \
+		_mm_shuffle_epi32(rk[(k) - 8], 0x39), zero), rk[(k) - 1])
+
+#define SHAVITE_L(k) \
+	rk[k] = _mm_xor_si128(rk[(k) - 8], \
+		_mm_alignr_epi8(rk[(k) - 1], rk[(k) - 2], 4))
+
+/* P0 ^= F(P1) with four AES rounds keyed by rk[k] to rk[k + 3]. */
+#define SHAVITE_F(p0, p1, k)   do { \
+		__m128i x = _mm_xor_si128(p1, rk[k]); \
+		x = _mm_aesenc_si128(x, rk[(k) + 1]); \
+		x = _mm_aesenc_si128(x, rk[(k) + 2]); \
+		x = _mm_aesenc_si128(x, rk[(k) + 3]); \
+		p0 = _mm_xor_si128(p0, _mm_aesenc_si128(x, zero)); \
+	} while (0)
+
+#define SHAVITE_ROUND(k)   do { \
+		__m128i t; \
+		SHAVITE_F(p0, p1, k); \
+		SHAVITE_F(p2, p3, (k) + 4); \
+		t = p3; \
+		p3 = p2; \
+		p2 = p1; \
+		p1 = p0; \
+		p0 = t; \
+	} while (0)
+
+/*
+ * One SHAvite-512 compression. The 448 words of round keys are expanded
+ * from the message and the bit counter four words at a time, alternating
+ * eight nonlinear (AES round) and eight linear steps; the counter enters
+ * the key at four fixed positions.
+ */
+AESNI_TARGET static void
+shavite_big_compress_aesni(sph_shavite_big_context *sc, const void *msg)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i rk[112];
+	__m128i p0, p1, p2, p3;
+	sph_u32 c0, c1, c2, c3;
+	int k;
+
+	c0 = sc->count0;
+	c1 = sc->count1;
+	c2 = sc->count2;
+	c3 = sc->count3;
+	for (k = 0; k < 8; k ++)
+		rk[k] = _mm_loadu_si128((const __m128i *)msg + k);
+	for (k = 8; k < 112; k += 16) {
+		SHAVITE_NL(k + 0);
+		if (k == 8)
+			rk[8] = _mm_xor_si128(rk[8], _mm_set_epi32(
+				(int)~c3, (int)c2, (int)c1, (int)c0));
+		SHAVITE_NL(k + 1);
+		if (k == 40)
+			rk[41] = _mm_xor_si128(rk[41], _mm_set_epi32(
+				(int)~c0, (int)c1, (int)c2, (int)c3));
+		SHAVITE_NL(k + 2);
+		SHAVITE_NL(k + 3);
+		SHAVITE_NL(k + 4);
+		SHAVITE_NL(k + 5);
+		SHAVITE_NL(k + 6);
+		if (k == 104)
+			rk[110] = _mm_xor_si128(rk[110], _mm_set_epi32(
+				(int)~c2, (int)c3, (int)c0, (int)c1));
+		SHAVITE_NL(k + 7);
+		if (k == 72)
+			rk[79] = _mm_xor_si128(rk[79], _mm_set_epi32(
+				(int)~c1, (int)c0, (int)c3, (int)c2));
+		if (k == 104)
+			break;
+		SHAVITE_L(k + 8);
+		SHAVITE_L(k + 9);
+		SHAVITE_L(k + 10);
+		SHAVITE_L(k + 11);
+		SHAVITE_L(k + 12);
+		SHAVITE_L(k + 13);
+		SHAVITE_L(k + 14);
+		SHAVITE_L(k + 15);
+	}
+
+	p0 = _mm_loadu_si128((const __m128i *)sc->h + 0);
+	p1 = _mm_loadu_si128((const __m128i *)sc->h + 1);
+	p2 = _mm_loadu_si128((const __m128i *)sc->h + 2);
+	p3 = _mm_loadu_si128((const __m128i *)sc->h + 3);
+	for (k = 0; k < 112; k += 16) {
+		SHAVITE_ROUND(k);
+		SHAVITE_ROUND(k + 8);
+	}
+	_mm_storeu_si128((__m128i *)sc->h + 0,
+		_mm_xor_si128(_mm_loadu_si128((const __m128i *)sc->h + 0), p0));
+	_mm_storeu_si128((__m128i *)sc->h + 1,
+		_mm_xor_si128(_mm_loadu_si128((const __m128i *)sc->h + 1), p1));
+	_mm_storeu_si128((__m128i *)sc->h + 2,
+		_mm_xor_si128(_mm_loadu_si128((const __m128i *)sc->h + 2), p2));
+	_mm_storeu_si128((__m128i *)sc->h + 3,
+		_mm_xor_si128(_mm_loadu_si128((const __m128i *)sc->h + 3), p3));
+}
+
+static int
+cpu_has_aesni(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return 0;
+	/* SSSE3 is ECX bit 9, AES is ECX bit 25 */
+	return ((ecx >> 9) & 1) && ((ecx >> 25) & 1);
+}
+
+#endif
+
+/*
+ * Known answers of the portable implementation, for the empty message, a
+ * single 64-byte message (the size hashed inside the chained algorithms)
+ * and a 200-byte message spanning two blocks with a partial tail. Message
+ * byte i is 7 * i + 1.
+ */
+static const unsigned char kat_groestl[3][64] = {
+	{
+		0x6D, 0x3A, 0xD2, 0x9D, 0x27, 0x91, 0x10, 0xEE,
+		0xF3, 0xAD, 0xBD, 0x66, 0xDE, 0x2A, 0x03, 0x45,
+		0xA7, 0x7B, 0xAE, 0xDE, 0x15, 0x57, 0xF5, 0xD0,
+		0x99, 0xFC, 0xE0, 0xC0, 0x3D, 0x6D, 0xC2, 0xBA,
+		0x8E, 0x6D, 0x4A, 0x66, 0x33, 0xDF, 0xBD, 0x66,
+		0x05, 0x3C, 0x20, 0xFA, 0xA8, 0x7D, 0x1A, 0x11,
+		0xF3, 0x9A, 0x7F, 0xBE, 0x4A, 0x6C, 0x2F, 0x00,
+		0x98, 0x01, 0x37, 0x03, 0x08, 0xFC, 0x4A, 0xD8
+	},
+	{
+		0xA7, 0xFE, 0x07, 0x93, 0x02, 0xE4, 0x11, 0xD4,
+		0x9F, 0x14, 0x3C, 0x09, 0xB8, 0xE9, 0x71, 0x9E,
+		0x7B, 0x54, 0xF2, 0x82, 0x0B, 0x48, 0x16, 0xC0,
+		0xC0, 0xEB, 0xF9, 0xDD, 0x97, 0xA1, 0x29, 0xDB,
+		0x0F, 0xD4, 0xD1, 0x60, 0x62, 0x14, 0x5A, 0x21,
+		0x9E, 0x80, 0x86, 0xE3, 0xAB, 0x23, 0xA7, 0x32,
+		0xBC, 0x81, 0x5B, 0x92, 0x08, 0x7B, 0xEE, 0x60,
+		0xFB, 0x98, 0x8B, 0x15, 0xBC, 0x10, 0x44, 0xEA
+	},
+	{
+		0x4C, 0x34, 0x21, 0x5E, 0xFE, 0x3A, 0xF6, 0xDD,
+		0x9F, 0x6B, 0x68, 0xB6, 0x5E, 0x75, 0x8B, 0x3B,
+		0x3F, 0xBE, 0xB5, 0xD2, 0x1A, 0x2C, 0xC0, 0xD7,
+		0x11, 0xED, 0xDD, 0xF3, 0xCC, 0x8C, 0xB8, 0x38,
+		0x70, 0x33, 0x39, 0x5C, 0x15, 0xA4, 0x14, 0xE6,
+		0x31, 0x04, 0x99, 0x25, 0x91, 0x03, 0x85, 0x73,
+		0x87, 0x81, 0xF7, 0xBE, 0xC3, 0xAA, 0x84, 0x65,
+		0x96, 0x16, 0x4A, 0xE9, 0xE7, 0xFB, 0xEA, 0xDB
+	}
+};
+
+static const unsigned char kat_echo[3][64] = {
+	{
+		0x15, 0x8F, 0x58, 0xCC, 0x79, 0xD3, 0x00, 0xA9,
+		0xAA, 0x29, 0x25, 0x15, 0x04, 0x92, 0x75, 0xD0,
+		0x51, 0xA2, 0x8A, 0xB9, 0x31, 0x72, 0x6D, 0x0E,
+		0xC4, 0x4B, 0xDD, 0x9F, 0xAE, 0xF4, 0xA7, 0x02,
+		0xC3, 0x6D, 0xB9, 0xE7, 0x92, 0x2F, 0xFF, 0x07,
+		0x74, 0x02, 0x23, 0x64, 0x65, 0x83, 0x3C, 0x5C,
+		0xC7, 0x6A, 0xF4, 0xEF, 0xC3, 0x52, 0xB4, 0xB4,
+		0x4C, 0x7F, 0xA1, 0x5A, 0xA0, 0xEF, 0x23, 0x4E
+	},
+	{
+		0x5B, 0x0A, 0x3C, 0x6B, 0x90, 0x18, 0xBC, 0x69,
+		0x94, 0x39, 0xD3, 0x75, 0x16, 0xE7, 0x99, 0xBC,
+		0x44, 0x60, 0x9B, 0x0B, 0x57, 0x25, 0xA3, 0x30,
+		0x2D, 0x23, 0x58, 0xEA, 0x3A, 0xB1, 0x60, 0xEC,
+		0xBD, 0x68, 0x6C, 0xBE, 0x1E, 0xF0, 0x15, 0x77,
+		0xD1, 0x2D, 0x35, 0x69, 0x68, 0x92, 0x5E, 0x56,
+		0x4D, 0x3D, 0xDA, 0xDD, 0x99, 0xD5, 0x6A, 0x10,
+		0x9E, 0x9F, 0xCE, 0xBA, 0xEE, 0xD3, 0xE5, 0x10
+	},
+	{
+		0xD2, 0x3C, 0x84, 0xBE, 0x00, 0x10, 0x7B, 0xA5,
+		0xE9, 0xFD, 0xD0, 0xF9, 0xD7, 0xF5, 0x6C, 0x56,
+		0xCA, 0x1E, 0x45, 0xB6, 0x0C, 0xB3, 0x66, 0xF4,
+		0x2D, 0xDF, 0xCB, 0xF6, 0x33, 0xBD, 0x9F, 0x1A,
+		0x10, 0x74, 0x4B, 0xBE, 0x03, 0xC6, 0x23, 0xFC,
+		0x27, 0x12, 0x23, 0x99, 0xEA, 0x28, 0x93, 0xAE,
+		0xB4, 0x3C, 0x29, 0xA5, 0xA0, 0xB0, 0xAE, 0x64,
+		0x28, 0x5C, 0x58, 0xC1, 0x01, 0x34, 0xB3, 0xD5
+	}
+};
+
+static const unsigned char kat_shavite[3][64] = {
+	{
+		0xA4, 0x85, 0xC1, 0xB2, 0x57, 0x84, 0x59, 0xD1,
+		0xEF, 0xC5, 0xDD, 0xDD, 0x84, 0x0B, 0xB0, 0xB4,
+		0xA6, 0x50, 0xAC, 0x82, 0xFE, 0x68, 0xF5, 0x8C,
+		0x44, 0x42, 0xCC, 0xDA, 0x74, 0x7D, 0xA0, 0x06,
+		0xB2, 0xD1, 0xDC, 0x6B, 0x4A, 0x4E, 0xB7, 0xD8,
+		0x4F, 0xF9, 0x1E, 0x1F, 0x46, 0x6F, 0xEF, 0x42,
+		0x9D, 0x25, 0x9A, 0xCD, 0x99, 0x5D, 0xDD, 0xCA,
+		0xD1, 0x6F, 0xA5, 0x45, 0xC7, 0xA6, 0xE5, 0xBA
+	},
+	{
+		0xF4, 0x53, 0xAF, 0xA1, 0x4C, 0x2A, 0xD2, 0x94,
+		0xE6, 0xB5, 0x51, 0xF1, 0x8C, 0xA1, 0x35, 0x1D,
+		0x1A, 0x2E, 0x9E, 0x13, 0x6F, 0xB9, 0x1A, 0x46,
+		0x12, 0x10, 0xF7, 0xFB, 0x49, 0x22, 0xE8, 0x95,
+		0x9C, 0xDE, 0x59, 0x1E, 0x33, 0x0A, 0xA0, 0x74,
+		0xDA, 0xC6, 0x0F, 0xB5, 0x82, 0x98, 0xFE, 0x54,
+		0xF0, 0x1F, 0x79, 0x9A, 0xA4, 0x67, 0x16, 0xFC,
+		0x96, 0xDC, 0x41, 0x64, 0x48, 0xD4, 0x18, 0x48
+	},
+	{
+		0x5D, 0xAB, 0x23, 0x72, 0x63, 0xBB, 0xEB, 0xBB,
+		0x63, 0x9D, 0x1D, 0xEB, 0x65, 0x95, 0x88, 0x3F,
+		0x31, 0x62, 0xDF, 0xF7, 0x86, 0x1D, 0xB5, 0x56,
+		0x51, 0x54, 0x7F, 0x8E, 0x38, 0xEC, 0x58, 0x11,
+		0x49, 0x0F, 0x62, 0x4A, 0xC8, 0x98, 0x83, 0xC1,
+		0xD1, 0x7B, 0xAE, 0x57, 0xC4, 0x40, 0x5A, 0xB5,
+		0x71, 0x8F, 0xF2, 0xA9, 0xF6, 0x4F, 0xC8, 0x66,
+		0x18, 0x5E, 0xD4, 0x5B, 0x20, 0x61, 0xDC, 0x8B
+	}
+};
+
+
+/*
+ * Hash the known answer messages with the currently installed functions.
+ * The long message is fed in uneven pieces to exercise the buffering.
+ */
+static int
+self_test(void)
+{
+	static const size_t lengths[3] = { 0, 64, 200 };
+	static const size_t pieces[5] = { 1, 3, 7, 60, 129 };
+	unsigned char msg[200], out[64];
+	sph_groestl512_context groestl;
+	sph_echo512_context echo;
+	sph_shavite512_context shavite;
+	size_t i, k;
+
+	for (i = 0; i < sizeof msg; i ++)
+		msg[i] = (unsigned char)(7 * i + 1);
+	for (k = 0; k < 3; k ++) {
+		const unsigned char *p = msg;
+		size_t len = lengths[k];
+
+		sph_groestl512_init(&groestl);
+		sph_echo512_init(&echo);
+		sph_shavite512_init(&shavite);
+		for (i = 0; len > 0; i ++) {
+			size_t clen = len < 64 ? len : pieces[i % 5];
+
+			if (clen > len)
+				clen = len;
+			sph_groestl512(&groestl, p, clen);
+			sph_echo512(&echo, p, clen);
+			sph_shavite512(&shavite, p, clen);
+			p += clen;
+			len -= clen;
+		}
+		sph_groestl512_close(&groestl, out);
+		if (memcmp(out, kat_groestl[k], sizeof out) != 0)
+			return 0;
+		sph_echo512_close(&echo, out);
+		if (memcmp(out, kat_echo[k], sizeof out) != 0)
+			return 0;
+		sph_shavite512_close(&shavite, out);
+		if (memcmp(out, kat_shavite[k], sizeof out) != 0)
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * The portable functions, as installed before the first call to
+ * sph_aesni_autodetect().
+ */
+static struct {
+	int saved;
+	void (*groestl_big_compress)(void *state, const unsigned char *buf);
+	void (*groestl_big_final)(void *state);
+	void (*echo_big_compress)(sph_echo_big_context *sc);
+	void (*shavite_big_compress)(sph_shavite_big_context *sc,
+		const void *msg);
+} portable;
+
+static void
+save_portable(void)
+{
+	if (portable.saved)
+		return;
+	portable.groestl_big_compress = sph_groestl_big_compress;
+	portable.groestl_big_final = sph_groestl_big_final;
+	portable.echo_big_compress = sph_echo_big_compress;
+	portable.shavite_big_compress = sph_shavite_big_compress;
+	portable.saved = 1;
+}
+
+/* see sph_aesni.h */
+const char *
+sph_aesni_autodetect(void)
+{
+	save_portable();
+#if SPH_AESNI
+	if (cpu_has_aesni()) {
+		sph_groestl_big_compress = groestl_big_compress_aesni;
+		sph_groestl_big_final = groestl_big_final_aesni;
+		sph_echo_big_compress = echo_big_compress_aesni;
+		sph_shavite_big_compress = shavite_big_compress_aesni;
+		assert(self_test());
+		return "aes-ni";
+	}
+#endif
+	assert(self_test());
+	return "standard";
+}
+
+/* see sph_aesni.h */
+const char *
+sph_aesni_use_base(void)
+{
+	save_portable();
+	sph_groestl_big_compress = portable.groestl_big_compress;
+	sph_groestl_big_final = portable.groestl_big_final;
+	sph_echo_big_compress = portable.echo_big_compress;
+	sph_shavite_big_compress = portable.shavite_big_compress;
+	return "standard";
+}
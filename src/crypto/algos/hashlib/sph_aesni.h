@@ -0,0 +1,58 @@
+/*
+ * Runtime selection of the AES-NI implementations of the Groestl-512,
+ * ECHO-512 and SHAvite-512 compression functions.
+ *
+ * Copyright (c) 2018-2019 The Globaltoken Core developers
+ * Distributed under the MIT software license, see the accompanying
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.
+ */
+
+#ifndef SPH_AESNI_H__
+#define SPH_AESNI_H__
+
+#include "sph_types.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * The accelerated code needs x86, SSSE3/AES intrinsics usable through
+ * function target attributes (GCC 4.9 and later, or clang) and 64-bit
+ * integer support (for the ECHO state layout).
+ */
+#if !defined SPH_AESNI
+#if (defined(__x86_64__) || defined(__amd64__) || defined(__i386__)) \
+	&& (defined(__clang__) || __GNUC__ > 4 \
+	|| (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) \
+	&& SPH_64
+#define SPH_AESNI   1
+#else
+#define SPH_AESNI   0
+#endif
+#endif
+
+/**
+ * Install the AES-NI implementations of Groestl-512, ECHO-512 and
+ * SHAvite-512 if the CPU supports AES-NI and SSSE3, then check the
+ * installed functions against known answers of the portable code
+ * (aborting on mismatch). Returns the name of the implementation in
+ * use. Call once at startup, before any hashing thread is started.
+ *
+ * @return   "aes-ni" or "standard"
+ */
+const char *sph_aesni_autodetect(void);
+
+/**
+ * Install the portable implementations again, to test or benchmark the
+ * AES-NI ones against them. Not thread safe, like sph_aesni_autodetect().
+ *
+ * @return   "standard"
+ */
+const char *sph_aesni_use_base(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -312,6 +312,14 @@ void sph_echo512_close(void *cc, void *dst);
  */
 void sph_echo512_addbits_and_close(
 	void *cc, unsigned ub, unsigned n, void *dst);
+
+/**
+ * Compression function of ECHO-384 and ECHO-512, applied to the block in
+ * <code>sc->buf</code> with the counter already updated. It points to the
+ * portable implementation and is replaced by an equivalent accelerated one
+ * by <code>sph_aesni_autodetect()</code>.
+ */
+extern void (*sph_echo_big_compress)(sph_echo_big_context *sc);
 	
 #ifdef __cplusplus
 }
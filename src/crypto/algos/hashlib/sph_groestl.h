@@ -322,6 +322,16 @@ void sph_groestl512_close(void *cc, void *dst);
 void sph_groestl512_addbits_and_close(
 	void *cc, unsigned ub, unsigned n, void *dst);
 
+/**
+ * Compression function and output transformation of Groestl-384 and
+ * Groestl-512, operating on the 1024-bit chaining value as stored in the
+ * context (on little-endian systems, the state bytes in order). They
+ * point to the portable implementation and are replaced by an equivalent
+ * accelerated one by <code>sph_aesni_autodetect()</code>.
+ */
+extern void (*sph_groestl_big_compress)(void *state, const unsigned char *buf);
+extern void (*sph_groestl_big_final)(void *state);
+
 #ifdef __cplusplus
 }
 #endif
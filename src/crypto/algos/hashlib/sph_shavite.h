@@ -306,6 +306,15 @@ void sph_shavite512_close(void *cc, void *dst);
  */
 void sph_shavite512_addbits_and_close(
 	void *cc, unsigned ub, unsigned n, void *dst);
+
+/**
+ * Compression function of SHAvite-384 and SHAvite-512, applied to a
+ * 128-byte block with the counter already updated. It points to the
+ * portable implementation and is replaced by an equivalent accelerated one
+ * by <code>sph_aesni_autodetect()</code>.
+ */
+extern void (*sph_shavite_big_compress)(sph_shavite_big_context *sc,
+	const void *msg);
 	
 #ifdef __cplusplus
 }
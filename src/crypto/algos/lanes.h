@@ -0,0 +1,119 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBALTOKEN_CRYPTO_ALGOS_LANES_H
+#define GLOBALTOKEN_CRYPTO_ALGOS_LANES_H
+
+#include <stdint.h>
+
+/**
+ * 32-bit word vectors for multi-buffer kernels. Lane i of a vector holds a
+ * word of the i-th independent input, so a round function written once over
+ * these types hashes COUNT inputs at a time. Word arrays are stored word
+ * major: word k of lane i is at index k * COUNT + i, aligned to ALIGN bytes.
+ */
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+struct LanesSSE2
+{
+    static const unsigned int COUNT = 4;
+    static const unsigned int ALIGN = 16;
+    typedef __m128i Word;
+
+    static Word Load(const uint32_t* p) { return _mm_load_si128((const __m128i*)p); }
+    static void Store(uint32_t* p, Word w) { _mm_store_si128((__m128i*)p, w); }
+    static Word Add(Word a, Word b) { return _mm_add_epi32(a, b); }
+    static Word Xor(Word a, Word b) { return _mm_xor_si128(a, b); }
+    template <int N> static Word Rotl(Word w) { return _mm_or_si128(_mm_slli_epi32(w, N), _mm_srli_epi32(w, 32 - N)); }
+};
+
+/** 64-bit word vectors, laid out the same way as the 32-bit ones */
+struct Lanes64SSE2
+{
+    static const unsigned int COUNT = 2;
+    static const unsigned int ALIGN = 16;
+    typedef __m128i Word;
+
+    static Word Load(const uint64_t* p) { return _mm_load_si128((const __m128i*)p); }
+    static void Store(uint64_t* p, Word w) { _mm_store_si128((__m128i*)p, w); }
+    static Word Set1(uint64_t x) { return _mm_set1_epi64x(x); }
+    static Word Add(Word a, Word b) { return _mm_add_epi64(a, b); }
+    static Word Sub(Word a, Word b) { return _mm_sub_epi64(a, b); }
+    static Word Xor(Word a, Word b) { return _mm_xor_si128(a, b); }
+    /** ~a & b */
+    static Word AndNot(Word a, Word b) { return _mm_andnot_si128(a, b); }
+    template <int N> static Word Shl(Word w) { return _mm_slli_epi64(w, N); }
+    template <int N> static Word Shr(Word w) { return _mm_srli_epi64(w, N); }
+    template <int N> static Word Rotl(Word w) { return _mm_or_si128(_mm_slli_epi64(w, N), _mm_srli_epi64(w, 64 - N)); }
+};
+
+template <> inline __m128i Lanes64SSE2::Rotl<32>(__m128i w)
+{
+    return _mm_shuffle_epi32(w, 0xb1);
+}
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+struct LanesAVX2
+{
+    static const unsigned int COUNT = 8;
+    static const unsigned int ALIGN = 32;
+    typedef __m256i Word;
+
+    static Word Load(const uint32_t* p) { return _mm256_load_si256((const __m256i*)p); }
+    static void Store(uint32_t* p, Word w) { _mm256_store_si256((__m256i*)p, w); }
+    static Word Add(Word a, Word b) { return _mm256_add_epi32(a, b); }
+    static Word Xor(Word a, Word b) { return _mm256_xor_si256(a, b); }
+    template <int N> static Word Rotl(Word w) { return _mm256_or_si256(_mm256_slli_epi32(w, N), _mm256_srli_epi32(w, 32 - N)); }
+};
+
+/** Byte-aligned rotations are a single shuffle */
+template <> inline __m256i LanesAVX2::Rotl<8>(__m256i w)
+{
+    return _mm256_shuffle_epi8(w, _mm256_set_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+                                                  14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3));
+}
+
+template <> inline __m256i LanesAVX2::Rotl<16>(__m256i w)
+{
+    return _mm256_shuffle_epi8(w, _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                                                  13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2));
+}
+
+struct Lanes64AVX2
+{
+    static const unsigned int COUNT = 4;
+    static const unsigned int ALIGN = 32;
+    typedef __m256i Word;
+
+    static Word Load(const uint64_t* p) { return _mm256_load_si256((const __m256i*)p); }
+    static void Store(uint64_t* p, Word w) { _mm256_store_si256((__m256i*)p, w); }
+    static Word Set1(uint64_t x) { return _mm256_set1_epi64x(x); }
+    static Word Add(Word a, Word b) { return _mm256_add_epi64(a, b); }
+    static Word Sub(Word a, Word b) { return _mm256_sub_epi64(a, b); }
+    static Word Xor(Word a, Word b) { return _mm256_xor_si256(a, b); }
+    /** ~a & b */
+    static Word AndNot(Word a, Word b) { return _mm256_andnot_si256(a, b); }
+    template <int N> static Word Shl(Word w) { return _mm256_slli_epi64(w, N); }
+    template <int N> static Word Shr(Word w) { return _mm256_srli_epi64(w, N); }
+    template <int N> static Word Rotl(Word w) { return _mm256_or_si256(_mm256_slli_epi64(w, N), _mm256_srli_epi64(w, 64 - N)); }
+};
+
+template <> inline __m256i Lanes64AVX2::Rotl<32>(__m256i w)
+{
+    return _mm256_shuffle_epi32(w, 0xb1);
+}
+
+template <> inline __m256i Lanes64AVX2::Rotl<48>(__m256i w)
+{
+    return _mm256_shuffle_epi8(w, _mm256_set_epi8(9, 8, 15, 14, 13, 12, 11, 10, 1, 0, 7, 6, 5, 4, 3, 2,
+                                                  9, 8, 15, 14, 13, 12, 11, 10, 1, 0, 7, 6, 5, 4, 3, 2));
+}
+#endif
+
+#endif // GLOBALTOKEN_CRYPTO_ALGOS_LANES_H
@@ -0,0 +1,15 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/algos/neoscrypt/neoscrypt-multi.h>
+
+#if defined(__AVX2__)
+namespace neoscrypt_avx2
+{
+void Hash_8way(const unsigned char* const* password, unsigned char* output, uint32_t* V)
+{
+    neoscrypt_lanes<LanesAVX2>(password, output, V);
+}
+}
+#endif
@@ -0,0 +1,94 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/algos/neoscrypt/neoscrypt-multi.h>
+#include <crypto/algos/cpufeatures.h>
+
+#include <assert.h>
+#include <memory>
+
+#if defined(__SSE2__)
+namespace neoscrypt_sse2
+{
+void Hash_4way(const unsigned char* const* password, unsigned char* output, uint32_t* V)
+{
+    neoscrypt_lanes<LanesSSE2>(password, output, V);
+}
+}
+#endif
+
+#if defined(ENABLE_AVX2)
+namespace neoscrypt_avx2
+{
+void Hash_8way(const unsigned char* const* password, unsigned char* output, uint32_t* V);
+}
+#endif
+
+namespace {
+
+bool fUseAVX2 = false;
+
+/** Scratchpad for nLanes lanes, aligned for any lane width */
+class MultiScratchpad
+{
+    std::unique_ptr<uint32_t[]> buf;
+
+public:
+    explicit MultiScratchpad(unsigned int nLanes) : buf(new uint32_t[NEOSCRYPT_LANE_SCRATCHPAD_WORDS * nLanes + 8]) {}
+    uint32_t* get() const { return (uint32_t*)(((uintptr_t)buf.get() + 31) & ~(uintptr_t)31); }
+};
+
+#if defined(ENABLE_AVX2)
+bool SelfTestAVX2()
+{
+    unsigned char input[8][80];
+    const unsigned char* pinput[8];
+    unsigned char expected[8 * 32], actual[8 * 32];
+    for (unsigned int l = 0; l < 8; l++) {
+        for (unsigned int i = 0; i < 80; i++)
+            input[l][i] = (unsigned char)(l * 80 + i);
+        pinput[l] = input[l];
+        neoscrypt(input[l], &expected[32 * l], 0);
+    }
+    neoscrypt_avx2::Hash_8way(pinput, actual, MultiScratchpad(8).get());
+    return memcmp(expected, actual, sizeof(actual)) == 0;
+}
+#endif
+
+} // namespace
+
+const char* neoscrypt_multi_autodetect(void)
+{
+    fUseAVX2 = false;
+#if defined(ENABLE_AVX2) && defined(ALGOS_HAVE_CPUID)
+    if (algos_cpu_has_avx2()) {
+        assert(SelfTestAVX2());
+        fUseAVX2 = true;
+        return "avx2(8way),sse2(4way)";
+    }
+#endif
+#if defined(__SSE2__)
+    return "sse2(4way)";
+#else
+    return "standard";
+#endif
+}
+
+void neoscrypt_multi(const unsigned char* const* password, unsigned char* output, unsigned int profile, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(__SSE2__)
+    if (profile == 0 && count >= 4) {
+        MultiScratchpad scratchpad(fUseAVX2 && count >= 8 ? 8 : 4);
+#if defined(ENABLE_AVX2)
+        for (; fUseAVX2 && count - i >= 8; i += 8)
+            neoscrypt_avx2::Hash_8way(&password[i], &output[32 * i], scratchpad.get());
+#endif
+        for (; count - i >= 4; i += 4)
+            neoscrypt_sse2::Hash_4way(&password[i], &output[32 * i], scratchpad.get());
+    }
+#endif
+    for (; i < count; i++)
+        neoscrypt(password[i], &output[32 * i], profile);
+}
@@ -0,0 +1,168 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBALTOKEN_CRYPTO_ALGOS_NEOSCRYPT_MULTI_H
+#define GLOBALTOKEN_CRYPTO_ALGOS_NEOSCRYPT_MULTI_H
+
+#include <crypto/algos/lanes.h>
+#include <crypto/algos/neoscrypt/neoscrypt.h>
+
+#include <string.h>
+
+/** NeoScrypt(128, 2, 1), the default profile: N and words of X per lane */
+static const unsigned int NEOSCRYPT_LANE_N = 128;
+static const unsigned int NEOSCRYPT_LANE_X_WORDS = 64;
+/** Words of scratchpad neoscrypt_lanes() needs per lane */
+static const size_t NEOSCRYPT_LANE_SCRATCHPAD_WORDS = NEOSCRYPT_LANE_N * NEOSCRYPT_LANE_X_WORDS;
+
+/** B = Salsa20/20(B ^ Bx) in every lane, neoscrypt_blkxor() and neoscrypt_salsa() */
+template <typename L>
+static inline void neoscrypt_xor_salsa_lanes(uint32_t* B, const uint32_t* Bx)
+{
+    typedef typename L::Word Word;
+    const unsigned int n = L::COUNT;
+    Word x[16];
+
+    for (unsigned int k = 0; k < 16; k++) {
+        x[k] = L::Xor(L::Load(&B[k * n]), L::Load(&Bx[k * n]));
+        L::Store(&B[k * n], x[k]);
+    }
+
+#define QUARTER(a, b, c, d) \
+    x[b] = L::Xor(x[b], L::template Rotl<7>(L::Add(x[a], x[d]))); \
+    x[c] = L::Xor(x[c], L::template Rotl<9>(L::Add(x[b], x[a]))); \
+    x[d] = L::Xor(x[d], L::template Rotl<13>(L::Add(x[c], x[b]))); \
+    x[a] = L::Xor(x[a], L::template Rotl<18>(L::Add(x[d], x[c])));
+    for (unsigned int rounds = 20; rounds; rounds -= 2) {
+        QUARTER( 0,  4,  8, 12);
+        QUARTER( 5,  9, 13,  1);
+        QUARTER(10, 14,  2,  6);
+        QUARTER(15,  3,  7, 11);
+        QUARTER( 0,  1,  2,  3);
+        QUARTER( 5,  6,  7,  4);
+        QUARTER(10, 11,  8,  9);
+        QUARTER(15, 12, 13, 14);
+    }
+#undef QUARTER
+
+    for (unsigned int k = 0; k < 16; k++)
+        L::Store(&B[k * n], L::Add(L::Load(&B[k * n]), x[k]));
+}
+
+/** B = ChaCha20/20(B ^ Bx) in every lane, neoscrypt_blkxor() and neoscrypt_chacha() */
+template <typename L>
+static inline void neoscrypt_xor_chacha_lanes(uint32_t* B, const uint32_t* Bx)
+{
+    typedef typename L::Word Word;
+    const unsigned int n = L::COUNT;
+    Word x[16];
+
+    for (unsigned int k = 0; k < 16; k++) {
+        x[k] = L::Xor(L::Load(&B[k * n]), L::Load(&Bx[k * n]));
+        L::Store(&B[k * n], x[k]);
+    }
+
+#define QUARTER(a, b, c, d) \
+    x[a] = L::Add(x[a], x[b]); x[d] = L::template Rotl<16>(L::Xor(x[d], x[a])); \
+    x[c] = L::Add(x[c], x[d]); x[b] = L::template Rotl<12>(L::Xor(x[b], x[c])); \
+    x[a] = L::Add(x[a], x[b]); x[d] = L::template Rotl<8>(L::Xor(x[d], x[a])); \
+    x[c] = L::Add(x[c], x[d]); x[b] = L::template Rotl<7>(L::Xor(x[b], x[c]));
+    for (unsigned int rounds = 20; rounds; rounds -= 2) {
+        QUARTER( 0,  4,  8, 12);
+        QUARTER( 1,  5,  9, 13);
+        QUARTER( 2,  6, 10, 14);
+        QUARTER( 3,  7, 11, 15);
+        QUARTER( 0,  5, 10, 15);
+        QUARTER( 1,  6, 11, 12);
+        QUARTER( 2,  7,  8, 13);
+        QUARTER( 3,  4,  9, 14);
+    }
+#undef QUARTER
+
+    for (unsigned int k = 0; k < 16; k++)
+        L::Store(&B[k * n], L::Add(L::Load(&B[k * n]), x[k]));
+}
+
+/** neoscrypt_blkmix() with r = 2 in every lane */
+template <typename L, bool fChaCha>
+static inline void neoscrypt_blkmix_lanes(uint32_t* X)
+{
+    const unsigned int n = L::COUNT;
+    uint32_t* const B[4] = {&X[0], &X[16 * n], &X[32 * n], &X[48 * n]};
+    alignas(L::ALIGN) uint32_t tmp[16 * n];
+
+    for (unsigned int b = 0; b < 4; b++) {
+        if (fChaCha)
+            neoscrypt_xor_chacha_lanes<L>(B[b], B[(b + 3) % 4]);
+        else
+            neoscrypt_xor_salsa_lanes<L>(B[b], B[(b + 3) % 4]);
+    }
+    memcpy(tmp, B[1], sizeof(tmp));
+    memcpy(B[1], B[2], sizeof(tmp));
+    memcpy(B[2], tmp, sizeof(tmp));
+}
+
+/** SMix of X against the scratchpad V in every lane */
+template <typename L, bool fChaCha>
+static inline void neoscrypt_smix_lanes(uint32_t* X, uint32_t* V)
+{
+    const unsigned int n = L::COUNT;
+    const unsigned int nWords = NEOSCRYPT_LANE_X_WORDS * n;
+    unsigned int i, k, l;
+
+    for (i = 0; i < NEOSCRYPT_LANE_N; i++) {
+        memcpy(&V[i * nWords], X, nWords * sizeof(uint32_t));
+        neoscrypt_blkmix_lanes<L, fChaCha>(X);
+    }
+    for (i = 0; i < NEOSCRYPT_LANE_N; i++) {
+        for (l = 0; l < n; l++) {
+            /* integerify(X) mod N */
+            const uint32_t* Vj = &V[nWords * (X[48 * n + l] & (NEOSCRYPT_LANE_N - 1)) + l];
+            for (k = 0; k < NEOSCRYPT_LANE_X_WORDS; k++)
+                X[k * n + l] ^= Vj[k * n];
+        }
+        neoscrypt_blkmix_lanes<L, fChaCha>(X);
+    }
+}
+
+/**
+ * neoscrypt() with profile 0 of L::COUNT 80 byte inputs at once. output
+ * receives L::COUNT consecutive 32 byte hashes. V must hold
+ * NEOSCRYPT_LANE_SCRATCHPAD_WORDS * L::COUNT words aligned to L::ALIGN.
+ *
+ * The ChaCha and Salsa rounds run on all lanes together; FastKDF and the
+ * data dependent reads of the scratchpad are done lane by lane.
+ */
+template <typename L>
+void neoscrypt_lanes(const unsigned char* const* password, unsigned char* output, uint32_t* V)
+{
+    const unsigned int n = L::COUNT;
+    alignas(L::ALIGN) uint32_t X[NEOSCRYPT_LANE_X_WORDS * n];
+    alignas(L::ALIGN) uint32_t Z[NEOSCRYPT_LANE_X_WORDS * n];
+    alignas(L::ALIGN) uint32_t buf[NEOSCRYPT_LANE_X_WORDS];
+    unsigned int k, l;
+
+    /* X = KDF(password, salt) */
+    for (l = 0; l < n; l++) {
+        neoscrypt_fastkdf_opt(password[l], password[l], (unsigned char *)buf, 0);
+        for (k = 0; k < NEOSCRYPT_LANE_X_WORDS; k++)
+            X[k * n + l] = buf[k];
+    }
+
+    /* Process ChaCha 1st, Salsa 2nd and XOR them into FastKDF */
+    memcpy(Z, X, sizeof(Z));
+    neoscrypt_smix_lanes<L, true>(Z, V);
+    neoscrypt_smix_lanes<L, false>(X, V);
+    for (k = 0; k < NEOSCRYPT_LANE_X_WORDS * n; k++)
+        X[k] ^= Z[k];
+
+    /* output = KDF(password, X) */
+    for (l = 0; l < n; l++) {
+        for (k = 0; k < NEOSCRYPT_LANE_X_WORDS; k++)
+            buf[k] = X[k * n + l];
+        neoscrypt_fastkdf_opt(password[l], (const unsigned char *)buf, output + 32 * l, 1);
+    }
+}
+
+#endif // GLOBALTOKEN_CRYPTO_ALGOS_NEOSCRYPT_MULTI_H
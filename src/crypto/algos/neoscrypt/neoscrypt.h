@@ -32,6 +32,20 @@ void neoscrypt_fastkdf_4way(const unsigned char *password,
 
 unsigned int cpu_vec_exts(void);
 
+/* FastKDF-BLAKE2s of neoscrypt(): mode 0 expands password into 256 bytes
+ * of output, mode 1 compresses the 256 byte salt into 32 bytes */
+void neoscrypt_fastkdf_opt(const unsigned char *password,
+  const unsigned char *salt, unsigned char *output, unsigned int mode);
+
+/* neoscrypt() of count 80 byte inputs into count consecutive 32 byte
+ * outputs. With profile 0, groups of inputs run through the widest
+ * multi-buffer kernel selected by neoscrypt_multi_autodetect() */
+void neoscrypt_multi(const unsigned char *const *password,
+  unsigned char *output, unsigned int profile, unsigned int count);
+
+/* Select the multi-buffer kernels the CPU supports and return their names */
+const char *neoscrypt_multi_autodetect(void);
+
 #if (__cplusplus)
 }
 #else
@@ -0,0 +1,15 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/algos/scrypt/scrypt-multi.h>
+
+#if defined(__AVX2__)
+namespace scrypt_avx2
+{
+void Hash_8way(const char* const* input, char* output, uint32_t* V)
+{
+    scrypt_1024_1_1_256_lanes<LanesAVX2>(input, output, V);
+}
+}
+#endif
@@ -0,0 +1,94 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/algos/scrypt/scrypt-multi.h>
+#include <crypto/algos/cpufeatures.h>
+
+#include <assert.h>
+#include <memory>
+
+#if defined(__SSE2__)
+namespace scrypt_sse2
+{
+void Hash_4way(const char* const* input, char* output, uint32_t* V)
+{
+    scrypt_1024_1_1_256_lanes<LanesSSE2>(input, output, V);
+}
+}
+#endif
+
+#if defined(ENABLE_AVX2)
+namespace scrypt_avx2
+{
+void Hash_8way(const char* const* input, char* output, uint32_t* V);
+}
+#endif
+
+namespace {
+
+bool fUseAVX2 = false;
+
+/** Scratchpad for nLanes lanes, aligned for any lane width */
+class MultiScratchpad
+{
+    std::unique_ptr<uint32_t[]> buf;
+
+public:
+    explicit MultiScratchpad(unsigned int nLanes) : buf(new uint32_t[SCRYPT_LANE_SCRATCHPAD_WORDS * nLanes + 8]) {}
+    uint32_t* get() const { return (uint32_t*)(((uintptr_t)buf.get() + 31) & ~(uintptr_t)31); }
+};
+
+#if defined(ENABLE_AVX2)
+bool SelfTestAVX2()
+{
+    char input[8][80];
+    const char* pinput[8];
+    char expected[8 * 32], actual[8 * 32];
+    for (unsigned int l = 0; l < 8; l++) {
+        for (unsigned int i = 0; i < 80; i++)
+            input[l][i] = (char)(l * 80 + i);
+        pinput[l] = input[l];
+        scrypt_1024_1_1_256(input[l], &expected[32 * l]);
+    }
+    scrypt_avx2::Hash_8way(pinput, actual, MultiScratchpad(8).get());
+    return memcmp(expected, actual, sizeof(actual)) == 0;
+}
+#endif
+
+} // namespace
+
+std::string scrypt_multi_autodetect()
+{
+    fUseAVX2 = false;
+#if defined(ENABLE_AVX2) && defined(ALGOS_HAVE_CPUID)
+    if (algos_cpu_has_avx2()) {
+        assert(SelfTestAVX2());
+        fUseAVX2 = true;
+        return "avx2(8way),sse2(4way)";
+    }
+#endif
+#if defined(__SSE2__)
+    return "sse2(4way)";
+#else
+    return "standard";
+#endif
+}
+
+void scrypt_1024_1_1_256_multi(const char* const* input, char* output, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(__SSE2__)
+    if (count >= 4) {
+        MultiScratchpad scratchpad(fUseAVX2 && count >= 8 ? 8 : 4);
+#if defined(ENABLE_AVX2)
+        for (; fUseAVX2 && count - i >= 8; i += 8)
+            scrypt_avx2::Hash_8way(&input[i], &output[32 * i], scratchpad.get());
+#endif
+        for (; count - i >= 4; i += 4)
+            scrypt_sse2::Hash_4way(&input[i], &output[32 * i], scratchpad.get());
+    }
+#endif
+    for (; i < count; i++)
+        scrypt_1024_1_1_256(input[i], &output[32 * i]);
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBALTOKEN_CRYPTO_ALGOS_SCRYPT_MULTI_H
+#define GLOBALTOKEN_CRYPTO_ALGOS_SCRYPT_MULTI_H
+
+#include <crypto/algos/lanes.h>
+#include <crypto/algos/scrypt/scrypt.h>
+
+#include <string.h>
+
+/** Words of scratchpad scrypt_1024_1_1_256_lanes() needs per lane */
+static const size_t SCRYPT_LANE_SCRATCHPAD_WORDS = 1024 * 32;
+
+/** xor_salsa8() of every lane: B = Salsa20/8(B ^ Bx) */
+template <typename L>
+static inline void xor_salsa8_lanes(uint32_t* B, const uint32_t* Bx)
+{
+    typedef typename L::Word Word;
+    const unsigned int n = L::COUNT;
+    Word x[16];
+
+    for (unsigned int k = 0; k < 16; k++) {
+        x[k] = L::Xor(L::Load(&B[k * n]), L::Load(&Bx[k * n]));
+        L::Store(&B[k * n], x[k]);
+    }
+
+#define SALSA_STEP(a, b, c, s) x[a] = L::Xor(x[a], L::template Rotl<s>(L::Add(x[b], x[c])))
+    for (unsigned int i = 0; i < 8; i += 2) {
+        /* Operate on columns. */
+        SALSA_STEP( 4,  0, 12,  7); SALSA_STEP( 9,  5,  1,  7);
+        SALSA_STEP(14, 10,  6,  7); SALSA_STEP( 3, 15, 11,  7);
+
+        SALSA_STEP( 8,  4,  0,  9); SALSA_STEP(13,  9,  5,  9);
+        SALSA_STEP( 2, 14, 10,  9); SALSA_STEP( 7,  3, 15,  9);
+
+        SALSA_STEP(12,  8,  4, 13); SALSA_STEP( 1, 13,  9, 13);
+        SALSA_STEP( 6,  2, 14, 13); SALSA_STEP(11,  7,  3, 13);
+
+        SALSA_STEP( 0, 12,  8, 18); SALSA_STEP( 5,  1, 13, 18);
+        SALSA_STEP(10,  6,  2, 18); SALSA_STEP(15, 11,  7, 18);
+
+        /* Operate on rows. */
+        SALSA_STEP( 1,  0,  3,  7); SALSA_STEP( 6,  5,  4,  7);
+        SALSA_STEP(11, 10,  9,  7); SALSA_STEP(12, 15, 14,  7);
+
+        SALSA_STEP( 2,  1,  0,  9); SALSA_STEP( 7,  6,  5,  9);
+        SALSA_STEP( 8, 11, 10,  9); SALSA_STEP(13, 12, 15,  9);
+
+        SALSA_STEP( 3,  2,  1, 13); SALSA_STEP( 4,  7,  6, 13);
+        SALSA_STEP( 9,  8, 11, 13); SALSA_STEP(14, 13, 12, 13);
+
+        SALSA_STEP( 0,  3,  2, 18); SALSA_STEP( 5,  4,  7, 18);
+        SALSA_STEP(10,  9,  8, 18); SALSA_STEP(15, 14, 13, 18);
+    }
+#undef SALSA_STEP
+
+    for (unsigned int k = 0; k < 16; k++)
+        L::Store(&B[k * n], L::Add(L::Load(&B[k * n]), x[k]));
+}
+
+/**
+ * scrypt_1024_1_1_256_sp_generic() of L::COUNT 80 byte inputs at once.
+ * output receives L::COUNT consecutive 32 byte hashes. V must hold
+ * SCRYPT_LANE_SCRATCHPAD_WORDS * L::COUNT words aligned to L::ALIGN.
+ *
+ * The Salsa20/8 rounds run on all lanes together; only the data dependent
+ * reads of the scratchpad are done lane by lane.
+ */
+template <typename L>
+void scrypt_1024_1_1_256_lanes(const char* const* input, char* output, uint32_t* V)
+{
+    const unsigned int n = L::COUNT;
+    alignas(L::ALIGN) uint32_t X[32 * n];
+    uint8_t B[128];
+    unsigned int i, k, l;
+
+    for (l = 0; l < n; l++) {
+        PBKDF2_SHA256((const uint8_t *)input[l], 80, (const uint8_t *)input[l], 80, 1, B, 128);
+        for (k = 0; k < 32; k++)
+            X[k * n + l] = le32dec(&B[4 * k]);
+    }
+
+    for (i = 0; i < 1024; i++) {
+        memcpy(&V[i * 32 * n], X, sizeof(X));
+        xor_salsa8_lanes<L>(&X[0], &X[16 * n]);
+        xor_salsa8_lanes<L>(&X[16 * n], &X[0]);
+    }
+    for (i = 0; i < 1024; i++) {
+        for (l = 0; l < n; l++) {
+            const uint32_t* Vj = &V[32 * n * (X[16 * n + l] & 1023) + l];
+            for (k = 0; k < 32; k++)
+                X[k * n + l] ^= Vj[k * n];
+        }
+        xor_salsa8_lanes<L>(&X[0], &X[16 * n]);
+        xor_salsa8_lanes<L>(&X[16 * n], &X[0]);
+    }
+
+    for (l = 0; l < n; l++) {
+        for (k = 0; k < 32; k++)
+            le32enc(&B[4 * k], X[k * n + l]);
+        PBKDF2_SHA256((const uint8_t *)input[l], 80, B, 128, 1, (uint8_t *)output + 32 * l, 32);
+    }
+}
+
+#endif // GLOBALTOKEN_CRYPTO_ALGOS_SCRYPT_MULTI_H
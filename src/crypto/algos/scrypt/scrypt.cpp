@@ -323,7 +323,12 @@ std::string scrypt_detect_sse2()
 #endif // USE_SSE2_ALWAYS
     return ret;
 }
-#endif
+#else // USE_SSE2
+std::string scrypt_detect_sse2()
+{
+    return "scrypt: using scrypt-generic as built.";
+}
+#endif // USE_SSE2
 
 void scrypt_1024_1_1_256(const char *input, char *output)
 {
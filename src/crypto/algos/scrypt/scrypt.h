@@ -2,14 +2,26 @@
 #define SCRYPT_H
 #include <stdlib.h>
 #include <stdint.h>
+#include <string>
 
 static const int SCRYPT_SCRATCHPAD_SIZE = 131072 + 63;
 
 void scrypt_1024_1_1_256(const char *input, char *output);
 void scrypt_1024_1_1_256_sp_generic(const char *input, char *output, char *scratchpad);
 
+/** Select the scrypt kernel and describe the choice for the log. */
+std::string scrypt_detect_sse2();
+
+/**
+ * Hash count 80 byte inputs into count consecutive 32 byte outputs. Groups of
+ * inputs run through the widest multi-buffer kernel selected by
+ * scrypt_multi_autodetect(), the rest one at a time.
+ */
+void scrypt_1024_1_1_256_multi(const char* const* input, char* output, unsigned int count);
+/** Select the multi-buffer kernels the CPU supports and return their names. */
+std::string scrypt_multi_autodetect();
+
 #if defined(USE_SSE2)
-#include <string>
 #if defined(_M_X64) || defined(__x86_64__) || defined(_M_AMD64) || (defined(MAC_OSX) && defined(__i386__))
 #define USE_SSE2_ALWAYS 1
 #define scrypt_1024_1_1_256_sp(input, output, scratchpad) scrypt_1024_1_1_256_sp_sse2((input), (output), (scratchpad))
@@ -17,7 +29,6 @@ void scrypt_1024_1_1_256_sp_generic(const char *input, char *output, char *scrat
 #define scrypt_1024_1_1_256_sp(input, output, scratchpad) scrypt_1024_1_1_256_sp_detected((input), (output), (scratchpad))
 #endif
 
-std::string scrypt_detect_sse2();
 void scrypt_1024_1_1_256_sp_sse2(const char *input, char *output, char *scratchpad);
 extern void (*scrypt_1024_1_1_256_sp_detected)(const char *input, char *output, char *scratchpad);
 #else
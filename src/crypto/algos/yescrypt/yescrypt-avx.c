@@ -0,0 +1,14 @@
+/*
+ * The yescrypt kernel built with AVX enabled, as yescrypt_kdf_avx.
+ * Selected at runtime by yescrypt_autodetect() in yescrypt-best.c.
+ */
+#define yescrypt_kdf yescrypt_kdf_avx
+#define yescrypt_init_shared yescrypt_init_shared_avx
+#define yescrypt_free_shared yescrypt_free_shared_avx
+#define yescrypt_init_local yescrypt_init_local_avx
+#define yescrypt_free_local yescrypt_free_local_avx
+#if defined (__x86_64__)
+#include "yescrypt-simd.c"
+#else
+#include "yescrypt-opt.c"
+#endif
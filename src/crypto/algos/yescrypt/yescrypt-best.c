@@ -1,5 +1,128 @@
+/*
+ * The kernel for the compiler's baseline instruction set is built here as
+ * yescrypt_kdf_base. yescrypt_kdf() runs the kernel installed by
+ * yescrypt_autodetect(), which may be one of the builds in yescrypt-sse41.c
+ * and yescrypt-avx.c.
+ */
+#define yescrypt_kdf yescrypt_kdf_base
 #if defined (__x86_64__)
 #include "yescrypt-simd.c"
 #else
 #include "yescrypt-opt.c"
 #endif
+#undef yescrypt_kdf
+
+#include <assert.h>
+
+#include "../cpufeatures.h"
+
+#if defined(__x86_64__) && defined(ALGOS_HAVE_CPUID)
+#define YESCRYPT_DISPATCH 1
+#else
+#define YESCRYPT_DISPATCH 0
+#endif
+
+#if defined(__AVX__)
+#define YESCRYPT_BASE_NAME "avx"
+#elif defined(__SSE4_1__)
+#define YESCRYPT_BASE_NAME "sse4.1"
+#elif defined(__x86_64__)
+#define YESCRYPT_BASE_NAME "sse2"
+#else
+#define YESCRYPT_BASE_NAME "standard"
+#endif
+
+typedef int yescrypt_kdf_fn(const yescrypt_shared_t * shared,
+    yescrypt_local_t * local,
+    const uint8_t * passwd, size_t passwdlen,
+    const uint8_t * salt, size_t saltlen,
+    uint64_t N, uint32_t r, uint32_t p, uint32_t t, yescrypt_flags_t flags,
+    uint8_t * buf, size_t buflen);
+
+#if YESCRYPT_DISPATCH && defined(ENABLE_SSE41)
+extern yescrypt_kdf_fn yescrypt_kdf_sse41;
+#endif
+#if YESCRYPT_DISPATCH && defined(ENABLE_AVX)
+extern yescrypt_kdf_fn yescrypt_kdf_avx;
+#endif
+
+extern yescrypt_kdf_fn yescrypt_kdf_ref;
+
+static yescrypt_kdf_fn *yescrypt_kdf_selected = yescrypt_kdf_base;
+
+int
+yescrypt_kdf(const yescrypt_shared_t * shared, yescrypt_local_t * local,
+    const uint8_t * passwd, size_t passwdlen,
+    const uint8_t * salt, size_t saltlen,
+    uint64_t N, uint32_t r, uint32_t p, uint32_t t, yescrypt_flags_t flags,
+    uint8_t * buf, size_t buflen)
+{
+	return yescrypt_kdf_selected(shared, local, passwd, passwdlen,
+	    salt, saltlen, N, r, p, t, flags, buf, buflen);
+}
+
+#if YESCRYPT_DISPATCH && (defined(ENABLE_SSE41) || defined(ENABLE_AVX))
+/* Compare a kernel with the baseline one on a small instance. */
+static int
+yescrypt_self_test(yescrypt_kdf_fn * kdf)
+{
+	static const uint8_t passwd[] = "yescrypt self test";
+	static const uint8_t salt[] = "globaltoken";
+	uint8_t expected[32], actual[32];
+	yescrypt_shared_t shared;
+	yescrypt_local_t local;
+	int ok;
+
+	if (yescrypt_init_shared(&shared, NULL, 0,
+	    0, 0, 0, YESCRYPT_SHARED_DEFAULTS, 0, NULL, 0))
+		return 0;
+	if (yescrypt_init_local(&local)) {
+		yescrypt_free_shared(&shared);
+		return 0;
+	}
+	ok = !yescrypt_kdf_base(&shared, &local, passwd, sizeof(passwd) - 1,
+	    salt, sizeof(salt) - 1, 64, 8, 1, 0,
+	    YESCRYPT_RW | YESCRYPT_PWXFORM, expected, sizeof(expected)) &&
+	    !kdf(&shared, &local, passwd, sizeof(passwd) - 1,
+	    salt, sizeof(salt) - 1, 64, 8, 1, 0,
+	    YESCRYPT_RW | YESCRYPT_PWXFORM, actual, sizeof(actual)) &&
+	    !memcmp(expected, actual, sizeof(expected));
+	yescrypt_free_local(&local);
+	yescrypt_free_shared(&shared);
+	return ok;
+}
+#endif
+
+const char *
+yescrypt_autodetect(void)
+{
+#if YESCRYPT_DISPATCH && defined(ENABLE_AVX)
+	if (algos_cpu_has_avx()) {
+		yescrypt_kdf_selected = yescrypt_kdf_avx;
+		assert(yescrypt_self_test(yescrypt_kdf_selected));
+		return "avx";
+	}
+#endif
+#if YESCRYPT_DISPATCH && defined(ENABLE_SSE41)
+	if (algos_cpu_has_sse41()) {
+		yescrypt_kdf_selected = yescrypt_kdf_sse41;
+		assert(yescrypt_self_test(yescrypt_kdf_selected));
+		return "sse4.1";
+	}
+#endif
+	return yescrypt_use_base();
+}
+
+const char *
+yescrypt_use_base(void)
+{
+	yescrypt_kdf_selected = yescrypt_kdf_base;
+	return YESCRYPT_BASE_NAME;
+}
+
+const char *
+yescrypt_use_ref(void)
+{
+	yescrypt_kdf_selected = yescrypt_kdf_ref;
+	return "ref";
+}
@@ -0,0 +1,18 @@
+/*
+ * The portable yescrypt kernel, as yescrypt_kdf_ref. Selected by
+ * yescrypt_use_ref() in yescrypt-best.c to cross-check the SIMD kernels.
+ */
+
+/* Built on purpose, so the upstream warning about using it is not needed */
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-W#warnings"
+#elif defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wcpp"
+#endif
+
+#define yescrypt_kdf yescrypt_kdf_ref
+#define yescrypt_init_shared yescrypt_init_shared_ref
+#define yescrypt_free_shared yescrypt_free_shared_ref
+#define yescrypt_init_local yescrypt_init_local_ref
+#define yescrypt_free_local yescrypt_free_local_ref
+#include "yescrypt-opt.c"
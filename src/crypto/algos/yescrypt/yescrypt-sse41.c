@@ -0,0 +1,14 @@
+/*
+ * The yescrypt kernel built with SSE4.1 enabled, as yescrypt_kdf_sse41.
+ * Selected at runtime by yescrypt_autodetect() in yescrypt-best.c.
+ */
+#define yescrypt_kdf yescrypt_kdf_sse41
+#define yescrypt_init_shared yescrypt_init_shared_sse41
+#define yescrypt_free_shared yescrypt_free_shared_sse41
+#define yescrypt_init_local yescrypt_init_local_sse41
+#define yescrypt_free_local yescrypt_free_local_sse41
+#if defined (__x86_64__)
+#include "yescrypt-simd.c"
+#else
+#include "yescrypt-opt.c"
+#endif
@@ -372,6 +372,39 @@ extern uint8_t * yescrypt_gensalt(
     yescrypt_flags_t __flags,
     const uint8_t * __src, size_t __srclen);
 
+/**
+ * yescrypt_autodetect():
+ * Make yescrypt_kdf() use the kernel built for the newest instruction set
+ * the CPU supports, after checking it against the baseline kernel.
+ *
+ * Return the name of the selected kernel.
+ *
+ * MT-unsafe: call once at startup, before any hashing.
+ */
+extern const char * yescrypt_autodetect(void);
+
+/**
+ * yescrypt_use_base():
+ * Make yescrypt_kdf() use the kernel built for the compiler's baseline
+ * instruction set.
+ *
+ * Return the name of the baseline kernel.
+ *
+ * MT-unsafe.
+ */
+extern const char * yescrypt_use_base(void);
+
+/**
+ * yescrypt_use_ref():
+ * Make yescrypt_kdf() use the portable kernel from yescrypt-opt.c, the
+ * reference the SIMD kernels are tested against.
+ *
+ * Return "ref".
+ *
+ * MT-unsafe.
+ */
+extern const char * yescrypt_use_ref(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,9 @@
+/*
+ * The yespower kernel built with AVX enabled, as yespower_tls_avx.
+ * Selected at runtime by yespower_autodetect() in yespower.c.
+ */
+#define yespower yespower_avx
+#define yespower_tls yespower_tls_avx
+#define yespower_init_local yespower_init_local_avx
+#define yespower_free_local yespower_free_local_avx
+#include "yespower-opt.c"
@@ -0,0 +1,17 @@
+/*
+ * The reference yespower kernel, as yespower_tls_ref. Selected by
+ * yespower_use_ref() in yespower.c to cross-check the optimized kernels.
+ */
+
+/* Built on purpose, so the upstream warning about using it is not needed */
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-W#warnings"
+#elif defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wcpp"
+#endif
+
+#define yespower yespower_ref
+#define yespower_tls yespower_tls_ref
+#define yespower_init_local yespower_init_local_ref
+#define yespower_free_local yespower_free_local_ref
+#include "yespower-ref.c"
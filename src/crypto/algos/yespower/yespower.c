@@ -1,7 +1,68 @@
+#include <assert.h>
+#include <string.h>
+
 #include "yespower.h"
+#include "../cpufeatures.h"
+
+#if defined(__XOP__)
+#define YESPOWER_BASE_NAME "xop"
+#elif defined(__AVX__)
+#define YESPOWER_BASE_NAME "avx"
+#elif defined(__SSE2__)
+#define YESPOWER_BASE_NAME "sse2"
+#else
+#define YESPOWER_BASE_NAME "standard"
+#endif
+
+typedef int yespower_tls_fn(const uint8_t *src, size_t srclen,
+    const yespower_params_t *params, yespower_binary_t *dst);
+
+#if defined(ALGOS_HAVE_CPUID) && defined(ENABLE_AVX)
+extern yespower_tls_fn yespower_tls_avx;
+
+/* Compare a kernel with the baseline one on a small instance. */
+static int yespower_self_test(yespower_tls_fn *kernel)
+{
+	static const uint8_t src[80] = "yespower self test";
+	yespower_params_t params = {YESPOWER_1_0, 1024, 8, NULL, 0};
+	yespower_binary_t expected, actual;
+
+	return !yespower_tls(src, sizeof(src), &params, &expected) &&
+	    !kernel(src, sizeof(src), &params, &actual) &&
+	    !memcmp(&expected, &actual, sizeof(expected));
+}
+#endif
+
+extern yespower_tls_fn yespower_tls_ref;
+
+static yespower_tls_fn *yespower_tls_selected = yespower_tls;
+
+const char *yespower_autodetect(void)
+{
+#if defined(ALGOS_HAVE_CPUID) && defined(ENABLE_AVX)
+	if (algos_cpu_has_avx()) {
+		yespower_tls_selected = yespower_tls_avx;
+		assert(yespower_self_test(yespower_tls_selected));
+		return "avx";
+	}
+#endif
+	return yespower_use_base();
+}
+
+const char *yespower_use_base(void)
+{
+	yespower_tls_selected = yespower_tls;
+	return YESPOWER_BASE_NAME;
+}
+
+const char *yespower_use_ref(void)
+{
+	yespower_tls_selected = yespower_tls_ref;
+	return "ref";
+}
 
 int yespower_hash(const char *input, char *output)
 {
 	yespower_params_t params = {YESPOWER_1_0, 2048, 32, NULL, 0};
-	return yespower_tls(input, 80, &params, (yespower_binary_t *) output);
+	return yespower_tls_selected((const uint8_t *) input, 80, &params, (yespower_binary_t *) output);
 }
@@ -128,6 +128,25 @@ extern int yespower_tls(const uint8_t *src, size_t srclen,
  */
 int yespower_hash(const char *input, char *output);
 
+/**
+ * Make yespower_hash() use the kernel built for the newest instruction set
+ * the CPU supports, after checking it against the baseline kernel. Returns
+ * the name of the selected kernel. Call once at startup, before any hashing.
+ */
+const char *yespower_autodetect(void);
+
+/**
+ * Make yespower_hash() use the kernel built for the compiler's baseline
+ * instruction set. Returns the name of the baseline kernel.
+ */
+const char *yespower_use_base(void);
+
+/**
+ * Make yespower_hash() use the kernel from yespower-ref.c, the reference
+ * the optimized kernels are tested against. Returns "ref".
+ */
+const char *yespower_use_ref(void);
+
 #ifdef __cplusplus
 }
 #endif
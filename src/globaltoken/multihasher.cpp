@@ -28,10 +28,13 @@
 #include <crypto/algos/yespower/yespower.h>
 #include <crypto/algos/honeycomb/hash_honeycomb.h>
 #include <crypto/algos/allium/allium.h>
+#include <crypto/common.h>
 #include <uint256.h>
 #include <hash.h>
 #include <version.h>
 
+#include <algorithm>
+
 
 uint256 CMultihasher::GetSHA256Hash() const
 {
@@ -41,8 +44,69 @@ uint256 CMultihasher::GetSHA256Hash() const
     return ss.GetHash();
 }
 
+const CHashChain* GetAlgoHashChain(uint8_t nAlgo)
+{
+    switch (nAlgo)
+    {
+        case ALGO_X11:
+            return &HASHCHAIN_X11;
+        case ALGO_X12:
+            return &HASHCHAIN_X12;
+        case ALGO_X13:
+            return &HASHCHAIN_X13;
+        case ALGO_X14:
+            return &HASHCHAIN_X14;
+        case ALGO_X15:
+            return &HASHCHAIN_X15;
+        case ALGO_X17:
+            return &HASHCHAIN_X17;
+        case ALGO_C11:
+            return &HASHCHAIN_C11;
+        case ALGO_NIST5:
+            return &HASHCHAIN_NIST5;
+        case ALGO_QUBIT:
+            return &HASHCHAIN_QUBIT;
+        case ALGO_GROESTL:
+            return &HASHCHAIN_GROESTL;
+        case ALGO_SKEIN:
+            return &HASHCHAIN_SKEIN;
+        case ALGO_PHI1612:
+            return &HASHCHAIN_PHI1612;
+        case ALGO_SKUNKHASH:
+            return &HASHCHAIN_SKUNKHASH;
+        case ALGO_TRIBUS:
+            return &HASHCHAIN_TRIBUS;
+    }
+    return nullptr;
+}
+
+const CHashChain* GetPrevBlockHashChain(uint8_t nAlgo, const unsigned char* header)
+{
+    uint256 hashPrevBlock;
+    switch (nAlgo)
+    {
+        case ALGO_X16R:
+            memcpy(hashPrevBlock.begin(), header + 4, 32);
+            return &GetCachedX16RHashChain(hashPrevBlock);
+        case ALGO_X16S:
+            memcpy(hashPrevBlock.begin(), header + 4, 32);
+            return &GetCachedX16SHashChain(hashPrevBlock);
+        case ALGO_X21S:
+            memcpy(hashPrevBlock.begin(), header + 4, 32);
+            return &GetCachedX21SHashChain(hashPrevBlock);
+        case ALGO_CPU23R:
+            memcpy(hashPrevBlock.begin(), header + 4, 32);
+            return &GetCachedCPU23RHashChain(hashPrevBlock);
+    }
+    return nullptr;
+}
+
 uint256 CMultihasher::GetHash() const 
 {
+    if (const CHashChain* chain = GetAlgoHashChain(nAlgo)) {
+        return chain->Hash(buf.data(), buf.size());
+    }
+
     switch (nAlgo)
     {
         case ALGO_SHA256D:
@@ -56,10 +120,6 @@ uint256 CMultihasher::GetHash() const
             scrypt_1024_1_1_256((const char*)buf.data(), (char*)&thash);
             return thash;
         }
-        case ALGO_X11:
-        {
-            return HashX11(buf.data(), buf.data() + buf.size());
-        }
         case ALGO_NEOSCRYPT:
         {
             unsigned int profile = 0x0;
@@ -87,10 +147,6 @@ uint256 CMultihasher::GetHash() const
         {
             return XEVAN(buf.data(), buf.data() + buf.size());	    
         }
-        case ALGO_NIST5:
-        {
-            return NIST5(buf.data(), buf.data() + buf.size());	    
-        }
         case ALGO_TIMETRAVEL10:
         {
             assert(buf.size() == 80);
@@ -102,22 +158,6 @@ uint256 CMultihasher::GetHash() const
         {
             return PawelHash(buf.data(), buf.data() + buf.size());
         }
-        case ALGO_X13:
-        {
-            return HashX13(buf.data(), buf.data() + buf.size());
-        }
-        case ALGO_X14:
-        {
-            return HashX14(buf.data(), buf.data() + buf.size());
-        }
-        case ALGO_X15:
-        {
-            return HashX15(buf.data(), buf.data() + buf.size());
-        }
-        case ALGO_X17:
-        {
-            return HashX17(buf.data(), buf.data() + buf.size());
-        }
         case ALGO_LYRA2REV2:
         {
             assert(buf.size() == 80);
@@ -157,22 +197,6 @@ uint256 CMultihasher::GetHash() const
         {
             return GlobalHash(buf.data(), buf.data() + buf.size());
         }
-        case ALGO_GROESTL:
-        {
-            return HashGroestl(buf.data(), buf.data() + buf.size());
-        }
-        case ALGO_SKEIN:
-        {
-            return HashSkein(buf.data(), buf.data() + buf.size());
-        }
-        case ALGO_QUBIT:
-        {
-            return HashQubit(buf.data(), buf.data() + buf.size());
-        }
-        case ALGO_SKUNKHASH:
-        {
-            return SkunkHash5(buf.data(), buf.data() + buf.size());
-        }
         case ALGO_QUARK:
         {
             return QUARK(buf.data(), buf.data() + buf.size());
@@ -180,9 +204,7 @@ uint256 CMultihasher::GetHash() const
         case ALGO_X16R:
         {
             assert(buf.size() == 80);
-            uint256 hashPrevBlock;
-            memcpy(&hashPrevBlock, buf.data() + 4, 32);
-            return HashX16R(buf.data(), buf.data() + buf.size(), hashPrevBlock);
+            return GetPrevBlockHashChain(nAlgo, buf.data())->Hash(buf.data(), buf.size());
         }
         case ALGO_LYRA2REV3:
         {
@@ -230,7 +252,7 @@ uint256 CMultihasher::GetHash() const
         {
             uint256 salt, pepper, finalhash;
             salt = GlobalHash(buf.data(), buf.data() + buf.size());
-            pepper = HashX16R(buf.data(), buf.data() + buf.size(), salt);
+            pepper = GetX16RHashChain(salt).Hash(buf.data(), buf.size());
             Argon2dHash(buf.data(), buf.size(), finalhash.begin(), 32, salt.begin(), 32, pepper.begin(), 32);
             return finalhash;
         }
@@ -238,16 +260,14 @@ uint256 CMultihasher::GetHash() const
         {
             uint256 salt, pepper, finalhash;
             salt = GlobalHash(buf.data(), buf.data() + buf.size());
-            pepper = HashCPU23R(buf.data(), buf.data() + buf.size(), salt);
+            pepper = GetCPU23RHashChain(salt).Hash(buf.data(), buf.size());
             Argon2iHash(buf.data(), buf.size(), finalhash.begin(), 32, salt.begin(), 32, pepper.begin(), 32);
             return finalhash;
         }
         case ALGO_CPU23R:
         {
             assert(buf.size() == 80);
-            uint256 hashPrevBlock;
-            memcpy(&hashPrevBlock, buf.data() + 4, 32);
-            return HashCPU23R(buf.data(), buf.data() + buf.size(), hashPrevBlock);
+            return GetPrevBlockHashChain(nAlgo, buf.data())->Hash(buf.data(), buf.size());
         }
         case ALGO_YESPOWER:
         {
@@ -259,16 +279,12 @@ uint256 CMultihasher::GetHash() const
         case ALGO_X21S:
         {
             assert(buf.size() == 80);
-            uint256 hashPrevBlock;
-            memcpy(&hashPrevBlock, buf.data() + 4, 32);
-            return HashX21S(buf.data(), buf.data() + buf.size(), hashPrevBlock);
+            return GetPrevBlockHashChain(nAlgo, buf.data())->Hash(buf.data(), buf.size());
         }
         case ALGO_X16S:
         {
             assert(buf.size() == 80);
-            uint256 hashPrevBlock;
-            memcpy(&hashPrevBlock, buf.data() + 4, 32);
-            return HashX16s(buf.data(), buf.data() + buf.size(), hashPrevBlock);
+            return GetPrevBlockHashChain(nAlgo, buf.data())->Hash(buf.data(), buf.size());
         }
         case ALGO_X22I:
         {
@@ -293,10 +309,6 @@ uint256 CMultihasher::GetHash() const
         {
             return this->GetSHA256Hash();
         }
-        case ALGO_X12:
-        {
-            return HashX12(buf.data(), buf.data() + buf.size());
-        }
         case ALGO_HEX:
         {
             return HashHEX(buf.data(), buf.data() + buf.size());
@@ -305,14 +317,6 @@ uint256 CMultihasher::GetHash() const
         {
             return HashDedal(buf.data(), buf.data() + buf.size());
         }
-        case ALGO_C11:
-        {
-            return HashC11(buf.data(), buf.data() + buf.size());
-        }
-        case ALGO_PHI1612:
-        {
-            return Phi1612(buf.data(), buf.data() + buf.size());
-        }
         case ALGO_PHI2:
         {
             return PHI2(buf.data(), buf.data() + buf.size());
@@ -324,11 +328,7 @@ uint256 CMultihasher::GetHash() const
             memcpy(&nTime, buf.data() + 68, 4);
             int32_t nTimeX16r = nTime & 0xffffff80;
             uint256 hashTime = Hash(static_cast<char*>(static_cast<void*>(&nTimeX16r)), static_cast<char*>(static_cast<void*>(&nTimeX16r))+4);
-            return HashX16R(buf.data(), buf.data() + buf.size(), hashTime);
-        }
-        case ALGO_TRIBUS:
-        {
-            return Tribus(buf.data(), buf.data() + buf.size());
+            return GetCachedX16RHashChain(hashTime).Hash(buf.data(), buf.size());
         }
         case ALGO_ALLIUM:
         {
@@ -357,6 +357,200 @@ uint256 CMultihasher::GetHash() const
     return this->GetSHA256Hash();
 }
 
+void CMultihasher::GetHashBatch(const CMultihasher* hashers, size_t nCount, uint256* hashes)
+{
+    if (nCount == 0)
+        return;
+
+    const uint8_t nAlgo = hashers[0].nAlgo;
+    const size_t nSize = hashers[0].buf.size();
+    bool fSameInput = true;
+    for (size_t i = 1; i < nCount && fSameInput; i++) {
+        if (hashers[i].nAlgo != nAlgo || hashers[i].buf.size() != nSize)
+            fSameInput = false;
+    }
+
+    if (fSameInput && nSize == 80 && (nAlgo == ALGO_SCRYPT || nAlgo == ALGO_NEOSCRYPT)) {
+        static_assert(sizeof(uint256) == 32, "the kernels write consecutive 32 byte hashes");
+        std::vector<const unsigned char*> data(nCount);
+        for (size_t i = 0; i < nCount; i++)
+            data[i] = hashers[i].buf.data();
+        if (nAlgo == ALGO_SCRYPT)
+            scrypt_1024_1_1_256_multi((const char* const*)data.data(), (char*)hashes, nCount);
+        else
+            neoscrypt_multi(data.data(), (unsigned char*)hashes, 0x0, nCount);
+        return;
+    }
+
+    const CHashChain* chain = fSameInput ? GetAlgoHashChain(nAlgo) : nullptr;
+    if (fSameInput && nSize == 80 && !chain) {
+        // Chains ordered by the previous block hash batch when all share it
+        bool fSamePrevBlock = true;
+        for (size_t i = 1; i < nCount && fSamePrevBlock; i++) {
+            if (memcmp(hashers[i].buf.data() + 4, hashers[0].buf.data() + 4, 32) != 0)
+                fSamePrevBlock = false;
+        }
+        if (fSamePrevBlock)
+            chain = GetPrevBlockHashChain(nAlgo, hashers[0].buf.data());
+    }
+    if (!chain) {
+        for (size_t i = 0; i < nCount; i++)
+            hashes[i] = hashers[i].GetHash();
+        return;
+    }
+
+    const unsigned char* data[MULTIHASH_BATCH_LANES];
+    for (size_t nStart = 0; nStart < nCount; nStart += MULTIHASH_BATCH_LANES) {
+        const size_t nLanes = std::min(MULTIHASH_BATCH_LANES, nCount - nStart);
+        for (size_t i = 0; i < nLanes; i++)
+            data[i] = hashers[nStart + i].buf.data();
+        chain->HashBatch(data, nSize, hashes + nStart, nLanes);
+    }
+}
+
+bool CMultihasher::HasBatchKernel(uint8_t nAlgo)
+{
+    return nAlgo == ALGO_SCRYPT || nAlgo == ALGO_NEOSCRYPT || GetAlgoHashChain(nAlgo) != nullptr ||
+           nAlgo == ALGO_X16R || nAlgo == ALGO_X16S || nAlgo == ALGO_X21S || nAlgo == ALGO_CPU23R;
+}
+
+CMultihashMidstate CMultihasher::GetMidstate() const
+{
+    assert(buf.size() == CMultihashMidstate::HEADER_SIZE);
+    return CMultihashMidstate(nAlgo, buf.data());
+}
+
+bool CMultihashMidstate::IsSupported(uint8_t nAlgo)
+{
+    switch (nAlgo)
+    {
+        case ALGO_SHA256D:
+        case ALGO_X11:
+        case ALGO_X13:
+        case ALGO_X14:
+        case ALGO_X15:
+        case ALGO_X17:
+        case ALGO_NIST5:
+        case ALGO_GROESTL:
+        case ALGO_SKEIN:
+        case ALGO_QUBIT:
+            return true;
+    }
+    return false;
+}
+
+CMultihashMidstate::CMultihashMidstate(uint8_t nAlgoIn, const unsigned char* pheader) : nAlgo(nAlgoIn)
+{
+    assert(IsSupported(nAlgo));
+    memcpy(vchPrefix, pheader, sizeof(vchPrefix));
+    memcpy(vchSuffix, pheader + PREFIX_SIZE, sizeof(vchSuffix));
+    switch (nAlgo)
+    {
+        case ALGO_SHA256D:
+            ctx_sha256.Write(pheader, PREFIX_SIZE);
+            break;
+        case ALGO_GROESTL:
+            sph_groestl512_init(&ctx_groestl);
+            sph_groestl512(&ctx_groestl, pheader, PREFIX_SIZE);
+            break;
+        case ALGO_SKEIN:
+            sph_skein512_init(&ctx_skein);
+            sph_skein512(&ctx_skein, pheader, PREFIX_SIZE);
+            break;
+        case ALGO_QUBIT:
+            sph_luffa512_init(&ctx_luffa);
+            sph_luffa512(&ctx_luffa, pheader, PREFIX_SIZE);
+            break;
+        default:
+            sph_blake512_init(&ctx_blake);
+            sph_blake512(&ctx_blake, pheader, PREFIX_SIZE);
+            break;
+    }
+}
+
+uint256 CMultihashMidstate::GetHash(const unsigned char* suffix) const
+{
+    const size_t nSuffixSize = HEADER_SIZE - PREFIX_SIZE;
+    uint512 first;
+    switch (nAlgo)
+    {
+        case ALGO_SHA256D:
+        {
+            unsigned char hash1[CSHA256::OUTPUT_SIZE];
+            uint256 hash2;
+            CSHA256(ctx_sha256).Write(suffix, nSuffixSize).Finalize(hash1);
+            CSHA256().Write(hash1, sizeof(hash1)).Finalize(hash2.begin());
+            return hash2;
+        }
+        case ALGO_GROESTL:
+        {
+            sph_groestl512_context ctx = ctx_groestl;
+            sph_groestl512(&ctx, suffix, nSuffixSize);
+            sph_groestl512_close(&ctx, first.begin());
+            break;
+        }
+        case ALGO_SKEIN:
+        {
+            sph_skein512_context ctx = ctx_skein;
+            sph_skein512(&ctx, suffix, nSuffixSize);
+            sph_skein512_close(&ctx, first.begin());
+            break;
+        }
+        case ALGO_QUBIT:
+        {
+            sph_luffa512_context ctx = ctx_luffa;
+            sph_luffa512(&ctx, suffix, nSuffixSize);
+            sph_luffa512_close(&ctx, first.begin());
+            break;
+        }
+        default:
+        {
+            sph_blake512_context ctx = ctx_blake;
+            sph_blake512(&ctx, suffix, nSuffixSize);
+            sph_blake512_close(&ctx, first.begin());
+            break;
+        }
+    }
+    return GetAlgoHashChain(nAlgo)->Hash(first.begin(), first.size(), 1);
+}
+
+uint256 CMultihashMidstate::GetHash(uint32_t nNonce) const
+{
+    unsigned char suffix[sizeof(vchSuffix)];
+    memcpy(suffix, vchSuffix, sizeof(suffix));
+    WriteLE32(suffix + 12, nNonce);
+    return GetHash(suffix);
+}
+
+uint256 CMultihashMidstate::GetHash(uint32_t nTime, uint32_t nNonce) const
+{
+    unsigned char suffix[sizeof(vchSuffix)];
+    memcpy(suffix, vchSuffix, sizeof(suffix));
+    WriteLE32(suffix + 4, nTime);
+    WriteLE32(suffix + 12, nNonce);
+    return GetHash(suffix);
+}
+
+std::vector<unsigned char> CMultihashMidstate::GetState() const
+{
+    std::vector<unsigned char> state;
+    if (nAlgo == ALGO_SHA256D) {
+        // CSHA256 keeps its state private, so run the one prefix block again
+        // with sph. Only templates ask for this, not the nonce loop.
+        sph_sha256_context ctx;
+        sph_sha256_init(&ctx);
+        sph_sha256(&ctx, vchPrefix, PREFIX_SIZE);
+        state.resize(sizeof(ctx.val));
+        for (size_t i = 0; i < state.size() / 4; i++)
+            WriteLE32(state.data() + 4 * i, ctx.val[i]);
+    } else if (nAlgo == ALGO_QUBIT) {
+        state.resize(sizeof(ctx_luffa.V));
+        for (size_t i = 0; i < state.size() / 4; i++)
+            WriteLE32(state.data() + 4 * i, ctx_luffa.V[i / 8][i % 8]);
+    }
+    return state;
+}
+
 int LoadMultiHasherVersionFlags(bool fHardfork3Activated)
 {
     return fHardfork3Activated ? PROTOCOL_VERSION | MULTIHASHER_YESCRYPT_R8_NEW : PROTOCOL_VERSION;
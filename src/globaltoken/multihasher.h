@@ -7,6 +7,12 @@
 #ifndef GLOBALTOKEN_MULTIHASHER_H
 #define GLOBALTOKEN_MULTIHASHER_H
 
+#include <crypto/algos/hashlib/sph_blake.h>
+#include <crypto/algos/hashlib/sph_groestl.h>
+#include <crypto/algos/hashlib/sph_luffa.h>
+#include <crypto/algos/hashlib/sph_skein.h>
+#include <crypto/sha256.h>
+#include <crypto/algos/hashlib/hashchain.h>
 #include <globaltoken/powalgorithm.h>
 #include <serialize.h>
 #include <version.h>
@@ -16,6 +22,68 @@
 
 static const int MULTIHASHER_YESCRYPT_R8_NEW = 0x40000000;
 
+/** Inputs a hash chain stage runs over before the next stage starts */
+static const size_t MULTIHASH_BATCH_LANES = 8;
+
+/** The fixed stage sequence nAlgo hashes with, or nullptr if it is not a plain hash chain. */
+const CHashChain* GetAlgoHashChain(uint8_t nAlgo);
+/**
+ * The stage sequence an 80 byte header of nAlgo hashes with when the order
+ * comes from its previous block hash, or nullptr. The chain is the calling
+ * thread's cached one for that hash (see GetCachedX16RHashChain).
+ */
+const CHashChain* GetPrevBlockHashChain(uint8_t nAlgo, const unsigned char* header);
+
+/**
+ * Proof of work hash of an 80 byte block header with the first 64 bytes
+ * (version, previous block hash and most of the merkle root) absorbed ahead
+ * of time. These stay the same while a miner rolls nTime and nNonce, so each
+ * attempt only feeds the last 16 bytes to a copy of the first hash stage and
+ * runs the remaining stages on its output.
+ *
+ * The first stage only saves compression work where its block size divides
+ * the prefix and full blocks are compressed eagerly (SHA-256d, Luffa-512);
+ * Blake-512 and Groestl-512 still buffer the prefix and Skein-512 keeps its
+ * last block back, so for those it just saves re-serializing the header.
+ */
+class CMultihashMidstate
+{
+private:
+    uint8_t nAlgo;
+    unsigned char vchPrefix[64];
+    unsigned char vchSuffix[16];
+    CSHA256 ctx_sha256;
+    sph_blake512_context ctx_blake;
+    sph_groestl512_context ctx_groestl;
+    sph_luffa512_context ctx_luffa;
+    sph_skein512_context ctx_skein;
+
+    uint256 GetHash(const unsigned char* suffix) const;
+public:
+    static const size_t HEADER_SIZE = 80;
+    static const size_t PREFIX_SIZE = 64;
+
+    /** Whether nAlgo hashes an 80 byte header in stages that allow a midstate. */
+    static bool IsSupported(uint8_t nAlgo);
+
+    /** Absorb the prefix of a serialized header of HEADER_SIZE bytes. nAlgo must be supported. */
+    CMultihashMidstate(uint8_t nAlgoIn, const unsigned char* pheader);
+
+    uint8_t GetAlgo() const { return nAlgo; }
+
+    /** Hash of the header with its nonce replaced, equal to the full CMultihasher hash. */
+    uint256 GetHash(uint32_t nNonce) const;
+    /** Hash of the header with its time and nonce replaced. */
+    uint256 GetHash(uint32_t nTime, uint32_t nNonce) const;
+
+    /**
+     * Chaining value of the first stage after the prefix as little endian
+     * 32-bit words, for external miners resuming it with their own code.
+     * Empty where the first stage has not compressed anything yet.
+     */
+    std::vector<unsigned char> GetState() const;
+};
+
 /** A writer stream (for serialization) that computes a 256-bit hash, with selected algorithm. */
 class CMultihasher
 {
@@ -39,6 +107,28 @@ public:
 
     uint256 GetHash() const;
 
+    /**
+     * Hashes of nCount streams. When they share an algorithm that is a plain
+     * hash chain and hold the same number of bytes, the chain runs stage by
+     * stage over groups of MULTIHASH_BATCH_LANES of them, and its BLAKE,
+     * BMW, Keccak and Skein stages through the interleaved kernels of
+     * HashChainMulti(). So do X16R, X16S, X21S and CPU23R headers that all
+     * build on the same previous block, as they do while mining. Scrypt and NeoScrypt headers go through the
+     * multi-buffer kernels, which hash several headers at once. Anything else
+     * is hashed one stream at a time.
+     */
+    static void GetHashBatch(const CMultihasher* hashers, size_t nCount, uint256* hashes);
+
+    /**
+     * Whether GetHashBatch() is faster than hashing nAlgo streams one at a
+     * time; for the chains ordered by the previous block hash, only when the
+     * headers share it.
+     */
+    static bool HasBatchKernel(uint8_t nAlgo);
+
+    /** Midstate of the serialized header, which must be CMultihashMidstate::HEADER_SIZE bytes. */
+    CMultihashMidstate GetMidstate() const;
+
     template<typename T>
     CMultihasher& operator<<(const T& obj) {
         // Serialize to this stream
@@ -56,6 +146,28 @@ uint256 SerializeMultiAlgoHash(const T& obj, uint8_t nAlgo, int nType=SER_GETHAS
     return ss.GetHash();
 }
 
+/** Compute the hashes of nCount objects' serializations, all with the same algorithm. */
+template<typename T>
+void SerializeMultiAlgoHashBatch(const T* const* objs, size_t nCount, uint8_t nAlgo, uint256* hashes, int nType=SER_GETHASH, int nVersion=PROTOCOL_VERSION)
+{
+    std::vector<CMultihasher> hashers;
+    hashers.reserve(nCount);
+    for (size_t i = 0; i < nCount; i++) {
+        hashers.emplace_back(nType, nVersion, nAlgo);
+        hashers.back() << *objs[i];
+    }
+    CMultihasher::GetHashBatch(hashers.data(), nCount, hashes);
+}
+
+/** Midstate of a header's serialization. The algorithm must be supported by CMultihashMidstate. */
+template<typename T>
+CMultihashMidstate SerializeMultiAlgoMidstate(const T& obj, uint8_t nAlgo, int nType=SER_GETHASH, int nVersion=PROTOCOL_VERSION)
+{
+    CMultihasher ss(nType, nVersion, nAlgo);
+    ss << obj;
+    return ss.GetMidstate();
+}
+
 int LoadMultiHasherVersionFlags(bool fHardfork3Activated);
 
 #endif // GLOBALTOKEN_MULTIHASHER_H
@@ -3,6 +3,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <algostats.h>
 #include <chainparams.h>
 #include <gltnotificationinterface.h>
 #include <instantx.h>
@@ -13,6 +14,7 @@
 void CGLTNotificationInterface::InitializeCurrentBlockTip()
 {
     LOCK(cs_main);
+    algoStats.NotifyHeaderTip(pindexBestHeader);
     UpdatedBlockTip(chainActive.Tip(), nullptr, IsInitialBlockDownload());
 }
 
@@ -23,11 +25,14 @@ void CGLTNotificationInterface::AcceptedBlockHeader(const CBlockIndex *pindexNew
 
 void CGLTNotificationInterface::NotifyHeaderTip(const CBlockIndex *pindexNew, bool fInitialDownload)
 {
+    algoStats.NotifyHeaderTip(pindexNew);
     masternodeSync.NotifyHeaderTip(pindexNew, fInitialDownload, connman);
 }
 
 void CGLTNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload)
 {
+    algoStats.UpdatedBlockTip(pindexNew, fInitialDownload);
+
     if (pindexNew == pindexFork) // blocks were disconnected without any new ones
         return;
 
@@ -7,6 +7,7 @@
 #include <base58.h>
 #include <chainparams.h>
 #include <httpserver.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <random.h>
@@ -58,11 +59,26 @@ private:
     struct event_base* base;
 };
 
+/* Runs entries of JSON-RPC batches on the HTTP worker threads */
+class HTTPRPCBatchInterface : public RPCBatchInterface
+{
+public:
+    const char* Name() override
+    {
+        return "HTTP";
+    }
+    bool Dispatch(const std::function<void(void)>& func) override
+    {
+        return QueueHTTPWork(func);
+    }
+};
+
 
 /* Pre-base64-encoded authentication token */
 static std::string strRPCUserColonPass;
 /* Stored RPC timer interface (for unregistration) */
 static std::unique_ptr<HTTPRPCTimerInterface> httpRPCTimerInterface;
+static std::unique_ptr<HTTPRPCBatchInterface> httpRPCBatchInterface;
 
 static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const UniValue& id)
 {
@@ -77,6 +93,8 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
 
     std::string strReply = JSONRPCReply(NullUniValue, objError, id);
 
+    // A streamed result may have been cut short
+    req->DiscardReplyBody();
     req->WriteHeader("Content-Type", "application/json");
     req->WriteReply(nStatus, strReply);
 }
@@ -149,26 +167,30 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         req->WriteReply(HTTP_BAD_METHOD, "JSONRPC server handles only POST requests");
         return false;
     }
-    // Check authorization
-    std::pair<bool, std::string> authHeader = req->GetHeader("authorization");
-    if (!authHeader.first) {
-        req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
-        req->WriteReply(HTTP_UNAUTHORIZED);
-        return false;
-    }
-
     JSONRPCRequest jreq;
-    if (!RPCAuthorized(authHeader.second, jreq.authUser)) {
-        LogPrintf("ThreadRPCServer incorrect password attempt from %s\n", req->GetPeer().ToString());
+    // Processes of the node's own user could read the auth cookie anyway, so
+    // on the -rpcunix socket their credentials stand in for a password.
+    if (!req->IsFromLocalUser()) {
+        // Check authorization
+        std::pair<bool, std::string> authHeader = req->GetHeader("authorization");
+        if (!authHeader.first) {
+            req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
+            req->WriteReply(HTTP_UNAUTHORIZED);
+            return false;
+        }
 
-        /* Deter brute-forcing
-           If this results in a DoS the user really
-           shouldn't have their RPC port exposed. */
-        MilliSleep(250);
+        if (!RPCAuthorized(authHeader.second, jreq.authUser)) {
+            LogPrintf("ThreadRPCServer incorrect password attempt from %s\n", req->GetPeer().ToString());
 
-        req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
-        req->WriteReply(HTTP_UNAUTHORIZED);
-        return false;
+            /* Deter brute-forcing
+               If this results in a DoS the user really
+               shouldn't have their RPC port exposed. */
+            MilliSleep(250);
+
+            req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
+            req->WriteReply(HTTP_UNAUTHORIZED);
+            return false;
+        }
     }
 
     try {
@@ -185,10 +207,22 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
 
+            // Write the reply straight into the HTTP output buffer, and let
+            // methods with large results stream them in there.
+            JSONStreamWriter writer([req](const char* data, size_t size) { req->WriteReplyBody(data, size); });
+            writer.BeginObject();
+            writer.Key("result");
+            jreq.resultStream = &writer;
             UniValue result = tableRPC.execute(jreq);
-
-            // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            if (writer.AfterKey())
+                writer.Value(result);
+            writer.Key("error");
+            writer.Value(NullUniValue);
+            writer.Key("id");
+            writer.Value(jreq.id);
+            writer.EndObject();
+            writer.Flush();
+            strReply = "\n";
 
         // array of requests
         } else if (valRequest.isArray())
@@ -240,6 +274,8 @@ bool StartHTTPRPC()
     assert(EventBase());
     httpRPCTimerInterface = MakeUnique<HTTPRPCTimerInterface>(EventBase());
     RPCSetTimerInterface(httpRPCTimerInterface.get());
+    httpRPCBatchInterface = MakeUnique<HTTPRPCBatchInterface>();
+    RPCSetBatchInterface(httpRPCBatchInterface.get());
     return true;
 }
 
@@ -256,4 +292,8 @@ void StopHTTPRPC()
         RPCUnsetTimerInterface(httpRPCTimerInterface.get());
         httpRPCTimerInterface.reset();
     }
+    if (httpRPCBatchInterface) {
+        RPCUnsetBatchInterface(httpRPCBatchInterface.get());
+        httpRPCBatchInterface.reset();
+    }
 }
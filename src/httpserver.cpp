@@ -20,8 +20,15 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <signal.h>
+#include <deque>
 #include <future>
 
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
 #include <event2/thread.h>
 #include <event2/buffer.h>
 #include <event2/bufferevent.h>
@@ -39,6 +46,10 @@
 
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
+/** The work queue only grows while items wait less than this for a worker (microseconds) */
+static const int64_t HTTP_WORKQUEUE_GROW_MAX_WAIT = 250 * 1000;
+/** Time after growing or shrinking before the work queue shrinks again when it drains (microseconds) */
+static const int64_t HTTP_WORKQUEUE_SHRINK_INTERVAL = 60 * 1000 * 1000;
 
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
@@ -60,6 +71,22 @@ private:
     HTTPRequestHandler func;
 };
 
+/** Work item that runs a function on an HTTP worker thread */
+class HTTPWorkFunction final : public HTTPClosure
+{
+public:
+    explicit HTTPWorkFunction(const std::function<void(void)>& _func) : func(_func)
+    {
+    }
+    void operator()() override
+    {
+        func();
+    }
+
+private:
+    std::function<void(void)> func;
+};
+
 /** Simple work queue for distributing work over multiple threads.
  * Work items are simply callable objects.
  */
@@ -70,13 +97,58 @@ private:
     /** Mutex protects entire object */
     std::mutex cs;
     std::condition_variable cond;
-    std::deque<std::unique_ptr<WorkItem>> queue;
+    //! Work items with the time they were enqueued
+    std::deque<std::pair<std::unique_ptr<WorkItem>, int64_t>> queue;
     bool running;
     size_t maxDepth;
+    //! The depth the queue starts with and shrinks back to, and the most it grows to
+    const size_t minDepth;
+    const size_t depthLimit;
+    int64_t nLastResize;
+    HTTPWorkQueueStats stats;
+
+    void Push(WorkItem* item)
+    {
+        queue.emplace_back(std::unique_ptr<WorkItem>(item), GetTimeMicros());
+        stats.nEnqueued++;
+        stats.nPeakDepth = std::max(stats.nPeakDepth, queue.size());
+        cond.notify_one();
+    }
+    /**
+     * Make room for a burst of requests, unless the ones in the queue already
+     * wait too long for a worker: then turning requests away is what tells
+     * clients to back off.
+     */
+    bool Grow()
+    {
+        if (maxDepth >= depthLimit || stats.nAvgWaitMicros > HTTP_WORKQUEUE_GROW_MAX_WAIT)
+            return false;
+        maxDepth = std::min(maxDepth * 2, depthLimit);
+        nLastResize = GetTimeMicros();
+        stats.nGrown++;
+        return true;
+    }
+    /** Called with an item taken from the queue */
+    void Taken(int64_t nTimeEnqueued)
+    {
+        const int64_t nNow = GetTimeMicros();
+        const int64_t nWait = std::max<int64_t>(nNow - nTimeEnqueued, 0);
+        stats.nAvgWaitMicros += (nWait - stats.nAvgWaitMicros) / 8;
+        stats.nMaxWaitMicros = std::max(stats.nMaxWaitMicros, nWait);
+        if (queue.empty() && maxDepth > minDepth && nNow - nLastResize > HTTP_WORKQUEUE_SHRINK_INTERVAL) {
+            maxDepth = std::max(maxDepth / 2, minDepth);
+            nLastResize = nNow;
+            stats.nShrunk++;
+        }
+    }
 
 public:
-    explicit WorkQueue(size_t _maxDepth) : running(true),
-                                 maxDepth(_maxDepth)
+    WorkQueue(size_t _maxDepth, size_t _depthLimit) : running(true),
+                                 maxDepth(_maxDepth),
+                                 minDepth(_maxDepth),
+                                 depthLimit(std::max(_maxDepth, _depthLimit)),
+                                 nLastResize(0),
+                                 stats()
     {
     }
     /** Precondition: worker threads have all stopped (they have been joined).
@@ -88,11 +160,21 @@ public:
     bool Enqueue(WorkItem* item)
     {
         std::unique_lock<std::mutex> lock(cs);
-        if (queue.size() >= maxDepth) {
+        if (queue.size() >= maxDepth && !Grow()) {
+            stats.nRejected++;
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
-        cond.notify_one();
+        Push(item);
+        return true;
+    }
+    /** Enqueue a work item if the queue is at most half full, so it leaves room for requests */
+    bool EnqueueIfIdle(WorkItem* item)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        if (queue.size() * 2 >= maxDepth) {
+            return false;
+        }
+        Push(item);
         return true;
     }
     /** Thread function */
@@ -106,8 +188,10 @@ public:
                     cond.wait(lock);
                 if (!running)
                     break;
-                i = std::move(queue.front());
+                i = std::move(queue.front().first);
+                const int64_t nTimeEnqueued = queue.front().second;
                 queue.pop_front();
+                Taken(nTimeEnqueued);
             }
             (*i)();
         }
@@ -119,6 +203,16 @@ public:
         running = false;
         cond.notify_all();
     }
+    HTTPWorkQueueStats GetStats()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        HTTPWorkQueueStats ret = stats;
+        ret.nDepth = queue.size();
+        ret.nMaxDepth = maxDepth;
+        ret.nMinDepth = minDepth;
+        ret.nDepthLimit = depthLimit;
+        return ret;
+    }
 };
 
 struct HTTPPathHandler
@@ -147,6 +241,8 @@ static WorkQueue<HTTPClosure>* workQueue = nullptr;
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
 std::vector<evhttp_bound_socket *> boundSockets;
+//! Path of the -rpcunix socket, removed again at shutdown
+static std::string strUnixSocketPath;
 
 /** Check if a network address is allowed to access the HTTP server */
 static bool ClientAllowed(const CNetAddr& netaddr)
@@ -208,6 +304,47 @@ static std::string RequestMethodString(HTTPRequest::RequestMethod m)
     }
 }
 
+/** Whether the peer on the socket is a process of the node's own user, connected to the -rpcunix socket */
+static bool SocketFromLocalUser(evutil_socket_t fd)
+{
+#ifndef WIN32
+    struct sockaddr_storage addr;
+    socklen_t addrlen = sizeof(addr);
+    if (fd < 0 || getsockname(fd, (struct sockaddr*)&addr, &addrlen) != 0 || addr.ss_family != AF_UNIX)
+        return false;
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t credlen = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &credlen) != 0)
+        return false;
+    return cred.uid == geteuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    if (getpeereid(fd, &uid, &gid) != 0)
+        return false;
+    return uid == geteuid();
+#endif
+#else
+    return false;
+#endif
+}
+
+/**
+ * Whether the request is on the -rpcunix socket from the node's own user.
+ * The socket is looked at for every request instead of being remembered by
+ * connection, whose memory libevent may hand to the next peer, and not at all
+ * without -rpcunix.
+ */
+static bool RequestFromLocalUser(struct evhttp_request* req)
+{
+    if (strUnixSocketPath.empty())
+        return false;
+    evhttp_connection* conn = evhttp_request_get_connection(req);
+    bufferevent* bev = conn ? evhttp_connection_get_bufferevent(conn) : nullptr;
+    return bev && SocketFromLocalUser(bufferevent_getfd(bev));
+}
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request* req, void* arg)
 {
@@ -221,13 +358,14 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
             }
         }
     }
-    std::unique_ptr<HTTPRequest> hreq(new HTTPRequest(req));
+    std::unique_ptr<HTTPRequest> hreq(new HTTPRequest(req, RequestFromLocalUser(req)));
 
     LogPrint(BCLog::HTTP, "Received a %s request for %s from %s\n",
              RequestMethodString(hreq->GetRequestMethod()), hreq->GetURI(), hreq->GetPeer().ToString());
 
-    // Early address-based allow check
-    if (!ClientAllowed(hreq->GetPeer())) {
+    // Early address-based allow check. The -rpcunix socket has no address
+    // to check, and is open to processes of the node's own user only.
+    if (!hreq->IsFromLocalUser() && !ClientAllowed(hreq->GetPeer())) {
         hreq->WriteReply(HTTP_FORBIDDEN);
         return;
     }
@@ -326,6 +464,54 @@ static bool HTTPBindAddresses(struct evhttp* http)
     return !boundSockets.empty();
 }
 
+/** Listen on the -rpcunix socket as well */
+static bool HTTPBindUnixSocket(struct evhttp* http)
+{
+#ifndef WIN32
+    const std::string strPath = AbsPathForConfigVal(fs::path(gArgs.GetArg("-rpcunix", ""))).string();
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (strPath.size() >= sizeof(addr.sun_path)) {
+        LogPrintf("Binding RPC on unix socket %s failed: path too long\n", strPath);
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, strPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    // A socket left behind by a node that did not shut down cleanly would make bind fail
+    struct stat st;
+    if (lstat(strPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(strPath.c_str());
+
+    LogPrint(BCLog::HTTP, "Binding RPC on unix socket %s\n", strPath);
+    evutil_socket_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        LogPrintf("Binding RPC on unix socket %s failed: %s\n", strPath, NetworkErrorString(WSAGetLastError()));
+        return false;
+    }
+    // Only the node's own user may connect, before anything can
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || chmod(strPath.c_str(), S_IRUSR | S_IWUSR) != 0 ||
+        listen(fd, SOMAXCONN) != 0 || evutil_make_socket_nonblocking(fd) != 0) {
+        LogPrintf("Binding RPC on unix socket %s failed: %s\n", strPath, NetworkErrorString(WSAGetLastError()));
+        close(fd);
+        return false;
+    }
+    evhttp_bound_socket *bind_handle = evhttp_accept_socket_with_handle(http, fd);
+    if (!bind_handle) {
+        LogPrintf("Binding RPC on unix socket %s failed.\n", strPath);
+        close(fd);
+        unlink(strPath.c_str());
+        return false;
+    }
+    boundSockets.push_back(bind_handle);
+    strUnixSocketPath = strPath;
+    return true;
+#else
+    LogPrintf("Unix sockets (-rpcunix) are not supported on this platform\n");
+    return false;
+#endif
+}
+
 /** Simple wrapper to set thread name and run work queue */
 static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue)
 {
@@ -388,6 +574,9 @@ bool InitHTTPServer()
     evhttp_set_max_body_size(http, MAX_SIZE);
     evhttp_set_gencb(http, http_request_cb, nullptr);
 
+    if (gArgs.IsArgSet("-rpcunix") && !HTTPBindUnixSocket(http)) {
+        return false;
+    }
     if (!HTTPBindAddresses(http)) {
         LogPrintf("Unable to bind any endpoint for RPC server\n");
         return false;
@@ -395,9 +584,10 @@ bool InitHTTPServer()
 
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
     int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    int workQueueDepthMax = std::max((long)gArgs.GetArg("-rpcworkqueuemax", DEFAULT_HTTP_WORKQUEUE_MAX), (long)workQueueDepth);
+    LogPrintf("HTTP: creating work queue of depth %d (growing up to %d)\n", workQueueDepth, workQueueDepthMax);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth, workQueueDepthMax);
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -437,6 +627,25 @@ bool StartHTTPServer()
     return true;
 }
 
+bool QueueHTTPWork(const std::function<void(void)>& func)
+{
+    if (!workQueue)
+        return false;
+    std::unique_ptr<HTTPWorkFunction> item(new HTTPWorkFunction(func));
+    if (!workQueue->EnqueueIfIdle(item.get()))
+        return false;
+    item.release(); /* if true, queue took ownership */
+    return true;
+}
+
+bool GetHTTPWorkQueueStats(HTTPWorkQueueStats& stats)
+{
+    if (!workQueue)
+        return false;
+    stats = workQueue->GetStats();
+    return true;
+}
+
 void InterruptHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Interrupting HTTP server\n");
@@ -488,6 +697,12 @@ void StopHTTPServer()
         event_base_free(eventBase);
         eventBase = nullptr;
     }
+#ifndef WIN32
+    if (!strUnixSocketPath.empty()) {
+        unlink(strUnixSocketPath.c_str());
+        strUnixSocketPath.clear();
+    }
+#endif
     LogPrint(BCLog::HTTP, "Stopped HTTP server\n");
 }
 
@@ -522,8 +737,9 @@ void HTTPEvent::trigger(struct timeval* tv)
     else
         evtimer_add(ev, tv); // trigger after timeval passed
 }
-HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req),
-                                                       replySent(false)
+HTTPRequest::HTTPRequest(struct evhttp_request* _req, bool _fLocalUser) : req(_req),
+                                                                         fLocalUser(_fLocalUser),
+                                                                         replySent(false)
 {
 }
 HTTPRequest::~HTTPRequest()
@@ -606,6 +822,39 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     req = nullptr; // transferred back to main thread
 }
 
+void HTTPRequest::WriteReplyBody(const char* data, size_t size)
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_add(evb, data, size);
+}
+
+static void http_reply_reference_cleanup(const void* data, size_t size, void* arg)
+{
+    delete static_cast<std::shared_ptr<const void>*>(arg);
+}
+
+void HTTPRequest::WriteReplyBody(const char* data, size_t size, std::shared_ptr<const void> owner)
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    std::shared_ptr<const void>* pOwner = new std::shared_ptr<const void>(std::move(owner));
+    if (evbuffer_add_reference(evb, data, size, http_reply_reference_cleanup, pOwner) != 0) {
+        delete pOwner;
+        evbuffer_add(evb, data, size);
+    }
+}
+
+void HTTPRequest::DiscardReplyBody()
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_drain(evb, evbuffer_get_length(evb));
+}
+
 CService HTTPRequest::GetPeer()
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
@@ -620,6 +869,11 @@ CService HTTPRequest::GetPeer()
     return peer;
 }
 
+bool HTTPRequest::IsFromLocalUser()
+{
+    return fLocalUser;
+}
+
 std::string HTTPRequest::GetURI()
 {
     return evhttp_request_get_uri(req);
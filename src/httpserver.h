@@ -8,9 +8,11 @@
 #include <string>
 #include <stdint.h>
 #include <functional>
+#include <memory>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
+static const int DEFAULT_HTTP_WORKQUEUE_MAX=256;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
 struct evhttp_request;
@@ -32,6 +34,34 @@ void InterruptHTTPServer();
 /** Stop HTTP server */
 void StopHTTPServer();
 
+/** Statistics of the HTTP work queue */
+struct HTTPWorkQueueStats
+{
+    //! Requests waiting for a worker thread now
+    size_t nDepth;
+    //! How many may wait now, between -rpcworkqueue and -rpcworkqueuemax
+    size_t nMaxDepth;
+    size_t nMinDepth;
+    size_t nDepthLimit;
+    size_t nPeakDepth;
+    uint64_t nEnqueued;
+    uint64_t nRejected;
+    //! Times the queue grew for a burst and shrank back
+    uint64_t nGrown;
+    uint64_t nShrunk;
+    //! Moving average and maximum of the time waited for a worker thread
+    int64_t nAvgWaitMicros;
+    int64_t nMaxWaitMicros;
+};
+
+/** Get the statistics of the HTTP work queue. Returns false if the HTTP server is not running. */
+bool GetHTTPWorkQueueStats(HTTPWorkQueueStats& stats);
+
+/** Run func on an HTTP worker thread. Returns false, without running it,
+ * when the work queue is more than half full, so that requests still fit.
+ */
+bool QueueHTTPWork(const std::function<void(void)>& func);
+
 /** Change logging level for libevent. Removes BCLog::LIBEVENT from logCategories if
  * libevent doesn't support debug logging.*/
 bool UpdateHTTPServerLogging(bool enable);
@@ -58,10 +88,12 @@ class HTTPRequest
 {
 private:
     struct evhttp_request* req;
+    //! Set for requests on the -rpcunix socket from the node's own user
+    bool fLocalUser;
     bool replySent;
 
 public:
-    explicit HTTPRequest(struct evhttp_request* req);
+    explicit HTTPRequest(struct evhttp_request* req, bool fLocalUser = false);
     ~HTTPRequest();
 
     enum RequestMethod {
@@ -84,6 +116,12 @@ public:
      */
     RequestMethod GetRequestMethod();
 
+    /**
+     * Whether the request came in on the -rpcunix socket from a process of
+     * the user the node runs as, going by the credentials of the peer.
+     */
+    bool IsFromLocalUser();
+
     /**
      * Get the request header specified by hdr, or an empty string.
      * Return a pair (isPresent,string).
@@ -114,6 +152,22 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Append to the body of the reply, before WriteReply sends it.
+     */
+    void WriteReplyBody(const char* data, size_t size);
+
+    /**
+     * Append to the body of the reply without copying the data, which owner
+     * keeps alive until the reply is sent.
+     */
+    void WriteReplyBody(const char* data, size_t size, std::shared_ptr<const void> owner);
+
+    /**
+     * Drop what was appended to the body of the reply.
+     */
+    void DiscardReplyBody();
 };
 
 /** Event handler closure.
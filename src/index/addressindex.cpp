@@ -0,0 +1,252 @@
+// Copyright (c) 2016 BitPay, Inc.
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <coins.h>
+#include <index/addressindex.h>
+#include <undo.h>
+#include <util.h>
+#include <validation.h>
+
+constexpr char DB_ADDRESSINDEX = 'a';
+constexpr char DB_ADDRESSUNSPENTINDEX = 'u';
+
+std::unique_ptr<AddressIndex> g_addressindex;
+
+namespace {
+
+class IndexKeyVisitor : public boost::static_visitor<bool>
+{
+private:
+    uint8_t& type;
+    uint160& hash;
+
+public:
+    IndexKeyVisitor(uint8_t& typeIn, uint160& hashIn) : type(typeIn), hash(hashIn) {}
+
+    bool operator()(const CKeyID& id) const { type = ADDRESS_TYPE_PUBKEYHASH; hash = id; return true; }
+    bool operator()(const CScriptID& id) const { type = ADDRESS_TYPE_SCRIPTHASH; hash = id; return true; }
+    bool operator()(const WitnessV0KeyHash& id) const { type = ADDRESS_TYPE_WITNESS_PUBKEYHASH; hash = id; return true; }
+    template <typename T>
+    bool operator()(const T&) const { return false; }
+};
+
+} // namespace
+
+bool DestinationToIndexKey(const CTxDestination& dest, uint8_t& type, uint160& hash)
+{
+    return boost::apply_visitor(IndexKeyVisitor(type, hash), dest);
+}
+
+bool ScriptToIndexKey(const CScript& script, uint8_t& type, uint160& hash)
+{
+    CTxDestination dest;
+    return ExtractDestination(script, dest) && DestinationToIndexKey(dest, type, hash);
+}
+
+CTxDestination IndexKeyToDestination(uint8_t type, const uint160& hash)
+{
+    switch (type) {
+    case ADDRESS_TYPE_PUBKEYHASH: return CKeyID(hash);
+    case ADDRESS_TYPE_SCRIPTHASH: return CScriptID(hash);
+    case ADDRESS_TYPE_WITNESS_PUBKEYHASH: return WitnessV0KeyHash(hash);
+    }
+    return CNoDestination();
+}
+
+/** Access to the address index database (indexes/addressindex/) */
+class AddressIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+AddressIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe)
+{}
+
+AddressIndex::AddressIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<AddressIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+AddressIndex::~AddressIndex() {}
+
+BaseIndex::DB& AddressIndex::GetDB() const { return *m_db; }
+
+static void WriteAddressIndexInputs(CDBBatch& batch, const CTransaction& tx, const CTxUndo& txundo,
+                                    const CBlockIndex* pindex, size_t i, bool fDisconnect)
+{
+    const uint256& txhash = tx.GetHash();
+    for (size_t j = 0; j < tx.vin.size(); j++) {
+        const Coin& coin = txundo.vprevout[j];
+        uint8_t type;
+        uint160 hash;
+        if (!ScriptToIndexKey(coin.out.scriptPubKey, type, hash)) continue;
+
+        const COutPoint& prevout = tx.vin[j].prevout;
+        CAddressIndexKey key(type, hash, pindex->nHeight, i, txhash, j, true);
+        CAddressUnspentKey unspent(type, hash, prevout.hash, prevout.n);
+        if (fDisconnect) {
+            batch.Erase(std::make_pair(DB_ADDRESSINDEX, key));
+            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, unspent),
+                        CAddressUnspentValue(coin.out.nValue, coin.out.scriptPubKey, coin.nHeight));
+        } else {
+            batch.Write(std::make_pair(DB_ADDRESSINDEX, key), -coin.out.nValue);
+            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, unspent));
+        }
+    }
+}
+
+static void WriteAddressIndexOutputs(CDBBatch& batch, const CTransaction& tx,
+                                     const CBlockIndex* pindex, size_t i, bool fDisconnect)
+{
+    const uint256& txhash = tx.GetHash();
+    for (size_t k = 0; k < tx.vout.size(); k++) {
+        const CTxOut& out = tx.vout[k];
+        uint8_t type;
+        uint160 hash;
+        if (out.scriptPubKey.IsUnspendable() || !ScriptToIndexKey(out.scriptPubKey, type, hash)) continue;
+
+        CAddressIndexKey key(type, hash, pindex->nHeight, i, txhash, k, false);
+        CAddressUnspentKey unspent(type, hash, txhash, k);
+        if (fDisconnect) {
+            batch.Erase(std::make_pair(DB_ADDRESSINDEX, key));
+            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, unspent));
+        } else {
+            batch.Write(std::make_pair(DB_ADDRESSINDEX, key), out.nValue);
+            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, unspent),
+                        CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight));
+        }
+    }
+}
+
+/**
+ * Add the entries of one block, or remove them when disconnecting. Blocks are
+ * undone in reverse transaction order so that outputs created and spent within
+ * the same block do not reappear in the unspent set. Replaying already indexed
+ * blocks in order yields the same entries, which lets the sync thread resume
+ * from a slightly stale locator.
+ */
+static void WriteAddressIndexBatch(CDBBatch& batch, const CBlock& block, const CBlockUndo& blockundo,
+                                   const CBlockIndex* pindex, bool fDisconnect)
+{
+    if (fDisconnect) {
+        for (size_t i = block.vtx.size(); i-- > 0;) {
+            WriteAddressIndexOutputs(batch, *block.vtx[i], pindex, i, true);
+            if (i > 0) WriteAddressIndexInputs(batch, *block.vtx[i], blockundo.vtxundo[i - 1], pindex, i, true);
+        }
+    } else {
+        for (size_t i = 0; i < block.vtx.size(); i++) {
+            if (i > 0) WriteAddressIndexInputs(batch, *block.vtx[i], blockundo.vtxundo[i - 1], pindex, i, false);
+            WriteAddressIndexOutputs(batch, *block.vtx[i], pindex, i, false);
+        }
+    }
+}
+
+bool AddressIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    // The genesis output cannot be spent and has no undo data.
+    if (pindex->nHeight == 0) return true;
+
+    CBlockUndo blockundo;
+    if (!UndoReadFromDisk(blockundo, pindex)) {
+        return error("%s: Failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    CDBBatch batch(*m_db);
+    WriteAddressIndexBatch(batch, block, blockundo, pindex, false);
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        CBlockUndo blockundo;
+        if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            return error("%s: Failed to read block %s from disk", __func__, pindex->GetBlockHash().ToString());
+        }
+        if (!UndoReadFromDisk(blockundo, pindex)) {
+            return error("%s: Failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+
+        CDBBatch batch(*m_db);
+        WriteAddressIndexBatch(batch, block, blockundo, pindex, true);
+        if (!m_db->WriteBatch(batch)) {
+            return error("%s: Failed to rewind block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+bool AddressIndex::GetBalance(uint8_t type, const uint160& hash, CAmount& balance, CAmount& received) const
+{
+    balance = 0;
+    received = 0;
+
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, hash, 0)));
+    for (; pcursor->Valid(); pcursor->Next()) {
+        std::pair<char, CAddressIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX ||
+            key.second.type != type || key.second.hash != hash) {
+            break;
+        }
+        CAmount nValue;
+        if (!pcursor->GetValue(nValue)) {
+            return error("%s: failed to read address index value", __func__);
+        }
+        balance += nValue;
+        if (nValue > 0) received += nValue;
+    }
+    return true;
+}
+
+bool AddressIndex::FindTxids(uint8_t type, const uint160& hash, int start, int end, size_t max_count,
+                             std::vector<std::pair<int, uint256>>& txids) const
+{
+    size_t count = 0;
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, hash, start)));
+    for (; pcursor->Valid() && count < max_count; pcursor->Next()) {
+        std::pair<char, CAddressIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX ||
+            key.second.type != type || key.second.hash != hash) {
+            break;
+        }
+        if (end > 0 && key.second.nHeight > end) break;
+
+        // Entries of the same transaction are adjacent
+        if (count > 0 && txids.back().second == key.second.txhash) continue;
+        txids.emplace_back(key.second.nHeight, key.second.txhash);
+        count++;
+    }
+    return true;
+}
+
+bool AddressIndex::FindUnspentOutputs(uint8_t type, const uint160& hash, size_t max_count,
+                                      std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& outputs) const
+{
+    size_t count = 0;
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressUnspentIteratorKey(type, hash)));
+    for (; pcursor->Valid() && count < max_count; pcursor->Next()) {
+        std::pair<char, CAddressUnspentKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSUNSPENTINDEX ||
+            key.second.type != type || key.second.hash != hash) {
+            break;
+        }
+        CAddressUnspentValue value;
+        if (!pcursor->GetValue(value)) {
+            return error("%s: failed to read address unspent index value", __func__);
+        }
+        outputs.emplace_back(key.second, value);
+        count++;
+    }
+    return true;
+}
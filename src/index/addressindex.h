@@ -0,0 +1,226 @@
+// Copyright (c) 2016 BitPay, Inc.
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_ADDRESSINDEX_H
+#define BITCOIN_INDEX_ADDRESSINDEX_H
+
+#include <amount.h>
+#include <chain.h>
+#include <index/base.h>
+#include <pubkey.h>
+#include <script/script.h>
+#include <script/standard.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <vector>
+
+static const bool DEFAULT_ADDRESSINDEX = false;
+
+/** Default and maximum number of entries returned by a single address index query */
+static const unsigned int DEFAULT_ADDRESS_QUERY_LIMIT = 1000;
+static const unsigned int MAX_ADDRESS_QUERY_LIMIT = 50000;
+/** Maximum number of addresses accepted by a single address index query */
+static const unsigned int MAX_ADDRESS_QUERY_ADDRESSES = 100;
+
+/** Kinds of destination the address and spent indexes are keyed by */
+enum AddressType : uint8_t
+{
+    ADDRESS_TYPE_UNKNOWN = 0,
+    ADDRESS_TYPE_PUBKEYHASH = 1,        //!< P2PKH, and P2PK under the key's hash
+    ADDRESS_TYPE_SCRIPTHASH = 2,        //!< P2SH
+    ADDRESS_TYPE_WITNESS_PUBKEYHASH = 3 //!< P2WPKH
+};
+
+/** Map a destination onto the (type, hash) pair used as index key. Returns false for unsupported destinations. */
+bool DestinationToIndexKey(const CTxDestination& dest, uint8_t& type, uint160& hash);
+/** Map an output script onto the (type, hash) pair used as index key. Returns false for unsupported scripts. */
+bool ScriptToIndexKey(const CScript& script, uint8_t& type, uint160& hash);
+/** Inverse of DestinationToIndexKey */
+CTxDestination IndexKeyToDestination(uint8_t type, const uint160& hash);
+
+/**
+ * One credit or debit of an address. Height and position in the block are
+ * serialized big endian so that LevelDB iterates an address' history in
+ * chain order.
+ */
+struct CAddressIndexKey
+{
+    uint8_t type;
+    uint160 hash;
+    int nHeight;
+    uint32_t nTxIndex;
+    uint256 txhash;
+    uint32_t nIndex;
+    bool fSpending;
+
+    CAddressIndexKey() : type(ADDRESS_TYPE_UNKNOWN), nHeight(0), nTxIndex(0), nIndex(0), fSpending(false) {}
+    CAddressIndexKey(uint8_t typeIn, const uint160& hashIn, int nHeightIn, uint32_t nTxIndexIn,
+                     const uint256& txhashIn, uint32_t nIndexIn, bool fSpendingIn) :
+        type(typeIn), hash(hashIn), nHeight(nHeightIn), nTxIndex(nTxIndexIn),
+        txhash(txhashIn), nIndex(nIndexIn), fSpending(fSpendingIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, type);
+        hash.Serialize(s);
+        ser_writedata32be(s, nHeight);
+        ser_writedata32be(s, nTxIndex);
+        txhash.Serialize(s);
+        ser_writedata32(s, nIndex);
+        ser_writedata8(s, fSpending);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        type = ser_readdata8(s);
+        hash.Unserialize(s);
+        nHeight = ser_readdata32be(s);
+        nTxIndex = ser_readdata32be(s);
+        txhash.Unserialize(s);
+        nIndex = ser_readdata32(s);
+        fSpending = ser_readdata8(s);
+    }
+};
+
+/** Prefix of CAddressIndexKey used to seek to the first entry of an address at or above a height */
+struct CAddressIndexIteratorKey
+{
+    uint8_t type;
+    uint160 hash;
+    int nHeight;
+
+    CAddressIndexIteratorKey(uint8_t typeIn, const uint160& hashIn, int nHeightIn) :
+        type(typeIn), hash(hashIn), nHeight(nHeightIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, type);
+        hash.Serialize(s);
+        ser_writedata32be(s, nHeight);
+    }
+};
+
+/** An unspent output paying to an address */
+struct CAddressUnspentKey
+{
+    uint8_t type;
+    uint160 hash;
+    uint256 txhash;
+    uint32_t nIndex;
+
+    CAddressUnspentKey() : type(ADDRESS_TYPE_UNKNOWN), nIndex(0) {}
+    CAddressUnspentKey(uint8_t typeIn, const uint160& hashIn, const uint256& txhashIn, uint32_t nIndexIn) :
+        type(typeIn), hash(hashIn), txhash(txhashIn), nIndex(nIndexIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, type);
+        hash.Serialize(s);
+        txhash.Serialize(s);
+        ser_writedata32(s, nIndex);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        type = ser_readdata8(s);
+        hash.Unserialize(s);
+        txhash.Unserialize(s);
+        nIndex = ser_readdata32(s);
+    }
+};
+
+/** Prefix of CAddressUnspentKey used to seek to the first unspent output of an address */
+struct CAddressUnspentIteratorKey
+{
+    uint8_t type;
+    uint160 hash;
+
+    CAddressUnspentIteratorKey(uint8_t typeIn, const uint160& hashIn) : type(typeIn), hash(hashIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, type);
+        hash.Serialize(s);
+    }
+};
+
+struct CAddressUnspentValue
+{
+    CAmount nValue;
+    CScript script;
+    int nHeight;
+
+    CAddressUnspentValue() : nValue(-1), nHeight(0) {}
+    CAddressUnspentValue(CAmount nValueIn, const CScript& scriptIn, int nHeightIn) :
+        nValue(nValueIn), script(scriptIn), nHeight(nHeightIn) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nValue);
+        READWRITE(*(CScriptBase*)(&script));
+        READWRITE(nHeight);
+    }
+};
+
+/**
+ * AddressIndex keeps, for every P2PKH, P2SH and P2WPKH address, the list of
+ * outputs paying to it and inputs spending from it, plus the set of its
+ * currently unspent outputs. Spent outputs are taken from the block undo
+ * data, so no UTXO lookups are needed while indexing.
+ */
+class AddressIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "addressindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~AddressIndex() override;
+
+    /// Sum the history of an address.
+    ///
+    /// @param[out]  balance   Value of the outputs that are still unspent.
+    /// @param[out]  received  Value of all outputs ever paid to the address.
+    bool GetBalance(uint8_t type, const uint160& hash, CAmount& balance, CAmount& received) const;
+
+    /// Append the distinct transactions touching an address within heights
+    /// [start, end] (end 0 means unbounded) to txids, in chain order, stopping
+    /// once max_count transactions were appended.
+    bool FindTxids(uint8_t type, const uint160& hash, int start, int end, size_t max_count,
+                   std::vector<std::pair<int, uint256>>& txids) const;
+
+    /// Append at most max_count unspent outputs of an address to outputs.
+    bool FindUnspentOutputs(uint8_t type, const uint160& hash, size_t max_count,
+                            std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& outputs) const;
+};
+
+/// The global address index, used by the address RPCs. May be null.
+extern std::unique_ptr<AddressIndex> g_addressindex;
+
+#endif // BITCOIN_INDEX_ADDRESSINDEX_H
@@ -0,0 +1,96 @@
+// Copyright (c) 2016 BitPay, Inc.
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <coins.h>
+#include <index/addressindex.h>
+#include <index/spentindex.h>
+#include <undo.h>
+#include <util.h>
+#include <validation.h>
+
+constexpr char DB_SPENTINDEX = 'p';
+
+std::unique_ptr<SpentIndex> g_spentindex;
+
+/** Access to the spent index database (indexes/spentindex/) */
+class SpentIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+SpentIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "spentindex", n_cache_size, f_memory, f_wipe)
+{}
+
+SpentIndex::SpentIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<SpentIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+SpentIndex::~SpentIndex() {}
+
+BaseIndex::DB& SpentIndex::GetDB() const { return *m_db; }
+
+bool SpentIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    if (pindex->nHeight == 0) return true;
+
+    CBlockUndo blockundo;
+    if (!UndoReadFromDisk(blockundo, pindex)) {
+        return error("%s: Failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    CDBBatch batch(*m_db);
+    for (size_t i = 1; i < block.vtx.size(); i++) {
+        const CTransaction& tx = *block.vtx[i];
+        const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+        for (size_t j = 0; j < tx.vin.size(); j++) {
+            const Coin& coin = txundo.vprevout[j];
+            CSpentIndexValue value;
+            value.txid = tx.GetHash();
+            value.nInputIndex = j;
+            value.nHeight = pindex->nHeight;
+            value.nValue = coin.out.nValue;
+            if (!ScriptToIndexKey(coin.out.scriptPubKey, value.addressType, value.addressHash)) {
+                value.addressType = ADDRESS_TYPE_UNKNOWN;
+                value.addressHash.SetNull();
+            }
+            const COutPoint& prevout = tx.vin[j].prevout;
+            batch.Write(std::make_pair(DB_SPENTINDEX, CSpentIndexKey(prevout.hash, prevout.n)), value);
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool SpentIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // Only the spending inputs are needed, so the undo data is not read here.
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            return error("%s: Failed to read block %s from disk", __func__, pindex->GetBlockHash().ToString());
+        }
+
+        CDBBatch batch(*m_db);
+        for (size_t i = 1; i < block.vtx.size(); i++) {
+            for (const CTxIn& txin : block.vtx[i]->vin) {
+                batch.Erase(std::make_pair(DB_SPENTINDEX, CSpentIndexKey(txin.prevout.hash, txin.prevout.n)));
+            }
+        }
+        if (!m_db->WriteBatch(batch)) {
+            return error("%s: Failed to rewind block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+bool SpentIndex::FindSpent(const CSpentIndexKey& key, CSpentIndexValue& value) const
+{
+    return m_db->Read(std::make_pair(DB_SPENTINDEX, key), value);
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2016 BitPay, Inc.
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_SPENTINDEX_H
+#define BITCOIN_INDEX_SPENTINDEX_H
+
+#include <amount.h>
+#include <chain.h>
+#include <index/base.h>
+#include <serialize.h>
+#include <uint256.h>
+
+static const bool DEFAULT_SPENTINDEX = false;
+
+/** Output that has been spent */
+struct CSpentIndexKey
+{
+    uint256 txid;
+    uint32_t nIndex;
+
+    CSpentIndexKey() : nIndex(0) {}
+    CSpentIndexKey(const uint256& txidIn, uint32_t nIndexIn) : txid(txidIn), nIndex(nIndexIn) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(txid);
+        READWRITE(nIndex);
+    }
+};
+
+/** Input spending a CSpentIndexKey, and the output it spent */
+struct CSpentIndexValue
+{
+    uint256 txid;
+    uint32_t nInputIndex;
+    int nHeight;
+    CAmount nValue;
+    uint8_t addressType;
+    uint160 addressHash;
+
+    CSpentIndexValue() : nInputIndex(0), nHeight(0), nValue(-1), addressType(0) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(txid);
+        READWRITE(nInputIndex);
+        READWRITE(nHeight);
+        READWRITE(nValue);
+        READWRITE(addressType);
+        READWRITE(addressHash);
+    }
+};
+
+/**
+ * SpentIndex records, for every output spent in the active chain, the input
+ * that spent it. Spent outputs are taken from the block undo data.
+ */
+class SpentIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "spentindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit SpentIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~SpentIndex() override;
+
+    /// Look up the input spending an output. Returns false if it is unspent.
+    bool FindSpent(const CSpentIndexKey& key, CSpentIndexValue& value) const;
+};
+
+/// The global spent index, used by getspentinfo. May be null.
+extern std::unique_ptr<SpentIndex> g_spentindex;
+
+#endif // BITCOIN_INDEX_SPENTINDEX_H
@@ -15,14 +15,26 @@
 #include <addrman.h>
 #include <amount.h>
 #include <base58.h>
+#include <blockfilemap.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
 #include <compat/sanity.h>
 #include <consensus/validation.h>
+#include <crypto/algos/argon2/argon2.h>
+#include <crypto/algos/argon2/hashargon.h>
+#include <crypto/algos/hashlib/hashchain.h>
+#include <crypto/algos/hashlib/sph_aesni.h>
+#include <crypto/algos/neoscrypt/neoscrypt.h>
+#include <crypto/algos/scrypt/scrypt.h>
+#include <crypto/algos/yescrypt/yescrypt.h>
+#include <crypto/algos/yespower/yespower.h>
 #include <fs.h>
 #include <httpserver.h>
 #include <httprpc.h>
+#include <index/addressindex.h>
+#include <index/spentindex.h>
+#include <index/txindex.h>
 #include <key.h>
 #include <validation.h>
 #include <miner.h>
@@ -32,6 +44,7 @@
 #include <policy/feerate.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
+#include <powcache.h>
 #include <rpc/server.h>
 #include <rpc/register.h>
 #include <rpc/safemode.h>
@@ -42,6 +55,7 @@
 #include <timedata.h>
 #include <txdb.h>
 #include <txmempool.h>
+#include <stratum.h>
 #include <torcontrol.h>
 #include <ui_interface.h>
 #include <util.h>
@@ -86,9 +100,6 @@
 #include <zmq/zmqnotificationinterface.h>
 #endif
 
-#ifdef USE_SSE2
-#include <crypto/algos/scrypt/scrypt.h>
-#endif
 
 bool fFeeEstimatesInitialized = false;
 static const bool DEFAULT_PROXYRANDOMIZE = true;
@@ -190,9 +201,16 @@ void Interrupt()
     InterruptRPC();
     InterruptREST();
     InterruptTorControl();
+    InterruptStratumServer();
     InterruptMapPort();
     if (g_connman)
         g_connman->Interrupt();
+    if (g_txindex)
+        g_txindex->Interrupt();
+    if (g_addressindex)
+        g_addressindex->Interrupt();
+    if (g_spentindex)
+        g_spentindex->Interrupt();
 }
 
 void Shutdown()
@@ -214,6 +232,7 @@ void Shutdown()
     StopREST();
     StopRPC();
     StopHTTPServer();
+    StopStratumServer();
 #ifdef ENABLE_WALLET
     FlushWallets();
 #endif
@@ -225,6 +244,18 @@ void Shutdown()
     if (g_connman) g_connman->Stop();
     peerLogic.reset();
     g_connman.reset();
+    if (g_txindex) {
+        g_txindex->Stop();
+        g_txindex.reset();
+    }
+    if (g_addressindex) {
+        g_addressindex->Stop();
+        g_addressindex.reset();
+    }
+    if (g_spentindex) {
+        g_spentindex->Stop();
+        g_spentindex.reset();
+    }
     
     // STORE DATA CACHES INTO SERIALIZED DAT FILES
     if (!fLiteMode) {
@@ -242,6 +273,7 @@ void Shutdown()
     // CScheduler/checkqueue threadGroup
     threadGroup.interrupt_all();
     threadGroup.join_all();
+    Argon2StopLaneThreads();
 
     if (fDumpMempoolLater && gArgs.GetArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL)) {
         DumpMempool();
@@ -374,6 +406,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-version", _("Print version and exit"));
     strUsage += HelpMessageOpt("-alertnotify=<cmd>", _("Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)"));
     strUsage +=HelpMessageOpt("-assumevalid=<hex>", strprintf(_("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s)"), defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex()));
+    strUsage += HelpMessageOpt("-blockmapfiles=<n>", strprintf(_("Number of block files kept memory mapped for reading blocks (0 to disable, max: %u, default: %u)"), MAX_BLOCK_MAP_FILES, DEFAULT_BLOCK_MAP_FILES));
     strUsage += HelpMessageOpt("-blocknotify=<cmd>", _("Execute command when the best block changes (%s in cmd is replaced by block hash)"));
     strUsage += HelpMessageOpt("-blockreconstructionextratxn=<n>", strprintf(_("Extra transactions to keep in memory for compact block reconstructions (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN));
     if (showDebug)
@@ -409,8 +442,10 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-prune=<n>", strprintf(_("Reduce storage requirements by enabling pruning (deleting) of old blocks. This allows the pruneblockchain RPC to be called to delete specific blocks, and enables automatic pruning of old blocks if a target size in MiB is provided. This mode is incompatible with -txindex and -rescan. "
             "Warning: Reverting this setting requires re-downloading the entire blockchain. "
             "(default: 0 = disable pruning blocks, 1 = allow manual pruning via RPC, >%u = automatically prune block files to stay under the specified target size in MiB)"), MIN_DISK_SPACE_FOR_BLOCK_FILES / 1024 / 1024));
+    strUsage += HelpMessageOpt("-addressindex", strprintf(_("Maintain an index of the outputs and spends of every address, used by the getaddressbalance, getaddressutxos and getaddresstxids rpc calls (default: %u)"), DEFAULT_ADDRESSINDEX));
     strUsage += HelpMessageOpt("-reindex", _("Rebuild chain state and block index from the blk*.dat files on disk"));
     strUsage += HelpMessageOpt("-reindex-chainstate", _("Rebuild chain state from the currently indexed blocks"));
+    strUsage += HelpMessageOpt("-spentindex", strprintf(_("Maintain an index of the input spending every output, used by the getspentinfo rpc call (default: %u)"), DEFAULT_SPENTINDEX));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-sysperms", _("Create new files with system default permissions, instead of umask 077 (only effective with disabled wallet functionality)"));
 #endif
@@ -434,6 +469,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-maxsendbuffer=<n>", strprintf(_("Maximum per-connection send buffer, <n>*1000 bytes (default: %u)"), DEFAULT_MAXSENDBUFFER));
     strUsage += HelpMessageOpt("-maxtimeadjustment", strprintf(_("Maximum allowed median peer time offset adjustment. Local perspective of time may be influenced by peers forward or backward by this amount. (default: %u seconds)"), DEFAULT_MAX_TIME_ADJUSTMENT));
     strUsage += HelpMessageOpt("-maxuploadtarget=<n>", strprintf(_("Tries to keep outbound traffic under the given target (in MiB per 24h), 0 = no limit (default: %d)"), DEFAULT_MAX_UPLOAD_TARGET));
+    strUsage += HelpMessageOpt("-msgworkers=<n>", strprintf(_("Number of threads processing masternode, InstantSend, spork and getdata messages in parallel (0 to %d, 0 = use the message handler thread, default: %d)"), MAX_MSG_WORKER_THREADS, DEFAULT_MSG_WORKER_THREADS));
     strUsage += HelpMessageOpt("-onion=<ip:port>", strprintf(_("Use separate SOCKS5 proxy to reach peers via Tor hidden services (default: %s)"), "-proxy"));
     strUsage += HelpMessageOpt("-onlynet=<net>", _("Only connect to nodes in network <net> (ipv4, ipv6 or onion)"));
     strUsage += HelpMessageOpt("-peerbloomfilters", strprintf(_("Support filtering of blocks and transaction with bloom filters (default: %u)"), DEFAULT_PEERBLOOMFILTERS));
@@ -462,10 +498,16 @@ std::string HelpMessage(HelpMessageMode mode)
 
 #if ENABLE_ZMQ
     strUsage += HelpMessageGroup(_("ZeroMQ notification options:"));
+    strUsage += HelpMessageOpt("-zmqpubauxblock=<address>", _("Enable publish auxblock-<algo> with the new tip, for every algo that can be merge mined on top of it, in <address>"));
     strUsage += HelpMessageOpt("-zmqpubhashblock=<address>", _("Enable publish hash block in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubhashblockalgo=<address>", _("Enable publish hash block as hashblock-<algo> of the algo it was mined with in <address>"));
     strUsage += HelpMessageOpt("-zmqpubhashtx=<address>", _("Enable publish hash transaction in <address>"));
     strUsage += HelpMessageOpt("-zmqpubhashtxlock=<address>", _("Enable publish hash transaction (locked via InstantSend) in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubmasternode=<address>", _("Enable publish masternodes added to, removed from or changing state in the masternode list in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawblock=<address>", _("Enable publish raw block in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubrawblockheader=<address>", _("Enable publish raw block header in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubrawmnpaymentvote=<address>", _("Enable publish raw masternode payment vote in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubrawspork=<address>", _("Enable publish raw spork in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawtx=<address>", _("Enable publish raw transaction in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawtxlock=<address>", _("Enable publish raw transaction (locked via InstantSend) in <address>"));
 #endif
@@ -500,8 +542,11 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-logtimestamps", strprintf(_("Prepend debug output with timestamp (default: %u)"), DEFAULT_LOGTIMESTAMPS));
     if (showDebug)
     {
+        strUsage += HelpMessageOpt("-argon2lanethreads=<n>", strprintf("Fill the lanes of Argon2d and Argon2i hashes on up to <n> helper threads (0 = off, default: 1 on multi-core machines, max: %d)", MAX_ARGON2_LANE_THREADS));
+        strUsage += HelpMessageOpt("-lockprofile", strprintf("Add up the time cs_main, mempool.cs, mnodeman.cs, cs_instantsend and cs_mapMasternodeBlocks are waited for and held, for getlockinfo (default: %u)", DEFAULT_LOCK_PROFILE));
         strUsage += HelpMessageOpt("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS));
         strUsage += HelpMessageOpt("-mocktime=<n>", "Replace actual time with <n> seconds since epoch (default: 0)");
+        strUsage += HelpMessageOpt("-maxpowcachesize=<n>", strprintf("Limit the cache of proof of work hashes to <n> MiB (default: %u)", DEFAULT_MAX_POW_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit sum of signature cache and script execution cache sizes to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE));
     }
@@ -559,10 +604,20 @@ std::string HelpMessage(HelpMessageMode mode)
 		
     strUsage += HelpMessageOpt("-coinbasetxnaddress=<address>", _("If you mine with getblocktemplate coinbasetxn, you need to paste an address here. It will be used to generate the coinbasetxn"));
     strUsage += HelpMessageOpt("-enableequihash", _("Activate this option, to mine equihash based algorithms in this wallet. (default: disabled)"));
+    strUsage += HelpMessageGroup(_("Stratum server options:"));
+    strUsage += HelpMessageOpt("-stratumaddress=<address>", _("Address that the blocks mined through the Stratum server pay to"));
+    strUsage += HelpMessageOpt("-stratumallowip=<ip>", _("Allow Stratum connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times"));
+    strUsage += HelpMessageOpt("-stratumbind=<addr>", _("Bind to given address to listen for Stratum connections. This option is ignored unless -stratumallowip is also passed. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost, or if -stratumallowip has been specified, 0.0.0.0 and :: i.e., all addresses)"));
+    strUsage += HelpMessageOpt("-stratumdifficulty=[<algo>:]<n>", strprintf(_("Share difficulty for the miners of <algo>, or of every algo without <algo>, where 1 is the pow limit of the algo (default: %s)"), DEFAULT_STRATUM_DIFFICULTY));
+    strUsage += HelpMessageOpt("-stratumport=[<algo>:]<port>", _("Listen for Stratum v1 connections of miners of <algo> (default: -algo) on <port>. This option can be specified multiple times"));
     strUsage += HelpMessageGroup(_("RPC server options:"));
     strUsage += HelpMessageOpt("-rest", strprintf(_("Accept public REST requests (default: %u)"), DEFAULT_REST_ENABLE));
     strUsage += HelpMessageOpt("-rpcallowip=<ip>", _("Allow JSON-RPC connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times"));
     strUsage += HelpMessageOpt("-rpcauth=<userpw>", _("Username and hashed password for JSON-RPC connections. The field <userpw> comes in the format: <USERNAME>:<SALT>$<HASH>. A canonical python script is included in share/rpcuser. The client then connects normally using the rpcuser=<USERNAME>/rpcpassword=<PASSWORD> pair of arguments. This option can be specified multiple times"));
+    strUsage += HelpMessageOpt("-rpcbatchlockgroups", strprintf(_("Run consecutive chain state reads of a JSON-RPC batch under one lock of the chain state (default: %u)"), DEFAULT_RPC_BATCH_LOCK_GROUPS));
+    strUsage += HelpMessageOpt("-rpcbatchmaxsize=<n>", strprintf(_("Reject JSON-RPC batches of more than <n> requests, 0 for no limit (default: %d)"), DEFAULT_RPC_BATCH_MAX_SIZE));
+    strUsage += HelpMessageOpt("-rpcbatchthreads=<n>", strprintf(_("Run the requests of a JSON-RPC batch on up to <n> more RPC threads, 0 to run them one after another (default: %d)"), DEFAULT_RPC_BATCH_THREADS));
+    strUsage += HelpMessageOpt("-rpcbatchtimeout=<n>", strprintf(_("Fail the requests of a JSON-RPC batch that did not start within <n> seconds, 0 for no limit (default: %d)"), DEFAULT_RPC_BATCH_TIMEOUT));
     strUsage += HelpMessageOpt("-rpcbind=<addr>[:port]", _("Bind to given address to listen for JSON-RPC connections. This option is ignored unless -rpcallowip is also passed. Port is optional and overrides -rpcport. Use [host]:port notation for IPv6. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost, or if -rpcallowip has been specified, 0.0.0.0 and :: i.e., all addresses)"));
     strUsage += HelpMessageOpt("-rpccookiefile=<loc>", _("Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)"));
     strUsage += HelpMessageOpt("-rpcpassword=<pw>", _("Password for JSON-RPC connections"));
@@ -571,9 +626,14 @@ std::string HelpMessage(HelpMessageMode mode)
     if (showDebug)
         strUsage += HelpMessageOpt("-rpcservertimeout=<n>", strprintf("Timeout during HTTP requests (default: %d)", DEFAULT_HTTP_SERVER_TIMEOUT));
     strUsage += HelpMessageOpt("-rpcthreads=<n>", strprintf(_("Set the number of threads to service RPC calls (default: %d)"), DEFAULT_HTTP_THREADS));
+#ifndef WIN32
+    strUsage += HelpMessageOpt("-rpcunix=<path>", _("Also listen for JSON-RPC connections on a unix socket at <path>, open to processes of the same user without a password. Relative paths will be prefixed by a net-specific datadir location."));
+#endif
     strUsage += HelpMessageOpt("-rpcuser=<user>", _("Username for JSON-RPC connections"));
-    if (showDebug)
+    if (showDebug) {
         strUsage += HelpMessageOpt("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE));
+        strUsage += HelpMessageOpt("-rpcworkqueuemax=<n>", strprintf("Let the work queue grow up to a depth of <n> for bursts of requests that are served quickly (default: %d)", DEFAULT_HTTP_WORKQUEUE_MAX));
+    }
     strUsage += HelpMessageOpt("-server", _("Accept command line and JSON-RPC commands"));
 
     return strUsage;
@@ -989,6 +1049,11 @@ bool AppInitParameterInteraction()
     if (gArgs.GetArg("-prune", 0)) {
         if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+        // The address and spent indexes are built from block undo data
+        if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX))
+            return InitError(_("Prune mode is incompatible with -addressindex."));
+        if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX))
+            return InitError(_("Prune mode is incompatible with -spentindex."));
     }
 
     // -bind and -whitebind can't be set when not listening
@@ -1111,6 +1176,8 @@ bool AppInitParameterInteraction()
     else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
         nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
 
+    blockFileMapCache.SetMaxFiles(std::max(0, std::min((int)gArgs.GetArg("-blockmapfiles", DEFAULT_BLOCK_MAP_FILES), MAX_BLOCK_MAP_FILES)));
+
     // block pruning; get the amount of disk space (in MiB) to allot for block & undo files
     int64_t nPruneArg = gArgs.GetArg("-prune", 0);
     if (nPruneArg < 0) {
@@ -1255,6 +1322,21 @@ bool AppInitSanityChecks()
     // Initialize elliptic curve code
     std::string sha256_algo = SHA256AutoDetect();
     LogPrintf("Using the '%s' SHA256 implementation\n", sha256_algo);
+    std::string sph_aes_algo = sph_aesni_autodetect();
+    LogPrintf("Using the '%s' Groestl/ECHO/SHAvite implementation\n", sph_aes_algo);
+    std::string yescrypt_algo = yescrypt_autodetect();
+    LogPrintf("Using the '%s' yescrypt implementation\n", yescrypt_algo);
+    std::string yespower_algo = yespower_autodetect();
+    LogPrintf("Using the '%s' yespower implementation\n", yespower_algo);
+    std::string argon2_algo = argon2_autodetect();
+    LogPrintf("Using the '%s' Argon2 implementation\n", argon2_algo);
+    LogPrintf("%s\n", scrypt_detect_sse2());
+    std::string scrypt_multi_algo = scrypt_multi_autodetect();
+    LogPrintf("Using the '%s' multi-buffer scrypt implementation\n", scrypt_multi_algo);
+    std::string neoscrypt_multi_algo = neoscrypt_multi_autodetect();
+    LogPrintf("Using the '%s' multi-buffer NeoScrypt implementation\n", neoscrypt_multi_algo);
+    std::string hashchain_multi_algo = hashchain_multi_autodetect();
+    LogPrintf("Using the '%s' multi-buffer hash chain implementation\n", hashchain_multi_algo);
     RandomInit();
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
@@ -1318,6 +1400,15 @@ bool AppInitMain()
 
     InitSignatureCache();
     InitScriptExecutionCache();
+    InitPoWCache();
+
+    if (gArgs.GetBoolArg("-lockprofile", DEFAULT_LOCK_PROFILE)) {
+        ProfileLock(cs_main, "cs_main");
+        ProfileLock(mempool.cs, "mempool.cs");
+        mnodeman.ProfileListLock();
+        ProfileLock(instantsend.cs_instantsend, "cs_instantsend");
+        ProfileLock(cs_mapMasternodeBlocks, "cs_mapMasternodeBlocks");
+    }
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
@@ -1325,6 +1416,11 @@ bool AppInitMain()
             threadGroup.create_thread(&ThreadScriptCheck);
     }
 
+    int nArgon2LaneThreads = gArgs.GetArg("-argon2lanethreads", GetNumCores() > 1 ? 1 : 0);
+    nArgon2LaneThreads = std::max(0, std::min(nArgon2LaneThreads, MAX_ARGON2_LANE_THREADS));
+    LogPrintf("Using %d helper threads for Argon2 lanes\n", nArgon2LaneThreads);
+    Argon2StartLaneThreads(nArgon2LaneThreads);
+
     // Start the lightweight task scheduler thread
     CScheduler::Function serviceLoop = boost::bind(&CScheduler::serviceQueue, &scheduler);
     threadGroup.create_thread(boost::bind(&TraceThread<CScheduler::Function>, "scheduler", serviceLoop));
@@ -1354,11 +1450,6 @@ bool AppInitMain()
 
     int64_t nStart;
 
-#if defined(USE_SSE2)
-    std::string sse2detect = scrypt_detect_sse2();
-    LogPrintf("%s\n", sse2detect);
-#endif
-
     // ********************************************************* Step 5: verify wallet database integrity
 #ifdef ENABLE_WALLET
     if (!VerifyWallets())
@@ -1500,9 +1591,14 @@ bool AppInitMain()
     int64_t nTotalCache = (gArgs.GetArg("-dbcache", nDefaultDbCache) << 20);
     nTotalCache = std::max(nTotalCache, nMinDbCache << 20); // total cache cannot be less than nMinDbCache
     nTotalCache = std::min(nTotalCache, nMaxDbCache << 20); // total cache cannot be greater than nMaxDbcache
-    int64_t nBlockTreeDBCache = nTotalCache / 8;
-    nBlockTreeDBCache = std::min(nBlockTreeDBCache, (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxBlockDBAndTxIndexCache : nMaxBlockDBCache) << 20);
+    int64_t nBlockTreeDBCache = std::min(nTotalCache / 8, nMaxBlockDBCache << 20);
     nTotalCache -= nBlockTreeDBCache;
+    int64_t nTxIndexCache = std::min(nTotalCache / 8, gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache << 20 : 0);
+    nTotalCache -= nTxIndexCache;
+    int64_t nAddressIndexCache = std::min(nTotalCache / 8, gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) ? nMaxAddressIndexCache << 20 : 0);
+    nTotalCache -= nAddressIndexCache;
+    int64_t nSpentIndexCache = std::min(nTotalCache / 8, gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX) ? nMaxAddressIndexCache << 20 : 0);
+    nTotalCache -= nSpentIndexCache;
     int64_t nCoinDBCache = std::min(nTotalCache / 2, (nTotalCache / 4) + (1 << 23)); // use 25%-50% of the remainder for disk cache
     nCoinDBCache = std::min(nCoinDBCache, nMaxCoinsDBCache << 20); // cap total coins db cache
     nTotalCache -= nCoinDBCache;
@@ -1510,6 +1606,15 @@ bool AppInitMain()
     int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
     LogPrintf("Cache configuration:\n");
     LogPrintf("* Using %.1fMiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
+    if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
+        LogPrintf("* Using %.1fMiB for transaction index database\n", nTxIndexCache * (1.0 / 1024 / 1024));
+    }
+    if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
+        LogPrintf("* Using %.1fMiB for address index database\n", nAddressIndexCache * (1.0 / 1024 / 1024));
+    }
+    if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
+        LogPrintf("* Using %.1fMiB for spent index database\n", nSpentIndexCache * (1.0 / 1024 / 1024));
+    }
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set (plus up to %.1fMiB of unused mempool space)\n", nCoinCacheUsage * (1.0 / 1024 / 1024), nMempoolSizeMax * (1.0 / 1024 / 1024));
 
@@ -1541,9 +1646,8 @@ bool AppInitMain()
 
                 if (fRequestShutdown) break;
 
-                // LoadBlockIndex will load fTxIndex from the db, or set it if
-                // we're reindexing. It will also load fHavePruned if we've
-                // ever removed a block file from disk.
+                // LoadBlockIndex will load fHavePruned if we've ever removed a
+                // block file from disk.
                 // Note that it also sets fReindex based on the disk flag!
                 // From here on out fReindex and fReset mean something different!
                 if (!LoadBlockIndex(chainparams)) {
@@ -1556,12 +1660,6 @@ bool AppInitMain()
                 if (!mapBlockIndex.empty() && mapBlockIndex.count(chainparams.GetConsensus().hashGenesisBlock) == 0)
                     return InitError(_("Incorrect or no genesis block found. Wrong datadir for network?"));
 
-                // Check for changed -txindex state
-                if (fTxIndex != gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex to change -txindex");
-                    break;
-                }
-
                 // Check for changed -prune state.  What we are concerned about is a user who has pruned blocks
                 // in the past, but is now trying to run unpruned.
                 if (fHavePruned && !fPruneMode) {
@@ -1713,6 +1811,23 @@ bool AppInitMain()
         LogPrintf("Initial auxpow validation disabled by user request... skipping ...\n");
     }
 
+    // ********************************************************* Step 8a: start indexers
+
+    // The transaction, address and spent indexes are built in the background,
+    // so turning them on does not need a reindex.
+    if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
+        g_txindex = MakeUnique<TxIndex>(nTxIndexCache, false, fReindex);
+        g_txindex->Start();
+    }
+    if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
+        g_addressindex = MakeUnique<AddressIndex>(nAddressIndexCache, false, fReindex);
+        g_addressindex->Start();
+    }
+    if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
+        g_spentindex = MakeUnique<SpentIndex>(nSpentIndexCache, false, fReindex);
+        g_spentindex->Start();
+    }
+
     // ********************************************************* Step 9: load wallet
 #ifdef ENABLE_WALLET
     if (!OpenWallets())
@@ -1803,7 +1918,7 @@ bool AppInitMain()
         InitWarning(_("You are starting in lite mode, all Globaltoken-specific functionality is disabled."));
     }
 
-    if((!fLiteMode && fTxIndex == false)
+    if((!fLiteMode && !gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX))
        && chainparams.NetworkIDString() != CBaseChainParams::REGTEST) { // TODO remove this when pruning is fixed. See https://github.com/dashpay/dash/pull/1817 and https://github.com/dashpay/dash/pull/1743
         return InitError(_("Transaction index can't be disabled in full mode. Either start with -litemode command line switch or enable transaction index."));
     }
@@ -1940,6 +2055,7 @@ bool AppInitMain()
     connOptions.nSendBufferMaxSize = 1000*gArgs.GetArg("-maxsendbuffer", DEFAULT_MAXSENDBUFFER);
     connOptions.nReceiveFloodSize = 1000*gArgs.GetArg("-maxreceivebuffer", DEFAULT_MAXRECEIVEBUFFER);
     connOptions.m_added_nodes = gArgs.GetArgs("-addnode");
+    connOptions.nMsgWorkerThreads = std::max(0, std::min((int)gArgs.GetArg("-msgworkers", DEFAULT_MSG_WORKER_THREADS), MAX_MSG_WORKER_THREADS));
 
     connOptions.nMaxOutboundTimeframe = nMaxOutboundTimeframe;
     connOptions.nMaxOutboundLimit = nMaxOutboundLimit;
@@ -1984,6 +2100,11 @@ bool AppInitMain()
         return false;
     }
 
+    if (!InitStratumServer()) {
+        return false;
+    }
+    StartStratumServer();
+
     // ********************************************************* Step 14: finished
 
     SetRPCWarmupFinished();
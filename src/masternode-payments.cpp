@@ -14,6 +14,7 @@
 #include <netmessagemaker.h>
 #include <spork.h>
 #include <util.h>
+#include <validationinterface.h>
 
 #include <boost/lexical_cast.hpp>
 
@@ -179,7 +180,10 @@ void CMasternodePayments::ProcessMessage(CNode* pfrom, const std::string& strCom
 
         uint256 nHash = vote.GetHash();
 
-        pfrom->setAskFor.erase(nHash);
+        {
+            LOCK(cs_main);
+            pfrom->setAskFor.erase(nHash);
+        }
 
         // TODO: clear setAskFor for MSG_MASTERNODE_PAYMENT_BLOCK too
 
@@ -358,6 +362,7 @@ bool CMasternodePayments::AddOrUpdatePaymentVote(const CMasternodePaymentVote& v
     it->second.AddPayee(vote);
 
     LogPrint(BCLog::MNPAYMENTS, "CMasternodePayments::AddOrUpdatePaymentVote -- added, hash=%s\n", nVoteHash.ToString());
+    GetMainSignals().NotifyMasternodePaymentVote(vote);
 
     return true;
 }
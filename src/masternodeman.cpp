@@ -15,6 +15,7 @@
 #include <script/standard.h>
 #include <ui_interface.h>
 #include <util.h>
+#include <validationinterface.h>
 #include <warnings.h>
 
 /** Masternode manager */
@@ -64,6 +65,7 @@ CMasternodeMan::CMasternodeMan():
     listScheduledMnbRequestConnections(),
     fMasternodesAdded(false),
     fMasternodesRemoved(false),
+    fSnapshotStale(true),
     mapSeenMasternodeBroadcast(),
     mapSeenMasternodePing()
 {}
@@ -77,6 +79,7 @@ bool CMasternodeMan::Add(CMasternode &mn)
     LogPrint(BCLog::MASTERNODE, "CMasternodeMan::Add -- Adding new Masternode: addr=%s, %i now\n", mn.addr.ToString(), size() + 1);
     mapMasternodes[mn.outpoint] = mn;
     fMasternodesAdded = true;
+    fSnapshotStale = true;
     return true;
 }
 
@@ -123,6 +126,7 @@ bool CMasternodeMan::PoSeBan(const COutPoint &outpoint)
         return false;
     }
     pmn->PoSeBan();
+    fSnapshotStale = true;
 
     return true;
 }
@@ -136,7 +140,16 @@ void CMasternodeMan::Check()
     for (auto& mnpair : mapMasternodes) {
         // NOTE: internally it checks only every MASTERNODE_CHECK_SECONDS seconds
         // since the last time, so expect some MNs to skip this
+        const int nActiveStateOld = mnpair.second.nActiveState;
         mnpair.second.Check();
+        if (mnpair.second.nActiveState != nActiveStateOld) {
+            fSnapshotStale = true;
+        }
+    }
+
+    // Publish what changed since the last run, so readers of the list never wait for cs
+    if (fSnapshotStale) {
+        PublishSnapshot();
     }
 }
 
@@ -172,6 +185,7 @@ void CMasternodeMan::CheckAndRemove(CConnman& connman)
                 // and finally remove it from the list
                 mapMasternodes.erase(it++);
                 fMasternodesRemoved = true;
+                fSnapshotStale = true;
             } else {
                 bool fAsk = (nAskForMnbRecovery > 0) &&
                             masternodeSync.IsSynced() &&
@@ -327,6 +341,7 @@ void CMasternodeMan::Clear()
 {
     LOCK(cs);
     mapMasternodes.clear();
+    fSnapshotStale = true;
     mAskedUsForMasternodeList.clear();
     mWeAskedForMasternodeList.clear();
     mWeAskedForMasternodeListEntry.clear();
@@ -413,6 +428,58 @@ CMasternode* CMasternodeMan::Find(const COutPoint &outpoint)
     return it == mapMasternodes.end() ? nullptr : &(it->second);
 }
 
+void CMasternodeMan::PublishSnapshot()
+{
+    AssertLockHeld(cs);
+    std::shared_ptr<CMasternodeListSnapshot> snapshotNew = std::make_shared<CMasternodeListSnapshot>();
+    snapshotNew->vMasternodes.reserve(mapMasternodes.size());
+    for (const auto& mnpair : mapMasternodes) {
+        const CMasternode& mn = mnpair.second;
+        snapshotNew->vMasternodes.push_back(CMasternodeListEntry{mn.GetInfo(), mn.lastPing.nDaemonVersion, mn.GetLastPaidBlock()});
+    }
+    snapshotNew->nTimeCreated = GetTime();
+    fSnapshotStale = false;
+    CMasternodeListSnapshotRef snapshotOld = std::atomic_load(&snapshot);
+    CMasternodeListSnapshotRef snapshotRef(std::move(snapshotNew));
+    std::atomic_store(&snapshot, snapshotRef);
+    GetMainSignals().NotifyMasternodeListChanged(snapshotOld, snapshotRef);
+}
+
+CMasternodeListSnapshotRef CMasternodeMan::GetMasternodeListSnapshot()
+{
+    CMasternodeListSnapshotRef snapshotRet = std::atomic_load(&snapshot);
+    if (!snapshotRet || (fSnapshotStale && GetTime() - snapshotRet->nTimeCreated >= SNAPSHOT_MAX_AGE_SECONDS)) {
+        LOCK(cs);
+        if (fSnapshotStale || !snapshot) {
+            PublishSnapshot();
+        }
+        snapshotRet = std::atomic_load(&snapshot);
+    }
+    return snapshotRet;
+}
+
+masternode_list_changes_t DiffMasternodeListSnapshots(const CMasternodeListSnapshot& snapshotOld, const CMasternodeListSnapshot& snapshotNew)
+{
+    // Both lists are in outpoint order, so one merge pass finds the changes
+    masternode_list_changes_t vChanges;
+    auto itOld = snapshotOld.vMasternodes.begin();
+    auto itNew = snapshotNew.vMasternodes.begin();
+    while (itOld != snapshotOld.vMasternodes.end() || itNew != snapshotNew.vMasternodes.end()) {
+        if (itNew == snapshotNew.vMasternodes.end() || (itOld != snapshotOld.vMasternodes.end() && itOld->info.outpoint < itNew->info.outpoint)) {
+            vChanges.emplace_back(MasternodeListChange::REMOVED, &*itOld++);
+        } else if (itOld == snapshotOld.vMasternodes.end() || itNew->info.outpoint < itOld->info.outpoint) {
+            vChanges.emplace_back(MasternodeListChange::ADDED, &*itNew++);
+        } else {
+            if (itNew->info.nActiveState != itOld->info.nActiveState) {
+                vChanges.emplace_back(MasternodeListChange::STATE, &*itNew);
+            }
+            ++itOld;
+            ++itNew;
+        }
+    }
+    return vChanges;
+}
+
 bool CMasternodeMan::Get(const COutPoint& outpoint, CMasternode& masternodeRet)
 {
     // Theses mutexes are recursive so double locking by the same thread is safe.
@@ -771,7 +838,10 @@ void CMasternodeMan::ProcessMessage(CNode* pfrom, const std::string& strCommand,
         CMasternodeBroadcast mnb;
         vRecv >> mnb;
 
-        pfrom->setAskFor.erase(mnb.GetHash());
+        {
+            LOCK(cs_main);
+            pfrom->setAskFor.erase(mnb.GetHash());
+        }
 
         if(!masternodeSync.IsBlockchainSynced()) return;
 
@@ -797,7 +867,10 @@ void CMasternodeMan::ProcessMessage(CNode* pfrom, const std::string& strCommand,
 
         uint256 nHash = mnp.GetHash();
 
-        pfrom->setAskFor.erase(nHash);
+        {
+            LOCK(cs_main);
+            pfrom->setAskFor.erase(nHash);
+        }
 
         if(!masternodeSync.IsBlockchainSynced()) return;
 
@@ -818,7 +891,10 @@ void CMasternodeMan::ProcessMessage(CNode* pfrom, const std::string& strCommand,
         if(pmn && pmn->IsNewStartRequired()) return;
 
         int nDos = 0;
-        if(mnp.CheckAndUpdate(pmn, false, nDos, connman)) return;
+        if(mnp.CheckAndUpdate(pmn, false, nDos, connman)) {
+            fSnapshotStale = true;
+            return;
+        }
 
         if(nDos > 0) {
             // if anything significant failed, mark that node
@@ -864,7 +940,10 @@ void CMasternodeMan::ProcessMessage(CNode* pfrom, const std::string& strCommand,
         CMasternodeVerification mnv;
         vRecv >> mnv;
 
-        pfrom->setAskFor.erase(mnv.GetHash());
+        {
+            LOCK(cs_main);
+            pfrom->setAskFor.erase(mnv.GetHash());
+        }
 
         if(!masternodeSync.IsMasternodeListSynced()) return;
 
@@ -1543,6 +1622,7 @@ bool CMasternodeMan::CheckMnbAndUpdateMasternodeList(CNode* pfrom, CMasternodeBr
                 LogPrint(BCLog::MASTERNODE, "CMasternodeMan::CheckMnbAndUpdateMasternodeList -- Update() failed, masternode=%s\n", mnb.outpoint.ToStringShort());
                 return false;
             }
+            fSnapshotStale = true;
             if(hash != mnbOld.GetHash()) {
                 mapSeenMasternodeBroadcast.erase(mnbOld.GetHash());
             }
@@ -1593,7 +1673,11 @@ void CMasternodeMan::UpdateLastPaid(const CBlockIndex* pindex)
                             nCachedBlockHeight, nLastRunBlockHeight, nMaxBlocksToScanBack);
 
     for (auto& mnpair : mapMasternodes) {
+        const int nBlockLastPaidOld = mnpair.second.GetLastPaidBlock();
         mnpair.second.UpdateLastPaid(pindex, nMaxBlocksToScanBack);
+        if (mnpair.second.GetLastPaidBlock() != nBlockLastPaidOld) {
+            fSnapshotStale = true;
+        }
     }
 
     nLastRunBlockHeight = nCachedBlockHeight;
@@ -1605,6 +1689,7 @@ void CMasternodeMan::CheckMasternode(const CPubKey& pubKeyMasternode, bool fForc
     for (auto& mnpair : mapMasternodes) {
         if (mnpair.second.pubKeyMasternode == pubKeyMasternode) {
             mnpair.second.Check(fForce);
+            fSnapshotStale = true;
             return;
         }
     }
@@ -1625,6 +1710,7 @@ void CMasternodeMan::SetMasternodeLastPing(const COutPoint& outpoint, const CMas
         return;
     }
     pmn->lastPing = mnp;
+    fSnapshotStale = true;
     mapSeenMasternodePing.insert(std::make_pair(mnp.GetHash(), mnp));
 
     CMasternodeBroadcast mnb(*pmn);
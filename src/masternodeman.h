@@ -8,11 +8,51 @@
 #include <masternode.h>
 #include <sync.h>
 
+#include <atomic>
+#include <memory>
+
 class CMasternodeMan;
 class CConnman;
 
 extern CMasternodeMan mnodeman;
 
+/** One masternode of a list snapshot: its info and what the lists show of its last ping and payment */
+struct CMasternodeListEntry
+{
+    masternode_info_t info;
+    uint32_t nDaemonVersion;
+    int nBlockLastPaid;
+
+    std::string GetStatus() const { return CMasternode::StateToString(info.nActiveState); }
+};
+
+/**
+ * The masternode list at one point in time. It is never changed once
+ * published, so readers can keep using it without holding any lock.
+ */
+struct CMasternodeListSnapshot
+{
+    //! In outpoint order
+    std::vector<CMasternodeListEntry> vMasternodes;
+    int64_t nTimeCreated;
+};
+
+typedef std::shared_ptr<const CMasternodeListSnapshot> CMasternodeListSnapshotRef;
+
+enum class MasternodeListChange {
+    ADDED,
+    REMOVED,
+    STATE
+};
+
+typedef std::vector<std::pair<MasternodeListChange, const CMasternodeListEntry*>> masternode_list_changes_t;
+
+/**
+ * The masternodes added, removed or with another state in snapshotNew. The
+ * entries point into the snapshots (removed ones into snapshotOld).
+ */
+masternode_list_changes_t DiffMasternodeListSnapshots(const CMasternodeListSnapshot& snapshotOld, const CMasternodeListSnapshot& snapshotNew);
+
 class CMasternodeMan
 {
 public:
@@ -39,10 +79,19 @@ private:
     static const int MNB_RECOVERY_WAIT_SECONDS      = 60;
     static const int MNB_RECOVERY_RETRY_SECONDS     = 3 * 60 * 60;
 
+    // Readers publish a stale list snapshot themselves once it is this old,
+    // Check() normally does it every second
+    static const int SNAPSHOT_MAX_AGE_SECONDS       = 1;
+
 
     // critical section to protect the inner data structures
     mutable CCriticalSection cs;
 
+    // The last published list snapshot, only accessed with std::atomic_load/store
+    CMasternodeListSnapshotRef snapshot;
+    // Set when the list changed since the snapshot was published
+    std::atomic<bool> fSnapshotStale;
+
     // Keep track of current block height
     int nCachedBlockHeight;
 
@@ -83,6 +132,9 @@ private:
 
     void PushDsegInvs(CNode* pnode, const CMasternode& mn);
 
+    /// Publish a snapshot of the current list, cs must be held
+    void PublishSnapshot();
+
 public:
     // Keep track of all broadcasts I've seen
     std::map<uint256, std::pair<int64_t, CMasternodeBroadcast> > mapSeenMasternodeBroadcast;
@@ -122,6 +174,9 @@ public:
 
     CMasternodeMan();
 
+    /// Profile the waits for and holds of cs (see ProfileLock)
+    void ProfileListLock() { ProfileLock(cs, "mnodeman.cs"); }
+
     /// Add an entry
     bool Add(CMasternode &mn);
 
@@ -170,7 +225,8 @@ public:
     /// Find a random entry
     masternode_info_t FindRandomNotInVec(const std::vector<COutPoint> &vecToExclude, int nProtocolVersion = -1);
 
-    std::map<COutPoint, CMasternode> GetFullMasternodeMap() { return mapMasternodes; }
+    /// The masternode list as of the last change, without taking cs unless none was published yet
+    CMasternodeListSnapshotRef GetMasternodeListSnapshot();
 
     bool GetMasternodeRanks(rank_pair_vec_t& vecMasternodeRanksRet, int nBlockHeight = -1, int nMinProtocol = 0);
     bool GetMasternodeRank(const COutPoint &outpoint, int& nRankRet, int nBlockHeight = -1, int nMinProtocol = 0);
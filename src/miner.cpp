@@ -46,8 +46,8 @@
 // pool, we select by highest fee rate of a transaction combined with all
 // its ancestors.
 
-uint64_t nLastBlockTx = 0;
-uint64_t nLastBlockWeight = 0;
+std::atomic<uint64_t> nLastBlockTx{0};
+std::atomic<uint64_t> nLastBlockWeight{0};
 
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev, uint8_t algo)
 {
@@ -508,3 +508,63 @@ void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned
     pblock->vtx[0] = MakeTransactionRef(std::move(txCoinbase));
     pblock->hashMerkleRoot = BlockMerkleRoot(*pblock);
 }
+
+void CAuxBlockTemplateCache::Evict(int64_t nNow)
+{
+    for (auto it = mapBlocks.begin(); it != mapBlocks.end();) {
+        if (it->second.nTimeReplaced != 0 && nNow - it->second.nTimeReplaced > AUXBLOCK_TEMPLATE_EXPIRY)
+            it = mapBlocks.erase(it);
+        else
+            ++it;
+    }
+    while (mapBlocks.size() > MAX_AUXBLOCK_TEMPLATES) {
+        auto itOldest = mapBlocks.end();
+        for (auto it = mapBlocks.begin(); it != mapBlocks.end(); ++it) {
+            if (it->second.nTimeReplaced != 0 && (itOldest == mapBlocks.end() || it->second.nTimeReplaced < itOldest->second.nTimeReplaced))
+                itOldest = it;
+        }
+        // The current blocks, one per algo, are never evicted
+        if (itOldest == mapBlocks.end())
+            break;
+        mapBlocks.erase(itOldest);
+    }
+}
+
+CBlock* CAuxBlockTemplateCache::Add(std::unique_ptr<CBlockTemplate> pblocktemplate, int64_t nNow)
+{
+    const uint256 hash = pblocktemplate->block.GetHash();
+    const uint8_t nAlgo = pblocktemplate->block.GetAlgo();
+
+    auto itCurrent = mapCurrent.find(nAlgo);
+    if (itCurrent != mapCurrent.end()) {
+        auto it = mapBlocks.find(itCurrent->second);
+        // Zero is reserved for the current blocks
+        if (it != mapBlocks.end() && it->first != hash)
+            it->second.nTimeReplaced = std::max<int64_t>(nNow, 1);
+    }
+    mapCurrent[nAlgo] = hash;
+
+    Entry& entry = mapBlocks[hash];
+    entry.pblocktemplate = std::move(pblocktemplate);
+    entry.nTimeReplaced = 0;
+    Evict(nNow);
+    return &entry.pblocktemplate->block;
+}
+
+CBlock* CAuxBlockTemplateCache::Find(const uint256& hash)
+{
+    auto it = mapBlocks.find(hash);
+    return it != mapBlocks.end() ? &it->second.pblocktemplate->block : nullptr;
+}
+
+CBlock* CAuxBlockTemplateCache::GetCurrent(uint8_t nAlgo)
+{
+    auto itCurrent = mapCurrent.find(nAlgo);
+    return itCurrent != mapCurrent.end() ? Find(itCurrent->second) : nullptr;
+}
+
+void CAuxBlockTemplateCache::Clear()
+{
+    mapBlocks.clear();
+    mapCurrent.clear();
+}
@@ -9,6 +9,7 @@
 #include <primitives/block.h>
 #include <txmempool.h>
 
+#include <map>
 #include <stdint.h>
 #include <memory>
 #include <boost/multi_index_container.hpp>
@@ -21,6 +22,10 @@ class CScript;
 namespace Consensus { struct Params; };
 
 static const bool DEFAULT_PRINTPRIORITY = false;
+//! Seconds that a superseded auxpow block stays available to submitauxblock
+static const int64_t AUXBLOCK_TEMPLATE_EXPIRY = 10 * 60;
+//! Maximum number of auxpow blocks kept for submitauxblock
+static const size_t MAX_AUXBLOCK_TEMPLATES = 100;
 
 struct CBlockTemplate
 {
@@ -192,6 +197,40 @@ private:
     int UpdatePackagesForAdded(const CTxMemPool::setEntries& alreadyAdded, indexed_modified_transaction_set &mapModifiedTx);
 };
 
+/**
+ * The auxpow blocks handed out by createauxblock and getauxblock, by hash,
+ * so that submitauxblock can find them. Each algo has a current block. A
+ * block that a newer one of its algo replaced is kept for
+ * AUXBLOCK_TEMPLATE_EXPIRY seconds for the work still in flight, and the
+ * oldest replaced blocks are evicted beyond MAX_AUXBLOCK_TEMPLATES, so
+ * memory stays bounded no matter how often new blocks are requested.
+ *
+ * Not thread safe, the RPC code locks cs_auxblockCache.
+ */
+class CAuxBlockTemplateCache
+{
+private:
+    struct Entry
+    {
+        std::unique_ptr<CBlockTemplate> pblocktemplate;
+        //! When a newer block of the algo replaced this one, 0 while it is current
+        int64_t nTimeReplaced;
+    };
+    std::map<uint256, Entry> mapBlocks;
+    std::map<uint8_t, uint256> mapCurrent;
+
+    void Evict(int64_t nNow);
+
+public:
+    /** Add a block, which becomes the current one of its algo */
+    CBlock* Add(std::unique_ptr<CBlockTemplate> pblocktemplate, int64_t nNow);
+    CBlock* Find(const uint256& hash);
+    CBlock* GetCurrent(uint8_t nAlgo);
+    /** Forget all blocks, once the tip changed */
+    void Clear();
+    size_t Size() const { return mapBlocks.size(); }
+};
+
 /** Modify the extranonce in a block */
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce);
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev, uint8_t algo);
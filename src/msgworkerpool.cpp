@@ -0,0 +1,168 @@
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <msgworkerpool.h>
+
+#include <net.h>
+#include <util.h>
+#include <utiltime.h>
+
+#include <algorithm>
+#include <cassert>
+
+std::string GetMessageWorkerCategoryName(int nCategory)
+{
+    switch (nCategory) {
+        case MSG_WORKER_MASTERNODE:  return "masternode";
+        case MSG_WORKER_PAYMENT:     return "payment";
+        case MSG_WORKER_INSTANTSEND: return "instantsend";
+        case MSG_WORKER_SPORK:       return "spork";
+        case MSG_WORKER_GETDATA:     return "getdata";
+    }
+    return "unknown";
+}
+
+static void UpdateMax(std::atomic<int64_t>& nMax, int64_t nValue)
+{
+    int64_t nPrev = nMax.load();
+    while (nValue > nPrev && !nMax.compare_exchange_weak(nPrev, nValue)) {}
+}
+
+CMessageWorkerPool::CMessageWorkerPool(std::function<void()> wakeHandlerIn) :
+    wakeHandler(wakeHandlerIn), fInterrupt(false)
+{
+}
+
+CMessageWorkerPool::~CMessageWorkerPool()
+{
+    Interrupt();
+    Stop();
+}
+
+void CMessageWorkerPool::Start(int nThreads)
+{
+    assert(vThreads.empty());
+    nThreads = std::min(nThreads, MAX_MSG_WORKER_THREADS);
+    if (nThreads <= 0)
+        return;
+
+    fInterrupt = false;
+    vQueues.clear();
+    for (int i = 0; i < nThreads; i++)
+        vQueues.emplace_back(new WorkQueue());
+    for (int i = 0; i < nThreads; i++) {
+        WorkQueue& queue = *vQueues[i];
+        vThreads.emplace_back(&TraceThread<std::function<void()> >, "msgworker", std::function<void()>([this, &queue] { ThreadWorker(queue); }));
+    }
+    LogPrintf("Using %d threads for offloaded peer message processing\n", nThreads);
+}
+
+void CMessageWorkerPool::Interrupt()
+{
+    fInterrupt = true;
+    for (auto& queue : vQueues) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->cond.notify_all();
+    }
+}
+
+void CMessageWorkerPool::Stop()
+{
+    for (std::thread& thread : vThreads) {
+        if (thread.joinable())
+            thread.join();
+    }
+    vThreads.clear();
+
+    // Drop whatever was not run, releasing the node references
+    for (auto& queue : vQueues) {
+        std::deque<Job> jobs;
+        {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            jobs.swap(queue->jobs);
+        }
+        for (Job& job : jobs)
+            FinishJob(job);
+    }
+    vQueues.clear();
+}
+
+void CMessageWorkerPool::Enqueue(CNode* pnode, int nCategory, Function func)
+{
+    assert(nCategory >= 0 && nCategory < MSG_WORKER_CATEGORY_MAX);
+    assert(!vQueues.empty());
+
+    Job job;
+    job.pnode = pnode->AddRef();
+    job.nCategory = nCategory;
+    job.nTimeQueued = GetTimeMicros();
+    job.func = std::move(func);
+
+    pnode->nPendingWorkerMsgs++;
+    counters[nCategory].nQueued++;
+
+    WorkQueue& queue = *vQueues[pnode->GetId() % vQueues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    queue.cond.notify_one();
+}
+
+void CMessageWorkerPool::FinishJob(Job& job)
+{
+    counters[job.nCategory].nQueued--;
+    bool fWake = --job.pnode->nPendingWorkerMsgs == 0;
+    job.pnode->Release();
+    if (fWake)
+        wakeHandler();
+}
+
+void CMessageWorkerPool::ThreadWorker(WorkQueue& queue)
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.cond.wait(lock, [&] { return fInterrupt || !queue.jobs.empty(); });
+            if (fInterrupt)
+                return;
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+
+        CategoryCounters& cat = counters[job.nCategory];
+        int64_t nTimeStart = GetTimeMicros();
+        int64_t nWait = nTimeStart - job.nTimeQueued;
+        cat.nTotalWaitMicros += nWait;
+        UpdateMax(cat.nMaxWaitMicros, nWait);
+
+        if (!job.pnode->fDisconnect)
+            job.func();
+
+        int64_t nRun = GetTimeMicros() - nTimeStart;
+        cat.nTotalRunMicros += nRun;
+        UpdateMax(cat.nMaxRunMicros, nRun);
+        cat.nProcessed++;
+
+        FinishJob(job);
+    }
+}
+
+void CMessageWorkerPool::GetStats(std::vector<CMessageWorkerCategoryStats>& vStats) const
+{
+    vStats.clear();
+    vStats.reserve(MSG_WORKER_CATEGORY_MAX);
+    for (int i = 0; i < MSG_WORKER_CATEGORY_MAX; i++) {
+        CMessageWorkerCategoryStats stats;
+        stats.strName = GetMessageWorkerCategoryName(i);
+        stats.nQueued = counters[i].nQueued;
+        stats.nProcessed = counters[i].nProcessed;
+        stats.nTotalWaitMicros = counters[i].nTotalWaitMicros;
+        stats.nMaxWaitMicros = counters[i].nMaxWaitMicros;
+        stats.nTotalRunMicros = counters[i].nTotalRunMicros;
+        stats.nMaxRunMicros = counters[i].nMaxRunMicros;
+        vStats.push_back(stats);
+    }
+}
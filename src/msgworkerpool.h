@@ -0,0 +1,120 @@
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_MSGWORKERPOOL_H
+#define BITCOIN_MSGWORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CNode;
+
+/** Default for -msgworkers, number of threads handling offloaded peer messages (0 = disabled) */
+static const int DEFAULT_MSG_WORKER_THREADS = 2;
+/** Maximum number of message worker threads */
+static const int MAX_MSG_WORKER_THREADS = 16;
+
+/**
+ * Categories of peer messages that can be processed outside of the
+ * message handler thread. None of them need cs_main for their heavy
+ * part (signature verification, disk reads), so running them in
+ * parallel keeps block and transaction relay responsive.
+ */
+enum MessageWorkerCategory
+{
+    MSG_WORKER_MASTERNODE,      // mnb, mnp, mnv, dseg
+    MSG_WORKER_PAYMENT,         // mnw, mnget
+    MSG_WORKER_INSTANTSEND,     // txlvote
+    MSG_WORKER_SPORK,           // spork, getsporks
+    MSG_WORKER_GETDATA,         // getdata serving
+    MSG_WORKER_CATEGORY_MAX
+};
+
+std::string GetMessageWorkerCategoryName(int nCategory);
+
+struct CMessageWorkerCategoryStats
+{
+    std::string strName;
+    uint64_t nQueued;           // currently waiting or running
+    uint64_t nProcessed;        // total completed
+    int64_t nTotalWaitMicros;   // total time between queueing and start
+    int64_t nMaxWaitMicros;
+    int64_t nTotalRunMicros;    // total time spent executing
+    int64_t nMaxRunMicros;
+};
+
+/**
+ * Thread pool for peer messages that do not have to run on the message
+ * handler thread.
+ *
+ * Every peer is pinned to one worker queue, so messages handed over from
+ * the same peer are executed in the order they were received. While a
+ * peer has messages pending in the pool, the message handler must not
+ * process any other message from that peer; CNode::nPendingWorkerMsgs
+ * tracks this and the handler is woken once it drops back to zero.
+ */
+class CMessageWorkerPool
+{
+public:
+    typedef std::function<void()> Function;
+
+    explicit CMessageWorkerPool(std::function<void()> wakeHandlerIn);
+    ~CMessageWorkerPool();
+
+    void Start(int nThreads);
+    void Interrupt();
+    void Stop();
+
+    bool IsRunning() const { return !vThreads.empty(); }
+    int GetThreadCount() const { return vThreads.size(); }
+
+    /** Queue func for execution on behalf of pnode. Takes a reference on pnode until func has run. */
+    void Enqueue(CNode* pnode, int nCategory, Function func);
+
+    void GetStats(std::vector<CMessageWorkerCategoryStats>& vStats) const;
+
+private:
+    struct Job
+    {
+        CNode* pnode;
+        int nCategory;
+        int64_t nTimeQueued;
+        Function func;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<Job> jobs;
+    };
+
+    struct CategoryCounters
+    {
+        std::atomic<uint64_t> nQueued{0};
+        std::atomic<uint64_t> nProcessed{0};
+        std::atomic<int64_t> nTotalWaitMicros{0};
+        std::atomic<int64_t> nMaxWaitMicros{0};
+        std::atomic<int64_t> nTotalRunMicros{0};
+        std::atomic<int64_t> nMaxRunMicros{0};
+    };
+
+    void ThreadWorker(WorkQueue& queue);
+    void FinishJob(Job& job);
+
+    std::function<void()> wakeHandler;
+    std::vector<std::unique_ptr<WorkQueue>> vQueues;
+    std::vector<std::thread> vThreads;
+    std::atomic<bool> fInterrupt;
+    CategoryCounters counters[MSG_WORKER_CATEGORY_MAX];
+};
+
+#endif // BITCOIN_MSGWORKERPOOL_H
@@ -1464,6 +1464,20 @@ void CConnman::WakeMessageHandler()
     condMsgProc.notify_one();
 }
 
+bool CConnman::QueueWorkerMessage(CNode* pnode, int nCategory, std::function<void()> func)
+{
+    if (!msgWorkerPool.IsRunning() || flagInterruptMsgProc)
+        return false;
+    msgWorkerPool.Enqueue(pnode, nCategory, std::move(func));
+    return true;
+}
+
+bool CConnman::GetMessageWorkerStats(std::vector<CMessageWorkerCategoryStats>& vStats) const
+{
+    msgWorkerPool.GetStats(vStats);
+    return msgWorkerPool.IsRunning();
+}
+
 
 
 
@@ -2263,7 +2277,8 @@ void CConnman::SetNetworkActive(bool active)
     uiInterface.NotifyNetworkActiveChanged(fNetworkActive);
 }
 
-CConnman::CConnman(uint64_t nSeed0In, uint64_t nSeed1In) : addrman(Params().AllowMultiplePorts()), nSeed0(nSeed0In), nSeed1(nSeed1In)
+CConnman::CConnman(uint64_t nSeed0In, uint64_t nSeed1In) : addrman(Params().AllowMultiplePorts()), nSeed0(nSeed0In), nSeed1(nSeed1In),
+    msgWorkerPool(std::bind(&CConnman::WakeMessageHandler, this))
 {
     fNetworkActive = true;
     setBannedIsDirty = false;
@@ -2429,6 +2444,7 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         threadOpenConnections = std::thread(&TraceThread<std::function<void()> >, "opencon", std::function<void()>(std::bind(&CConnman::ThreadOpenConnections, this, connOptions.m_specified_outgoing)));
 
     // Process messages
+    msgWorkerPool.Start(nMsgWorkerThreads);
     threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msghand", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this)));
     
     // Initiate masternode connections
@@ -2462,6 +2478,7 @@ void CConnman::Interrupt()
         flagInterruptMsgProc = true;
     }
     condMsgProc.notify_all();
+    msgWorkerPool.Interrupt();
 
     interruptNet();
     InterruptSocks5(true);
@@ -2489,6 +2506,7 @@ void CConnman::Stop()
 {
     if (threadMessageHandler.joinable())
         threadMessageHandler.join();
+    msgWorkerPool.Stop();
     if (threadOpenMasternodeConnections.joinable())
         threadOpenMasternodeConnections.join();
     if (threadOpenConnections.joinable())
@@ -2851,6 +2869,7 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
     nextSendTimeFeeFilter = 0;
     fPauseRecv = false;
     fPauseSend = false;
+    nPendingWorkerMsgs = 0;
     nProcessQueueSize = 0;
 
     for (const std::string &msg : getAllNetMessageTypes())
@@ -13,6 +13,7 @@
 #include <compat.h>
 #include <hash.h>
 #include <limitedmap.h>
+#include <msgworkerpool.h>
 #include <netaddress.h>
 #include <policy/feerate.h>
 #include <protocol.h>
@@ -114,6 +115,15 @@ struct CSerializedNetMsg
     CSerializedNetMsg(const CSerializedNetMsg& msg) = delete;
     CSerializedNetMsg& operator=(const CSerializedNetMsg&) = delete;
 
+    /** Explicit copy, for messages that are serialized once and sent to many peers */
+    CSerializedNetMsg Copy() const
+    {
+        CSerializedNetMsg copy;
+        copy.data = data;
+        copy.command = command;
+        return copy;
+    }
+
     std::vector<unsigned char> data;
     std::string command;
 };
@@ -150,6 +160,7 @@ public:
         bool m_use_addrman_outgoing = true;
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
+        int nMsgWorkerThreads = 0;
     };
 
     void Init(const Options& connOptions) {
@@ -173,6 +184,7 @@ public:
             LOCK(cs_vAddedNodes);
             vAddedNodes = connOptions.m_added_nodes;
         }
+        nMsgWorkerThreads = connOptions.nMsgWorkerThreads;
     }
 
     CConnman(uint64_t seed0, uint64_t seed1);
@@ -422,6 +434,10 @@ public:
     unsigned int GetReceiveFloodSize() const;
 
     void WakeMessageHandler();
+
+    /** Run func for pnode on the message worker pool. Returns false if the pool is not running. */
+    bool QueueWorkerMessage(CNode* pnode, int nCategory, std::function<void()> func);
+    bool GetMessageWorkerStats(std::vector<CMessageWorkerCategoryStats>& vStats) const;
 private:
     struct ListenSocket {
         SOCKET socket;
@@ -546,6 +562,10 @@ private:
     std::thread threadOpenMasternodeConnections;
     std::thread threadMessageHandler;
 
+    /** Threads handling messages that do not need the message handler thread */
+    int nMsgWorkerThreads;
+    CMessageWorkerPool msgWorkerPool;
+
     /** flag for deciding to connect to an extra outbound peer,
      *  in excess of nMaxOutbound
      *  This takes the place of a feeler connection */
@@ -778,6 +798,8 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv;
     std::atomic_bool fPauseSend;
+    // Number of messages from this peer waiting in the message worker pool
+    std::atomic<int> nPendingWorkerMsgs;
 protected:
 
     mapMsgCmdSize mapSendBytesPerMsgCmd;
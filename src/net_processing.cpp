@@ -16,6 +16,7 @@
 #include <init.h>
 #include <validation.h>
 #include <merkleblock.h>
+#include <msgworkerpool.h>
 #include <netmessagemaker.h>
 #include <netbase.h>
 #include <policy/fees.h>
@@ -877,8 +878,11 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
         fWitnessesPresentInMostRecentCompactBlock = fWitnessEnabled;
     }
 
-    connman->ForEachNode([this, &pcmpctblock, pindex, &msgMaker, fWitnessEnabled, &hashBlock](CNode* pnode) {
-        // TODO: Avoid the repeated-serialization here
+    // Serialize once: auxpow and Equihash headers make this message a lot
+    // larger than a plain 80-byte header would.
+    const CSerializedNetMsg msgCmpctBlock = msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock);
+
+    connman->ForEachNode([this, &msgCmpctBlock, pindex, fWitnessEnabled, &hashBlock](CNode* pnode) {
         if (pnode->nVersion < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
             return;
         ProcessBlockAvailability(pnode->GetId());
@@ -890,7 +894,7 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
 
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerLogicValidation::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
-            connman->PushMessage(pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
+            connman->PushMessage(pnode, msgCmpctBlock.Copy());
             state.pindexBestHeaderSent = pindex;
         }
     });
@@ -1163,6 +1167,15 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
         std::shared_ptr<const CBlock> pblock;
         if (a_recent_block && a_recent_block->GetHash() == (*mi).second->GetBlockHash()) {
             pblock = a_recent_block;
+        } else if (inv.type == MSG_WITNESS_BLOCK || (inv.type == MSG_BLOCK && !IsWitnessEnabled(mi->second->pprev, consensusParams))) {
+            // The bytes on disk already are the requested serialization (a
+            // block from before witness activation has no witness data to
+            // strip), so send them without deserializing the block.
+            CSerializedNetMsg msg;
+            if (!ReadRawBlockFromDisk(msg.data, mi->second, Params().MessageStart()))
+                assert(!"cannot load block from disk");
+            msg.command = NetMsgType::BLOCK;
+            connman->PushMessage(pfrom, std::move(msg));
         } else {
             // Send block from disk
             std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
@@ -1170,7 +1183,9 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
                 assert(!"cannot load block from disk");
             pblock = pblockRead;
         }
-        if (inv.type == MSG_BLOCK)
+        if (!pblock) {
+            // Already sent from disk above
+        } else if (inv.type == MSG_BLOCK)
             connman->PushMessage(pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, *pblock));
         else if (inv.type == MSG_WITNESS_BLOCK)
             connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
@@ -3070,6 +3085,69 @@ static bool SendRejectsAndCheckIfBanned(CNode* pnode, CConnman* connman)
     return false;
 }
 
+/**
+ * Return the message worker category strCommand is handled in, or -1 if it
+ * has to be processed on the message handler thread.
+ */
+static int GetMessageWorkerCategory(const std::string& strCommand)
+{
+    if (strCommand == NetMsgType::MNANNOUNCE || strCommand == NetMsgType::MNPING ||
+        strCommand == NetMsgType::MNVERIFY || strCommand == NetMsgType::DSEG)
+        return MSG_WORKER_MASTERNODE;
+    if (strCommand == NetMsgType::MASTERNODEPAYMENTVOTE || strCommand == NetMsgType::MASTERNODEPAYMENTSYNC)
+        return MSG_WORKER_PAYMENT;
+    if (strCommand == NetMsgType::TXLOCKVOTE)
+        return MSG_WORKER_INSTANTSEND;
+    if (strCommand == NetMsgType::SPORK || strCommand == NetMsgType::GETSPORKS)
+        return MSG_WORKER_SPORK;
+    if (strCommand == NetMsgType::GETDATA)
+        return MSG_WORKER_GETDATA;
+    return -1;
+}
+
+static bool ProcessMessageAndHandleErrors(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, int64_t nTimeReceived, unsigned int nMessageSize, const CChainParams& chainparams, CConnman* connman, const std::atomic<bool>& interruptMsgProc)
+{
+    bool fRet = false;
+    try
+    {
+        fRet = ProcessMessage(pfrom, strCommand, vRecv, nTimeReceived, chainparams, connman, interruptMsgProc);
+    }
+    catch (const std::ios_base::failure& e)
+    {
+        connman->PushMessage(pfrom, CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::REJECT, strCommand, REJECT_MALFORMED, std::string("error parsing message")));
+        if (strstr(e.what(), "end of data"))
+        {
+            // Allow exceptions from under-length message on vRecv
+            LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' caught, normally caused by a message being shorter than its stated length\n", __func__, SanitizeString(strCommand), nMessageSize, e.what());
+        }
+        else if (strstr(e.what(), "size too large"))
+        {
+            // Allow exceptions from over-long size
+            LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand), nMessageSize, e.what());
+        }
+        else if (strstr(e.what(), "non-canonical ReadCompactSize()"))
+        {
+            // Allow exceptions from non-canonical encoding
+            LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand), nMessageSize, e.what());
+        }
+        else
+        {
+            PrintExceptionContinue(&e, "ProcessMessages()");
+        }
+    }
+    catch (const std::exception& e) {
+        PrintExceptionContinue(&e, "ProcessMessages()");
+    } catch (...) {
+        PrintExceptionContinue(nullptr, "ProcessMessages()");
+    }
+
+    if (!fRet) {
+        LogPrint(BCLog::NET, "%s(%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize, pfrom->GetId());
+    }
+
+    return fRet;
+}
+
 bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptMsgProc)
 {
     const CChainParams& chainparams = Params();
@@ -3083,24 +3161,33 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
     //
     bool fMoreWork = false;
 
-    if (!pfrom->vRecvGetData.empty())
+    // While the worker pool still holds messages from this peer it also owns
+    // vRecvGetData, and only further offloadable messages may be taken.
+    const bool fWorkerBusy = pfrom->nPendingWorkerMsgs > 0;
+
+    if (!fWorkerBusy && !pfrom->vRecvGetData.empty())
         ProcessGetData(pfrom, chainparams.GetConsensus(), connman, interruptMsgProc);
 
     if (pfrom->fDisconnect)
         return false;
 
     // this maintains the order of responses
-    if (!pfrom->vRecvGetData.empty()) return true;
+    if (!fWorkerBusy && !pfrom->vRecvGetData.empty()) return true;
 
     // Don't bother if send buffer is too full to respond anyway
     if (pfrom->fPauseSend)
         return false;
 
     std::list<CNetMessage> msgs;
+    int nWorkerCategory;
     {
         LOCK(pfrom->cs_vProcessMsg);
         if (pfrom->vProcessMsg.empty())
             return false;
+        nWorkerCategory = GetMessageWorkerCategory(pfrom->vProcessMsg.front().hdr.GetCommand());
+        // Keep per-peer ordering: the pool wakes us up once it has drained this peer
+        if (fWorkerBusy && nWorkerCategory < 0)
+            return false;
         // Just take one message
         msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
         pfrom->nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
@@ -3141,48 +3228,29 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
         return fMoreWork;
     }
 
-    // Process message
-    bool fRet = false;
-    try
-    {
-        fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, chainparams, connman, interruptMsgProc);
-        if (interruptMsgProc)
-            return false;
-        if (!pfrom->vRecvGetData.empty())
-            fMoreWork = true;
-    }
-    catch (const std::ios_base::failure& e)
-    {
-        connman->PushMessage(pfrom, CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::REJECT, strCommand, REJECT_MALFORMED, std::string("error parsing message")));
-        if (strstr(e.what(), "end of data"))
-        {
-            // Allow exceptions from under-length message on vRecv
-            LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' caught, normally caused by a message being shorter than its stated length\n", __func__, SanitizeString(strCommand), nMessageSize, e.what());
-        }
-        else if (strstr(e.what(), "size too large"))
-        {
-            // Allow exceptions from over-long size
-            LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand), nMessageSize, e.what());
-        }
-        else if (strstr(e.what(), "non-canonical ReadCompactSize()"))
-        {
-            // Allow exceptions from non-canonical encoding
-            LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand), nMessageSize, e.what());
-        }
-        else
-        {
-            PrintExceptionContinue(&e, "ProcessMessages()");
-        }
-    }
-    catch (const std::exception& e) {
-        PrintExceptionContinue(&e, "ProcessMessages()");
-    } catch (...) {
-        PrintExceptionContinue(nullptr, "ProcessMessages()");
+    // Hand the message over to the worker pool if it does not need this thread
+    if (nWorkerCategory >= 0) {
+        std::shared_ptr<std::list<CNetMessage>> pmsgs = std::make_shared<std::list<CNetMessage>>();
+        pmsgs->splice(pmsgs->begin(), msgs);
+        CConnman* const pconnman = connman;
+        const std::atomic<bool>& interrupt = interruptMsgProc;
+        bool fQueued = connman->QueueWorkerMessage(pfrom, nWorkerCategory, [pfrom, pmsgs, strCommand, nMessageSize, &chainparams, pconnman, &interrupt] {
+            CNetMessage& workerMsg = pmsgs->front();
+            ProcessMessageAndHandleErrors(pfrom, strCommand, workerMsg.vRecv, workerMsg.nTime, nMessageSize, chainparams, pconnman, interrupt);
+            LOCK(cs_main);
+            SendRejectsAndCheckIfBanned(pfrom, pconnman);
+        });
+        if (fQueued)
+            return fMoreWork;
+        msgs.splice(msgs.begin(), *pmsgs);
     }
 
-    if (!fRet) {
-        LogPrint(BCLog::NET, "%s(%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize, pfrom->GetId());
-    }
+    // Process message
+    ProcessMessageAndHandleErrors(pfrom, strCommand, vRecv, msg.nTime, nMessageSize, chainparams, connman, interruptMsgProc);
+    if (interruptMsgProc)
+        return false;
+    if (!pfrom->vRecvGetData.empty())
+        fMoreWork = true;
 
     LOCK(cs_main);
     SendRejectsAndCheckIfBanned(pfrom, connman);
@@ -19,8 +19,12 @@
 #include <util.h>
 #include <streams.h>
 #include <crypto/algos/equihash/equihash.h>
+#include <globaltoken/multihasher.h>
+#include <powcache.h>
 #include <validation.h>
 
+#include <map>
+
 bool IsAuxPowAllowed(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params& params, const uint8_t algo)
 {
     if(!pblock->IsAuxpow())
@@ -380,7 +384,7 @@ bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params
     return CheckProofOfWork(block, params, equihashvalidator);
 }
 
-bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params, bool &ehsolutionvalid)
+bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params, bool &ehsolutionvalid, const uint256* phashPoW)
 {
     bool hardfork    = params.Hardfork1.IsActivated(block.nTime);
     bool hardfork2   = params.Hardfork2.IsActivated(block.nTime);
@@ -409,6 +413,14 @@ bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params
         if (block.IsAuxpow())
             return error("%s : no auxpow on block with auxpow version",
                          __func__);
+
+        // Only headers that passed the checks below are in the PoW cache, and
+        // the block hash commits to the solution as well as the PoW hash input
+        const uint256 hashBlock = block.GetHash();
+        uint256 hashPoW;
+        if (GetCachedPoWHash(hashBlock, nAlgo, powHashFlags, hashPoW))
+            return true;
+        hashPoW = phashPoW ? *phashPoW : block.GetPoWHash(SER_GETHASH, powHashFlags);
         
         if(hardfork)
         {
@@ -429,14 +441,14 @@ bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params
                 
                 // Check the header
                 // Also check the Block Header after Equihash solution check.
-                if (!CheckProofOfWork(block.GetPoWHash(SER_GETHASH, powHashFlags), block.nBits, params, nAlgo))
-                    return error("%s : non-AUX proof of work failed - hash=%s, algo=%d (%s), nVersion=%d, PoWHash=%s", __func__, block.GetHash().ToString(), nAlgo, GetAlgoName(nAlgo), block.nVersion, block.GetPoWHash(SER_GETHASH, powHashFlags).ToString());
+                if (!CheckProofOfWork(hashPoW, block.nBits, params, nAlgo))
+                    return error("%s : non-AUX proof of work failed - hash=%s, algo=%d (%s), nVersion=%d, PoWHash=%s", __func__, block.GetHash().ToString(), nAlgo, GetAlgoName(nAlgo), block.nVersion, hashPoW.ToString());
             }
             else
             {
                 // Check the header
-                if (!CheckProofOfWork(block.GetPoWHash(SER_GETHASH, powHashFlags), block.nBits, params, nAlgo))
-                    return error("%s : non-AUX proof of work failed - hash=%s, algo=%d (%s), nVersion=%d, PoWHash=%s", __func__, block.GetHash().ToString(), nAlgo, GetAlgoName(nAlgo), block.nVersion, block.GetPoWHash(SER_GETHASH, powHashFlags).ToString());
+                if (!CheckProofOfWork(hashPoW, block.nBits, params, nAlgo))
+                    return error("%s : non-AUX proof of work failed - hash=%s, algo=%d (%s), nVersion=%d, PoWHash=%s", __func__, block.GetHash().ToString(), nAlgo, GetAlgoName(nAlgo), block.nVersion, hashPoW.ToString());
             }
         }
         else
@@ -444,8 +456,8 @@ bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params
             if(nAlgo == ALGO_SHA256D)
             {
                 // Check the header
-                if (!CheckProofOfWork(block.GetPoWHash(SER_GETHASH, powHashFlags), block.nBits, params, ALGO_SHA256D))
-                    return error("%s : non-AUX proof of work failed - hash=%s, algo=%d (%s), nVersion=%d, PoWHash=%s", __func__, block.GetHash().ToString(), nAlgo, GetAlgoName(nAlgo), block.nVersion, block.GetPoWHash(SER_GETHASH, powHashFlags).ToString());
+                if (!CheckProofOfWork(hashPoW, block.nBits, params, ALGO_SHA256D))
+                    return error("%s : non-AUX proof of work failed - hash=%s, algo=%d (%s), nVersion=%d, PoWHash=%s", __func__, block.GetHash().ToString(), nAlgo, GetAlgoName(nAlgo), block.nVersion, hashPoW.ToString());
             }
             else
             {
@@ -453,6 +465,7 @@ bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params
             }
         }
 
+        AddCachedPoWHash(hashBlock, nAlgo, powHashFlags, hashPoW);
         return true;
     }
     
@@ -533,6 +546,37 @@ bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params
     return true;
 }
 
+std::vector<uint256> GetPoWHashBatch(const std::vector<const CBlockHeader*>& headers, const Consensus::Params& params)
+{
+    std::vector<uint256> hashes(headers.size());
+
+    // Group the headers missing from the PoW cache by algorithm and hasher
+    // flags, keeping the header order in each group
+    std::map<std::pair<uint8_t, int>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < headers.size(); i++) {
+        if (headers[i]->auxpow)
+            continue;
+        const int powHashFlags = LoadMultiHasherVersionFlags(params.Hardfork3.IsActivated(headers[i]->nTime));
+        const uint8_t nAlgo = headers[i]->GetAlgo();
+        if (GetCachedPoWHash(headers[i]->GetHash(), nAlgo, powHashFlags, hashes[i]))
+            continue;
+        groups[std::make_pair(nAlgo, powHashFlags)].push_back(i);
+    }
+
+    for (const auto& group : groups) {
+        std::vector<const CPureBlockHeader*> vGroup;
+        vGroup.reserve(group.second.size());
+        for (size_t i : group.second)
+            vGroup.push_back(headers[i]);
+
+        std::vector<uint256> vGroupHash(vGroup.size());
+        SerializeMultiAlgoHashBatch(vGroup.data(), vGroup.size(), group.first.first, vGroupHash.data(), SER_GETHASH, group.first.second);
+        for (size_t j = 0; j < vGroup.size(); j++)
+            hashes[group.second[j]] = vGroupHash[j];
+    }
+    return hashes;
+}
+
 const CBlockIndex* GetLastBlockIndexForAlgo(const CBlockIndex* pindex, const uint8_t algo, const Consensus::Params& params)
 {
 	for (;;)
@@ -10,6 +10,7 @@
 #include <consensus/params.h>
 
 #include <stdint.h>
+#include <vector>
 
 enum {
     RETARGETING_LAST = 0,
@@ -43,10 +44,18 @@ const CBlockIndex* GetNextBlockIndexForAlgo(const CBlockIndex* pindex, const uin
  * @param block The block header.
  * @param params Consensus parameters.
  * @param ehsolutionvalid boolean set to false if equihash solution fails
+ * @param phashPoW PoW hash of a header without auxpow, if already computed.
  * @return True iff the PoW is correct.
  */
 bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params);
-bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params, bool &ehsolutionvalid);
+bool CheckProofOfWork(const CBlockHeader& block, const Consensus::Params& params, bool &ehsolutionvalid, const uint256* phashPoW = nullptr);
+
+/**
+ * PoW hashes of many headers, computed per algorithm so that hash chains
+ * run batched. Hashes in the PoW cache are looked up instead. Headers with
+ * auxpow get a null hash.
+ */
+std::vector<uint256> GetPoWHashBatch(const std::vector<const CBlockHeader*>& headers, const Consensus::Params& params);
 
 /** Calculations */
 int CalculateDiffRetargetingBlock(const CBlockIndex* pindex, int retargettype, const uint8_t algo, const Consensus::Params&);
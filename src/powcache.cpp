@@ -0,0 +1,145 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <powcache.h>
+
+#include <crypto/common.h>
+#include <crypto/sha256.h>
+#include <globaltoken/powalgorithm.h>
+#include <primitives/block.h>
+#include <random.h>
+#include <uint256.h>
+#include <util.h>
+
+#include <boost/thread.hpp>
+
+#include <string.h>
+#include <vector>
+
+namespace {
+/**
+ * A table of PoW hashes where every key has two slots it can live in. A new
+ * entry takes a free or matching slot, or else evicts one of the two, so the
+ * memory use is fixed and lookups touch at most two cache lines.
+ */
+class CPoWHashCache
+{
+private:
+    struct Entry
+    {
+        uint256 key;
+        uint256 hashPoW;
+    };
+
+    //! Keys are SHA256(nonce || block hash || algo || flags), which an attacker can not steer into chosen slots
+    uint256 nonce;
+    std::vector<Entry> table;
+    boost::shared_mutex cs_powcache;
+
+    uint32_t Slot(const uint256& key, int n) const
+    {
+        uint32_t u;
+        memcpy(&u, key.begin() + 4 * n, 4);
+        return (uint32_t)((u * (uint64_t)table.size()) >> 32);
+    }
+
+public:
+    CPoWHashCache() : table(2)
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    void ComputeKey(uint256& key, const uint256& hashBlock, uint8_t nAlgo, int nFlags) const
+    {
+        unsigned char vchFlags[4];
+        WriteLE32(vchFlags, (uint32_t)nFlags);
+        CSHA256().Write(nonce.begin(), 32).Write(hashBlock.begin(), 32).Write(&nAlgo, 1).Write(vchFlags, 4).Finalize(key.begin());
+    }
+
+    bool Get(const uint256& key, uint256& hashPoW)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_powcache);
+        for (int n = 0; n < 2; n++) {
+            const Entry& entry = table[Slot(key, n)];
+            if (entry.key == key) {
+                hashPoW = entry.hashPoW;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Set(const uint256& key, const uint256& hashPoW)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_powcache);
+        Entry* slots[2] = {&table[Slot(key, 0)], &table[Slot(key, 1)]};
+        Entry* dest = nullptr;
+        for (Entry* slot : slots) {
+            if (slot->key == key || slot->key.IsNull()) {
+                dest = slot;
+                break;
+            }
+        }
+        if (!dest) {
+            // Both slots are taken; the key picks the victim
+            dest = slots[key.begin()[8] & 1];
+        }
+        dest->key = key;
+        dest->hashPoW = hashPoW;
+    }
+
+    size_t setup_bytes(size_t nBytes)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_powcache);
+        table.assign(std::max<size_t>(2, nBytes / sizeof(Entry)), Entry());
+        return table.size();
+    }
+};
+
+static CPoWHashCache powHashCache;
+
+bool IsCachedAlgo(uint8_t nAlgo)
+{
+    return nAlgo != ALGO_SHA256D;
+}
+} // namespace
+
+// To be called once in AppInitMain/BasicTestingSetup to size the cache.
+void InitPoWCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-maxpowcachesize", DEFAULT_MAX_POW_CACHE_SIZE)), MAX_MAX_POW_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = powHashCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for PoW hash cache, able to store %zu elements\n",
+            (nElems*2*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
+
+bool GetCachedPoWHash(const uint256& hashBlock, uint8_t nAlgo, int nFlags, uint256& hashPoW)
+{
+    if (!IsCachedAlgo(nAlgo))
+        return false;
+    uint256 key;
+    powHashCache.ComputeKey(key, hashBlock, nAlgo, nFlags);
+    return powHashCache.Get(key, hashPoW);
+}
+
+void AddCachedPoWHash(const uint256& hashBlock, uint8_t nAlgo, int nFlags, const uint256& hashPoW)
+{
+    if (!IsCachedAlgo(nAlgo))
+        return;
+    uint256 key;
+    powHashCache.ComputeKey(key, hashBlock, nAlgo, nFlags);
+    powHashCache.Set(key, hashPoW);
+}
+
+uint256 GetCachedPoWHash(const CBlockHeader& block, int nFlags)
+{
+    const uint256 hashBlock = block.GetHash();
+    const uint8_t nAlgo = block.GetAlgo();
+    uint256 hashPoW;
+    if (GetCachedPoWHash(hashBlock, nAlgo, nFlags, hashPoW))
+        return hashPoW;
+    hashPoW = block.GetPoWHash(SER_GETHASH, nFlags);
+    AddCachedPoWHash(hashBlock, nAlgo, nFlags, hashPoW);
+    return hashPoW;
+}
@@ -0,0 +1,40 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBALTOKEN_POWCACHE_H
+#define GLOBALTOKEN_POWCACHE_H
+
+#include <stdint.h>
+
+// 4MB of 64 byte entries hold the PoW hashes of 65536 headers
+static const unsigned int DEFAULT_MAX_POW_CACHE_SIZE = 4;
+// Maximum PoW cache size allowed
+static const int64_t MAX_MAX_POW_CACHE_SIZE = 1024;
+
+class CBlockHeader;
+class uint256;
+
+/**
+ * The PoW hash cache remembers the PoW hashes of headers that passed their
+ * proof of work, so that checking a header again (when its block arrives,
+ * when a block is read from disk, in TestBlockValidity) or showing it over
+ * RPC does not run a memory-hard algorithm again. Entries are keyed on the
+ * block hash, which commits to every byte the PoW hash covers, together with
+ * the algorithm and the multihasher flags.
+ *
+ * SHA256D headers are not cached: hashing them is as cheap as the lookup.
+ */
+bool GetCachedPoWHash(const uint256& hashBlock, uint8_t nAlgo, int nFlags, uint256& hashPoW);
+void AddCachedPoWHash(const uint256& hashBlock, uint8_t nAlgo, int nFlags, const uint256& hashPoW);
+
+/**
+ * PoW hash of the header itself (never of an auxpow parent), through the
+ * cache. A computed hash is added, so only use it on headers that are known
+ * to be valid, such as those in the block index.
+ */
+uint256 GetCachedPoWHash(const CBlockHeader& block, int nFlags);
+
+void InitPoWCache();
+
+#endif // GLOBALTOKEN_POWCACHE_H
@@ -209,6 +209,10 @@ static bool rest_block(HTTPRequest* req,
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
 
     CBlock block;
+    std::vector<unsigned char> vchBlock;
+    std::shared_ptr<const CMappedBlockFile> mapping;
+    const unsigned char* pchBlock = nullptr;
+    unsigned int nBlockSize = 0;
     CBlockIndex* pblockindex = nullptr;
     {
         LOCK(cs_main);
@@ -219,23 +223,40 @@ static bool rest_block(HTTPRequest* req,
         if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
 
-        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
-            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        if (rf != RF_JSON && RPCSerializationFlags() == 0) {
+            // The bytes on disk are already in the requested serialization,
+            // sent straight from the mapped block file if there is one
+            if (!MapRawBlockFromDisk(mapping, pchBlock, nBlockSize, pblockindex, Params().MessageStart()) &&
+                !ReadRawBlockFromDisk(vchBlock, pblockindex, Params().MessageStart()))
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        } else {
+            if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+            if (rf != RF_JSON) {
+                CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+                ssBlock << block;
+                vchBlock.assign(ssBlock.begin(), ssBlock.end());
+            }
+        }
+    }
+    if (!mapping) {
+        pchBlock = vchBlock.data();
+        nBlockSize = vchBlock.size();
     }
-
-    CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    ssBlock << block;
 
     switch (rf) {
     case RF_BINARY: {
-        std::string binaryBlock = ssBlock.str();
         req->WriteHeader("Content-Type", "application/octet-stream");
-        req->WriteReply(HTTP_OK, binaryBlock);
+        if (mapping)
+            req->WriteReplyBody((const char*)pchBlock, nBlockSize, mapping);
+        else
+            req->WriteReplyBody((const char*)pchBlock, nBlockSize);
+        req->WriteReply(HTTP_OK);
         return true;
     }
 
     case RF_HEX: {
-        std::string strHex = HexStr(ssBlock.begin(), ssBlock.end()) + "\n";
+        std::string strHex = HexStr(pchBlock, pchBlock + nBlockSize) + "\n";
         req->WriteHeader("Content-Type", "text/plain");
         req->WriteReply(HTTP_OK, strHex);
         return true;
@@ -570,6 +591,98 @@ static bool rest_getutxos(HTTPRequest* req, const std::string& strURIPart)
     }
 }
 
+/** A label value of the Prometheus text format */
+static std::string MetricLabel(const std::string& str)
+{
+    std::string ret;
+    for (char c : str) {
+        if (c == '\\' || c == '"')
+            ret += '\\';
+        if (c == '\n')
+            ret += "\\n";
+        else
+            ret += c;
+    }
+    return ret;
+}
+
+static void MetricHeader(std::string& strOut, const std::string& strName, const std::string& strType, const std::string& strHelp)
+{
+    strOut += "# HELP " + strName + " " + strHelp + "\n";
+    strOut += "# TYPE " + strName + " " + strType + "\n";
+}
+
+static bool rest_metrics(HTTPRequest* req, const std::string& strURIPart)
+{
+    std::string strOut;
+
+    const std::map<std::string, CRPCMethodStats> mapMethods = GetRPCMethodStats();
+    MetricHeader(strOut, "globaltoken_rpc_calls_total", "counter", "RPC calls by method");
+    for (const auto& method : mapMethods)
+        strOut += strprintf("globaltoken_rpc_calls_total{method=\"%s\"} %d\n", MetricLabel(method.first), method.second.nCalls);
+    MetricHeader(strOut, "globaltoken_rpc_errors_total", "counter", "RPC calls that failed by method");
+    for (const auto& method : mapMethods)
+        strOut += strprintf("globaltoken_rpc_errors_total{method=\"%s\"} %d\n", MetricLabel(method.first), method.second.nErrors);
+    MetricHeader(strOut, "globaltoken_rpc_duration_seconds", "histogram", "Time of RPC calls by method");
+    for (const auto& method : mapMethods) {
+        const std::string strMethod = MetricLabel(method.first);
+        uint64_t nCalls = 0;
+        for (size_t i = 0; i < RPC_LATENCY_BUCKETS; i++) {
+            nCalls += method.second.vLatency[i];
+            const std::string strBound = i < RPC_LATENCY_BUCKETS - 1 ? strprintf("%g", RPC_LATENCY_BUCKET_BOUNDS[i] / 1000.0) : "+Inf";
+            strOut += strprintf("globaltoken_rpc_duration_seconds_bucket{method=\"%s\",le=\"%s\"} %d\n", strMethod, strBound, nCalls);
+        }
+        strOut += strprintf("globaltoken_rpc_duration_seconds_sum{method=\"%s\"} %.6f\n", strMethod, method.second.nTotalMicros / 1e6);
+        strOut += strprintf("globaltoken_rpc_duration_seconds_count{method=\"%s\"} %d\n", strMethod, nCalls);
+    }
+    MetricHeader(strOut, "globaltoken_rpc_lock_wait_seconds_total", "counter", "Time RPC calls waited for profiled locks by method");
+    for (const auto& method : mapMethods)
+        strOut += strprintf("globaltoken_rpc_lock_wait_seconds_total{method=\"%s\"} %.6f\n", MetricLabel(method.first), method.second.nLockWaitMicros / 1e6);
+    MetricHeader(strOut, "globaltoken_rpc_lock_hold_seconds_total", "counter", "Time RPC calls held profiled locks by method");
+    for (const auto& method : mapMethods)
+        strOut += strprintf("globaltoken_rpc_lock_hold_seconds_total{method=\"%s\"} %.6f\n", MetricLabel(method.first), method.second.nLockHoldMicros / 1e6);
+
+    HTTPWorkQueueStats queue;
+    if (GetHTTPWorkQueueStats(queue)) {
+        MetricHeader(strOut, "globaltoken_rpc_workqueue_depth", "gauge", "Requests waiting for an HTTP worker thread");
+        strOut += strprintf("globaltoken_rpc_workqueue_depth %d\n", queue.nDepth);
+        MetricHeader(strOut, "globaltoken_rpc_workqueue_max_depth", "gauge", "Requests that may wait before new ones are rejected");
+        strOut += strprintf("globaltoken_rpc_workqueue_max_depth %d\n", queue.nMaxDepth);
+        MetricHeader(strOut, "globaltoken_rpc_workqueue_enqueued_total", "counter", "Requests queued for an HTTP worker thread");
+        strOut += strprintf("globaltoken_rpc_workqueue_enqueued_total %d\n", queue.nEnqueued);
+        MetricHeader(strOut, "globaltoken_rpc_workqueue_rejected_total", "counter", "Requests rejected because the work queue was full");
+        strOut += strprintf("globaltoken_rpc_workqueue_rejected_total %d\n", queue.nRejected);
+        MetricHeader(strOut, "globaltoken_rpc_workqueue_wait_seconds", "gauge", "Moving average of the time requests wait for an HTTP worker thread");
+        strOut += strprintf("globaltoken_rpc_workqueue_wait_seconds %.6f\n", queue.nAvgWaitMicros / 1e6);
+    }
+
+    const std::vector<CLockProfileStats> vLocks = GetLockProfiles();
+    const struct {
+        const char* name;
+        const char* help;
+        bool fSeconds;
+        std::function<double(const CLockSiteStats&)> value;
+    } lockMetrics[] = {
+        {"globaltoken_lock_acquired_total", "Times a profiled lock was taken by site", false, [](const CLockSiteStats& site) { return (double)site.nAcquired; }},
+        {"globaltoken_lock_contended_total", "Times a profiled lock was held by another thread when it was taken by site", false, [](const CLockSiteStats& site) { return (double)site.nContended; }},
+        {"globaltoken_lock_wait_seconds_total", "Time waited for a profiled lock by site", true, [](const CLockSiteStats& site) { return site.nWaitMicros / 1e6; }},
+        {"globaltoken_lock_hold_seconds_total", "Time a profiled lock was held by site", true, [](const CLockSiteStats& site) { return site.nHoldMicros / 1e6; }},
+    };
+    for (const auto& metric : lockMetrics) {
+        MetricHeader(strOut, metric.name, "counter", metric.help);
+        for (const CLockProfileStats& lock : vLocks) {
+            for (const CLockSiteStats& site : lock.vSites) {
+                strOut += strprintf(metric.fSeconds ? "%s{lock=\"%s\",site=\"%s:%d\"} %.6f\n" : "%s{lock=\"%s\",site=\"%s:%d\"} %.0f\n",
+                                    metric.name, MetricLabel(lock.strName), MetricLabel(site.strFile), site.nLine, metric.value(site));
+            }
+        }
+    }
+
+    req->WriteHeader("Content-Type", "text/plain; version=0.0.4");
+    req->WriteReply(HTTP_OK, strOut);
+    return true;
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(HTTPRequest* req, const std::string& strReq);
@@ -582,6 +695,7 @@ static const struct {
       {"/rest/mempool/contents", rest_mempool_contents},
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
+      {"/rest/metrics", rest_metrics},
 };
 
 bool StartREST()
@@ -18,6 +18,7 @@
 #include <policy/feerate.h>
 #include <policy/policy.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <streams.h>
 #include <sync.h>
@@ -76,6 +77,11 @@ double GetDifficulty(const CChain& chain, const CBlockIndex* blockindex, uint8_t
     else
     nBits = blockindex->nBits;
 
+    return GetDifficultyFromBits(nBits);
+}
+
+double GetDifficultyFromBits(unsigned int nBits)
+{
     int nShift = (nBits >> 24) & 0xff;
     double dDiff =
         (double)0x0000ffff / (double)(nBits & 0x00ffffff);
@@ -226,6 +232,30 @@ UniValue blockheaderToJSON(const CBlockIndex* blockindex)
     return result;
 }
 
+/** blockToJSON written to a stream, one transaction at a time */
+static void blockToJSON(JSONStreamWriter& writer, const CBlock& block, const CBlockIndex* blockindex, bool txDetails)
+{
+    // All but the transactions is small, so it is built as usual with the txids
+    const UniValue result = blockToJSON(block, blockindex, false);
+    const int nSerializationFlags = RPCSerializationFlags();
+    writer.BeginObject();
+    for (size_t i = 0; i < result.size(); i++) {
+        writer.Key(result.getKeys()[i]);
+        if (txDetails && result.getKeys()[i] == "tx") {
+            writer.BeginArray();
+            for (const auto& tx : block.vtx) {
+                UniValue objTx(UniValue::VOBJ);
+                TxToUniv(*tx, uint256(), objTx, true, nSerializationFlags);
+                writer.Value(objTx);
+            }
+            writer.EndArray();
+        } else {
+            writer.Value(result.getValues()[i]);
+        }
+    }
+    writer.EndObject();
+}
+
 UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails)
 {
     AssertLockHeld(cs_main);
@@ -248,7 +278,7 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool tx
     result.pushKV("algo", GetAlgoName(algo));
 	result.pushKV("algoid", algo);
     if(!isauxpow)
-        result.pushKV("algopowhash", block.GetPoWHash(SER_GETHASH, LoadMultiHasherVersionFlags(Params().GetConsensus().Hardfork3.IsActivated(block.nTime))).GetHex());
+        result.pushKV("algopowhash", blockindex->GetBlockPoWHash().GetHex());
     result.pushKV("version", block.nVersion);
     result.pushKV("versionHex", strprintf("%08x", block.nVersion));
     result.pushKV("merkleroot", block.hashMerkleRoot.GetHex());
@@ -602,6 +632,19 @@ UniValue getrawmempool(const JSONRPCRequest& request)
     if (!request.params[0].isNull())
         fVerbose = request.params[0].get_bool();
 
+    if (fVerbose && request.resultStream) {
+        JSONStreamWriter& writer = *request.resultStream;
+        LOCK(mempool.cs);
+        writer.BeginObject();
+        for (const CTxMemPoolEntry& e : mempool.mapTx) {
+            UniValue info(UniValue::VOBJ);
+            entryToJSON(info, e);
+            writer.Key(e.GetTx().GetHash().ToString());
+            writer.Value(info);
+        }
+        writer.EndObject();
+        return NullUniValue;
+    }
     return mempoolToJSON(fVerbose);
 }
 
@@ -926,6 +969,19 @@ UniValue getblock(const JSONRPCRequest& request)
     if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
         throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
 
+    if (verbosity <= 0 && RPCSerializationFlags() == 0)
+    {
+        // The bytes on disk are already in the requested serialization
+        std::vector<unsigned char> vchBlock;
+        if (!ReadRawBlockFromDisk(vchBlock, pblockindex, Params().MessageStart()))
+            throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+        if (request.resultStream) {
+            request.resultStream->HexValue(vchBlock.data(), vchBlock.data() + vchBlock.size());
+            return NullUniValue;
+        }
+        return HexStr(vchBlock.begin(), vchBlock.end());
+    }
+
     if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
         // Block not found on disk. This could be because we have the block
         // header in our index but don't have the block (for example if a
@@ -938,10 +994,19 @@ UniValue getblock(const JSONRPCRequest& request)
     {
         CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
         ssBlock << block;
+        if (request.resultStream) {
+            const unsigned char* begin = (const unsigned char*)ssBlock.data();
+            request.resultStream->HexValue(begin, begin + ssBlock.size());
+            return NullUniValue;
+        }
         std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
         return strHex;
     }
 
+    if (request.resultStream) {
+        blockToJSON(*request.resultStream, block, pblockindex, verbosity >= 2);
+        return NullUniValue;
+    }
     return blockToJSON(block, pblockindex, verbosity >= 2);
 }
 
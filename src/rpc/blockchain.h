@@ -18,6 +18,9 @@ class UniValue;
  */
 double GetDifficulty(const CBlockIndex* blockindex = nullptr, uint8_t algo = 0);
 
+/** The difficulty of a compact target, as returned by GetDifficulty. */
+double GetDifficultyFromBits(unsigned int nBits);
+
 /** Callback for when block tip changed. */
 void RPCNotifyBlockChange(bool ibd, const CBlockIndex *);
 
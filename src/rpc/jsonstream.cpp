@@ -0,0 +1,104 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+
+#include <utilstrencodings.h>
+
+#include <algorithm>
+#include <assert.h>
+
+JSONStreamWriter::JSONStreamWriter(const Sink& sinkIn, size_t nChunkSizeIn) : sink(sinkIn), nChunkSize(nChunkSizeIn), fAfterKey(false)
+{
+    buffer.reserve(nChunkSize);
+}
+
+void JSONStreamWriter::Separate()
+{
+    if (fAfterKey) {
+        fAfterKey = false;
+    } else if (!vEmpty.empty()) {
+        if (!vEmpty.back())
+            Append(",", 1);
+        vEmpty.back() = false;
+    }
+}
+
+void JSONStreamWriter::Append(const char* data, size_t size)
+{
+    buffer.append(data, size);
+    if (buffer.size() >= nChunkSize)
+        Flush();
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (buffer.empty())
+        return;
+    sink(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    Separate();
+    Append("{", 1);
+    vEmpty.push_back(true);
+}
+
+void JSONStreamWriter::EndObject()
+{
+    assert(!vEmpty.empty() && !fAfterKey);
+    vEmpty.pop_back();
+    Append("}", 1);
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    Separate();
+    Append("[", 1);
+    vEmpty.push_back(true);
+}
+
+void JSONStreamWriter::EndArray()
+{
+    assert(!vEmpty.empty() && !fAfterKey);
+    vEmpty.pop_back();
+    Append("]", 1);
+}
+
+void JSONStreamWriter::Key(const std::string& key)
+{
+    assert(!vEmpty.empty() && !fAfterKey);
+    Separate();
+    Append(UniValue(key).write());
+    Append(":", 1);
+    fAfterKey = true;
+}
+
+void JSONStreamWriter::Value(const UniValue& value)
+{
+    Separate();
+    Append(value.write());
+}
+
+void JSONStreamWriter::RawValue(const std::string& json)
+{
+    Separate();
+    Append(json);
+}
+
+void JSONStreamWriter::HexValue(const unsigned char* begin, const unsigned char* end)
+{
+    // Hex digits need no escaping, so the string can go out piece by piece
+    static const size_t HEX_PIECE_SIZE = 4096;
+    Separate();
+    Append("\"", 1);
+    while (begin < end) {
+        const unsigned char* pieceEnd = begin + std::min<size_t>(end - begin, HEX_PIECE_SIZE);
+        Append(HexStr(begin, pieceEnd));
+        begin = pieceEnd;
+    }
+    Append("\"", 1);
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBALTOKEN_RPC_JSONSTREAM_H
+#define GLOBALTOKEN_RPC_JSONSTREAM_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <univalue.h>
+
+//! Bytes collected before they are handed to the sink of a JSONStreamWriter
+static const size_t JSON_STREAM_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * Writes compact JSON, the same as UniValue::write() without indentation,
+ * while it is produced. Large results are written one element at a time
+ * instead of being built as a whole UniValue tree first, and the text is
+ * handed to the sink in chunks instead of as one string.
+ *
+ * Nothing is written on destruction: a writer that is dropped half way
+ * leaves only the chunks already handed over.
+ */
+class JSONStreamWriter
+{
+public:
+    typedef std::function<void(const char* data, size_t size)> Sink;
+
+    explicit JSONStreamWriter(const Sink& sinkIn, size_t nChunkSizeIn = JSON_STREAM_CHUNK_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    /** Write the key of the next member of the current object */
+    void Key(const std::string& key);
+    /** Write a complete value */
+    void Value(const UniValue& value);
+    /** Write a complete value that is already compact JSON */
+    void RawValue(const std::string& json);
+    /** Write a string value of the hex encoding of [begin, end), without a copy of it */
+    void HexValue(const unsigned char* begin, const unsigned char* end);
+
+    /** Whether a key was written that still waits for its value */
+    bool AfterKey() const { return fAfterKey; }
+
+    /** Hand everything written so far to the sink */
+    void Flush();
+
+private:
+    Sink sink;
+    size_t nChunkSize;
+    std::string buffer;
+    //! For each open object or array, whether it is still empty
+    std::vector<bool> vEmpty;
+    bool fAfterKey;
+
+    /** Write the comma before an element, if needed */
+    void Separate();
+    void Append(const char* data, size_t size);
+    void Append(const std::string& str) { Append(str.data(), str.size()); }
+};
+
+#endif // GLOBALTOKEN_RPC_JSONSTREAM_H
@@ -14,6 +14,7 @@
 #include <masternode-sync.h>
 #include <masternodeconfig.h>
 #include <masternodeman.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <script/standard.h>
 #include <util.h>
@@ -494,115 +495,132 @@ UniValue masternodelist(const JSONRPCRequest& request)
         mnodeman.UpdateLastPaid(pindex);
     }
 
+    // The list of a large network is written out entry by entry if the
+    // reply is streamed, instead of building the whole object first.
     UniValue obj(UniValue::VOBJ);
+    JSONStreamWriter* stream = request.resultStream;
+    auto pushKV = [&obj, stream](const std::string& key, const UniValue& value) {
+        if (stream) {
+            stream->Key(key);
+            stream->Value(value);
+        } else {
+            obj.pushKV(key, value);
+        }
+    };
+    if (stream)
+        stream->BeginObject();
     if (strMode == "rank") {
         CMasternodeMan::rank_pair_vec_t vMasternodeRanks;
         mnodeman.GetMasternodeRanks(vMasternodeRanks);
         for (const auto& rankpair : vMasternodeRanks) {
             std::string strOutpoint = rankpair.second.outpoint.ToStringShort();
             if (strFilter !="" && strOutpoint.find(strFilter) == std::string::npos) continue;
-            obj.pushKV(strOutpoint, rankpair.first);
+            pushKV(strOutpoint, rankpair.first);
         }
     } else {
-        std::map<COutPoint, CMasternode> mapMasternodes = mnodeman.GetFullMasternodeMap();
-        for (const auto& mnpair : mapMasternodes) {
-            CMasternode mn = mnpair.second;
-            std::string strOutpoint = mnpair.first.ToStringShort();
+        CMasternodeListSnapshotRef snapshot = mnodeman.GetMasternodeListSnapshot();
+        for (const CMasternodeListEntry& entry : snapshot->vMasternodes) {
+            const masternode_info_t& mn = entry.info;
+            std::string strOutpoint = mn.outpoint.ToStringShort();
             if (strMode == "activeseconds") {
                 if (strFilter !="" && strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, (int64_t)(mn.lastPing.sigTime - mn.sigTime));
+                pushKV(strOutpoint, (int64_t)(mn.nTimeLastPing - mn.sigTime));
             } else if (strMode == "addr") {
                 std::string strAddress = mn.addr.ToString();
                 if (strFilter !="" && strAddress.find(strFilter) == std::string::npos &&
                     strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, strAddress);
+                pushKV(strOutpoint, strAddress);
             } else if (strMode == "daemon") {
-                std::string strDaemon = mn.lastPing.nDaemonVersion > DEFAULT_DAEMON_VERSION ? FormatVersion(mn.lastPing.nDaemonVersion) : "Unknown";
+                std::string strDaemon = entry.nDaemonVersion > DEFAULT_DAEMON_VERSION ? FormatVersion(entry.nDaemonVersion) : "Unknown";
                 if (strFilter !="" && strDaemon.find(strFilter) == std::string::npos &&
                     strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, strDaemon);
+                pushKV(strOutpoint, strDaemon);
             } else if (strMode == "full") {
                 std::ostringstream streamFull;
                 streamFull << std::setw(18) <<
-                               mn.GetStatus() << " " <<
+                               entry.GetStatus() << " " <<
                                mn.nProtocolVersion << " " <<
                                EncodeDestination(mn.pubKeyCollateralAddress.GetID()) << " " <<
-                               (int64_t)mn.lastPing.sigTime << " " << std::setw(8) <<
-                               (int64_t)(mn.lastPing.sigTime - mn.sigTime) << " " << std::setw(10) <<
-                               mn.GetLastPaidTime() << " "  << std::setw(6) <<
-                               mn.GetLastPaidBlock() << " " <<
+                               (int64_t)mn.nTimeLastPing << " " << std::setw(8) <<
+                               (int64_t)(mn.nTimeLastPing - mn.sigTime) << " " << std::setw(10) <<
+                               mn.nTimeLastPaid << " "  << std::setw(6) <<
+                               entry.nBlockLastPaid << " " <<
                                mn.addr.ToString();
                 std::string strFull = streamFull.str();
                 if (strFilter !="" && strFull.find(strFilter) == std::string::npos &&
                     strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, strFull);
+                pushKV(strOutpoint, strFull);
             } else if (strMode == "info") {
                 std::ostringstream streamInfo;
                 streamInfo << std::setw(18) <<
-                               mn.GetStatus() << " " <<
+                               entry.GetStatus() << " " <<
                                mn.nProtocolVersion << " " <<
                                EncodeDestination(mn.pubKeyCollateralAddress.GetID()) << " " <<
-                               (int64_t)mn.lastPing.sigTime << " " << std::setw(8) <<
-                               (int64_t)(mn.lastPing.sigTime - mn.sigTime) << " " <<
+                               (int64_t)mn.nTimeLastPing << " " << std::setw(8) <<
+                               (int64_t)(mn.nTimeLastPing - mn.sigTime) << " " <<
                                mn.addr.ToString();
                 std::string strInfo = streamInfo.str();
                 if (strFilter !="" && strInfo.find(strFilter) == std::string::npos &&
                     strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, strInfo);
+                pushKV(strOutpoint, strInfo);
             } else if (strMode == "json") {
                 std::ostringstream streamInfo;
                 streamInfo <<  mn.addr.ToString() << " " <<
                                EncodeDestination(mn.pubKeyCollateralAddress.GetID()) << " " <<
-                               mn.GetStatus() << " " <<
+                               entry.GetStatus() << " " <<
                                mn.nProtocolVersion << " " <<
-                               mn.lastPing.nDaemonVersion << " " <<
-                               (int64_t)mn.lastPing.sigTime << " " <<
-                               (int64_t)(mn.lastPing.sigTime - mn.sigTime) << " " <<
-                               mn.GetLastPaidTime() << " " <<
-                               mn.GetLastPaidBlock();
+                               entry.nDaemonVersion << " " <<
+                               (int64_t)mn.nTimeLastPing << " " <<
+                               (int64_t)(mn.nTimeLastPing - mn.sigTime) << " " <<
+                               mn.nTimeLastPaid << " " <<
+                               entry.nBlockLastPaid;
                 std::string strInfo = streamInfo.str();
                 if (strFilter !="" && strInfo.find(strFilter) == std::string::npos &&
                     strOutpoint.find(strFilter) == std::string::npos) continue;
                 UniValue objMN(UniValue::VOBJ);
                 objMN.pushKV("address", mn.addr.ToString());
                 objMN.pushKV("payee", EncodeDestination(mn.pubKeyCollateralAddress.GetID()));
-                objMN.pushKV("status", mn.GetStatus());
+                objMN.pushKV("status", entry.GetStatus());
                 objMN.pushKV("protocol", mn.nProtocolVersion);
-                objMN.pushKV("daemonversion", mn.lastPing.nDaemonVersion > DEFAULT_DAEMON_VERSION ? FormatVersion(mn.lastPing.nDaemonVersion) : "Unknown");
-                objMN.pushKV("lastseen", (int64_t)mn.lastPing.sigTime);
-                objMN.pushKV("activeseconds", (int64_t)(mn.lastPing.sigTime - mn.sigTime));
-                objMN.pushKV("lastpaidtime", mn.GetLastPaidTime());
-                objMN.pushKV("lastpaidblock", mn.GetLastPaidBlock());
-                obj.pushKV(strOutpoint, objMN);
+                objMN.pushKV("daemonversion", entry.nDaemonVersion > DEFAULT_DAEMON_VERSION ? FormatVersion(entry.nDaemonVersion) : "Unknown");
+                objMN.pushKV("lastseen", (int64_t)mn.nTimeLastPing);
+                objMN.pushKV("activeseconds", (int64_t)(mn.nTimeLastPing - mn.sigTime));
+                objMN.pushKV("lastpaidtime", mn.nTimeLastPaid);
+                objMN.pushKV("lastpaidblock", entry.nBlockLastPaid);
+                pushKV(strOutpoint, objMN);
             } else if (strMode == "lastpaidblock") {
                 if (strFilter !="" && strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, mn.GetLastPaidBlock());
+                pushKV(strOutpoint, entry.nBlockLastPaid);
             } else if (strMode == "lastpaidtime") {
                 if (strFilter !="" && strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, mn.GetLastPaidTime());
+                pushKV(strOutpoint, mn.nTimeLastPaid);
             } else if (strMode == "lastseen") {
                 if (strFilter !="" && strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, (int64_t)mn.lastPing.sigTime);
+                pushKV(strOutpoint, (int64_t)mn.nTimeLastPing);
             } else if (strMode == "payee") {
                 std::string strPayee = EncodeDestination(mn.pubKeyCollateralAddress.GetID());
                 if (strFilter !="" && strPayee.find(strFilter) == std::string::npos &&
                     strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, strPayee);
+                pushKV(strOutpoint, strPayee);
             } else if (strMode == "protocol") {
                 if (strFilter !="" && strFilter != strprintf("%d", mn.nProtocolVersion) &&
                     strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, mn.nProtocolVersion);
+                pushKV(strOutpoint, mn.nProtocolVersion);
             } else if (strMode == "pubkey") {
                 if (strFilter !="" && strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, HexStr(mn.pubKeyMasternode));
+                pushKV(strOutpoint, HexStr(mn.pubKeyMasternode));
             } else if (strMode == "status") {
-                std::string strStatus = mn.GetStatus();
+                std::string strStatus = entry.GetStatus();
                 if (strFilter !="" && strStatus.find(strFilter) == std::string::npos &&
                     strOutpoint.find(strFilter) == std::string::npos) continue;
-                obj.pushKV(strOutpoint, strStatus);
+                pushKV(strOutpoint, strStatus);
             }
         }
     }
+    if (stream) {
+        stream->EndObject();
+        return NullUniValue;
+    }
     return obj;
 }
 
@@ -9,16 +9,19 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <algostats.h>
 #include <base58.h>
 #include <amount.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <consensus/consensus.h>
+#include <consensus/merkle.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
 #include <core_io.h>
 #include <crypto/algos/equihash/equihash.h>
 #include <globaltoken/hardfork.h>
+#include <globaltoken/multihasher.h>
 #include <init.h>
 #include <validation.h>
 #include <miner.h>
@@ -27,6 +30,7 @@
 #include <pow.h>
 #include <primitives/mining_block.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <rpc/mining.h>
 #include <rpc/server.h>
 #include <spork.h>
@@ -39,6 +43,8 @@
 #include <masternode-payments.h>
 #include <masternode-sync.h>
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <stdint.h>
 
@@ -201,6 +207,56 @@ UniValue getnetworkhashps(const JSONRPCRequest& request)
     return GetNetworkHashPS(algo, !request.params[0].isNull() ? request.params[0].get_int() : 24, !request.params[1].isNull() ? request.params[1].get_int() : -1);
 }
 
+/**
+ * Increment the nonce of a non-Equihash header until its proof of work hash
+ * meets the target, nMaxTries is exhausted or the nonce reaches
+ * nInnerLoopCount. Algorithms with a midstate only hash the header prefix once,
+ * and those with a batch kernel hash MULTIHASH_BATCH_LANES nonces at a time.
+ */
+static void ScanDefaultHeaderNonce(CDefaultBlockHeader& header, uint8_t nAlgo, uint64_t& nMaxTries, int nInnerLoopCount)
+{
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    const int nHashVersion = LoadMultiHasherVersionFlags(consensusParams.Hardfork3.IsActivated(header.nTime));
+
+    if (CMultihashMidstate::IsSupported(nAlgo)) {
+        const CMultihashMidstate midstate = SerializeMultiAlgoMidstate(header, nAlgo, SER_GETHASH, nHashVersion);
+        while (nMaxTries > 0 && header.nNonce < nInnerLoopCount && !CheckProofOfWork(midstate.GetHash(header.nNonce), header.nBits, consensusParams, nAlgo)) {
+            ++header.nNonce;
+            --nMaxTries;
+        }
+        return;
+    }
+
+    if (CMultihasher::HasBatchKernel(nAlgo)) {
+        CDefaultBlockHeader batch[MULTIHASH_BATCH_LANES];
+        const CDefaultBlockHeader* pbatch[MULTIHASH_BATCH_LANES];
+        uint256 hashes[MULTIHASH_BATCH_LANES];
+        while (nMaxTries > 0 && header.nNonce < nInnerLoopCount) {
+            const size_t nLanes = std::min<uint64_t>(std::min<uint64_t>(MULTIHASH_BATCH_LANES, nMaxTries), nInnerLoopCount - header.nNonce);
+            for (size_t i = 0; i < nLanes; i++) {
+                batch[i] = header;
+                batch[i].nNonce = header.nNonce + i;
+                pbatch[i] = &batch[i];
+            }
+            SerializeMultiAlgoHashBatch(pbatch, nLanes, nAlgo, hashes, SER_GETHASH, nHashVersion);
+            for (size_t i = 0; i < nLanes; i++) {
+                if (CheckProofOfWork(hashes[i], header.nBits, consensusParams, nAlgo)) {
+                    header.nNonce += i;
+                    return;
+                }
+                --nMaxTries;
+            }
+            header.nNonce += nLanes;
+        }
+        return;
+    }
+
+    while (nMaxTries > 0 && header.nNonce < nInnerLoopCount && !CheckProofOfWork(header.GetPoWHash(nAlgo, SER_GETHASH, nHashVersion), header.nBits, consensusParams, nAlgo)) {
+        ++header.nNonce;
+        --nMaxTries;
+    }
+}
+
 UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGenerate, uint64_t nMaxTries, bool keepScript, uint8_t nAlgo)
 {
 	static const int nInnerLoopGlobalTokenMask = 0x1FFFF;
@@ -328,10 +384,7 @@ UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGen
                 CDefaultBlockHeader defaultblockheader = pblock->GetDefaultBlockHeader();
 				nInnerLoopMask = nInnerLoopGlobalTokenMask;
 				nInnerLoopCount = nInnerLoopGlobalTokenCount;
-				while (nMaxTries > 0 && defaultblockheader.nNonce < nInnerLoopCount && !CheckProofOfWork(defaultblockheader.GetPoWHash(nAlgo, SER_GETHASH, LoadMultiHasherVersionFlags(Params().GetConsensus().Hardfork3.IsActivated(defaultblockheader.nTime))), defaultblockheader.nBits, Params().GetConsensus(), nAlgo)) {
-					++defaultblockheader.nNonce;
-					--nMaxTries;
-				}
+				ScanDefaultHeaderNonce(defaultblockheader, nAlgo, nMaxTries, nInnerLoopCount);
                 
                 // If Block is found convert CDefaultBlockHeader calculated stuff to pblock
                 
@@ -343,10 +396,7 @@ UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGen
             CDefaultBlockHeader defaultblockheader = pblock->GetDefaultBlockHeader();
 			nInnerLoopMask = nInnerLoopGlobalTokenMask;
 			nInnerLoopCount = nInnerLoopGlobalTokenCount;
-			while (nMaxTries > 0 && defaultblockheader.nNonce < nInnerLoopCount && !CheckProofOfWork(defaultblockheader.GetPoWHash(ALGO_SHA256D, SER_GETHASH, LoadMultiHasherVersionFlags(Params().GetConsensus().Hardfork3.IsActivated(defaultblockheader.nTime))), defaultblockheader.nBits, Params().GetConsensus(), ALGO_SHA256D)) {
-				++defaultblockheader.nNonce;
-				--nMaxTries;
-			}
+			ScanDefaultHeaderNonce(defaultblockheader, ALGO_SHA256D, nMaxTries, nInnerLoopCount);
             
             // If Block is found convert CDefaultBlockHeader calculated stuff to pblock
                 
@@ -461,22 +511,22 @@ UniValue getmininginfo(const JSONRPCRequest& request)
         );
 
 
-    LOCK(cs_main);
+    const CAlgoStatsSnapshot stats = algoStats.GetSnapshot();
 
     UniValue obj(UniValue::VOBJ);
     UniValue algodetails(UniValue::VOBJ);
-    obj.pushKV("blocks",             (int)chainActive.Height());
+    obj.pushKV("blocks",             stats.nHeight);
     obj.pushKV("currentblockweight", (uint64_t)nLastBlockWeight);
     obj.pushKV("currentblocktx",     (uint64_t)nLastBlockTx);
 	obj.pushKV("algoid",             currentAlgo);
 	obj.pushKV("algo",               GetAlgoName(currentAlgo));
-    obj.pushKV("difficulty",         (double)GetDifficulty(NULL, currentAlgo));
-    obj.pushKV("networkhashps",      getnetworkhashps(request));
+    obj.pushKV("difficulty",         GetDifficultyFromBits(stats.algos[currentAlgo].nBits));
+    obj.pushKV("networkhashps",      stats.algos[currentAlgo].dNetworkHashPS);
     for(uint8_t i = 0; i < NUM_ALGOS; i++)
     {
         UniValue currentAlgo(UniValue::VOBJ);
-        currentAlgo.pushKV("difficulty",       (double)GetDifficulty(NULL, i));
-        currentAlgo.pushKV("nethashrate",      GetNetworkHashPS(i, 24, -1));
+        currentAlgo.pushKV("difficulty",       GetDifficultyFromBits(stats.algos[i].nBits));
+        currentAlgo.pushKV("nethashrate",      stats.algos[i].dNetworkHashPS);
         algodetails.pushKV(GetAlgoName(i), currentAlgo);
     }
 	obj.pushKV("algodetails", algodetails);
@@ -518,19 +568,17 @@ UniValue getalgoinfo(const JSONRPCRequest& request)
             + HelpExampleRpc("getalgoinfo", "")
         );
 
-    LOCK(cs_main);
-	
-    CBlockIndex* tip = chainActive.Tip();
+    const CAlgoStatsSnapshot stats = algoStats.GetSnapshot();
 
     UniValue obj(UniValue::VOBJ);
     UniValue algos(UniValue::VOBJ);
 	
-    obj.pushKV("blocks",                (int)chainActive.Height());
-    obj.pushKV("headers",               pindexBestHeader ? pindexBestHeader->nHeight : -1);
-    obj.pushKV("bestblockhash",         tip->GetBlockHash().GetHex());
+    obj.pushKV("blocks",                stats.nHeight);
+    obj.pushKV("headers",               stats.nHeaders);
+    obj.pushKV("bestblockhash",         stats.hashTip.GetHex());
     obj.pushKV("algos",                 NUM_ALGOS);
-    obj.pushKV("lastblockalgo",         GetAlgoName(tip->GetAlgo()));
-    obj.pushKV("lastblockalgoid",       tip->GetAlgo());
+    obj.pushKV("lastblockalgo",         GetAlgoName(stats.nTipAlgo));
+    obj.pushKV("lastblockalgoid",       stats.nTipAlgo);
     obj.pushKV("localalgo",             GetAlgoName(currentAlgo));
     obj.pushKV("localalgoid",           currentAlgo);
     
@@ -539,16 +587,16 @@ UniValue getalgoinfo(const JSONRPCRequest& request)
     for(uint8_t i = 0; i < NUM_ALGOS; i++)
     {
 	    UniValue algo_description(UniValue::VOBJ);
-        const CBlockIndex* pindexLastAlgo = GetLastBlockIndexForAlgo(tip, consensusParams.aPOWAlgos[i].GetAlgoID(), consensusParams);
-        int lastblock = (pindexLastAlgo != nullptr) ? pindexLastAlgo->nHeight : -1;
+        const uint8_t nAlgo = consensusParams.aPOWAlgos[i].GetAlgoID();
+        const CAlgoChainStats& algo = stats.algos[nAlgo];
 	
-        algo_description.pushKV("algoid",      consensusParams.aPOWAlgos[i].GetAlgoID());
-        algo_description.pushKV("lastblock",   lastblock);
-        algo_description.pushKV("difficulty",  (double)GetDifficulty(NULL, consensusParams.aPOWAlgos[i].GetAlgoID()));
-        algo_description.pushKV("nethashrate", GetNetworkHashPS(consensusParams.aPOWAlgos[i].GetAlgoID(), 24, -1));
-        algo_description.pushKV("lastdiffret", CalculateDiffRetargetingBlock(tip, RETARGETING_LAST, consensusParams.aPOWAlgos[i].GetAlgoID(), Params().GetConsensus()));
-        algo_description.pushKV("nextdiffret", CalculateDiffRetargetingBlock(tip, RETARGETING_NEXT, consensusParams.aPOWAlgos[i].GetAlgoID(), Params().GetConsensus()));
-        algos.pushKV(GetAlgoName(consensusParams.aPOWAlgos[i].GetAlgoID()), algo_description);
+        algo_description.pushKV("algoid",      nAlgo);
+        algo_description.pushKV("lastblock",   algo.nLastBlock);
+        algo_description.pushKV("difficulty",  GetDifficultyFromBits(algo.nBits));
+        algo_description.pushKV("nethashrate", algo.dNetworkHashPS);
+        algo_description.pushKV("lastdiffret", algo.nLastDiffRet);
+        algo_description.pushKV("nextdiffret", algo.nNextDiffRet);
+        algos.pushKV(GetAlgoName(nAlgo), algo_description);
     }
 	
     obj.pushKV("algo_details", algos);
@@ -619,6 +667,92 @@ std::string gbt_vb_name(const Consensus::DeploymentPos pos) {
     return s;
 }
 
+UniValue BlockTemplateTxToJSON(const CBlockTemplate& blocktemplate, size_t nIndex, const std::map<uint256, int64_t>& mapTxIndex, bool fPreSegWit)
+{
+    const CTransaction& tx = *blocktemplate.block.vtx[nIndex];
+    UniValue entry(UniValue::VOBJ);
+
+    entry.pushKV("data", EncodeHexTx(tx));
+    entry.pushKV("txid", tx.GetHash().GetHex());
+    entry.pushKV("hash", tx.GetWitnessHash().GetHex());
+
+    UniValue deps(UniValue::VARR);
+    for (const CTxIn &in : tx.vin)
+    {
+        auto it = mapTxIndex.find(in.prevout.hash);
+        if (it != mapTxIndex.end())
+            deps.push_back(it->second);
+    }
+    entry.pushKV("depends", deps);
+
+    entry.pushKV("fee", blocktemplate.vTxFees[nIndex]);
+    int64_t nTxSigOps = blocktemplate.vTxSigOpsCost[nIndex];
+    if (fPreSegWit) {
+        assert(nTxSigOps % WITNESS_SCALE_FACTOR == 0);
+        nTxSigOps /= WITNESS_SCALE_FACTOR;
+    }
+    entry.pushKV("sigops", nTxSigOps);
+    entry.pushKV("weight", GetTransactionWeight(tx));
+    return entry;
+}
+
+CGBTTemplate::CGBTTemplate() : pindexPrev(nullptr), nStart(0), nTransactionsUpdated(0), fSupportsSegwit(false), fPreSegWit(false)
+{
+}
+
+CGBTTemplate::~CGBTTemplate()
+{
+}
+
+void CGBTTemplate::Set(std::unique_ptr<CBlockTemplate> pblocktemplateIn, bool fPreSegWitIn)
+{
+    pblocktemplate = std::move(pblocktemplateIn);
+    fPreSegWit = fPreSegWitIn;
+    std::string().swap(strTransactions);
+    transactions = UniValue();
+}
+
+void CGBTTemplate::Release()
+{
+    Set(nullptr, false);
+    pindexPrev = nullptr;
+}
+
+/** Call func with the getblocktemplate entry of each non-coinbase transaction of a template */
+static void ForEachBlockTemplateTx(const CBlockTemplate& blocktemplate, bool fPreSegWit, const std::function<void(UniValue&&)>& func)
+{
+    std::map<uint256, int64_t> mapTxIndex;
+    const std::vector<CTransactionRef>& vtx = blocktemplate.block.vtx;
+    for (size_t i = 0; i < vtx.size(); i++) {
+        mapTxIndex[vtx[i]->GetHash()] = i;
+        // The coinbase is shown on its own, as it depends on the request
+        if (!vtx[i]->IsCoinBase())
+            func(BlockTemplateTxToJSON(blocktemplate, i, mapTxIndex, fPreSegWit));
+    }
+}
+
+const std::string& CGBTTemplate::GetTransactionsJSON()
+{
+    if (strTransactions.empty()) {
+        // Written entry by entry, so the whole array is never held as a UniValue
+        JSONStreamWriter writer([this](const char* data, size_t size) { strTransactions.append(data, size); });
+        writer.BeginArray();
+        ForEachBlockTemplateTx(*pblocktemplate, fPreSegWit, [&writer](UniValue&& entry) { writer.Value(entry); });
+        writer.EndArray();
+        writer.Flush();
+    }
+    return strTransactions;
+}
+
+const UniValue& CGBTTemplate::GetTransactions()
+{
+    if (transactions.isNull()) {
+        transactions = UniValue(UniValue::VARR);
+        ForEachBlockTemplateTx(*pblocktemplate, fPreSegWit, [this](UniValue&& entry) { transactions.push_back(entry); });
+    }
+    return transactions;
+}
+
 UniValue getblocktemplate(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 2)
@@ -637,7 +771,7 @@ UniValue getblocktemplate(const JSONRPCRequest& request)
             "     {\n"
             "       \"mode\":\"template\"    (string, optional) This must be set to \"template\", \"proposal\" (see BIP 23),or omitted\n"
             "       \"capabilities\":[     (array, optional) A list of strings\n"
-            "           \"support\"          (string) client side supported feature, 'longpoll', 'coinbasetxn', 'coinbasevalue', 'proposal', 'serverlist', 'workid'\n"
+            "           \"support\"          (string) client side supported feature, 'longpoll', 'coinbasetxn', 'coinbasevalue', 'proposal', 'serverlist', 'workid', 'midstate'\n"
             "           ,...\n"
             "       ],\n"
             "       \"rules\":[            (array, optional) A list of strings\n"
@@ -698,6 +832,8 @@ UniValue getblocktemplate(const JSONRPCRequest& request)
             "  \"weightlimit\" : n,                (numeric) limit of block weight\n"
             "  \"curtime\" : ttt,                  (numeric) current timestamp in seconds since epoch (Jan 1 1970 GMT)\n"
             "  \"bits\" : \"xxxxxxxx\",              (string) compressed target of next block\n"
+            "  \"merkleroot\" : \"xxxx\",            (string, optional) merkle root of the template with 'coinbasetxn', given with 'midstate'\n"
+            "  \"midstate\" : \"xxxx\",              (string, optional) with the 'midstate' and 'coinbasetxn' capabilities, the first hash stage state after the first 64 header bytes as little endian 32-bit words, for algorithms that have one\n"
             "  \"height\" : n                      (numeric) The height of the next block\n"
             "  \"masternode\" : {                  (json object) required masternode payee that must be included in the next block\n"
             "      \"payee\" : \"xxxx\",             (string) payee address\n"
@@ -899,33 +1035,37 @@ UniValue getblocktemplate(const JSONRPCRequest& request)
         coinbasetxnscript = GetScriptForDestination(destination);
     }
 
-    // Update block
-    static CBlockIndex* pindexPrev;
-    static int64_t nStart;
-    static std::unique_ptr<CBlockTemplate> pblocktemplate;
-    // Cache whether the last invocation was with segwit support, to avoid returning
-    // a segwit-block to a non-segwit caller.
-    static bool fLastTemplateSupportsSegwit = true;
-    static uint8_t lastAlgo;
-    if (pindexPrev != chainActive.Tip() ||
-        (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > 5) ||
-        fLastTemplateSupportsSegwit != fSupportsSegwit || algo != lastAlgo)
+    // Update block. Each algo keeps its own template, so that miners of
+    // several algos asking in turn do not remake it on every call.
+    static CGBTTemplate gbtTemplates[NUM_ALGOS];
+    CGBTTemplate& gbt = gbtTemplates[algo];
+    // Templates on an earlier tip are of no use anymore, whether or not
+    // their algo is asked for again
+    for (CGBTTemplate& gbtOther : gbtTemplates) {
+        if (gbtOther.pblocktemplate && gbtOther.pindexPrev != chainActive.Tip())
+            gbtOther.Release();
+    }
+    const CScript createscript = (coinbasetxn) ? coinbasetxnscript : (CScript() << OP_TRUE);
+    // The template is remade for a caller without segwit support, to avoid
+    // returning a segwit-block to it.
+    if (gbt.pindexPrev != chainActive.Tip() ||
+        (mempool.GetTransactionsUpdated() != gbt.nTransactionsUpdated && GetTime() - gbt.nStart > 5) ||
+        gbt.fSupportsSegwit != fSupportsSegwit || gbt.scriptCoinbase != createscript)
     {
         // Clear pindexPrev so future calls make a new block, despite any failures from here on
-        pindexPrev = nullptr;
+        gbt.pindexPrev = nullptr;
 
         // Store the pindexBest used before CreateNewBlock, to avoid races
         nTransactionsUpdatedLast = mempool.GetTransactionsUpdated();
+        gbt.nTransactionsUpdated = nTransactionsUpdatedLast;
         CBlockIndex* pindexPrevNew = chainActive.Tip();
-        nStart = GetTime();
-        fLastTemplateSupportsSegwit = fSupportsSegwit;
-        lastAlgo = algo;
+        gbt.nStart = GetTime();
+        gbt.fSupportsSegwit = fSupportsSegwit;
+        gbt.scriptCoinbase = createscript;
 
         // Create new block
-        CScript scriptDummy = CScript() << OP_TRUE;
-        CScript createscript = (coinbasetxn) ? coinbasetxnscript : scriptDummy;
-        pblocktemplate = BlockAssembler(Params()).CreateNewBlock(createscript, algo, fSupportsSegwit);
-        if (!pblocktemplate)
+        std::unique_ptr<CBlockTemplate> pblocktemplateNew = BlockAssembler(Params()).CreateNewBlock(createscript, algo, fSupportsSegwit);
+        if (!pblocktemplateNew)
         {
             if(Params().GetConsensus().Hardfork2.IsActivated(pindexPrevNew->nTime))
             {
@@ -946,9 +1086,15 @@ UniValue getblocktemplate(const JSONRPCRequest& request)
             }
         }
 
+        // NOTE: If at some point we support pre-segwit miners post-segwit-activation, this needs to take segwit support into consideration
+        const bool fPreSegWitNew = (THRESHOLD_ACTIVE != VersionBitsState(pindexPrevNew, Params().GetConsensus(), Consensus::DEPLOYMENT_SEGWIT, versionbitscache));
+        gbt.Set(std::move(pblocktemplateNew), fPreSegWitNew);
+
         // Need to update only after we know CreateNewBlock succeeded
-        pindexPrev = pindexPrevNew;
+        gbt.pindexPrev = pindexPrevNew;
     }
+    CBlockIndex* const pindexPrev = gbt.pindexPrev;
+    CBlockTemplate* const pblocktemplate = gbt.pblocktemplate.get();
     CBlock* pblock = &pblocktemplate->block; // pointer for convenience
     const Consensus::Params& consensusParams = Params().GetConsensus();
 
@@ -968,7 +1114,6 @@ UniValue getblocktemplate(const JSONRPCRequest& request)
 
     UniValue aCaps(UniValue::VARR); aCaps.push_back("proposal");
 
-    UniValue transactions(UniValue::VARR);
     UniValue txCoinbase = NullUniValue;
     UniValue masternodeObj(UniValue::VOBJ);
     UniValue treasuryObj(UniValue::VOBJ);
@@ -982,55 +1127,17 @@ UniValue getblocktemplate(const JSONRPCRequest& request)
         masternodeObj.pushKV("amount", (int64_t)pblock->txoutMasternode.nValue);
     }
     
-    std::map<uint256, int64_t> setTxIndex;
-    int i = 0;
-    for (const auto& it : pblock->vtx) {
-        const CTransaction& tx = *it;
-        uint256 txHash = tx.GetHash();
-        setTxIndex[txHash] = i++;
-
-        if (tx.IsCoinBase() && !coinbasetxn)
-            continue;
-
-        UniValue entry(UniValue::VOBJ);
-
-        entry.pushKV("data", EncodeHexTx(tx));
-        entry.pushKV("txid", txHash.GetHex());
-        entry.pushKV("hash", tx.GetWitnessHash().GetHex());
-
-        UniValue deps(UniValue::VARR);
-        for (const CTxIn &in : tx.vin)
-        {
-            if (setTxIndex.count(in.prevout.hash))
-                deps.push_back(setTxIndex[in.prevout.hash]);
-        }
-        entry.pushKV("depends", deps);
-
-        int index_in_template = i - 1;
-        entry.pushKV("fee", pblocktemplate->vTxFees[index_in_template]);
-        int64_t nTxSigOps = pblocktemplate->vTxSigOpsCost[index_in_template];
-        if (fPreSegWit) {
-            assert(nTxSigOps % WITNESS_SCALE_FACTOR == 0);
-            nTxSigOps /= WITNESS_SCALE_FACTOR;
-        }
-        entry.pushKV("sigops", nTxSigOps);
-        entry.pushKV("weight", GetTransactionWeight(tx));
-
-        if (tx.IsCoinBase()) 
-        {
-            // Show treasury reward if it is required and masternode payee
-            if (consensusParams.Hardfork1.IsActivated(pblock->nTime)) {
-                // Correct this if GetBlockTemplate changes the order
-                entry.pushKV("treasury", treasuryObj);
-                entry.pushKV("masternode", masternodeObj);
-            }
-            entry.pushKV("required", true);
-            txCoinbase = entry;
-        } 
-        else 
-        {
-            transactions.push_back(entry);
+    // The other transactions were serialized with the template
+    if (coinbasetxn)
+    {
+        txCoinbase = BlockTemplateTxToJSON(*pblocktemplate, 0, std::map<uint256, int64_t>(), fPreSegWit);
+        // Show treasury reward if it is required and masternode payee
+        if (consensusParams.Hardfork1.IsActivated(pblock->nTime)) {
+            // Correct this if GetBlockTemplate changes the order
+            txCoinbase.pushKV("treasury", treasuryObj);
+            txCoinbase.pushKV("masternode", masternodeObj);
         }
+        txCoinbase.pushKV("required", true);
     }
 
     UniValue aux(UniValue::VOBJ);
@@ -1104,7 +1211,8 @@ UniValue getblocktemplate(const JSONRPCRequest& request)
     }
 
     result.pushKV("previousblockhash", pblock->hashPrevBlock.GetHex());
-    result.pushKV("transactions", transactions);
+    // Streamed callers get the serialized transactions in place of this
+    result.pushKV("transactions", request.resultStream ? NullUniValue : gbt.GetTransactions());
     if (coinbasetxn) 
     {
         assert(txCoinbase.isObject());
@@ -1116,7 +1224,7 @@ UniValue getblocktemplate(const JSONRPCRequest& request)
         result.pushKV("coinbasevalue", (int64_t)pblock->vtx[0]->GetValueOut());
     }
     result.pushKV("treasury", treasuryObj);
-    result.pushKV("longpollid", chainActive.Tip()->GetBlockHash().GetHex() + i64tostr(nTransactionsUpdatedLast));
+    result.pushKV("longpollid", chainActive.Tip()->GetBlockHash().GetHex() + i64tostr(gbt.nTransactionsUpdated));
     result.pushKV("target", hashTarget.GetHex());
     result.pushKV("mintime", (int64_t)pindexPrev->GetMedianTimePast()+1);
     result.pushKV("mutable", aMutable);
@@ -1151,6 +1259,34 @@ UniValue getblocktemplate(const JSONRPCRequest& request)
         result.pushKV("default_witness_commitment", HexStr(pblocktemplate->vchCoinbaseCommitment.begin(), pblocktemplate->vchCoinbaseCommitment.end()));
     }
 
+    // The midstate only holds for the coinbase we hand out, so clients that
+    // build their own coinbase do not get one.
+    if (coinbasetxn && setCapabilitiesRules.count("midstate") && CMultihashMidstate::IsSupported(pblock->GetAlgo()))
+    {
+        CDefaultBlockHeader header = pblock->GetDefaultBlockHeader();
+        header.hashMerkleRoot = BlockMerkleRoot(*pblock);
+        const std::vector<unsigned char> vchState = SerializeMultiAlgoMidstate(header, pblock->GetAlgo()).GetState();
+        if (!vchState.empty()) {
+            result.pushKV("merkleroot", header.hashMerkleRoot.GetHex());
+            result.pushKV("midstate", HexStr(vchState.begin(), vchState.end()));
+        }
+    }
+
+    if (request.resultStream) {
+        JSONStreamWriter& writer = *request.resultStream;
+        const std::vector<std::string>& keys = result.getKeys();
+        const std::vector<UniValue>& values = result.getValues();
+        writer.BeginObject();
+        for (size_t j = 0; j < keys.size(); j++) {
+            writer.Key(keys[j]);
+            if (keys[j] == "transactions")
+                writer.RawValue(gbt.GetTransactionsJSON());
+            else
+                writer.Value(values[j]);
+        }
+        writer.EndObject();
+        return NullUniValue;
+    }
     return result;
 }
 
@@ -1423,8 +1559,7 @@ namespace {
  * RPC threads running in parallel.
  */
 CCriticalSection cs_auxblockCache;
-std::map<uint256, CBlock*> mapNewBlock;
-std::vector<std::unique_ptr<CBlockTemplate>> vNewBlockTemplate;
+CAuxBlockTemplateCache auxBlockCache;
 
 void AuxMiningCheck()
 {
@@ -1450,6 +1585,35 @@ void AuxMiningCheck()
   }
 }
 
+/**
+ * Wait to respond until either the best block changes, OR a minute has
+ * passed and there are more transactions, like the getblocktemplate long poll.
+ */
+void AuxMiningWaitForChange(const std::string& lpstr)
+{
+    // Format: <hashBestChain><nTransactionsUpdatedLast>
+    uint256 hashWatchedChain;
+    hashWatchedChain.SetHex(lpstr.substr(0, 64));
+    const unsigned int nTransactionsUpdatedLastLP = atoi64(lpstr.substr(std::min<size_t>(64, lpstr.size())));
+
+    std::chrono::steady_clock::time_point checktxtime = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+
+    WaitableLock lock(csBestBlock);
+    while (chainActive.Tip()->GetBlockHash() == hashWatchedChain && IsRPCRunning())
+    {
+        if (cvBlockChange.wait_until(lock, checktxtime) == std::cv_status::timeout)
+        {
+            // Timeout: Check transactions for update
+            if (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLastLP)
+                break;
+            checktxtime += std::chrono::seconds(10);
+        }
+    }
+
+    if (!IsRPCRunning())
+        throw JSONRPCError(RPC_CLIENT_NOT_CONNECTED, "Shutting down");
+}
+
 } // anonymous namespace
 
 UniValue AuxMiningCreateBlock(const CScript& scriptPubKey, const uint8_t nAlgo)
@@ -1458,27 +1622,26 @@ UniValue AuxMiningCreateBlock(const CScript& scriptPubKey, const uint8_t nAlgo)
 
     LOCK(cs_auxblockCache);
 
-    static unsigned nTransactionsUpdatedLast;
+    static unsigned nTransactionsUpdatedLast[NUM_ALGOS];
     static const CBlockIndex* pindexPrev = nullptr;
-    static uint64_t nStart;
-    static CBlock* pblock = nullptr;
+    static uint64_t nStart[NUM_ALGOS];
     static unsigned nExtraNonce = 0;
-    static uint8_t lastAlgo;
 
     // Update block
+    CBlock* pblock;
     {
     LOCK(cs_main);
-    if (pindexPrev != chainActive.Tip()
-        || (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast
-            && GetTime() - nStart > 60) || nAlgo != lastAlgo)
+    if (pindexPrev != chainActive.Tip())
+    {
+        // Clear old blocks since they're obsolete now.
+        auxBlockCache.Clear();
+        pindexPrev = chainActive.Tip();
+    }
+    pblock = auxBlockCache.GetCurrent(nAlgo);
+    if (pblock == nullptr
+        || (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast[nAlgo]
+            && GetTime() - nStart[nAlgo] > 60))
     {
-        if (pindexPrev != chainActive.Tip())
-        {
-            // Clear old blocks since they're obsolete now.
-            mapNewBlock.clear();
-            vNewBlockTemplate.clear();
-            pblock = nullptr;
-        }
 
         // Create new block with nonce = 0 and extraNonce = 1
         std::unique_ptr<CBlockTemplate> newBlock
@@ -1510,10 +1673,8 @@ UniValue AuxMiningCreateBlock(const CScript& scriptPubKey, const uint8_t nAlgo)
         }
 
         // Update state only when CreateNewBlock succeeded
-        nTransactionsUpdatedLast = mempool.GetTransactionsUpdated();
-        pindexPrev = chainActive.Tip();
-        nStart = GetTime();
-        lastAlgo = nAlgo;
+        nTransactionsUpdatedLast[nAlgo] = mempool.GetTransactionsUpdated();
+        nStart[nAlgo] = GetTime();
 	    
         // If new block is an Equihash block, set the nNonce to null, because it is randomized by default.
         if(IsEquihashBasedAlgo(nAlgo))
@@ -1524,17 +1685,12 @@ UniValue AuxMiningCreateBlock(const CScript& scriptPubKey, const uint8_t nAlgo)
         newBlock->block.SetAuxpowVersion(true);
 
         // Save
-        pblock = &newBlock->block;
-        mapNewBlock[pblock->GetHash()] = pblock;
-        vNewBlockTemplate.push_back(std::move(newBlock));
+        pblock = auxBlockCache.Add(std::move(newBlock), GetTime());
     }
     }
 
-    // At this point, pblock is always initialised:  If we make it here
-    // without creating a new block above, it means that, in particular,
-    // pindexPrev == chainActive.Tip().  But for that to happen, we must
-    // already have created a pblock in a previous call, as pindexPrev is
-    // initialised only when pblock is.
+    // At this point, pblock is always initialised:  Either the current
+    // block of the algo was found above, or a new one was created.
     assert(pblock);
 
     arith_uint256 target;
@@ -1557,6 +1713,7 @@ UniValue AuxMiningCreateBlock(const CScript& scriptPubKey, const uint8_t nAlgo)
     result.pushKV("bits", strprintf("%08x", pblock->nBits));
     result.pushKV("height", static_cast<int64_t> (pindexPrev->nHeight + 1));
     result.pushKV("target", HexStr(BEGIN(target), END(target)));
+    result.pushKV("longpollid", pindexPrev->GetBlockHash().GetHex() + i64tostr(nTransactionsUpdatedLast[nAlgo]));
 
     return result;
 }
@@ -1574,10 +1731,10 @@ bool AuxMiningSubmitBlock(const std::string& hashHex,
     std::string auxpowstring;
     uint32_t nVersion = CURRENT_AUXPOW_VERSION;
 
-    const std::map<uint256, CBlock*>::iterator mit = mapNewBlock.find(hash);
-    if (mit == mapNewBlock.end())
+    CBlock* pblock = auxBlockCache.Find(hash);
+    if (pblock == nullptr)
         throw JSONRPCError(RPC_INVALID_PARAMETER, "block hash unknown");
-    CBlock& block = *mit->second;
+    CBlock& block = *pblock;
     
     uint8_t nBlockAlgo = block.GetAlgo();
     
@@ -1618,13 +1775,15 @@ bool AuxMiningSubmitBlock(const std::string& hashHex,
 
 UniValue createauxblock(const JSONRPCRequest& request)
 {
-    if (request.fHelp || (request.params.size() < 1 && request.params.size() > 2))
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
         throw std::runtime_error(strprintf(
-            "createauxblock <address>\n"
+            "createauxblock <address> ( \"algo\" \"longpollid\" )\n"
             "\ncreate a new block and return information required to merge-mine it.\n"
             "\nArguments:\n"
             "1. address      (string, required) specify coinbase transaction payout address\n"
             "2. algo         (string, optional, default=%s) the pow algorithm to apply for this merge mining block. Available algorithms: %s\n"
+            "3. longpollid   (string, optional) the longpollid of an earlier result: wait until the tip changes,\n"
+            "                or a minute passed and there are new transactions, before returning a block\n"
             "\nResult:\n"
             "{\n"
             "  \"algo\"               (string) the pow algorithm, to mine this block.\n"
@@ -1640,6 +1799,7 @@ UniValue createauxblock(const JSONRPCRequest& request)
             "  \"bits\"               (string) compressed target of the block\n"
             "  \"height\"             (numeric) height of the block\n"
             "  \"_target\"            (string) target in reversed byte order, deprecated\n"
+            "  \"longpollid\"         (string) id to wait for newer work with\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("createauxblock", "\"address\"")
@@ -1669,6 +1829,9 @@ UniValue createauxblock(const JSONRPCRequest& request)
     if(!fAlgoFound)
         throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid mining algorithm '%s' selected. Available algorithms: %s", request.params[1].get_str(), GetAlgoRangeString()));
 
+    if (!request.params[2].isNull())
+        AuxMiningWaitForChange(request.params[2].get_str());
+
     return AuxMiningCreateBlock(scriptPubKey, nAlgo);
 }
 
@@ -1713,7 +1876,7 @@ static const CRPCCommand commands[] =
     { "mining",             "prioritisetransaction",  &prioritisetransaction,  {"txid","dummy","fee_delta"} },
     { "mining",             "getblocktemplate",       &getblocktemplate,       {"template_request","algo"} },
     { "mining",             "submitblock",            &submitblock,            {"hexdata","dummy"} },
-    { "mining",             "createauxblock",         &createauxblock,         {"address", "algo"} },
+    { "mining",             "createauxblock",         &createauxblock,         {"address", "algo", "longpollid"} },
     { "mining",             "submitauxblock",         &submitauxblock,         {"hash", "auxpow", "auxpowversion"} },
 
 
@@ -6,11 +6,56 @@
 #define BITCOIN_RPC_MINING_H
 
 #include <script/script.h>
+#include <uint256.h>
 
+#include <map>
+#include <memory>
 #include <string>
 
 #include <univalue.h>
 
+class CBlockIndex;
+struct CBlockTemplate;
+
+/**
+ * A getblocktemplate block template of one algo, with the part of the reply
+ * that only changes with the template: its non-coinbase transactions. They
+ * are built once, as a UniValue for the callers that reply with one and as
+ * compact JSON for the ones that stream the reply. Calls for the same
+ * template only add the header fields and the coinbase.
+ */
+struct CGBTTemplate
+{
+    std::unique_ptr<CBlockTemplate> pblocktemplate;
+    //! What the template was made for, to know when it has to be remade
+    CBlockIndex* pindexPrev;
+    int64_t nStart;
+    unsigned int nTransactionsUpdated;
+    bool fSupportsSegwit;
+    CScript scriptCoinbase;
+
+    CGBTTemplate();
+    ~CGBTTemplate();
+
+    /** Take a new template */
+    void Set(std::unique_ptr<CBlockTemplate> pblocktemplateIn, bool fPreSegWitIn);
+    /** Free the template and the replies built from it */
+    void Release();
+    /** The "transactions" of the reply as compact JSON, for streaming callers */
+    const std::string& GetTransactionsJSON();
+    /** The "transactions" of the reply, for the other callers */
+    const UniValue& GetTransactions();
+
+private:
+    bool fPreSegWit;
+    //! Both built on first use
+    std::string strTransactions;
+    UniValue transactions;
+};
+
+/** A transaction of a block template as getblocktemplate shows it */
+UniValue BlockTemplateTxToJSON(const CBlockTemplate& blocktemplate, size_t nIndex, const std::map<uint256, int64_t>& mapTxIndex, bool fPreSegWit);
+
 /** Generate blocks (mine) */
 UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGenerate, uint64_t nMaxTries, bool keepScript, uint8_t nAlgo);
 
@@ -13,9 +13,12 @@
 #include <init.h>
 #include <validation.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
+#include <index/spentindex.h>
 #include <net.h>
 #include <netbase.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <timedata.h>
@@ -457,6 +460,175 @@ UniValue getmemoryinfo(const JSONRPCRequest& request)
     }
 }
 
+static UniValue RPCWorkQueueInfo()
+{
+    HTTPWorkQueueStats stats;
+    if (!GetHTTPWorkQueueStats(stats))
+        return NullUniValue;
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("depth", (uint64_t)stats.nDepth);
+    obj.pushKV("max_depth", (uint64_t)stats.nMaxDepth);
+    obj.pushKV("min_depth", (uint64_t)stats.nMinDepth);
+    obj.pushKV("depth_limit", (uint64_t)stats.nDepthLimit);
+    obj.pushKV("peak_depth", (uint64_t)stats.nPeakDepth);
+    obj.pushKV("enqueued", stats.nEnqueued);
+    obj.pushKV("rejected", stats.nRejected);
+    obj.pushKV("grown", stats.nGrown);
+    obj.pushKV("shrunk", stats.nShrunk);
+    obj.pushKV("avg_wait_ms", stats.nAvgWaitMicros / 1000.0);
+    obj.pushKV("max_wait_ms", stats.nMaxWaitMicros / 1000.0);
+    return obj;
+}
+
+static UniValue RPCMethodsInfo()
+{
+    UniValue obj(UniValue::VOBJ);
+    for (const auto& method : GetRPCMethodStats()) {
+        const CRPCMethodStats& stats = method.second;
+        UniValue latency(UniValue::VOBJ);
+        for (size_t i = 0; i < RPC_LATENCY_BUCKETS; i++)
+            latency.pushKV(i < RPC_LATENCY_BUCKETS - 1 ? std::to_string(RPC_LATENCY_BUCKET_BOUNDS[i]) : "inf", stats.vLatency[i]);
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("calls", stats.nCalls);
+        entry.pushKV("errors", stats.nErrors);
+        entry.pushKV("total_ms", stats.nTotalMicros / 1000.0);
+        entry.pushKV("max_ms", stats.nMaxMicros / 1000.0);
+        entry.pushKV("lock_wait_ms", stats.nLockWaitMicros / 1000.0);
+        entry.pushKV("lock_hold_ms", stats.nLockHoldMicros / 1000.0);
+        entry.pushKV("latency_ms", latency);
+        obj.pushKV(method.first, entry);
+    }
+    return obj;
+}
+
+UniValue getrpcinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getrpcinfo\n"
+            "Returns statistics of the RPC server: how requests queue for a worker thread and how long each method takes.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"workqueue\": {            (json object) The HTTP work queue, null if the HTTP server is not running\n"
+            "    \"depth\": n,             (numeric) Requests waiting for a worker thread\n"
+            "    \"max_depth\": n,         (numeric) Requests that may wait before new ones are rejected\n"
+            "    \"min_depth\": n,         (numeric) The depth the queue starts with and shrinks back to (-rpcworkqueue)\n"
+            "    \"depth_limit\": n,       (numeric) The depth the queue may grow to during bursts (-rpcworkqueuemax)\n"
+            "    \"peak_depth\": n,        (numeric) Most requests that waited at once\n"
+            "    \"enqueued\": n,          (numeric) Requests queued since startup\n"
+            "    \"rejected\": n,          (numeric) Requests rejected because the queue was full\n"
+            "    \"grown\": n,             (numeric) Times the queue grew for a burst of requests\n"
+            "    \"shrunk\": n,            (numeric) Times the queue shrank back after a burst\n"
+            "    \"avg_wait_ms\": x.xxx,   (numeric) Moving average of the time requests wait for a worker thread\n"
+            "    \"max_wait_ms\": x.xxx,   (numeric) Longest time a request waited for a worker thread\n"
+            "  },\n"
+            "  \"methods\": {              (json object) The methods called since startup\n"
+            "    \"method\": {\n"
+            "      \"calls\": n,           (numeric) Number of calls\n"
+            "      \"errors\": n,          (numeric) Number of calls that failed\n"
+            "      \"total_ms\": x.xxx,    (numeric) Time spent in the calls\n"
+            "      \"max_ms\": x.xxx,      (numeric) Time of the slowest call\n"
+            "      \"lock_wait_ms\": x.xxx,(numeric) Time the calls waited for the locks getlockinfo shows\n"
+            "      \"lock_hold_ms\": x.xxx,(numeric) Time the calls held those locks\n"
+            "      \"latency_ms\": {       (json object) Calls by latency: up to 1, 10, 100, 1000 and 10000 ms, and slower\n"
+            "        \"1\": n,\n"
+            "        ...\n"
+            "        \"inf\": n\n"
+            "      }\n"
+            "    },\n"
+            "    ...\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getrpcinfo", "")
+            + HelpExampleRpc("getrpcinfo", "")
+        );
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("workqueue", RPCWorkQueueInfo());
+    obj.pushKV("methods", RPCMethodsInfo());
+    return obj;
+}
+
+UniValue getlockinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "getlockinfo ( count )\n"
+            "Returns how long the profiled locks (cs_main, mempool.cs, mnodeman.cs, cs_instantsend and\n"
+            "cs_mapMasternodeBlocks, unless -lockprofile=0) were waited for and held, by the places they are taken.\n"
+            "\nArguments:\n"
+            "1. count    (numeric, optional, default=20) The number of places to return per lock, those holding it longest first, 0 for all\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"lock\": {                 (json object) A profiled lock\n"
+            "    \"acquired\": n,          (numeric) Times it was taken, not counting recursive locks\n"
+            "    \"contended\": n,         (numeric) Times it was held by another thread when it was taken\n"
+            "    \"wait_ms\": x.xxx,       (numeric) Time waited for it\n"
+            "    \"hold_ms\": x.xxx,       (numeric) Time it was held\n"
+            "    \"sites\": [              (json array) The places it is taken\n"
+            "      {\n"
+            "        \"site\": \"file:line\",\n"
+            "        \"name\": \"expr\",     (string) The locked expression\n"
+            "        \"acquired\": n,\n"
+            "        \"contended\": n,\n"
+            "        \"wait_ms\": x.xxx,\n"
+            "        \"max_wait_ms\": x.xxx,\n"
+            "        \"hold_ms\": x.xxx,\n"
+            "        \"max_hold_ms\": x.xxx\n"
+            "      },\n"
+            "      ...\n"
+            "    ]\n"
+            "  },\n"
+            "  ...\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getlockinfo", "")
+            + HelpExampleCli("getlockinfo", "0")
+            + HelpExampleRpc("getlockinfo", "5")
+        );
+
+    const int nCount = request.params[0].isNull() ? 20 : request.params[0].get_int();
+    if (nCount < 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+
+    UniValue obj(UniValue::VOBJ);
+    for (CLockProfileStats& profile : GetLockProfiles()) {
+        std::sort(profile.vSites.begin(), profile.vSites.end(), [](const CLockSiteStats& a, const CLockSiteStats& b) {
+            return a.nHoldMicros > b.nHoldMicros;
+        });
+        uint64_t nAcquired = 0, nContended = 0;
+        int64_t nWaitMicros = 0, nHoldMicros = 0;
+        UniValue sites(UniValue::VARR);
+        for (const CLockSiteStats& site : profile.vSites) {
+            nAcquired += site.nAcquired;
+            nContended += site.nContended;
+            nWaitMicros += site.nWaitMicros;
+            nHoldMicros += site.nHoldMicros;
+            if (nCount > 0 && sites.size() >= (size_t)nCount)
+                continue;
+            UniValue entry(UniValue::VOBJ);
+            entry.pushKV("site", strprintf("%s:%d", site.strFile, site.nLine));
+            entry.pushKV("name", site.strName);
+            entry.pushKV("acquired", site.nAcquired);
+            entry.pushKV("contended", site.nContended);
+            entry.pushKV("wait_ms", site.nWaitMicros / 1000.0);
+            entry.pushKV("max_wait_ms", site.nMaxWaitMicros / 1000.0);
+            entry.pushKV("hold_ms", site.nHoldMicros / 1000.0);
+            entry.pushKV("max_hold_ms", site.nMaxHoldMicros / 1000.0);
+            sites.push_back(entry);
+        }
+        UniValue lock(UniValue::VOBJ);
+        lock.pushKV("acquired", nAcquired);
+        lock.pushKV("contended", nContended);
+        lock.pushKV("wait_ms", nWaitMicros / 1000.0);
+        lock.pushKV("hold_ms", nHoldMicros / 1000.0);
+        lock.pushKV("sites", sites);
+        obj.pushKV(profile.strName, lock);
+    }
+    return obj;
+}
+
 uint32_t getCategoryMask(UniValue cats) {
     cats = cats.get_array();
     uint32_t mask = 0;
@@ -674,6 +846,339 @@ UniValue echo(const JSONRPCRequest& request)
     return request.params;
 }
 
+/** Check that an optional index is enabled and caught up, without holding cs_main */
+static void EnsureIndexSynced(BaseIndex* index, const std::string& strName)
+{
+    if (!index) {
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("%s not enabled (start with -%s)", strName, strName));
+    }
+    if (!index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_IN_WARMUP, strprintf("%s is still being built (at height %d)", strName, index->GetBestHeight()));
+    }
+}
+
+/** Parse the "addresses" of an address index query, given as a single address or as {"addresses": [...]} */
+static std::vector<std::pair<uint8_t, uint160>> ParseAddressQuery(const UniValue& param)
+{
+    std::vector<std::string> vAddresses;
+    if (param.isStr()) {
+        vAddresses.push_back(param.get_str());
+    } else if (param.isObject()) {
+        const UniValue& addresses = find_value(param.get_obj(), "addresses");
+        if (!addresses.isArray()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Addresses is expected to be an array");
+        }
+        for (const UniValue& address : addresses.getValues()) {
+            vAddresses.push_back(address.get_str());
+        }
+    } else {
+        throw JSONRPCError(RPC_TYPE_ERROR, "Expected an address or an object with addresses");
+    }
+
+    if (vAddresses.empty()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "No addresses given");
+    }
+    if (vAddresses.size() > MAX_ADDRESS_QUERY_ADDRESSES) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("At most %u addresses can be queried at once", MAX_ADDRESS_QUERY_ADDRESSES));
+    }
+
+    std::vector<std::pair<uint8_t, uint160>> ret;
+    for (const std::string& strAddress : vAddresses) {
+        uint8_t type;
+        uint160 hash;
+        CTxDestination dest = DecodeDestination(strAddress);
+        if (!IsValidDestination(dest)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address: " + strAddress);
+        }
+        if (!DestinationToIndexKey(dest, type, hash)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Address type not indexed: " + strAddress);
+        }
+        if (std::find(ret.begin(), ret.end(), std::make_pair(type, hash)) == ret.end()) {
+            ret.emplace_back(type, hash);
+        }
+    }
+    return ret;
+}
+
+/** Read an optional non-negative integer field of a query object */
+static unsigned int ParseQueryCount(const UniValue& param, const std::string& strKey, unsigned int nDefault)
+{
+    if (!param.isObject()) return nDefault;
+    const UniValue& value = find_value(param.get_obj(), strKey);
+    if (value.isNull()) return nDefault;
+    int n = value.get_int();
+    if (n < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("%s must not be negative", strKey));
+    }
+    return n;
+}
+
+/** Read the "skip" and "limit" pagination fields of a query object */
+static void ParseQueryPage(const UniValue& param, unsigned int& nSkip, unsigned int& nLimit)
+{
+    nSkip = ParseQueryCount(param, "skip", 0);
+    nLimit = ParseQueryCount(param, "limit", DEFAULT_ADDRESS_QUERY_LIMIT);
+    if (nLimit == 0 || nLimit > MAX_ADDRESS_QUERY_LIMIT) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("limit must be between 1 and %u", MAX_ADDRESS_QUERY_LIMIT));
+    }
+}
+
+UniValue getaddressbalance(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "getaddressbalance {\"addresses\": [\"address\",...]}\n"
+            "\nReturns the balance of one or more addresses (requires -addressindex).\n"
+            "\nArguments:\n"
+            "1. query            (json object or string, required) An address, or an object with\n"
+            "    {\n"
+            "      \"addresses\": [ (array, required) Up to " + std::to_string(MAX_ADDRESS_QUERY_ADDRESSES) + " addresses\n"
+            "        \"address\"  (string) The base58 or bech32 encoded address\n"
+            "        ,...\n"
+            "      ]\n"
+            "    }\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"balance\": n,   (numeric) The current balance in satoshis\n"
+            "  \"received\": n,  (numeric) The total number of satoshis received (including change)\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getaddressbalance", "'{\"addresses\": [\"GdCvo5ZYRVHamNmSrxanyZdiR86krcH22j\"]}'")
+            + HelpExampleRpc("getaddressbalance", "{\"addresses\": [\"GdCvo5ZYRVHamNmSrxanyZdiR86krcH22j\"]}")
+        );
+
+    std::vector<std::pair<uint8_t, uint160>> vAddresses = ParseAddressQuery(request.params[0]);
+    EnsureIndexSynced(g_addressindex.get(), "addressindex");
+
+    CAmount nBalance = 0;
+    CAmount nReceived = 0;
+    for (const auto& address : vAddresses) {
+        CAmount nAddressBalance, nAddressReceived;
+        if (!g_addressindex->GetBalance(address.first, address.second, nAddressBalance, nAddressReceived)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read address index");
+        }
+        nBalance += nAddressBalance;
+        nReceived += nAddressReceived;
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("balance", nBalance);
+    result.pushKV("received", nReceived);
+    return result;
+}
+
+UniValue getaddressutxos(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "getaddressutxos {\"addresses\": [\"address\",...], \"skip\": n, \"limit\": n}\n"
+            "\nReturns the unspent outputs of one or more addresses (requires -addressindex).\n"
+            "\nArguments:\n"
+            "1. query            (json object or string, required) An address, or an object with\n"
+            "    {\n"
+            "      \"addresses\": [ (array, required) Up to " + std::to_string(MAX_ADDRESS_QUERY_ADDRESSES) + " addresses\n"
+            "        \"address\"  (string) The base58 or bech32 encoded address\n"
+            "        ,...\n"
+            "      ],\n"
+            "      \"skip\": n,     (numeric, optional, default=0) Number of outputs to skip\n"
+            "      \"limit\": n,    (numeric, optional, default=" + std::to_string(DEFAULT_ADDRESS_QUERY_LIMIT) + ") Maximum number of outputs to return, at most " + std::to_string(MAX_ADDRESS_QUERY_LIMIT) + "\n"
+            "    }\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"address\": \"address\",  (string) The address\n"
+            "    \"txid\": \"hash\",        (string) The output txid\n"
+            "    \"outputIndex\": n,      (numeric) The output index\n"
+            "    \"script\": \"hex\",       (string) The script hex encoded\n"
+            "    \"satoshis\": n,         (numeric) The number of satoshis of the output\n"
+            "    \"height\": n            (numeric) The block height\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"GdCvo5ZYRVHamNmSrxanyZdiR86krcH22j\"], \"limit\": 100}'")
+            + HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"GdCvo5ZYRVHamNmSrxanyZdiR86krcH22j\"], \"limit\": 100}")
+        );
+
+    std::vector<std::pair<uint8_t, uint160>> vAddresses = ParseAddressQuery(request.params[0]);
+    unsigned int nSkip, nLimit;
+    ParseQueryPage(request.params[0], nSkip, nLimit);
+    EnsureIndexSynced(g_addressindex.get(), "addressindex");
+
+    // Outputs are returned grouped by address, in the order the addresses were given
+    const size_t nWanted = (size_t)nSkip + nLimit;
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> vOutputs;
+    for (const auto& address : vAddresses) {
+        if (vOutputs.size() >= nWanted) break;
+        if (!g_addressindex->FindUnspentOutputs(address.first, address.second, nWanted - vOutputs.size(), vOutputs)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read address index");
+        }
+    }
+
+    JSONStreamWriter* stream = request.resultStream;
+    UniValue result(UniValue::VARR);
+    if (stream)
+        stream->BeginArray();
+    for (size_t i = nSkip; i < vOutputs.size(); i++) {
+        const CAddressUnspentKey& key = vOutputs[i].first;
+        const CAddressUnspentValue& value = vOutputs[i].second;
+        UniValue output(UniValue::VOBJ);
+        output.pushKV("address", EncodeDestination(IndexKeyToDestination(key.type, key.hash)));
+        output.pushKV("txid", key.txhash.GetHex());
+        output.pushKV("outputIndex", (int)key.nIndex);
+        output.pushKV("script", HexStr(value.script.begin(), value.script.end()));
+        output.pushKV("satoshis", value.nValue);
+        output.pushKV("height", value.nHeight);
+        if (stream)
+            stream->Value(output);
+        else
+            result.push_back(output);
+    }
+    if (stream) {
+        stream->EndArray();
+        return NullUniValue;
+    }
+    return result;
+}
+
+UniValue getaddresstxids(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "getaddresstxids {\"addresses\": [\"address\",...], \"start\": n, \"end\": n, \"skip\": n, \"limit\": n}\n"
+            "\nReturns the txids of the transactions involving one or more addresses, in chain order (requires -addressindex).\n"
+            "\nArguments:\n"
+            "1. query            (json object or string, required) An address, or an object with\n"
+            "    {\n"
+            "      \"addresses\": [ (array, required) Up to " + std::to_string(MAX_ADDRESS_QUERY_ADDRESSES) + " addresses\n"
+            "        \"address\"  (string) The base58 or bech32 encoded address\n"
+            "        ,...\n"
+            "      ],\n"
+            "      \"start\": n,    (numeric, optional) The first block height to include\n"
+            "      \"end\": n,      (numeric, optional) The last block height to include\n"
+            "      \"skip\": n,     (numeric, optional, default=0) Number of txids to skip\n"
+            "      \"limit\": n,    (numeric, optional, default=" + std::to_string(DEFAULT_ADDRESS_QUERY_LIMIT) + ") Maximum number of txids to return, at most " + std::to_string(MAX_ADDRESS_QUERY_LIMIT) + "\n"
+            "    }\n"
+            "\nResult:\n"
+            "[\n"
+            "  \"transactionid\"  (string) The transaction id\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"GdCvo5ZYRVHamNmSrxanyZdiR86krcH22j\"], \"start\": 1000, \"end\": 2000}'")
+            + HelpExampleRpc("getaddresstxids", "{\"addresses\": [\"GdCvo5ZYRVHamNmSrxanyZdiR86krcH22j\"], \"start\": 1000, \"end\": 2000}")
+        );
+
+    std::vector<std::pair<uint8_t, uint160>> vAddresses = ParseAddressQuery(request.params[0]);
+    unsigned int nSkip, nLimit;
+    ParseQueryPage(request.params[0], nSkip, nLimit);
+    int nStart = ParseQueryCount(request.params[0], "start", 0);
+    int nEnd = ParseQueryCount(request.params[0], "end", 0);
+    if (nEnd > 0 && nEnd < nStart) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "end must not be below start");
+    }
+    EnsureIndexSynced(g_addressindex.get(), "addressindex");
+
+    // Each address' history is in chain order, so its first skip + limit
+    // transactions cover the first skip + limit of the merged history.
+    const size_t nWanted = (size_t)nSkip + nLimit;
+    std::vector<std::pair<int, uint256>> vTxids;
+    for (const auto& address : vAddresses) {
+        if (!g_addressindex->FindTxids(address.first, address.second, nStart, nEnd, nWanted, vTxids)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read address index");
+        }
+    }
+    if (vAddresses.size() > 1) {
+        std::stable_sort(vTxids.begin(), vTxids.end(),
+            [](const std::pair<int, uint256>& a, const std::pair<int, uint256>& b) { return a.first < b.first; });
+        std::set<uint256> setSeen;
+        vTxids.erase(std::remove_if(vTxids.begin(), vTxids.end(),
+            [&setSeen](const std::pair<int, uint256>& entry) { return !setSeen.insert(entry.second).second; }), vTxids.end());
+    }
+
+    JSONStreamWriter* stream = request.resultStream;
+    UniValue result(UniValue::VARR);
+    if (stream)
+        stream->BeginArray();
+    for (size_t i = nSkip; i < vTxids.size() && i < nWanted; i++) {
+        if (stream)
+            stream->Value(vTxids[i].second.GetHex());
+        else
+            result.push_back(vTxids[i].second.GetHex());
+    }
+    if (stream) {
+        stream->EndArray();
+        return NullUniValue;
+    }
+    return result;
+}
+
+/** Look up one {"txid", "index"} object in the spent index */
+static UniValue SpentInfoToJSON(const UniValue& query, bool fRequired)
+{
+    if (!query.isObject()) {
+        throw JSONRPCError(RPC_TYPE_ERROR, "Expected an object with txid and index");
+    }
+    uint256 txid = ParseHashO(query, "txid");
+    const UniValue& index = find_value(query.get_obj(), "index");
+    if (!index.isNum() || index.get_int() < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid index");
+    }
+
+    CSpentIndexValue value;
+    if (!g_spentindex->FindSpent(CSpentIndexKey(txid, index.get_int()), value)) {
+        if (fRequired) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unable to get spent info");
+        }
+        return NullUniValue;
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("txid", value.txid.GetHex());
+    result.pushKV("index", (int)value.nInputIndex);
+    result.pushKV("height", value.nHeight);
+    return result;
+}
+
+UniValue getspentinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "getspentinfo {\"txid\": \"txid\", \"index\": n}\n"
+            "\nReturns the txid and input index where an output is spent (requires -spentindex).\n"
+            "Several outputs can be looked up at once by passing an array of such objects.\n"
+            "\nArguments:\n"
+            "1. query            (json object or array, required) An output, or up to " + std::to_string(MAX_ADDRESS_QUERY_LIMIT) + " outputs\n"
+            "    {\n"
+            "      \"txid\": \"hash\",  (string, required) The hex string of the txid\n"
+            "      \"index\": n       (numeric, required) The output index\n"
+            "    }\n"
+            "\nResult (for an object, an array of these or null for unspent outputs when given an array):\n"
+            "{\n"
+            "  \"txid\": \"hash\",    (string) The transaction id spending the output\n"
+            "  \"index\": n,        (numeric) The spending input index\n"
+            "  \"height\": n        (numeric) The height of the block containing the spending transaction\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getspentinfo", "'{\"txid\": \"0437cd7f8525ceed2324359c2d0ba26006d92d856a9c20fa0241106ee5a597c9\", \"index\": 0}'")
+            + HelpExampleRpc("getspentinfo", "{\"txid\": \"0437cd7f8525ceed2324359c2d0ba26006d92d856a9c20fa0241106ee5a597c9\", \"index\": 0}")
+        );
+
+    if (request.params[0].isArray() && request.params[0].size() > MAX_ADDRESS_QUERY_LIMIT) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("At most %u outputs can be queried at once", MAX_ADDRESS_QUERY_LIMIT));
+    }
+    EnsureIndexSynced(g_spentindex.get(), "spentindex");
+
+    if (!request.params[0].isArray()) {
+        return SpentInfoToJSON(request.params[0], true);
+    }
+    UniValue result(UniValue::VARR);
+    for (const UniValue& query : request.params[0].getValues()) {
+        result.push_back(SpentInfoToJSON(query, false));
+    }
+    return result;
+}
+
 static UniValue getinfo_deprecated(const JSONRPCRequest& request)
 {
     throw JSONRPCError(RPC_METHOD_NOT_FOUND,
@@ -691,6 +1196,8 @@ static const CRPCCommand commands[] =
   //  --------------------- ------------------------  -----------------------  ----------
     { "control",            "getmemoryinfo",          &getmemoryinfo,          {"mode"} },
     { "control",            "logging",                &logging,                {"include", "exclude"}},
+    { "control",            "getlockinfo",            &getlockinfo,            {"count"} },
+    { "control",            "getrpcinfo",             &getrpcinfo,             {} },
     { "util",               "validateaddress",        &validateaddress,        {"address"} }, /* uses wallet if enabled */
     { "util",               "createmultisig",         &createmultisig,         {"nrequired","keys"} },
     { "util",               "helpnewscriptaddress",   &helpnewscriptaddress,   {} },
@@ -698,6 +1205,12 @@ static const CRPCCommand commands[] =
     { "util",               "verifymessage",          &verifymessage,          {"address","signature","message"} },
     { "util",               "signmessagewithprivkey", &signmessagewithprivkey, {"privkey","message"} },
     { "util",               "listattackersaddresses", &listattackersaddresses, {} },
+
+    /* Address index */
+    { "addressindex",       "getaddressbalance",      &getaddressbalance,      {"query"} },
+    { "addressindex",       "getaddressutxos",        &getaddressutxos,        {"query"} },
+    { "addressindex",       "getaddresstxids",        &getaddresstxids,        {"query"} },
+    { "addressindex",       "getspentinfo",           &getspentinfo,           {"query"} },
     
     /* Globaltoken features */
     { "globaltoken",        "mnsync",                 &mnsync,                 {} },
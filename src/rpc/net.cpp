@@ -392,6 +392,55 @@ UniValue getnettotals(const JSONRPCRequest& request)
     return obj;
 }
 
+UniValue getmsgworkerinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 0)
+        throw std::runtime_error(
+            "getmsgworkerinfo\n"
+            "\nReturns queue depth and latency of the peer message categories that are\n"
+            "processed outside of the message handler thread (see -msgworkers).\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"enabled\": true|false,      (boolean) Whether the message worker pool is running\n"
+            "  \"categories\": {\n"
+            "    \"name\": {                 (string) The message category\n"
+            "      \"queued\": n,             (numeric) Messages waiting or being processed\n"
+            "      \"processed\": n,          (numeric) Messages processed since startup\n"
+            "      \"avg_wait_us\": n,        (numeric) Average time between queueing and processing, in microseconds\n"
+            "      \"max_wait_us\": n,        (numeric) Maximum time between queueing and processing, in microseconds\n"
+            "      \"avg_run_us\": n,         (numeric) Average processing time, in microseconds\n"
+            "      \"max_run_us\": n          (numeric) Maximum processing time, in microseconds\n"
+            "    }, ...\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getmsgworkerinfo", "")
+            + HelpExampleRpc("getmsgworkerinfo", "")
+       );
+    if(!g_connman)
+        throw JSONRPCError(RPC_CLIENT_P2P_DISABLED, "Error: Peer-to-peer functionality missing or disabled");
+
+    std::vector<CMessageWorkerCategoryStats> vStats;
+    bool fEnabled = g_connman->GetMessageWorkerStats(vStats);
+
+    UniValue categories(UniValue::VOBJ);
+    for (const CMessageWorkerCategoryStats& stats : vStats) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("queued", stats.nQueued);
+        obj.pushKV("processed", stats.nProcessed);
+        obj.pushKV("avg_wait_us", stats.nProcessed ? stats.nTotalWaitMicros / (int64_t)stats.nProcessed : 0);
+        obj.pushKV("max_wait_us", stats.nMaxWaitMicros);
+        obj.pushKV("avg_run_us", stats.nProcessed ? stats.nTotalRunMicros / (int64_t)stats.nProcessed : 0);
+        obj.pushKV("max_run_us", stats.nMaxRunMicros);
+        categories.pushKV(stats.strName, obj);
+    }
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("enabled", fEnabled);
+    obj.pushKV("categories", categories);
+    return obj;
+}
+
 static UniValue GetNetworksInfo()
 {
     UniValue networks(UniValue::VARR);
@@ -634,6 +683,7 @@ static const CRPCCommand commands[] =
     { "network",            "disconnectnode",         &disconnectnode,         {"address", "nodeid"} },
     { "network",            "getaddednodeinfo",       &getaddednodeinfo,       {"node"} },
     { "network",            "getnettotals",           &getnettotals,           {} },
+    { "network",            "getmsgworkerinfo",       &getmsgworkerinfo,       {} },
     { "network",            "getnetworkinfo",         &getnetworkinfo,         {} },
     { "network",            "setban",                 &setban,                 {"subnet", "command", "bantime", "absolute"} },
     { "network",            "listbanned",             &listbanned,             {} },
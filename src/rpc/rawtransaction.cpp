@@ -10,6 +10,7 @@
 #include <coins.h>
 #include <consensus/validation.h>
 #include <core_io.h>
+#include <index/txindex.h>
 #include <init.h>
 #include <keystore.h>
 #include <validation.h>
@@ -171,6 +172,10 @@ UniValue getrawtransaction(const JSONRPCRequest& request)
             + HelpExampleCli("getrawtransaction", "\"mytxid\" true \"myblockhash\"")
         );
 
+    if (g_txindex && request.params[2].isNull()) {
+        g_txindex->BlockUntilSyncedToCurrentChain();
+    }
+
     LOCK(cs_main);
 
     bool in_active_chain = true;
@@ -208,7 +213,7 @@ UniValue getrawtransaction(const JSONRPCRequest& request)
             }
             errmsg = "No such transaction found in the provided block";
         } else {
-            errmsg = fTxIndex
+            errmsg = g_txindex
               ? "No such mempool or blockchain transaction"
               : "No such mempool transaction. Use -txindex to enable blockchain transaction queries";
         }
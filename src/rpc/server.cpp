@@ -13,6 +13,8 @@
 #include <ui_interface.h>
 #include <util.h>
 #include <utilstrencodings.h>
+#include <utiltime.h>
+#include <validation.h>
 
 #include <boost/bind.hpp>
 #include <boost/signals2/signal.hpp>
@@ -20,7 +22,11 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 
+#include <atomic>
+#include <condition_variable>
 #include <memory> // for unique_ptr
+#include <mutex>
+#include <set>
 #include <unordered_map>
 
 static bool fRPCRunning = false;
@@ -31,6 +37,8 @@ static CCriticalSection cs_rpcWarmup;
 static RPCTimerInterface* timerInterface = nullptr;
 /* Map of name to timer. */
 static std::map<std::string, std::unique_ptr<RPCTimerBase> > deadlineTimers;
+/* Batch driver */
+static RPCBatchInterface* batchInterface = nullptr;
 
 static struct CRPCSignals
 {
@@ -410,11 +418,203 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
+/**
+ * Commands that only read state, so that consecutive ones in a batch can run
+ * at the same time. Every other entry waits for the entries before it and
+ * runs alone, as it may change what a later entry sees.
+ */
+static const std::set<std::string> setBatchParallelCommands = {
+    "decoderawtransaction",
+    "decodescript",
+    "estimatesmartfee",
+    "getbestblockhash",
+    "getblock",
+    "getblockchaininfo",
+    "getblockcount",
+    "getblockhash",
+    "getblockheader",
+    "getchaintips",
+    "getconnectioncount",
+    "getdifficulty",
+    "getmempoolancestors",
+    "getmempooldescendants",
+    "getmempoolentry",
+    "getmempoolinfo",
+    "getmininginfo",
+    "getnetworkhashps",
+    "getnetworkinfo",
+    "getpeerinfo",
+    "getrawmempool",
+    "getrawtransaction",
+    "gettxout",
+    "gettxoutproof",
+    "listbanned",
+    "validateaddress",
+    "verifymessage",
+};
+
+/**
+ * Commands that only read chain state and may run with cs_main held. Not
+ * getrawtransaction: without a block hash it waits for -txindex to catch up,
+ * which must not happen under cs_main (see BatchEntryLocksMain).
+ */
+static const std::set<std::string> setBatchLockGroupCommands = {
+    "getbestblockhash",
+    "getblock",
+    "getblockcount",
+    "getblockhash",
+    "getblockheader",
+    "gettxout",
+};
+
+/** Whether a batch entry may run under a cs_main lock the batch holds */
+static bool BatchEntryLocksMain(const UniValue& req)
+{
+    const UniValue& valMethod = find_value(req, "method");
+    if (!valMethod.isStr())
+        return false;
+    if (setBatchLockGroupCommands.count(valMethod.get_str()))
+        return true;
+    // With a block hash it neither looks at nor waits for -txindex
+    if (valMethod.get_str() == "getrawtransaction") {
+        const UniValue& valParams = find_value(req, "params");
+        if (valParams.isArray())
+            return valParams.size() > 2 && !valParams[2].isNull();
+        if (valParams.isObject())
+            return !find_value(valParams, "blockhash").isNull();
+    }
+    return false;
+}
+
+namespace {
+
+/** Consecutive batch entries that one thread runs at once */
+struct BatchUnit
+{
+    size_t nBegin;
+    size_t nEnd;
+    bool fLockMain;
+};
+
+/**
+ * Units of a batch that can run at the same time, shared with the threads
+ * that help with them. They claim units until none are left, so a helper
+ * that only starts after the units are done does nothing.
+ */
+class BatchRun
+{
+public:
+    BatchRun(const JSONRPCRequest& _jreq, const UniValue& _vReq, std::vector<UniValue>& _vResults, int64_t _nDeadline) :
+        jreq(_jreq), vReq(_vReq), vResults(_vResults), nDeadline(_nDeadline), nNextUnit(0), nUnitsDone(0)
+    {
+    }
+
+    std::vector<BatchUnit> vUnits;
+
+    /** Run units until all of them are claimed */
+    void Work()
+    {
+        size_t nDone = 0;
+        for (size_t i = nNextUnit++; i < vUnits.size(); i = nNextUnit++) {
+            RunUnit(vUnits[i]);
+            nDone++;
+        }
+        if (nDone > 0) {
+            std::lock_guard<std::mutex> lock(cs);
+            nUnitsDone += nDone;
+            if (nUnitsDone == vUnits.size())
+                cond.notify_all();
+        }
+    }
+
+    /** Wait for the units that other threads claimed */
+    void WaitForCompletion()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        cond.wait(lock, [this] { return nUnitsDone == vUnits.size(); });
+    }
+
+private:
+    const JSONRPCRequest jreq;
+    //! Only used for claimed units, which the caller waits for
+    const UniValue& vReq;
+    std::vector<UniValue>& vResults;
+    const int64_t nDeadline;
+    std::atomic<size_t> nNextUnit;
+    std::mutex cs;
+    std::condition_variable cond;
+    size_t nUnitsDone;
+
+    void RunEntry(size_t nIdx)
+    {
+        if (nDeadline && GetTimeMicros() > nDeadline) {
+            vResults[nIdx] = JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_MISC_ERROR, "Batch time limit exceeded"), find_value(vReq[nIdx], "id"));
+            return;
+        }
+        vResults[nIdx] = JSONRPCExecOne(jreq, vReq[nIdx]);
+    }
+
+    void RunUnit(const BatchUnit& unit)
+    {
+        if (unit.fLockMain) {
+            LOCK(cs_main);
+            for (size_t i = unit.nBegin; i < unit.nEnd; i++)
+                RunEntry(i);
+        } else {
+            for (size_t i = unit.nBegin; i < unit.nEnd; i++)
+                RunEntry(i);
+        }
+    }
+};
+
+} // namespace
+
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
 {
+    const int64_t nMaxSize = gArgs.GetArg("-rpcbatchmaxsize", DEFAULT_RPC_BATCH_MAX_SIZE);
+    if (nMaxSize > 0 && vReq.size() > (uint64_t)nMaxSize)
+        throw JSONRPCError(RPC_INVALID_REQUEST, strprintf("Batch of %u requests exceeds the limit of %d", vReq.size(), nMaxSize));
+
+    const int64_t nTimeout = gArgs.GetArg("-rpcbatchtimeout", DEFAULT_RPC_BATCH_TIMEOUT);
+    const int64_t nDeadline = nTimeout > 0 ? GetTimeMicros() + nTimeout * 1000000 : 0;
+    const bool fLockGroups = gArgs.GetBoolArg("-rpcbatchlockgroups", DEFAULT_RPC_BATCH_LOCK_GROUPS);
+    const size_t nThreads = std::max(gArgs.GetArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), (int64_t)0);
+    std::vector<UniValue> vResults(vReq.size());
+    size_t nNext = 0;
+    while (nNext < vReq.size()) {
+        // Either a run of read-only entries, or one entry that runs alone
+        std::shared_ptr<BatchRun> run = std::make_shared<BatchRun>(jreq, vReq, vResults, nDeadline);
+        const size_t nBegin = nNext;
+        for (size_t i = nBegin; i < vReq.size(); i++) {
+            const UniValue& valMethod = find_value(vReq[i], "method");
+            const bool fParallel = valMethod.isStr() && setBatchParallelCommands.count(valMethod.get_str());
+            if (!fParallel && i > nBegin)
+                break;
+            nNext = i + 1;
+            const bool fLockMain = fLockGroups && BatchEntryLocksMain(vReq[i]);
+            if (fLockMain && !run->vUnits.empty()) {
+                BatchUnit& last = run->vUnits.back();
+                if (last.fLockMain && last.nEnd - last.nBegin < RPC_BATCH_LOCK_GROUP_SIZE) {
+                    last.nEnd++;
+                    continue;
+                }
+            }
+            run->vUnits.push_back(BatchUnit{i, i + 1, fLockMain});
+            if (!fParallel)
+                break;
+        }
+
+        const size_t nHelpers = std::min(nThreads, run->vUnits.size() - 1);
+        for (size_t i = 0; i < nHelpers && batchInterface; i++) {
+            if (!batchInterface->Dispatch([run] { run->Work(); }))
+                break;
+        }
+        run->Work();
+        run->WaitForCompletion();
+    }
+
     UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    ret.push_backV(vResults);
 
     return ret.write() + "\n";
 }
@@ -469,6 +669,56 @@ static inline JSONRPCRequest transformNamedArguments(const JSONRPCRequest& in, c
     return out;
 }
 
+static std::mutex cs_rpcMethodStats;
+static std::map<std::string, CRPCMethodStats> mapRPCMethodStats;
+
+/** Counts a call in the statistics of its method when it goes out of scope */
+class RPCCallTimer
+{
+public:
+    explicit RPCCallTimer(const std::string& _method) : method(_method), nTimeStart(GetTimeMicros()), fFailed(false)
+    {
+        GetThreadLockTimes(nLockWaitStart, nLockHoldStart);
+    }
+    ~RPCCallTimer()
+    {
+        const int64_t nTime = std::max<int64_t>(GetTimeMicros() - nTimeStart, 0);
+        int64_t nLockWait, nLockHold;
+        GetThreadLockTimes(nLockWait, nLockHold);
+        size_t nBucket = 0;
+        while (nBucket < RPC_LATENCY_BUCKETS - 1 && nTime > RPC_LATENCY_BUCKET_BOUNDS[nBucket] * 1000)
+            nBucket++;
+
+        std::lock_guard<std::mutex> lock(cs_rpcMethodStats);
+        CRPCMethodStats& stats = mapRPCMethodStats[method];
+        stats.nCalls++;
+        if (fFailed)
+            stats.nErrors++;
+        stats.nTotalMicros += nTime;
+        stats.nMaxMicros = std::max(stats.nMaxMicros, nTime);
+        stats.nLockWaitMicros += nLockWait - nLockWaitStart;
+        stats.nLockHoldMicros += nLockHold - nLockHoldStart;
+        stats.vLatency[nBucket]++;
+    }
+    void Failed()
+    {
+        fFailed = true;
+    }
+
+private:
+    const std::string& method;
+    const int64_t nTimeStart;
+    int64_t nLockWaitStart;
+    int64_t nLockHoldStart;
+    bool fFailed;
+};
+
+std::map<std::string, CRPCMethodStats> GetRPCMethodStats()
+{
+    std::lock_guard<std::mutex> lock(cs_rpcMethodStats);
+    return mapRPCMethodStats;
+}
+
 UniValue CRPCTable::execute(const JSONRPCRequest &request) const
 {
     // Return immediately if in warmup
@@ -485,6 +735,7 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
 
     g_rpcSignals.PreCommand(*pcmd);
 
+    RPCCallTimer timer(pcmd->name);
     try
     {
         // Execute, convert arguments to array if necessary
@@ -496,8 +747,14 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
     }
     catch (const std::exception& e)
     {
+        timer.Failed();
         throw JSONRPCError(RPC_MISC_ERROR, e.what());
     }
+    catch (...)
+    {
+        timer.Failed();
+        throw;
+    }
 }
 
 std::vector<std::string> CRPCTable::listCommands() const
@@ -539,6 +796,17 @@ void RPCUnsetTimerInterface(RPCTimerInterface *iface)
         timerInterface = nullptr;
 }
 
+void RPCSetBatchInterface(RPCBatchInterface *iface)
+{
+    batchInterface = iface;
+}
+
+void RPCUnsetBatchInterface(RPCBatchInterface *iface)
+{
+    if (batchInterface == iface)
+        batchInterface = nullptr;
+}
+
 void RPCRunLater(const std::string& name, std::function<void(void)> func, int64_t nSeconds)
 {
     if (!timerInterface)
@@ -10,6 +10,7 @@
 #include <rpc/protocol.h>
 #include <uint256.h>
 
+#include <array>
 #include <list>
 #include <map>
 #include <stdint.h>
@@ -18,8 +19,19 @@
 #include <univalue.h>
 
 static const unsigned int DEFAULT_RPC_SERIALIZE_VERSION = 1;
+//! Threads besides its own that a JSON-RPC batch may run entries on, 0 to run batches sequentially
+static const int DEFAULT_RPC_BATCH_THREADS = 0;
+//! Largest JSON-RPC batch accepted, 0 for no limit
+static const int64_t DEFAULT_RPC_BATCH_MAX_SIZE = 10000;
+//! Seconds after which the entries of a batch that did not start yet fail, 0 for no limit
+static const int64_t DEFAULT_RPC_BATCH_TIMEOUT = 0;
+//! Whether consecutive batch entries of chain state reads run under one cs_main lock
+static const bool DEFAULT_RPC_BATCH_LOCK_GROUPS = false;
+//! Most batch entries run under one cs_main lock, so validation is not held up for long
+static const size_t RPC_BATCH_LOCK_GROUP_SIZE = 32;
 
 class CRPCCommand;
+class JSONStreamWriter;
 
 namespace RPCServer
 {
@@ -45,8 +57,13 @@ public:
     bool fHelp;
     std::string URI;
     std::string authUser;
+    /**
+     * If set, the method may write its result here instead of returning it,
+     * which large results do so they are never held in memory as a whole.
+     */
+    JSONStreamWriter* resultStream;
 
-    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false) {}
+    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false), resultStream(nullptr) {}
     void parse(const UniValue& valRequest);
 };
 
@@ -125,6 +142,26 @@ void RPCUnsetTimerInterface(RPCTimerInterface *iface);
  */
 void RPCRunLater(const std::string& name, std::function<void(void)> func, int64_t nSeconds);
 
+/**
+ * RPC batch "driver": runs entries of a JSON-RPC batch on other threads.
+ * Like the timers, this is backend-neutral; without one batches run on the
+ * thread that received them.
+ */
+class RPCBatchInterface
+{
+public:
+    virtual ~RPCBatchInterface() {}
+    /** Implementation name */
+    virtual const char *Name() = 0;
+    /** Run func on another thread. Returns false if it can't take more work now. */
+    virtual bool Dispatch(const std::function<void(void)>& func) = 0;
+};
+
+/** Set the batch driver */
+void RPCSetBatchInterface(RPCBatchInterface *iface);
+/** Unset the batch driver */
+void RPCUnsetBatchInterface(RPCBatchInterface *iface);
+
 typedef UniValue(*rpcfn_type)(const JSONRPCRequest& jsonRequest);
 
 class CRPCCommand
@@ -191,8 +228,36 @@ extern std::string HelpExampleRpc(const std::string& methodname, const std::stri
 bool StartRPC();
 void InterruptRPC();
 void StopRPC();
+/**
+ * Execute a batch of requests and return the replies in request order.
+ * With -rpcbatchthreads, consecutive read-only entries are spread over the
+ * threads of the batch driver, while any other entry waits for the ones
+ * before it and runs alone. The calling thread works on the batch too, so it
+ * completes even when no other thread is free.
+ */
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq);
 
+//! Latency buckets of the per method RPC statistics, the last one for calls slower than all bounds
+static const size_t RPC_LATENCY_BUCKETS = 6;
+//! Upper bounds of the other latency buckets, in milliseconds
+static const int64_t RPC_LATENCY_BUCKET_BOUNDS[RPC_LATENCY_BUCKETS - 1] = {1, 10, 100, 1000, 10000};
+
+/** Calls of one RPC method and how long they took */
+struct CRPCMethodStats
+{
+    uint64_t nCalls = 0;
+    uint64_t nErrors = 0;
+    int64_t nTotalMicros = 0;
+    int64_t nMaxMicros = 0;
+    //! Time the calls waited for and held profiled locks (see ProfileLock)
+    int64_t nLockWaitMicros = 0;
+    int64_t nLockHoldMicros = 0;
+    std::array<uint64_t, RPC_LATENCY_BUCKETS> vLatency{};
+};
+
+/** The statistics of the RPC methods called since startup, by method name */
+std::map<std::string, CRPCMethodStats> GetRPCMethodStats();
+
 // Retrieves any serialization flags requested in command line argument
 int RPCSerializationFlags();
 
@@ -9,6 +9,7 @@
 #include <chainparams.h>
 #include <globaltoken/hardfork.h>
 #include <validation.h>
+#include <validationinterface.h>
 #include <wallet/wallet.h>
 #include <messagesigner.h>
 #include <net_processing.h>
@@ -69,6 +70,7 @@ void CSporkManager::ProcessSpork(CNode* pfrom, const std::string& strCommand, CD
         mapSporks[hash] = spork;
         mapSporksActive[spork.nSporkID] = spork;
         spork.Relay(connman);
+        GetMainSignals().NotifySpork(spork);
 
         //does a task if needed
         ExecuteSpork(spork.nSporkID, spork.nValue);
@@ -123,6 +125,7 @@ bool CSporkManager::UpdateSpork(int nSporkID, int64_t nValue, CConnman& connman)
         spork.Relay(connman);
         mapSporks[spork.GetHash()] = spork;
         mapSporksActive[nSporkID] = spork;
+        GetMainSignals().NotifySpork(spork);
         return true;
     }
 
@@ -0,0 +1,1118 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum.h>
+
+#include <arith_uint256.h>
+#include <base58.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <consensus/merkle.h>
+#include <crypto/common.h>
+#include <globaltoken/hardfork.h>
+#include <globaltoken/multihasher.h>
+#include <masternode-payments.h>
+#include <masternode-sync.h>
+#include <miner.h>
+#include <net.h>
+#include <netbase.h>
+#include <pow.h>
+#include <random.h>
+#include <script/standard.h>
+#include <spork.h>
+#include <streams.h>
+#include <sync.h>
+#include <timedata.h>
+#include <txmempool.h>
+#include <ui_interface.h>
+#include <util.h>
+#include <utilstrencodings.h>
+#include <validation.h>
+
+#include <univalue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/listener.h>
+#include <event2/thread.h>
+#include <event2/util.h>
+
+#include <support/events.h>
+
+namespace {
+
+/** A block template that miners work on, as sent in one mining.notify. */
+struct StratumJob
+{
+    std::string strId;
+    uint8_t nAlgo;
+    //! The template, with the coinbase prepared for the extranonce (Equihash: as created)
+    CBlock block;
+    std::vector<unsigned char> vchCoinb1;
+    std::vector<unsigned char> vchCoinb2;
+    std::vector<uint256> vMerkleBranch;
+    //! The shares submitted for this job. Only used by the event thread.
+    CStratumShareSet shares;
+};
+
+typedef std::shared_ptr<StratumJob> StratumJobRef;
+
+/** A miner connection. Only used by the event thread. */
+struct StratumClient
+{
+    //! Unique for the lifetime of the server, unlike bev
+    uint64_t nId;
+    struct bufferevent* bev;
+    CService addr;
+    uint8_t nAlgo;
+    std::vector<unsigned char> vchExtraNonce1;
+    bool fSubscribed;
+    std::string strWorker;
+    double dDifficulty;
+    arith_uint256 shareTarget;
+};
+
+/** A share waiting for a share thread, with what its reply needs */
+struct StratumShare
+{
+    uint64_t nClientId;
+    UniValue id;
+    StratumJobRef job;
+    CBlockHeader header;
+    CTransactionRef coinbase;
+    arith_uint256 shareTarget;
+    std::string strWorker;
+    CService addr;
+};
+
+// Stratum error codes
+enum StratumErrorCode
+{
+    STRATUM_ERROR_OTHER = 20,
+    STRATUM_ERROR_JOB_NOT_FOUND = 21,
+    STRATUM_ERROR_DUPLICATE_SHARE = 22,
+    STRATUM_ERROR_LOW_DIFFICULTY = 23,
+    STRATUM_ERROR_NOT_SUBSCRIBED = 25,
+};
+
+} // namespace
+
+//! libevent event loop
+static struct event_base* stratumBase = nullptr;
+//! Raised from the job thread to send the new jobs
+static struct event* eventNotify = nullptr;
+//! Raised from the share threads to send their replies
+static struct event* eventReplies = nullptr;
+//! Listening sockets
+static std::vector<struct evconnlistener*> vStratumListeners;
+//! List of subnets to allow Stratum connections from
+static std::vector<CSubNet> stratum_allow_subnets;
+//! Ports and their algos
+static std::vector<std::pair<uint8_t, uint16_t>> vStratumPorts;
+//! Algos that jobs are built for
+static std::vector<uint8_t> vStratumAlgos;
+static double dStratumDifficulty[NUM_ALGOS];
+static CScript scriptStratumPayout;
+static std::atomic<bool> fStratumInterrupt(false);
+
+static std::thread threadStratum;
+static std::future<bool> threadStratumResult;
+static std::thread threadStratumJobs;
+static std::vector<std::thread> vStratumShareThreads;
+
+//! Connected miners (event thread only)
+static std::map<struct bufferevent*, StratumClient> mapStratumClients;
+//! The same miners by id, to send the replies of the share threads to
+static std::map<uint64_t, struct bufferevent*> mapStratumClientIds;
+static uint64_t nStratumClientId = 0;
+static uint32_t nStratumExtraNonce1 = 0;
+
+static std::mutex cs_stratumShares;
+static std::condition_variable condStratumShares;
+//! Shares waiting for a share thread
+static std::deque<StratumShare> queueStratumShares;
+
+static CCriticalSection cs_stratum;
+//! The tip that the job thread last saw, shares of the jobs on others are stale
+static uint256 hashStratumTip;
+//! Jobs that shares can still be submitted for, by id
+static std::map<std::string, StratumJobRef> mapStratumJobs;
+//! The newest job of each algo
+static std::map<uint8_t, StratumJobRef> mapStratumCurrentJobs;
+//! Algos with a job to send, and whether the earlier jobs are stale
+static std::map<uint8_t, bool> mapStratumPendingNotify;
+//! Replies of the share threads, by client id
+static std::vector<std::pair<uint64_t, UniValue>> vStratumReplies;
+
+bool SplitStratumCoinbase(CMutableTransaction& tx, int nHeight, std::vector<unsigned char>& vchCoinb1, std::vector<unsigned char>& vchCoinb2)
+{
+    if (tx.vin.size() != 1)
+        return false;
+
+    const size_t nExtraNonceSize = STRATUM_EXTRANONCE1_SIZE + STRATUM_EXTRANONCE2_SIZE;
+    const CScript scriptHeight = CScript() << nHeight;
+    CScript scriptSig = scriptHeight;
+    scriptSig << std::vector<unsigned char>(nExtraNonceSize, 0);
+    scriptSig += COINBASE_FLAGS;
+    if (scriptSig.size() > 100)
+        return false;
+    tx.vin[0].scriptSig = scriptSig;
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS);
+    ss << tx;
+    // nVersion, the input count and the prevout come before the scriptSig,
+    // and the extranonce follows the height and its push opcode
+    const size_t nOffset = 4 + 1 + 36 + GetSizeOfCompactSize(scriptSig.size()) + scriptHeight.size() + 1;
+    vchCoinb1.assign(ss.begin(), ss.begin() + nOffset);
+    vchCoinb2.assign(ss.begin() + nOffset + nExtraNonceSize, ss.end());
+    return true;
+}
+
+bool AssembleStratumCoinbase(const std::vector<unsigned char>& vchCoinb1, const std::vector<unsigned char>& vchExtraNonce,
+                             const std::vector<unsigned char>& vchCoinb2, const CTransaction& txTemplate, CTransactionRef& txOut)
+{
+    std::vector<unsigned char> vch(vchCoinb1);
+    vch.insert(vch.end(), vchExtraNonce.begin(), vchExtraNonce.end());
+    vch.insert(vch.end(), vchCoinb2.begin(), vchCoinb2.end());
+
+    CMutableTransaction tx;
+    try {
+        CDataStream ss(vch, SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS);
+        ss >> tx;
+        if (!ss.empty())
+            return false;
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (tx.vin.size() != 1 || txTemplate.vin.size() != 1)
+        return false;
+    tx.vin[0].scriptWitness = txTemplate.vin[0].scriptWitness;
+    txOut = MakeTransactionRef(std::move(tx));
+    return true;
+}
+
+std::string StratumPrevHash(const uint256& hash)
+{
+    std::vector<unsigned char> vch(hash.begin(), hash.end());
+    for (size_t i = 0; i < vch.size(); i += 4)
+        std::reverse(vch.begin() + i, vch.begin() + i + 4);
+    return HexStr(vch);
+}
+
+arith_uint256 StratumShareTarget(uint8_t nAlgo, double dDifficulty, const Consensus::Params& params)
+{
+    // 16 bits of fraction, so that difficulties below 1 work as well. The
+    // division comes first, as the easiest pow limits use all 256 bits.
+    arith_uint256 target = params.aPOWAlgos[nAlgo].GetArithPowLimit();
+    target /= std::max<uint64_t>(1, (uint64_t)(std::min(dDifficulty, 1e12) * 65536));
+    if (target.bits() > 256 - 16)
+        return ~arith_uint256();
+    return target << 16;
+}
+
+bool CStratumShareSet::Insert(const uint256& hash)
+{
+    if (setOld.count(hash) || !setNew.insert(hash).second)
+        return false;
+    if (setNew.size() >= nMaxShares / 2) {
+        setOld.swap(setNew);
+        setNew.clear();
+    }
+    return true;
+}
+
+StratumShareResult CheckStratumShare(const uint256& hashPrevBlock, const uint256& hashTip, const uint256& hashShare, CStratumShareSet& shares)
+{
+    if (hashPrevBlock != hashTip)
+        return StratumShareResult::STALE;
+    if (!shares.Insert(hashShare))
+        return StratumShareResult::DUPLICATE;
+    return StratumShareResult::VALID;
+}
+
+StratumShareResult CheckStratumSharePoW(const uint256& hashPoW, uint32_t nBits, uint8_t nAlgo, const arith_uint256& shareTarget, const Consensus::Params& params)
+{
+    if (CheckProofOfWork(hashPoW, nBits, params, nAlgo))
+        return StratumShareResult::BLOCK;
+    if (UintToArith256(hashPoW) > shareTarget)
+        return StratumShareResult::LOW_DIFFICULTY;
+    return StratumShareResult::VALID;
+}
+
+static bool ParseStratumHex32(const UniValue& value, uint32_t& n)
+{
+    const std::string& str = value.get_str();
+    if (str.size() != 8 || !IsHex(str))
+        return false;
+    n = (uint32_t)strtoul(str.c_str(), nullptr, 16);
+    return true;
+}
+
+/** Check if a network address is allowed to access the Stratum server */
+static bool StratumClientAllowed(const CNetAddr& netaddr)
+{
+    if (!netaddr.IsValid())
+        return false;
+    for (const CSubNet& subnet : stratum_allow_subnets)
+        if (subnet.Match(netaddr))
+            return true;
+    return false;
+}
+
+/** Initialize ACL list for the Stratum server */
+static bool InitStratumAllowList()
+{
+    stratum_allow_subnets.clear();
+    CNetAddr localv4;
+    CNetAddr localv6;
+    LookupHost("127.0.0.1", localv4, false);
+    LookupHost("::1", localv6, false);
+    stratum_allow_subnets.push_back(CSubNet(localv4, 8));      // always allow IPv4 local subnet
+    stratum_allow_subnets.push_back(CSubNet(localv6));         // always allow IPv6 localhost
+    for (const std::string& strAllow : gArgs.GetArgs("-stratumallowip")) {
+        CSubNet subnet;
+        LookupSubNet(strAllow.c_str(), subnet);
+        if (!subnet.IsValid())
+            return InitError(strprintf(_("Invalid -stratumallowip subnet specification: %s"), strAllow));
+        stratum_allow_subnets.push_back(subnet);
+    }
+    return true;
+}
+
+/** Parse -stratumport=[<algo>:]<port> and -stratumdifficulty=[<algo>:]<n> */
+static bool ParseStratumAlgoArg(const std::string& strArg, const std::string& strValue, uint8_t& nAlgo, std::string& strRest)
+{
+    nAlgo = currentAlgo;
+    strRest = strValue;
+    const size_t nColon = strValue.find(':');
+    if (nColon != std::string::npos) {
+        bool fAlgoFound = false;
+        nAlgo = GetAlgoByName(strValue.substr(0, nColon), currentAlgo, fAlgoFound);
+        if (!fAlgoFound)
+            return InitError(strprintf(_("Invalid mining algorithm in -%s: '%s'. Available algorithms: %s"), strArg, strValue, GetAlgoRangeString()));
+        strRest = strValue.substr(nColon + 1);
+    }
+    return true;
+}
+
+static bool InitStratumOptions()
+{
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+
+    for (const std::string& strPort : gArgs.GetArgs("-stratumport")) {
+        uint8_t nAlgo;
+        std::string strNumber;
+        int32_t nPort;
+        if (!ParseStratumAlgoArg("stratumport", strPort, nAlgo, strNumber))
+            return false;
+        if (!ParseInt32(strNumber, &nPort) || nPort <= 0 || nPort > 65535)
+            return InitError(strprintf(_("Invalid port in -stratumport: '%s'"), strPort));
+        if (IsEquihashBasedAlgo(nAlgo) && !gArgs.GetBoolArg("-enableequihash", false))
+            return InitError(strprintf(_("Mining %s with -stratumport requires -enableequihash"), GetAlgoName(nAlgo)));
+        vStratumPorts.emplace_back(nAlgo, (uint16_t)nPort);
+        if (std::find(vStratumAlgos.begin(), vStratumAlgos.end(), nAlgo) == vStratumAlgos.end())
+            vStratumAlgos.push_back(nAlgo);
+    }
+
+    std::fill(dStratumDifficulty, dStratumDifficulty + NUM_ALGOS, DEFAULT_STRATUM_DIFFICULTY);
+    for (const std::string& strDifficulty : gArgs.GetArgs("-stratumdifficulty")) {
+        uint8_t nAlgo;
+        std::string strNumber;
+        double dDifficulty;
+        if (!ParseStratumAlgoArg("stratumdifficulty", strDifficulty, nAlgo, strNumber))
+            return false;
+        if (!ParseDouble(strNumber, &dDifficulty) || dDifficulty <= 0)
+            return InitError(strprintf(_("Invalid difficulty in -stratumdifficulty: '%s'"), strDifficulty));
+        // A difficulty without algo is the default of every algo
+        if (strNumber.size() == strDifficulty.size())
+            std::fill(dStratumDifficulty, dStratumDifficulty + NUM_ALGOS, dDifficulty);
+        else
+            dStratumDifficulty[nAlgo] = dDifficulty;
+    }
+
+    const std::string strAddress = gArgs.GetArg("-stratumaddress", "");
+    const CTxDestination destination = DecodeDestination(strAddress);
+    if (!IsValidDestination(destination))
+        return InitError(strprintf(_("The Stratum server needs a valid -stratumaddress to pay the blocks to: '%s'"), strAddress));
+    if (IsDestinationStringOldScriptFormat(strAddress))
+        return InitError(GetOldScriptAddressWarning(strAddress));
+    scriptStratumPayout = GetScriptForDestination(destination);
+
+    if (consensusParams.Hardfork1.IsActivated(GetAdjustedTime()) && !gArgs.GetBoolArg("-acceptdividedcoinbase", false))
+        return InitError(GetCoinbaseFeeString(DIVIDEDPAYMENTS_BLOCKTEMPLATE_WARNING));
+
+    return true;
+}
+
+static void StratumDisconnect(struct bufferevent* bev)
+{
+    auto it = mapStratumClients.find(bev);
+    if (it != mapStratumClients.end()) {
+        LogPrint(BCLog::STRATUM, "Stratum: %s disconnected\n", it->second.addr.ToString());
+        mapStratumClientIds.erase(it->second.nId);
+        mapStratumClients.erase(it);
+    }
+    bufferevent_free(bev);
+}
+
+static void StratumSend(StratumClient& client, const UniValue& message)
+{
+    const std::string strMessage = message.write() + "\n";
+    bufferevent_write(client.bev, strMessage.data(), strMessage.size());
+}
+
+static void StratumSendNotification(StratumClient& client, const std::string& strMethod, const UniValue& params)
+{
+    UniValue message(UniValue::VOBJ);
+    message.pushKV("id", NullUniValue);
+    message.pushKV("method", strMethod);
+    message.pushKV("params", params);
+    StratumSend(client, message);
+}
+
+static UniValue StratumError(int nCode, const std::string& strMessage)
+{
+    UniValue error(UniValue::VARR);
+    error.push_back(nCode);
+    error.push_back(strMessage);
+    error.push_back(NullUniValue);
+    return error;
+}
+
+static void StratumSendDifficulty(StratumClient& client)
+{
+    UniValue params(UniValue::VARR);
+    if (IsEquihashBasedAlgo(client.nAlgo)) {
+        params.push_back(client.shareTarget.GetHex());
+        StratumSendNotification(client, "mining.set_target", params);
+    } else {
+        params.push_back(client.dDifficulty);
+        StratumSendNotification(client, "mining.set_difficulty", params);
+    }
+}
+
+static void StratumSendJob(StratumClient& client, const StratumJob& job, bool fClean)
+{
+    const CBlock& block = job.block;
+    UniValue params(UniValue::VARR);
+    params.push_back(job.strId);
+    if (IsEquihashBasedAlgo(job.nAlgo)) {
+        // The header fields in their serialized byte order
+        unsigned char vchVersion[4], vchTime[4], vchBits[4];
+        WriteLE32(vchVersion, block.nVersion);
+        WriteLE32(vchTime, block.nTime);
+        WriteLE32(vchBits, block.nBits);
+        params.push_back(HexStr(vchVersion, vchVersion + 4));
+        params.push_back(HexStr(block.hashPrevBlock.begin(), block.hashPrevBlock.end()));
+        params.push_back(HexStr(block.hashMerkleRoot.begin(), block.hashMerkleRoot.end()));
+        params.push_back(HexStr(block.hashReserved.begin(), block.hashReserved.end()));
+        params.push_back(HexStr(vchTime, vchTime + 4));
+        params.push_back(HexStr(vchBits, vchBits + 4));
+    } else {
+        UniValue branch(UniValue::VARR);
+        for (const uint256& hash : job.vMerkleBranch)
+            branch.push_back(HexStr(hash.begin(), hash.end()));
+        params.push_back(StratumPrevHash(block.hashPrevBlock));
+        params.push_back(HexStr(job.vchCoinb1));
+        params.push_back(HexStr(job.vchCoinb2));
+        params.push_back(branch);
+        params.push_back(strprintf("%08x", (uint32_t)block.nVersion));
+        params.push_back(strprintf("%08x", block.nBits));
+        params.push_back(strprintf("%08x", block.nTime));
+    }
+    params.push_back(fClean);
+    StratumSendNotification(client, "mining.notify", params);
+}
+
+/** Send the jobs installed by the job thread to the miners of their algo */
+static void stratum_notify_cb(evutil_socket_t, short, void*)
+{
+    std::vector<std::pair<StratumJobRef, bool>> vJobs;
+    {
+        LOCK(cs_stratum);
+        for (const auto& pending : mapStratumPendingNotify) {
+            auto it = mapStratumCurrentJobs.find(pending.first);
+            if (it != mapStratumCurrentJobs.end())
+                vJobs.emplace_back(it->second, pending.second);
+        }
+        mapStratumPendingNotify.clear();
+    }
+    for (auto& entry : mapStratumClients) {
+        StratumClient& client = entry.second;
+        if (!client.fSubscribed)
+            continue;
+        for (const auto& job : vJobs) {
+            if (job.first->nAlgo == client.nAlgo)
+                StratumSendJob(client, *job.first, job.second);
+        }
+    }
+}
+
+/** Submit a block that solved a job */
+static bool StratumSubmitBlock(const StratumShare& share, const uint256& hashPoW)
+{
+    const StratumJob& job = *share.job;
+    std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>(job.block);
+    pblock->hashMerkleRoot = share.header.hashMerkleRoot;
+    pblock->nTime = share.header.nTime;
+    pblock->nNonce = share.header.nNonce;
+    pblock->nBigNonce = share.header.nBigNonce;
+    pblock->nSolution = share.header.nSolution;
+    if (share.coinbase)
+        pblock->vtx[0] = share.coinbase;
+
+    // Also puts the hash into the proof of work cache, so that
+    // ProcessNewBlock does not hash the header again
+    bool fEhSolutionValid;
+    if (!CheckProofOfWork(*pblock, Params().GetConsensus(), fEhSolutionValid, &hashPoW))
+        return false;
+
+    const bool fAccepted = ProcessNewBlock(Params(), pblock, true, nullptr);
+    LogPrintf("Stratum: %s block %s from %s (%s) %s\n", GetAlgoName(job.nAlgo), pblock->GetHash().ToString(),
+        share.strWorker, share.addr.ToString(), fAccepted ? "accepted" : "rejected");
+    return fAccepted;
+}
+
+/**
+ * Check what a share can be checked for cheaply, and queue it for a share
+ * thread. Returns false, with the error to reply, if the share was not queued.
+ */
+static bool StratumQueueShare(StratumClient& client, const UniValue& id, const UniValue& params, UniValue& error)
+{
+    if (!client.fSubscribed) {
+        error = StratumError(STRATUM_ERROR_NOT_SUBSCRIBED, "Not subscribed");
+        return false;
+    }
+    if (params.size() < 5) {
+        error = StratumError(STRATUM_ERROR_OTHER, "Invalid parameters");
+        return false;
+    }
+
+    StratumJobRef job;
+    uint256 hashTip;
+    {
+        LOCK(cs_stratum);
+        auto it = mapStratumJobs.find(params[1].get_str());
+        if (it != mapStratumJobs.end())
+            job = it->second;
+        hashTip = hashStratumTip;
+    }
+    if (!job || job->nAlgo != client.nAlgo) {
+        error = StratumError(STRATUM_ERROR_JOB_NOT_FOUND, "Job not found");
+        return false;
+    }
+
+    const bool fEquihash = IsEquihashBasedAlgo(job->nAlgo);
+    CBlockHeader header = job->block.GetBlockHeader();
+    CTransactionRef coinbase;
+    if (fEquihash) {
+        const std::vector<unsigned char> vchTime = ParseHex(params[2].get_str());
+        const std::vector<unsigned char> vchNonce2 = ParseHex(params[3].get_str());
+        const std::vector<unsigned char> vchSolution = ParseHex(params[4].get_str());
+        if (vchTime.size() != 4 || vchNonce2.size() != header.nBigNonce.size() - STRATUM_EXTRANONCE1_SIZE) {
+            error = StratumError(STRATUM_ERROR_OTHER, "Invalid time or nonce");
+            return false;
+        }
+        header.nTime = ReadLE32(vchTime.data());
+        std::copy(client.vchExtraNonce1.begin(), client.vchExtraNonce1.end(), header.nBigNonce.begin());
+        std::copy(vchNonce2.begin(), vchNonce2.end(), header.nBigNonce.begin() + STRATUM_EXTRANONCE1_SIZE);
+        try {
+            CDataStream ss(vchSolution, SER_NETWORK, PROTOCOL_VERSION);
+            ss >> header.nSolution;
+            if (!ss.empty())
+                throw std::ios_base::failure("trailing data");
+        } catch (const std::exception&) {
+            error = StratumError(STRATUM_ERROR_OTHER, "Invalid solution");
+            return false;
+        }
+    } else {
+        const std::vector<unsigned char> vchExtraNonce2 = ParseHex(params[2].get_str());
+        if (vchExtraNonce2.size() != STRATUM_EXTRANONCE2_SIZE || !ParseStratumHex32(params[3], header.nTime) ||
+            !ParseStratumHex32(params[4], header.nNonce)) {
+            error = StratumError(STRATUM_ERROR_OTHER, "Invalid extranonce2, time or nonce");
+            return false;
+        }
+        std::vector<unsigned char> vchExtraNonce(client.vchExtraNonce1);
+        vchExtraNonce.insert(vchExtraNonce.end(), vchExtraNonce2.begin(), vchExtraNonce2.end());
+        if (!AssembleStratumCoinbase(job->vchCoinb1, vchExtraNonce, job->vchCoinb2, *job->block.vtx[0], coinbase)) {
+            error = StratumError(STRATUM_ERROR_OTHER, "Invalid coinbase");
+            return false;
+        }
+        header.hashMerkleRoot = ComputeMerkleRootFromBranch(coinbase->GetHash(), job->vMerkleBranch, 0);
+    }
+
+    if (header.nTime < job->block.nTime || header.nTime > GetAdjustedTime() + MAX_FUTURE_BLOCK_TIME) {
+        error = StratumError(STRATUM_ERROR_OTHER, "Time out of range");
+        return false;
+    }
+    {
+        // Only the event thread queues shares, so there is still room below
+        std::lock_guard<std::mutex> lock(cs_stratumShares);
+        if (queueStratumShares.size() >= MAX_STRATUM_PENDING_SHARES) {
+            error = StratumError(STRATUM_ERROR_OTHER, "Server busy");
+            return false;
+        }
+    }
+    switch (CheckStratumShare(job->block.hashPrevBlock, hashTip, header.GetHash(), job->shares)) {
+    case StratumShareResult::STALE:
+        error = StratumError(STRATUM_ERROR_JOB_NOT_FOUND, "Stale share");
+        return false;
+    case StratumShareResult::DUPLICATE:
+        error = StratumError(STRATUM_ERROR_DUPLICATE_SHARE, "Duplicate share");
+        return false;
+    default:
+        break;
+    }
+
+    StratumShare share;
+    share.nClientId = client.nId;
+    share.id = id;
+    share.job = job;
+    share.header = header;
+    share.coinbase = coinbase;
+    share.shareTarget = client.shareTarget;
+    share.strWorker = client.strWorker;
+    share.addr = client.addr;
+    {
+        std::lock_guard<std::mutex> lock(cs_stratumShares);
+        queueStratumShares.push_back(std::move(share));
+    }
+    condStratumShares.notify_one();
+    return true;
+}
+
+/** Check the solution and proof of work of a share, and submit it if it solves a block */
+static bool StratumCheckShare(const StratumShare& share, UniValue& error)
+{
+    const StratumJob& job = *share.job;
+    const CBlockHeader& header = share.header;
+    if (IsEquihashBasedAlgo(job.nAlgo) && (header.nSolution.size() != Params().EquihashSolutionWidth(job.nAlgo) || !CheckEquihashSolution(&header, Params()))) {
+        error = StratumError(STRATUM_ERROR_OTHER, "Invalid solution");
+        return false;
+    }
+
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    const uint256 hashPoW = header.GetPoWHash(SER_GETHASH, LoadMultiHasherVersionFlags(consensusParams.Hardfork3.IsActivated(header.nTime)));
+    switch (CheckStratumSharePoW(hashPoW, header.nBits, job.nAlgo, share.shareTarget, consensusParams)) {
+    case StratumShareResult::BLOCK:
+        StratumSubmitBlock(share, hashPoW);
+        break;
+    case StratumShareResult::LOW_DIFFICULTY:
+        error = StratumError(STRATUM_ERROR_LOW_DIFFICULTY, "Low difficulty share");
+        return false;
+    default:
+        break;
+    }
+    return true;
+}
+
+/**
+ * Check the queued shares, which can take long for the memory-hard algos and
+ * the blocks, so that the event thread keeps serving the other miners.
+ */
+static void ThreadStratumShares()
+{
+    RenameThread("globaltoken-stratumshares");
+    while (true) {
+        StratumShare share;
+        {
+            std::unique_lock<std::mutex> lock(cs_stratumShares);
+            condStratumShares.wait(lock, [] { return fStratumInterrupt || !queueStratumShares.empty(); });
+            if (fStratumInterrupt)
+                return;
+            share = std::move(queueStratumShares.front());
+            queueStratumShares.pop_front();
+        }
+
+        UniValue error = NullUniValue;
+        bool fResult = false;
+        try {
+            fResult = StratumCheckShare(share, error);
+        } catch (const std::exception& e) {
+            error = StratumError(STRATUM_ERROR_OTHER, e.what());
+        }
+        if (!error.isNull())
+            LogPrint(BCLog::STRATUM, "Stratum: mining.submit from %s failed: %s\n", share.addr.ToString(), error[1].get_str());
+
+        UniValue reply(UniValue::VOBJ);
+        reply.pushKV("id", share.id);
+        reply.pushKV("result", error.isNull() ? UniValue(fResult) : NullUniValue);
+        reply.pushKV("error", error);
+        {
+            LOCK(cs_stratum);
+            vStratumReplies.emplace_back(share.nClientId, std::move(reply));
+        }
+        event_active(eventReplies, 0, 0);
+    }
+}
+
+/** Send the replies of the share threads to the miners that are still connected */
+static void stratum_replies_cb(evutil_socket_t, short, void*)
+{
+    std::vector<std::pair<uint64_t, UniValue>> vReplies;
+    {
+        LOCK(cs_stratum);
+        vReplies.swap(vStratumReplies);
+    }
+    for (const auto& reply : vReplies) {
+        auto it = mapStratumClientIds.find(reply.first);
+        if (it != mapStratumClientIds.end())
+            StratumSend(mapStratumClients.at(it->second), reply.second);
+    }
+}
+
+/** Handle a request line. Returns false to disconnect the miner. */
+static bool StratumHandleLine(StratumClient& client, const std::string& strLine)
+{
+    UniValue request;
+    if (!request.read(strLine) || !request.isObject())
+        return false;
+    const UniValue& id = find_value(request, "id");
+    const UniValue& method = find_value(request, "method");
+    const UniValue& params = find_value(request, "params");
+
+    UniValue result = NullUniValue;
+    UniValue error = NullUniValue;
+    bool fSendJob = false;
+    try {
+        const std::string strMethod = method.get_str();
+        if (strMethod == "mining.subscribe") {
+            result = UniValue(UniValue::VARR);
+            const std::string strExtraNonce1 = HexStr(client.vchExtraNonce1);
+            if (IsEquihashBasedAlgo(client.nAlgo)) {
+                result.push_back(NullUniValue);
+                result.push_back(strExtraNonce1);
+            } else {
+                UniValue subscriptions(UniValue::VARR);
+                for (const char* strNotification : {"mining.set_difficulty", "mining.notify"}) {
+                    UniValue subscription(UniValue::VARR);
+                    subscription.push_back(strNotification);
+                    subscription.push_back(strExtraNonce1);
+                    subscriptions.push_back(subscription);
+                }
+                result.push_back(subscriptions);
+                result.push_back(strExtraNonce1);
+                result.push_back((int)STRATUM_EXTRANONCE2_SIZE);
+            }
+            client.fSubscribed = true;
+            fSendJob = true;
+        } else if (strMethod == "mining.authorize") {
+            // Access is limited with -stratumallowip, the worker name is only logged
+            if (params.isArray() && params.size() >= 1)
+                client.strWorker = params[0].get_str();
+            result = true;
+        } else if (strMethod == "mining.extranonce.subscribe") {
+            result = true;
+        } else if (strMethod == "mining.suggest_difficulty") {
+            // Miners can ask for harder shares, but not for easier ones
+            if (params.isArray() && params.size() >= 1 && params[0].get_real() > client.dDifficulty) {
+                client.dDifficulty = params[0].get_real();
+                client.shareTarget = StratumShareTarget(client.nAlgo, client.dDifficulty, Params().GetConsensus());
+                if (client.fSubscribed)
+                    StratumSendDifficulty(client);
+            }
+            result = true;
+        } else if (strMethod == "mining.submit") {
+            // A share thread replies once the share is checked
+            if (StratumQueueShare(client, id, params, error))
+                return true;
+        } else {
+            error = StratumError(STRATUM_ERROR_OTHER, "Method not found");
+        }
+    } catch (const std::exception&) {
+        error = StratumError(STRATUM_ERROR_OTHER, "Invalid request");
+    }
+
+    if (!error.isNull())
+        LogPrint(BCLog::STRATUM, "Stratum: %s from %s failed: %s\n", method.isStr() ? method.get_str() : "request", client.addr.ToString(), error[1].get_str());
+
+    UniValue reply(UniValue::VOBJ);
+    reply.pushKV("id", id);
+    reply.pushKV("result", error.isNull() ? result : NullUniValue);
+    reply.pushKV("error", error);
+    StratumSend(client, reply);
+
+    if (fSendJob) {
+        StratumSendDifficulty(client);
+        StratumJobRef job;
+        {
+            LOCK(cs_stratum);
+            auto it = mapStratumCurrentJobs.find(client.nAlgo);
+            if (it != mapStratumCurrentJobs.end())
+                job = it->second;
+        }
+        if (job)
+            StratumSendJob(client, *job, true);
+    }
+    return true;
+}
+
+static void stratum_read_cb(struct bufferevent* bev, void*)
+{
+    auto it = mapStratumClients.find(bev);
+    if (it == mapStratumClients.end())
+        return;
+    struct evbuffer* input = bufferevent_get_input(bev);
+    size_t nLength;
+    char* line;
+    while ((line = evbuffer_readln(input, &nLength, EVBUFFER_EOL_CRLF)) != nullptr) {
+        const std::string strLine(line, nLength);
+        free(line);
+        if (strLine.empty())
+            continue;
+        if (nLength > MAX_STRATUM_LINE || !StratumHandleLine(it->second, strLine)) {
+            LogPrint(BCLog::STRATUM, "Stratum: invalid request from %s\n", it->second.addr.ToString());
+            StratumDisconnect(bev);
+            return;
+        }
+    }
+    if (evbuffer_get_length(input) > MAX_STRATUM_LINE) {
+        LogPrint(BCLog::STRATUM, "Stratum: request line from %s is too long\n", it->second.addr.ToString());
+        StratumDisconnect(bev);
+    }
+}
+
+static void stratum_event_cb(struct bufferevent* bev, short events, void*)
+{
+    if (events & (BEV_EVENT_EOF | BEV_EVENT_ERROR | BEV_EVENT_TIMEOUT))
+        StratumDisconnect(bev);
+}
+
+static void stratum_accept_cb(struct evconnlistener*, evutil_socket_t fd, struct sockaddr* address, int, void* arg)
+{
+    CService addr;
+    if (!addr.SetSockAddr(address) || !StratumClientAllowed(addr)) {
+        LogPrint(BCLog::STRATUM, "Stratum: rejected connection from %s\n", addr.ToString());
+        evutil_closesocket(fd);
+        return;
+    }
+    if (mapStratumClients.size() >= MAX_STRATUM_CLIENTS) {
+        LogPrintf("Stratum: too many connections, rejected %s\n", addr.ToString());
+        evutil_closesocket(fd);
+        return;
+    }
+    struct bufferevent* bev = bufferevent_socket_new(stratumBase, fd, BEV_OPT_CLOSE_ON_FREE);
+    if (!bev) {
+        evutil_closesocket(fd);
+        return;
+    }
+
+    StratumClient& client = mapStratumClients[bev];
+    client.nId = ++nStratumClientId;
+    mapStratumClientIds[client.nId] = bev;
+    client.bev = bev;
+    client.addr = addr;
+    client.nAlgo = (uint8_t)(intptr_t)arg;
+    client.vchExtraNonce1.resize(STRATUM_EXTRANONCE1_SIZE);
+    WriteBE32(client.vchExtraNonce1.data(), nStratumExtraNonce1++);
+    client.fSubscribed = false;
+    client.dDifficulty = dStratumDifficulty[client.nAlgo];
+    client.shareTarget = StratumShareTarget(client.nAlgo, client.dDifficulty, Params().GetConsensus());
+    LogPrint(BCLog::STRATUM, "Stratum: %s connected for %s\n", addr.ToString(), GetAlgoName(client.nAlgo));
+
+    struct timeval timeout = {STRATUM_CLIENT_TIMEOUT, 0};
+    bufferevent_setcb(bev, stratum_read_cb, nullptr, stratum_event_cb, nullptr);
+    bufferevent_set_timeouts(bev, &timeout, nullptr);
+    bufferevent_enable(bev, EV_READ | EV_WRITE);
+}
+
+/** Bind the Stratum server to the addresses of every port */
+static bool StratumBindAddresses()
+{
+    for (const auto& port : vStratumPorts) {
+        std::vector<std::string> vHosts;
+        if (!gArgs.IsArgSet("-stratumallowip")) { // Default to loopback if not allowing external IPs
+            vHosts = {"::1", "127.0.0.1"};
+        } else if (gArgs.IsArgSet("-stratumbind")) {
+            vHosts = gArgs.GetArgs("-stratumbind");
+        } else {
+            vHosts = {"::", "0.0.0.0"};
+        }
+
+        bool fBound = false;
+        for (const std::string& strHost : vHosts) {
+            const CService addrBind = LookupNumeric(strHost.c_str(), port.second);
+            struct sockaddr_storage sockaddr;
+            socklen_t len = sizeof(sockaddr);
+            if (!addrBind.IsValid() || !addrBind.GetSockAddr((struct sockaddr*)&sockaddr, &len)) {
+                LogPrintf("Stratum: invalid bind address %s\n", strHost);
+                continue;
+            }
+            struct evconnlistener* listener = evconnlistener_new_bind(stratumBase, stratum_accept_cb, (void*)(intptr_t)port.first,
+                LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE | LEV_OPT_THREADSAFE, -1, (struct sockaddr*)&sockaddr, len);
+            if (listener) {
+                LogPrintf("Stratum: listening for %s on %s\n", GetAlgoName(port.first), addrBind.ToString());
+                vStratumListeners.push_back(listener);
+                fBound = true;
+            } else {
+                LogPrintf("Stratum: binding on %s failed\n", addrBind.ToString());
+            }
+        }
+        if (!fBound)
+            return InitError(strprintf(_("Unable to bind the Stratum server on port %u"), port.second));
+    }
+    if (gArgs.IsArgSet("-stratumbind") && !gArgs.IsArgSet("-stratumallowip"))
+        LogPrintf("WARNING: option -stratumbind was ignored because -stratumallowip was not specified, refusing to allow everyone to connect\n");
+    return true;
+}
+
+/** Whether a block template would be accepted by the network, like getblocktemplate checks */
+static bool StratumCanMine()
+{
+    if (!g_connman || g_connman->GetNodeCount(CConnman::CONNECTIONS_ALL) == 0 || IsInitialBlockDownload())
+        return false;
+    int nHeight;
+    {
+        LOCK(cs_main);
+        nHeight = chainActive.Height();
+    }
+    CScript payee;
+    if (sporkManager.IsSporkActive(SPORK_5_MASTERNODE_PAYMENT_ENFORCEMENT)
+        && !masternodeSync.IsWinnersListSynced()
+        && !mnpayments.GetBlockPayee(nHeight + 1, payee))
+        return false;
+    return true;
+}
+
+static StratumJobRef StratumBuildJob(uint8_t nAlgo)
+{
+    std::unique_ptr<CBlockTemplate> pblocktemplate;
+    try {
+        pblocktemplate = BlockAssembler(Params()).CreateNewBlock(scriptStratumPayout, nAlgo);
+    } catch (const std::exception& e) {
+        LogPrintf("Stratum: could not create a %s block template: %s\n", GetAlgoName(nAlgo), e.what());
+        return nullptr;
+    }
+    if (!pblocktemplate)
+        return nullptr;
+
+    StratumJobRef job = std::make_shared<StratumJob>();
+    job->nAlgo = nAlgo;
+    job->block = pblocktemplate->block;
+    if (IsEquihashBasedAlgo(nAlgo)) {
+        // The nonce is 32 bytes long, so the coinbase does not need an extranonce
+        job->block.hashMerkleRoot = BlockMerkleRoot(job->block);
+    } else {
+        int nHeight;
+        {
+            LOCK(cs_main);
+            BlockMap::const_iterator mi = mapBlockIndex.find(job->block.hashPrevBlock);
+            if (mi == mapBlockIndex.end())
+                return nullptr;
+            nHeight = mi->second->nHeight + 1;
+        }
+        CMutableTransaction coinbase(*job->block.vtx[0]);
+        if (!SplitStratumCoinbase(coinbase, nHeight, job->vchCoinb1, job->vchCoinb2)) {
+            LogPrintf("Stratum: the coinbase of a %s block template has no room for the extranonce\n", GetAlgoName(nAlgo));
+            return nullptr;
+        }
+        job->block.vtx[0] = MakeTransactionRef(std::move(coinbase));
+        job->vMerkleBranch = BlockMerkleBranch(job->block, 0);
+    }
+    return job;
+}
+
+static void ThreadStratumJobs()
+{
+    RenameThread("globaltoken-stratumjobs");
+    uint256 hashJobsTip;
+    unsigned int nTransactionsUpdatedLast = 0;
+    int64_t nLastBuild = 0;
+    uint32_t nJobId = 0;
+    //! Algos whose last build failed, retried every second
+    std::set<uint8_t> setRetryAlgos;
+
+    while (!fStratumInterrupt) {
+        {
+            // Woken up by a new tip, like the getblocktemplate long poll
+            WaitableLock lock(csBestBlock);
+            if (!fStratumInterrupt && (chainActive.Tip()->GetBlockHash() == hashJobsTip || !setRetryAlgos.empty()))
+                cvBlockChange.wait_for(lock, std::chrono::seconds(1));
+        }
+        if (fStratumInterrupt || !StratumCanMine())
+            continue;
+
+        uint256 hashTip;
+        {
+            LOCK(cs_main);
+            hashTip = chainActive.Tip()->GetBlockHash();
+        }
+        const bool fNewTip = hashTip != hashJobsTip;
+        if (fNewTip) {
+            LOCK(cs_stratum);
+            hashStratumTip = hashTip;
+        }
+        const bool fRefresh = mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nLastBuild >= STRATUM_JOB_REFRESH;
+        if (!fNewTip && !fRefresh && setRetryAlgos.empty())
+            continue;
+        const unsigned int nTransactionsUpdated = mempool.GetTransactionsUpdated();
+
+        std::vector<StratumJobRef> vJobs;
+        std::set<uint8_t> setFailedAlgos;
+        for (uint8_t nAlgo : vStratumAlgos) {
+            if (!fNewTip && !fRefresh && !setRetryAlgos.count(nAlgo))
+                continue;
+            StratumJobRef job = StratumBuildJob(nAlgo);
+            if (job) {
+                job->strId = strprintf("%x", ++nJobId);
+                vJobs.push_back(job);
+            } else {
+                setFailedAlgos.insert(nAlgo);
+            }
+        }
+        setRetryAlgos.swap(setFailedAlgos);
+        // Keep trying the tip until a job is built for it
+        if (!vJobs.empty() && (fNewTip || fRefresh)) {
+            nTransactionsUpdatedLast = nTransactionsUpdated;
+            nLastBuild = GetTime();
+            hashJobsTip = hashTip;
+        }
+
+        {
+            LOCK(cs_stratum);
+            // Shares of the jobs on an earlier tip could not be blocks anymore
+            for (auto it = mapStratumJobs.begin(); it != mapStratumJobs.end();) {
+                if (it->second->block.hashPrevBlock != hashTip)
+                    it = mapStratumJobs.erase(it);
+                else
+                    ++it;
+            }
+            // and neither can the work of the miners of an algo whose build
+            // failed, so new miners get no job until one is built
+            for (auto it = mapStratumCurrentJobs.begin(); it != mapStratumCurrentJobs.end();) {
+                if (it->second->block.hashPrevBlock != hashTip)
+                    it = mapStratumCurrentJobs.erase(it);
+                else
+                    ++it;
+            }
+            for (const StratumJobRef& job : vJobs) {
+                auto it = mapStratumCurrentJobs.find(job->nAlgo);
+                const bool fClean = it == mapStratumCurrentJobs.end() || it->second->block.hashPrevBlock != job->block.hashPrevBlock;
+                mapStratumJobs[job->strId] = job;
+                mapStratumCurrentJobs[job->nAlgo] = job;
+                mapStratumPendingNotify[job->nAlgo] |= fClean;
+            }
+        }
+        if (!vJobs.empty())
+            event_active(eventNotify, 0, 0);
+    }
+}
+
+static bool ThreadStratum(struct event_base* base)
+{
+    RenameThread("globaltoken-stratum");
+    LogPrint(BCLog::STRATUM, "Entering stratum event loop\n");
+    event_base_dispatch(base);
+    // Event loop will be interrupted by StopStratumServer()
+    LogPrint(BCLog::STRATUM, "Exited stratum event loop\n");
+    return event_base_got_break(base) == 0;
+}
+
+bool InitStratumServer()
+{
+    if (!gArgs.IsArgSet("-stratumport"))
+        return true;
+
+    if (!InitStratumOptions() || !InitStratumAllowList())
+        return false;
+
+#ifdef WIN32
+    evthread_use_windows_threads();
+#else
+    evthread_use_pthreads();
+#endif
+
+    raii_event_base base_ctr = obtain_event_base();
+    stratumBase = base_ctr.release();
+    eventNotify = event_new(stratumBase, -1, 0, stratum_notify_cb, nullptr);
+    eventReplies = event_new(stratumBase, -1, 0, stratum_replies_cb, nullptr);
+    nStratumExtraNonce1 = GetRand(std::numeric_limits<uint32_t>::max());
+
+    return StratumBindAddresses();
+}
+
+void StartStratumServer()
+{
+    if (!stratumBase)
+        return;
+    LogPrint(BCLog::STRATUM, "Starting Stratum server\n");
+    std::packaged_task<bool(event_base*)> task(ThreadStratum);
+    threadStratumResult = task.get_future();
+    threadStratum = std::thread(std::move(task), stratumBase);
+    threadStratumJobs = std::thread(ThreadStratumJobs);
+    for (int i = 0; i < STRATUM_SHARE_THREADS; i++)
+        vStratumShareThreads.emplace_back(ThreadStratumShares);
+}
+
+void InterruptStratumServer()
+{
+    if (!stratumBase)
+        return;
+    LogPrint(BCLog::STRATUM, "Interrupting Stratum server\n");
+    fStratumInterrupt = true;
+    cvBlockChange.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(cs_stratumShares);
+        condStratumShares.notify_all();
+    }
+    for (struct evconnlistener* listener : vStratumListeners)
+        evconnlistener_disable(listener);
+}
+
+void StopStratumServer()
+{
+    if (!stratumBase)
+        return;
+    LogPrint(BCLog::STRATUM, "Stopping Stratum server\n");
+    if (threadStratumJobs.joinable())
+        threadStratumJobs.join();
+    for (std::thread& thread : vStratumShareThreads)
+        thread.join();
+    vStratumShareThreads.clear();
+    {
+        std::lock_guard<std::mutex> lock(cs_stratumShares);
+        queueStratumShares.clear();
+    }
+    if (threadStratum.joinable()) {
+        // Give the event loop a moment to send the last replies, then break it (see StopHTTPServer)
+        event_base_loopexit(stratumBase, nullptr);
+        if (threadStratumResult.wait_for(std::chrono::milliseconds(2000)) == std::future_status::timeout)
+            event_base_loopbreak(stratumBase);
+        threadStratum.join();
+    }
+    for (auto& entry : mapStratumClients)
+        bufferevent_free(entry.first);
+    mapStratumClients.clear();
+    mapStratumClientIds.clear();
+    for (struct evconnlistener* listener : vStratumListeners)
+        evconnlistener_free(listener);
+    vStratumListeners.clear();
+    {
+        LOCK(cs_stratum);
+        mapStratumJobs.clear();
+        mapStratumCurrentJobs.clear();
+        mapStratumPendingNotify.clear();
+        vStratumReplies.clear();
+        hashStratumTip.SetNull();
+    }
+    event_free(eventNotify);
+    eventNotify = nullptr;
+    event_free(eventReplies);
+    eventReplies = nullptr;
+    event_base_free(stratumBase);
+    stratumBase = nullptr;
+    LogPrint(BCLog::STRATUM, "Stopped Stratum server\n");
+}
@@ -0,0 +1,120 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBALTOKEN_STRATUM_H
+#define GLOBALTOKEN_STRATUM_H
+
+#include <arith_uint256.h>
+#include <consensus/params.h>
+#include <primitives/transaction.h>
+#include <uint256.h>
+
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//! Bytes of the extranonce (or Equihash nonce) that the server assigns to each connection
+static const size_t STRATUM_EXTRANONCE1_SIZE = 4;
+//! Bytes of the extranonce that miners of the non-Equihash algorithms roll
+static const size_t STRATUM_EXTRANONCE2_SIZE = 4;
+//! Default share difficulty. Difficulty 1 is the pow limit of the algo.
+static const double DEFAULT_STRATUM_DIFFICULTY = 1.0;
+//! Seconds after which a new job is built if the mempool changed
+static const int64_t STRATUM_JOB_REFRESH = 30;
+//! Seconds without a request after which a connection is closed
+static const int STRATUM_CLIENT_TIMEOUT = 600;
+//! Maximum number of miners connected at once
+static const size_t MAX_STRATUM_CLIENTS = 1024;
+//! Maximum length of a request line
+static const size_t MAX_STRATUM_LINE = 8192;
+//! Threads that check shares and submit blocks, off the event thread
+static const int STRATUM_SHARE_THREADS = 2;
+//! Maximum number of shares waiting for a share thread, more are turned away
+static const size_t MAX_STRATUM_PENDING_SHARES = 1024;
+//! Maximum number of share hashes a job remembers to turn away duplicates
+static const size_t MAX_STRATUM_JOB_SHARES = 65536;
+
+/**
+ * The built-in Stratum v1 server. Each -stratumport listens for miners of
+ * one algo. A job thread builds a block template per algo whenever the tip
+ * changes (and every STRATUM_JOB_REFRESH seconds if the mempool changed)
+ * and pushes it to the miners with mining.notify. Share threads check the
+ * shares with the local proof of work code, submit the ones that solve a
+ * block with ProcessNewBlock, and hand the replies back to the event thread.
+ *
+ * Does nothing unless -stratumport is set.
+ */
+bool InitStratumServer();
+void StartStratumServer();
+/** Stop accepting connections and building jobs */
+void InterruptStratumServer();
+/** Disconnect the miners and stop the server threads */
+void StopStratumServer();
+
+/**
+ * Prepare the coinbase of a block template for miners that roll an
+ * extranonce: its scriptSig becomes the height, a push of the extranonce
+ * bytes and COINBASE_FLAGS, and the serialization without witness is split
+ * into the parts before (coinb1) and after (coinb2) the extranonce.
+ */
+bool SplitStratumCoinbase(CMutableTransaction& tx, int nHeight, std::vector<unsigned char>& vchCoinb1, std::vector<unsigned char>& vchCoinb2);
+
+/**
+ * The coinbase a miner hashed: coinb1, the extranonce and coinb2, with the
+ * witness of the template coinbase (which is not part of the txid).
+ */
+bool AssembleStratumCoinbase(const std::vector<unsigned char>& vchCoinb1, const std::vector<unsigned char>& vchExtraNonce,
+                             const std::vector<unsigned char>& vchCoinb2, const CTransaction& txTemplate, CTransactionRef& txOut);
+
+/** A previous block hash as mining.notify sends it: the header bytes, with each 32 bit word reversed. */
+std::string StratumPrevHash(const uint256& hash);
+
+/**
+ * The share target of a difficulty. Difficulty 1 is the pow limit of the
+ * algo rather than a fixed target, which would be far too hard for the
+ * Equihash and memory-hard algos.
+ */
+arith_uint256 StratumShareTarget(uint8_t nAlgo, double dDifficulty, const Consensus::Params& params);
+
+/**
+ * The header hashes of the shares submitted for a job, to turn away
+ * duplicates. At most nMaxShares are kept: once the newer half is full it
+ * replaces the older one, so only a share older than nMaxShares / 2 others
+ * can come through twice.
+ */
+class CStratumShareSet
+{
+public:
+    explicit CStratumShareSet(size_t nMaxSharesIn = MAX_STRATUM_JOB_SHARES) : nMaxShares(nMaxSharesIn) {}
+
+    /** Returns false if the share was submitted before */
+    bool Insert(const uint256& hash);
+    size_t size() const { return setNew.size() + setOld.size(); }
+
+private:
+    size_t nMaxShares;
+    std::set<uint256> setNew;
+    std::set<uint256> setOld;
+};
+
+enum class StratumShareResult
+{
+    VALID,
+    BLOCK,
+    STALE,
+    DUPLICATE,
+    LOW_DIFFICULTY,
+};
+
+/**
+ * Check that a share is for a job on the tip and was not submitted before.
+ * Records the share in the shares of its job.
+ */
+StratumShareResult CheckStratumShare(const uint256& hashPrevBlock, const uint256& hashTip, const uint256& hashShare, CStratumShareSet& shares);
+
+/** Check the proof of work hash of a share against the block and the share target */
+StratumShareResult CheckStratumSharePoW(const uint256& hashPoW, uint32_t nBits, uint8_t nAlgo, const arith_uint256& shareTarget, const Consensus::Params& params);
+
+#endif // GLOBALTOKEN_STRATUM_H
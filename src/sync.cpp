@@ -4,10 +4,13 @@
 
 #include <sync.h>
 
+#include <map>
 #include <set>
 #include <util.h>
 #include <utilstrencodings.h>
 
+#include <algorithm>
+#include <chrono>
 #include <stdio.h>
 
 #ifdef DEBUG_LOCKCONTENTION
@@ -190,3 +193,197 @@ void DeleteLock(void* cs)
 }
 
 #endif /* DEBUG_LOCKORDER */
+
+//! Sites a profiled lock keeps apart, the ones beyond share one entry
+static const size_t LOCK_PROFILE_SITES = 1024;
+
+struct CLockSite
+{
+    //! Set last, with release semantics, when the entry is taken for a site
+    std::atomic<const char*> pszFile{nullptr};
+    const char* pszName = nullptr;
+    int nLine = 0;
+    std::atomic<uint64_t> nAcquired{0};
+    std::atomic<uint64_t> nContended{0};
+    std::atomic<int64_t> nWaitMicros{0};
+    std::atomic<int64_t> nMaxWaitMicros{0};
+    std::atomic<int64_t> nHoldMicros{0};
+    std::atomic<int64_t> nMaxHoldMicros{0};
+};
+
+/**
+ * Everything but the name is only written by the thread holding the lock,
+ * so the counters need no read-modify-write; they are atomic for readers.
+ */
+class CLockProfile
+{
+public:
+    explicit CLockProfile(const std::string& strNameIn) : strName(strNameIn) {}
+
+    const std::string strName;
+    //! Recursion depth of the thread holding the lock, only the outermost hold counts
+    int nDepth = 0;
+    CLockSite* pHolder = nullptr;
+    int64_t nAcquiredTime = 0;
+    CLockSite sites[LOCK_PROFILE_SITES];
+    CLockSite others;
+
+    CLockSite* FindSite(const char* pszName, const char* pszFile, int nLine)
+    {
+        // __FILE__ is the same string for every use at a site
+        size_t nIndex = (((uintptr_t)pszFile >> 3) ^ ((size_t)nLine * 2654435761u)) % LOCK_PROFILE_SITES;
+        for (size_t i = 0; i < LOCK_PROFILE_SITES; i++, nIndex = (nIndex + 1) % LOCK_PROFILE_SITES) {
+            CLockSite& site = sites[nIndex];
+            const char* pszSiteFile = site.pszFile.load(std::memory_order_relaxed);
+            if (pszSiteFile == pszFile && site.nLine == nLine)
+                return &site;
+            if (pszSiteFile == nullptr) {
+                site.pszName = pszName;
+                site.nLine = nLine;
+                site.pszFile.store(pszFile, std::memory_order_release);
+                return &site;
+            }
+        }
+        return &others;
+    }
+};
+
+template <typename T>
+static inline void AddRelaxed(std::atomic<T>& counter, T n)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+template <typename T>
+static inline void MaxRelaxed(std::atomic<T>& counter, T n)
+{
+    if (n > counter.load(std::memory_order_relaxed))
+        counter.store(n, std::memory_order_relaxed);
+}
+
+static std::mutex cs_lockProfiles;
+//! Only freed by UnprofileLock, the global locks they profile are never destroyed
+static std::vector<CLockProfile*> vLockProfiles;
+
+#ifdef HAVE_THREAD_LOCAL
+static thread_local int64_t nThreadLockWaitMicros = 0;
+static thread_local int64_t nThreadLockHoldMicros = 0;
+#endif
+
+int64_t LockProfileTime()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LockProfileAcquired(CLockProfile* profile, const char* pszName, const char* pszFile, int nLine, int64_t nWaitMicros)
+{
+    if (profile->nDepth++ > 0)
+        return;
+    CLockSite* site = profile->FindSite(pszName, pszFile, nLine);
+    AddRelaxed<uint64_t>(site->nAcquired, 1);
+    if (nWaitMicros >= 0) {
+        AddRelaxed<uint64_t>(site->nContended, 1);
+        AddRelaxed(site->nWaitMicros, nWaitMicros);
+        MaxRelaxed(site->nMaxWaitMicros, nWaitMicros);
+#ifdef HAVE_THREAD_LOCAL
+        nThreadLockWaitMicros += nWaitMicros;
+#endif
+    }
+    profile->pHolder = site;
+    profile->nAcquiredTime = LockProfileTime();
+}
+
+void LockProfileReleased(CLockProfile* profile)
+{
+    // Zero if the lock was taken before it was profiled
+    if (profile->nDepth == 0 || --profile->nDepth > 0)
+        return;
+    const int64_t nHoldMicros = LockProfileTime() - profile->nAcquiredTime;
+    AddRelaxed(profile->pHolder->nHoldMicros, nHoldMicros);
+    MaxRelaxed(profile->pHolder->nMaxHoldMicros, nHoldMicros);
+#ifdef HAVE_THREAD_LOCAL
+    nThreadLockHoldMicros += nHoldMicros;
+#endif
+}
+
+void EnterCriticalSectionLock(CCriticalSection& cs, const char* pszName, const char* pszFile, int nLine)
+{
+    CLockProfile* profile = cs.profile.load(std::memory_order_acquire);
+    if (!profile) {
+        cs.lock();
+        return;
+    }
+    const int64_t nWaitMicros = LockTimingWait(cs);
+    LockProfileAcquired(profile, pszName, pszFile, nLine, nWaitMicros);
+}
+
+void LeaveCriticalSectionLock(CCriticalSection& cs)
+{
+    CLockProfile* profile = cs.profile.load(std::memory_order_acquire);
+    if (profile)
+        LockProfileReleased(profile);
+    cs.unlock();
+}
+
+bool ProfileLock(CCriticalSection& cs, const std::string& strName)
+{
+    std::lock_guard<std::mutex> lock(cs_lockProfiles);
+    if (cs.profile.load())
+        return false;
+    CLockProfile* profile = new CLockProfile(strName);
+    vLockProfiles.push_back(profile);
+    cs.profile.store(profile, std::memory_order_release);
+    return true;
+}
+
+void UnprofileLock(CCriticalSection& cs)
+{
+    std::lock_guard<std::mutex> lock(cs_lockProfiles);
+    CLockProfile* profile = cs.profile.exchange(nullptr);
+    if (!profile)
+        return;
+    vLockProfiles.erase(std::find(vLockProfiles.begin(), vLockProfiles.end(), profile));
+    delete profile;
+}
+
+std::vector<CLockProfileStats> GetLockProfiles()
+{
+    std::lock_guard<std::mutex> lock(cs_lockProfiles);
+    std::vector<CLockProfileStats> ret;
+    for (const CLockProfile* profile : vLockProfiles) {
+        // A site in a header gets an entry for each copy of its __FILE__ string
+        std::map<std::pair<std::string, int>, CLockSiteStats> mapSites;
+        for (size_t i = 0; i <= LOCK_PROFILE_SITES; i++) {
+            const CLockSite& site = i < LOCK_PROFILE_SITES ? profile->sites[i] : profile->others;
+            const char* pszFile = i < LOCK_PROFILE_SITES ? site.pszFile.load(std::memory_order_acquire) : "other";
+            if (pszFile == nullptr || site.nAcquired.load(std::memory_order_relaxed) == 0)
+                continue;
+            CLockSiteStats& stats = mapSites.emplace(std::make_pair(std::string(pszFile), site.nLine), CLockSiteStats()).first->second;
+            stats.strName = site.pszName ? site.pszName : "";
+            stats.strFile = pszFile;
+            stats.nLine = site.nLine;
+            stats.nAcquired += site.nAcquired.load(std::memory_order_relaxed);
+            stats.nContended += site.nContended.load(std::memory_order_relaxed);
+            stats.nWaitMicros += site.nWaitMicros.load(std::memory_order_relaxed);
+            stats.nMaxWaitMicros = std::max(stats.nMaxWaitMicros, site.nMaxWaitMicros.load(std::memory_order_relaxed));
+            stats.nHoldMicros += site.nHoldMicros.load(std::memory_order_relaxed);
+            stats.nMaxHoldMicros = std::max(stats.nMaxHoldMicros, site.nMaxHoldMicros.load(std::memory_order_relaxed));
+        }
+        ret.emplace_back();
+        ret.back().strName = profile->strName;
+        for (auto& site : mapSites)
+            ret.back().vSites.push_back(std::move(site.second));
+    }
+    return ret;
+}
+
+void GetThreadLockTimes(int64_t& nWaitMicros, int64_t& nHoldMicros)
+{
+#ifdef HAVE_THREAD_LOCAL
+    nWaitMicros = nThreadLockWaitMicros;
+    nHoldMicros = nThreadLockHoldMicros;
+#else
+    nWaitMicros = 0;
+    nHoldMicros = 0;
+#endif
+}
@@ -8,9 +8,13 @@
 
 #include <threadsafety.h>
 
+#include <atomic>
 #include <condition_variable>
+#include <stdint.h>
+#include <string>
 #include <thread>
 #include <mutex>
+#include <vector>
 
 
 ////////////////////////////////////////////////
@@ -87,6 +91,8 @@ void static inline DeleteLock(void* cs) {}
 #define AssertLockHeld(cs) AssertLockHeldInternal(#cs, __FILE__, __LINE__, &cs)
 #define AssertLockNotHeld(cs) AssertLockNotHeldInternal(#cs, __FILE__, __LINE__, &cs)
 
+class CLockProfile;
+
 /**
  * Wrapped mutex: supports recursive locking, but no waiting
  * TODO: We should move away from using the recursive lock by default.
@@ -97,8 +103,69 @@ public:
     ~CCriticalSection() {
         DeleteLock((void*)this);
     }
+
+    //! Set by ProfileLock, for the few locks worth the time of profiling
+    std::atomic<CLockProfile*> profile{nullptr};
 };
 
+//
+// Lock profiling: unlike DEBUG_LOCKORDER this is built in and cheap enough
+// to leave on. Waits for and holds of a profiled lock are added up per
+// LOCK site, with the statistics only written by the thread holding the
+// lock. Uncontended locks only read the clock when they are taken and
+// released.
+//
+
+static const bool DEFAULT_LOCK_PROFILE = true;
+
+/** Waits for and holds of a profiled lock at one site */
+struct CLockSiteStats
+{
+    //! The locked expression, like "::cs_main" or "pool.cs"
+    std::string strName;
+    std::string strFile;
+    int nLine;
+    uint64_t nAcquired;
+    //! Times the lock was held by another thread when it was taken here
+    uint64_t nContended;
+    int64_t nWaitMicros;
+    int64_t nMaxWaitMicros;
+    int64_t nHoldMicros;
+    int64_t nMaxHoldMicros;
+};
+
+struct CLockProfileStats
+{
+    std::string strName;
+    std::vector<CLockSiteStats> vSites;
+};
+
+/** Profile the waits for and holds of cs under the given name. Returns false if it is profiled already. */
+bool ProfileLock(CCriticalSection& cs, const std::string& strName);
+/** Stop profiling cs and drop its statistics, before a lock that is not global goes away. No thread may use cs meanwhile. */
+void UnprofileLock(CCriticalSection& cs);
+/** The statistics of all profiled locks */
+std::vector<CLockProfileStats> GetLockProfiles();
+/** Time the calling thread waited for and held profiled locks, since it started */
+void GetThreadLockTimes(int64_t& nWaitMicros, int64_t& nHoldMicros);
+
+int64_t LockProfileTime();
+/** Called by the thread that took a profiled lock, nWaitMicros is -1 if the lock was free */
+void LockProfileAcquired(CLockProfile* profile, const char* pszName, const char* pszFile, int nLine, int64_t nWaitMicros);
+/** Called by the thread holding a profiled lock before it releases it */
+void LockProfileReleased(CLockProfile* profile);
+
+/** Take a profiled lock, returning how long it waited for it or -1 if it did not have to */
+template <typename Lockable>
+int64_t LockTimingWait(Lockable& lockable)
+{
+    if (lockable.try_lock())
+        return -1;
+    const int64_t nStart = LockProfileTime();
+    lockable.lock();
+    return LockProfileTime() - nStart;
+}
+
 /** Wrapped mutex: supports waiting but not recursive locking */
 typedef AnnotatedMixin<std::mutex> CWaitableCriticalSection;
 
@@ -121,6 +188,12 @@ private:
     void Enter(const char* pszName, const char* pszFile, int nLine)
     {
         EnterCritical(pszName, pszFile, nLine, (void*)(lock.mutex()));
+        CLockProfile* profile = lock.mutex()->profile.load(std::memory_order_acquire);
+        if (profile) {
+            const int64_t nWaitMicros = LockTimingWait(lock);
+            LockProfileAcquired(profile, pszName, pszFile, nLine, nWaitMicros);
+            return;
+        }
 #ifdef DEBUG_LOCKCONTENTION
         if (!lock.try_lock()) {
             PrintLockContention(pszName, pszFile, nLine);
@@ -135,9 +208,14 @@ private:
     {
         EnterCritical(pszName, pszFile, nLine, (void*)(lock.mutex()), true);
         lock.try_lock();
-        if (!lock.owns_lock())
+        if (!lock.owns_lock()) {
             LeaveCritical();
-        return lock.owns_lock();
+            return false;
+        }
+        CLockProfile* profile = lock.mutex()->profile.load(std::memory_order_acquire);
+        if (profile)
+            LockProfileAcquired(profile, pszName, pszFile, nLine, -1);
+        return true;
     }
 
 public:
@@ -162,8 +240,12 @@ public:
 
     ~CCriticalBlock() UNLOCK_FUNCTION()
     {
-        if (lock.owns_lock())
+        if (lock.owns_lock()) {
+            CLockProfile* profile = lock.mutex()->profile.load(std::memory_order_acquire);
+            if (profile)
+                LockProfileReleased(profile);
             LeaveCritical();
+        }
     }
 
     operator bool()
@@ -179,16 +261,30 @@ public:
 #define LOCK2(cs1, cs2) CCriticalBlock criticalblock1(cs1, #cs1, __FILE__, __LINE__), criticalblock2(cs2, #cs2, __FILE__, __LINE__)
 #define TRY_LOCK(cs, name) CCriticalBlock name(cs, #cs, __FILE__, __LINE__, true)
 
-#define ENTER_CRITICAL_SECTION(cs)                            \
-    {                                                         \
-        EnterCritical(#cs, __FILE__, __LINE__, (void*)(&cs)); \
-        (cs).lock();                                          \
+/** Lock and unlock for ENTER_CRITICAL_SECTION and LEAVE_CRITICAL_SECTION, profiling the locks that are */
+template <typename MutexType>
+void EnterCriticalSectionLock(MutexType& cs, const char* pszName, const char* pszFile, int nLine)
+{
+    cs.lock();
+}
+void EnterCriticalSectionLock(CCriticalSection& cs, const char* pszName, const char* pszFile, int nLine);
+template <typename MutexType>
+void LeaveCriticalSectionLock(MutexType& cs)
+{
+    cs.unlock();
+}
+void LeaveCriticalSectionLock(CCriticalSection& cs);
+
+#define ENTER_CRITICAL_SECTION(cs)                                    \
+    {                                                                 \
+        EnterCritical(#cs, __FILE__, __LINE__, (void*)(&cs));         \
+        EnterCriticalSectionLock(cs, #cs, __FILE__, __LINE__);        \
     }
 
-#define LEAVE_CRITICAL_SECTION(cs) \
-    {                              \
-        (cs).unlock();             \
-        LeaveCritical();           \
+#define LEAVE_CRITICAL_SECTION(cs)    \
+    {                                 \
+        LeaveCriticalSectionLock(cs); \
+        LeaveCritical();              \
     }
 
 class CSemaphore
@@ -0,0 +1,155 @@
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <consensus/validation.h>
+#include <index/addressindex.h>
+#include <index/spentindex.h>
+#include <script/sign.h>
+#include <script/standard.h>
+#include <test/test_bitcoin.h>
+#include <utiltime.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+template <typename Index>
+static void WaitForIndexSync(Index& index)
+{
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(addressindex_sync_and_rewind, TestChain100Setup)
+{
+    AddressIndex addressindex(1 << 20, true);
+    SpentIndex spentindex(1 << 20, true);
+
+    // The coinbases of TestChain100Setup pay to coinbaseKey with P2PK, which
+    // is indexed under the key's hash.
+    const CScript coinbase_script = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    const uint160 coinbase_hash = coinbaseKey.GetPubKey().GetID();
+    uint8_t type;
+    uint160 hash;
+    BOOST_CHECK(ScriptToIndexKey(coinbase_script, type, hash));
+    BOOST_CHECK_EQUAL(type, ADDRESS_TYPE_PUBKEYHASH);
+    BOOST_CHECK(hash == coinbase_hash);
+
+    CAmount coinbase_total = 0;
+    size_t coinbase_outputs = 0;
+    for (const auto& txn : coinbaseTxns) {
+        for (const auto& out : txn.vout) {
+            if (out.scriptPubKey == coinbase_script) {
+                coinbase_total += out.nValue;
+                coinbase_outputs++;
+            }
+        }
+    }
+
+    addressindex.Start();
+    spentindex.Start();
+    WaitForIndexSync(addressindex);
+    WaitForIndexSync(spentindex);
+    BOOST_CHECK_EQUAL(addressindex.GetBestHeight(), chainActive.Height());
+
+    CAmount balance, received;
+    BOOST_CHECK(addressindex.GetBalance(ADDRESS_TYPE_PUBKEYHASH, coinbase_hash, balance, received));
+    BOOST_CHECK_EQUAL(balance, coinbase_total);
+    BOOST_CHECK_EQUAL(received, coinbase_total);
+
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> outputs;
+    BOOST_CHECK(addressindex.FindUnspentOutputs(ADDRESS_TYPE_PUBKEYHASH, coinbase_hash, MAX_ADDRESS_QUERY_LIMIT, outputs));
+    BOOST_CHECK_EQUAL(outputs.size(), coinbase_outputs);
+
+    // Pagination stops the scan early
+    outputs.clear();
+    BOOST_CHECK(addressindex.FindUnspentOutputs(ADDRESS_TYPE_PUBKEYHASH, coinbase_hash, 10, outputs));
+    BOOST_CHECK_EQUAL(outputs.size(), 10U);
+
+    std::vector<std::pair<int, uint256>> txids;
+    BOOST_CHECK(addressindex.FindTxids(ADDRESS_TYPE_PUBKEYHASH, coinbase_hash, 0, 0, MAX_ADDRESS_QUERY_LIMIT, txids));
+    BOOST_CHECK_EQUAL(txids.size(), coinbaseTxns.size());
+    BOOST_CHECK(txids.front().second == coinbaseTxns.front().GetHash());
+    BOOST_CHECK(txids.back().second == coinbaseTxns.back().GetHash());
+
+    txids.clear();
+    BOOST_CHECK(addressindex.FindTxids(ADDRESS_TYPE_PUBKEYHASH, coinbase_hash, 10, 19, MAX_ADDRESS_QUERY_LIMIT, txids));
+    BOOST_CHECK_EQUAL(txids.size(), 10U);
+    BOOST_CHECK_EQUAL(txids.front().first, 10);
+
+    // Spend the first coinbase output to a new P2PKH address
+    CKey key;
+    key.MakeNewKey(true);
+    const uint160 dest_hash = key.GetPubKey().GetID();
+    const CTxOut& prevout = coinbaseTxns[0].vout[0];
+    BOOST_REQUIRE(prevout.scriptPubKey == coinbase_script);
+
+    CMutableTransaction spend;
+    spend.nVersion = 1;
+    spend.vin.resize(1);
+    spend.vin[0].prevout = COutPoint(coinbaseTxns[0].GetHash(), 0);
+    spend.vout.resize(1);
+    spend.vout[0].nValue = prevout.nValue - CENT;
+    spend.vout[0].scriptPubKey = GetScriptForDestination(CKeyID(dest_hash));
+    std::vector<unsigned char> sig;
+    uint256 sighash = SignatureHash(coinbase_script, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(coinbaseKey.Sign(sighash, sig));
+    sig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << sig;
+
+    const CBlock block = CreateAndProcessBlock({spend}, coinbase_script);
+    BOOST_REQUIRE(chainActive.Tip()->GetBlockHash() == block.GetHash());
+    BOOST_CHECK(addressindex.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(spentindex.BlockUntilSyncedToCurrentChain());
+
+    CSpentIndexValue spent;
+    BOOST_CHECK(spentindex.FindSpent(CSpentIndexKey(coinbaseTxns[0].GetHash(), 0), spent));
+    BOOST_CHECK(spent.txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(spent.nInputIndex, 0U);
+    BOOST_CHECK_EQUAL(spent.nHeight, chainActive.Height());
+    BOOST_CHECK_EQUAL(spent.nValue, prevout.nValue);
+    BOOST_CHECK(spent.addressHash == coinbase_hash);
+
+    BOOST_CHECK(addressindex.GetBalance(ADDRESS_TYPE_PUBKEYHASH, dest_hash, balance, received));
+    BOOST_CHECK_EQUAL(balance, prevout.nValue - CENT);
+    outputs.clear();
+    BOOST_CHECK(addressindex.FindUnspentOutputs(ADDRESS_TYPE_PUBKEYHASH, dest_hash, MAX_ADDRESS_QUERY_LIMIT, outputs));
+    BOOST_REQUIRE_EQUAL(outputs.size(), 1U);
+    BOOST_CHECK(outputs[0].first.txhash == spend.GetHash());
+
+    // Replace the block with one that does not contain the spend; the
+    // indexes rewind the stale block before indexing its replacement.
+    {
+        CValidationState state;
+        BOOST_CHECK(InvalidateBlock(state, Params(), chainActive.Tip()));
+    }
+    CreateAndProcessBlock({}, GetScriptForDestination(CKeyID(dest_hash)));
+    BOOST_CHECK(addressindex.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(spentindex.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK_EQUAL(addressindex.GetBestHeight(), chainActive.Height());
+
+    BOOST_CHECK(!spentindex.FindSpent(CSpentIndexKey(coinbaseTxns[0].GetHash(), 0), spent));
+    outputs.clear();
+    BOOST_CHECK(addressindex.FindUnspentOutputs(ADDRESS_TYPE_PUBKEYHASH, dest_hash, MAX_ADDRESS_QUERY_LIMIT, outputs));
+    for (const auto& output : outputs) {
+        BOOST_CHECK(output.first.txhash != spend.GetHash());
+    }
+    BOOST_CHECK(addressindex.GetBalance(ADDRESS_TYPE_PUBKEYHASH, coinbase_hash, balance, received));
+    BOOST_CHECK_EQUAL(balance, coinbase_total);
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    addressindex.Stop();
+    spentindex.Stop();
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
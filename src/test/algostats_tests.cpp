@@ -0,0 +1,111 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <algostats.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <random.h>
+#include <test/test_bitcoin.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(algostats_tests, BasicTestingSetup)
+
+static const uint8_t TEST_ALGOS[] = {ALGO_SHA256D, ALGO_SCRYPT, ALGO_X11, ALGO_LYRA2REV3};
+
+/** A branch of block index entries, starting on top of pindexFork (or at genesis). */
+struct TestBranch
+{
+    std::vector<uint256> vHashes;
+    std::vector<CBlockIndex> vBlocks;
+
+    TestBranch(const CBlockIndex* pindexFork, size_t nBlocks, uint32_t nTimeStart) : vHashes(nBlocks), vBlocks(nBlocks)
+    {
+        const unsigned int vBits[] = {0x1d00ffff, 0x1c7fffff, 0x1c0fffff};
+        int64_t nTime = nTimeStart;
+        for (size_t i = 0; i < nBlocks; i++) {
+            CBlockIndex& index = vBlocks[i];
+            index.pprev = i ? &vBlocks[i - 1] : const_cast<CBlockIndex*>(pindexFork);
+            index.nHeight = index.pprev ? index.pprev->nHeight + 1 : 0;
+            CBlockHeader header;
+            header.SetAlgo(TEST_ALGOS[InsecureRandRange(4)]);
+            index.nVersion = header.nVersion;
+            // Stretches of equal nBits per algo with retargets in between,
+            // and times that sometimes go back, to have equal and reversed ones
+            const CBlockIndex* pindexAlgo = GetLastBlockIndexForAlgo(index.pprev, index.GetAlgo(), Params().GetConsensus());
+            index.nBits = (pindexAlgo && InsecureRandRange(4)) ? pindexAlgo->nBits : vBits[InsecureRandRange(3)];
+            nTime += InsecureRandRange(4) ? (int64_t)InsecureRandRange(240) : -(int64_t)InsecureRandRange(60);
+            index.nTime = nTime;
+            vHashes[i] = InsecureRand256();
+            index.phashBlock = &vHashes[i];
+        }
+    }
+
+    const CBlockIndex* Tip() const { return &vBlocks.back(); }
+};
+
+static void CheckStats(CAlgoStats& stats, const CBlockIndex* pindexTip)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    const CAlgoStatsSnapshot snapshot = stats.GetSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.nHeight, pindexTip->nHeight);
+    BOOST_CHECK(snapshot.hashTip == pindexTip->GetBlockHash());
+    BOOST_CHECK_EQUAL(snapshot.nTipAlgo, pindexTip->GetAlgo());
+    for (uint8_t i = 0; i < NUM_ALGOS; i++) {
+        const CBlockIndex* pindexAlgo = GetLastBlockIndexForAlgo(pindexTip, i, params);
+        const CAlgoChainStats& algo = snapshot.algos[i];
+        BOOST_CHECK_EQUAL(algo.nLastBlock, pindexAlgo ? pindexAlgo->nHeight : -1);
+        BOOST_CHECK_EQUAL(algo.nBits, pindexAlgo ? pindexAlgo->nBits : params.aPOWAlgos[i].GetArithPowLimit().GetCompact());
+        const double dHashrate = pindexTip->nHeight ? CalculateAlgoHashrate(*pindexTip, i, std::min(ALGO_STATS_HASHRATE_LOOKUP, pindexTip->nHeight), params) : 0;
+        BOOST_CHECK_EQUAL(algo.dNetworkHashPS, dHashrate);
+        BOOST_CHECK_EQUAL(algo.nLastDiffRet, CalculateDiffRetargetingBlock(pindexTip, RETARGETING_LAST, i, params));
+        BOOST_CHECK_EQUAL(algo.nNextDiffRet, CalculateDiffRetargetingBlock(pindexTip, RETARGETING_NEXT, i, params));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(algostats_follow_tip)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    CAlgoStats stats;
+
+    // Start before the first hardfork, when only SHA256D blocks count, and
+    // cross both hardforks while the statistics follow the tip block by block.
+    TestBranch early(nullptr, 100, params.Hardfork1.GetActivationTime() - 100 * 60);
+    TestBranch middle(early.Tip(), 100, params.Hardfork2.GetActivationTime() - 100 * 60);
+    TestBranch late(middle.Tip(), 100, params.Hardfork2.GetActivationTime() + 100 * 60);
+    for (const TestBranch* branch : {&early, &middle, &late}) {
+        for (const CBlockIndex& index : branch->vBlocks) {
+            stats.UpdatedBlockTip(&index, false);
+            CheckStats(stats, &index);
+        }
+    }
+
+    // Only read every few blocks
+    TestBranch next(late.Tip(), 50, late.Tip()->nTime);
+    for (size_t i = 0; i < next.vBlocks.size(); i++) {
+        stats.UpdatedBlockTip(&next.vBlocks[i], false);
+        if (i % 7 == 6)
+            CheckStats(stats, &next.vBlocks[i]);
+    }
+    CheckStats(stats, next.Tip());
+
+    // A reorg, a disconnected tip and blocks connected during initial block download
+    TestBranch fork(&late.vBlocks[80], 40, late.vBlocks[80].nTime);
+    stats.UpdatedBlockTip(fork.Tip(), false);
+    CheckStats(stats, fork.Tip());
+    stats.UpdatedBlockTip(fork.Tip()->pprev, false);
+    CheckStats(stats, fork.Tip()->pprev);
+    stats.UpdatedBlockTip(fork.Tip(), true);
+    CheckStats(stats, fork.Tip());
+
+    stats.NotifyHeaderTip(next.Tip());
+    BOOST_CHECK_EQUAL(stats.GetSnapshot().nHeaders, next.Tip()->nHeight);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,9 +2,11 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <auxpow.h>
 #include <blockencodings.h>
 #include <consensus/merkle.h>
 #include <chainparams.h>
+#include <hash.h>
 #include <random.h>
 
 #include <test/test_bitcoin.h>
@@ -317,6 +319,67 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     }
 }
 
+// Round-trip a block through compact block relay with one transaction
+// missing from the mempool, as the getblocktxn path would.
+static void CheckMissingTxRoundTrip(const CBlock& block)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    pool.addUnchecked(block.vtx[2]->GetHash(), entry.FromTx(*block.vtx[2]));
+
+    CBlockHeaderAndShortTxIDs shortIDs(block, true);
+
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << shortIDs;
+
+    CBlockHeaderAndShortTxIDs shortIDs2;
+    stream >> shortIDs2;
+    BOOST_CHECK(stream.empty());
+    BOOST_CHECK_EQUAL(shortIDs2.header.GetHash().ToString(), block.GetHash().ToString());
+
+    PartiallyDownloadedBlock partialBlock(&pool);
+    BOOST_CHECK(partialBlock.InitData(shortIDs2, extra_txn) == READ_STATUS_OK);
+    BOOST_CHECK( partialBlock.IsTxAvailable(0));
+    BOOST_CHECK(!partialBlock.IsTxAvailable(1));
+    BOOST_CHECK( partialBlock.IsTxAvailable(2));
+
+    CBlock block2;
+    BOOST_CHECK(partialBlock.FillBlock(block2, {block.vtx[1]}) == READ_STATUS_OK);
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+    BOOST_CHECK_EQUAL(block.IsAuxpow(), block2.IsAuxpow());
+    BOOST_CHECK(block.nSolution == block2.nSolution);
+    BOOST_CHECK(block.nBigNonce == block2.nBigNonce);
+    if (block.IsAuxpow()) {
+        BOOST_CHECK(block2.auxpow);
+        BOOST_CHECK_EQUAL(SerializeHash(*block.auxpow).ToString(), SerializeHash(*block2.auxpow).ToString());
+    }
+    bool mutated;
+    BOOST_CHECK_EQUAL(block.hashMerkleRoot.ToString(), BlockMerkleRoot(block2, &mutated).ToString());
+    BOOST_CHECK(!mutated);
+}
+
+BOOST_AUTO_TEST_CASE(AuxpowRoundTripTest)
+{
+    CBlock block(BuildBlockTestCase());
+    CAuxPow::initAuxPow(block, CURRENT_AUXPOW_VERSION);
+    BOOST_CHECK(block.IsAuxpow());
+    CheckMissingTxRoundTrip(block);
+}
+
+BOOST_AUTO_TEST_CASE(EquihashRoundTripTest)
+{
+    CBlock block(BuildBlockTestCase());
+    block.nVersion = 0;
+    block.SetAlgo(ALGO_EQUIHASH);
+    block.hashReserved = InsecureRand256();
+    block.nBigNonce = InsecureRand256();
+    block.nSolution.resize(1344);
+    for (unsigned char& c : block.nSolution)
+        c = InsecureRandBits(8);
+    BOOST_CHECK(IsEquihashBasedAlgo(block.GetAlgo()));
+    CheckMissingTxRoundTrip(block);
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = InsecureRand256();
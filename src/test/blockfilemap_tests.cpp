@@ -0,0 +1,164 @@
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockfilemap.h>
+#include <chainparams.h>
+#include <consensus/merkle.h>
+#include <pow.h>
+#include <streams.h>
+#include <validation.h>
+
+#include <test/test_bitcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+struct BlockFileMapTestingSetup : public TestingSetup {
+    BlockFileMapTestingSetup() : TestingSetup(CBaseChainParams::REGTEST) {}
+};
+
+BOOST_FIXTURE_TEST_SUITE(blockfilemap_tests, BlockFileMapTestingSetup)
+
+// Far away from the block files written by the test setup itself
+static const int TEST_BLOCK_FILE = 900;
+
+static CBlock BuildTestBlock(int nOutputs)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig = CScript() << OP_1 << nOutputs;
+    tx.vout.resize(nOutputs);
+    for (int i = 0; i < nOutputs; i++)
+        tx.vout[i].nValue = i;
+
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(tx));
+    block.nVersion = 42;
+    block.hashPrevBlock = InsecureRand256();
+    block.nBits = 0x207fffff;
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    while (!CheckProofOfWork(block.GetHash(), block.nBits, Params().GetConsensus(), ALGO_SHA256D)) ++block.nNonce;
+    return block;
+}
+
+// Append block to the test block file the way WriteBlockToDisk lays it out
+static CDiskBlockPos AppendBlock(const CBlock& block)
+{
+    CDiskBlockPos pos(TEST_BLOCK_FILE, 0);
+    fs::create_directories(GetBlockPosFilename(pos, "blk").parent_path());
+    FILE* file = fsbridge::fopen(GetBlockPosFilename(pos, "blk"), "ab");
+    BOOST_REQUIRE(file);
+    CAutoFile fileout(file, SER_DISK, CLIENT_VERSION);
+    fseek(fileout.Get(), 0, SEEK_END);
+    fileout << FLATDATA(Params().MessageStart()) << (unsigned int)GetSerializeSize(fileout, block);
+    pos.nPos = ftell(fileout.Get());
+    fileout << block;
+    return pos;
+}
+
+static std::vector<unsigned char> Serialize(const CBlock& block)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << block;
+    return std::vector<unsigned char>(ss.begin(), ss.end());
+}
+
+static void CheckRead(const CBlock& block, const CDiskBlockPos& pos)
+{
+    CBlock block2;
+    BOOST_CHECK(ReadBlockFromDisk(block2, pos, Params().GetConsensus()));
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+
+    std::vector<unsigned char> vchBlock;
+    BOOST_CHECK(ReadRawBlockFromDisk(vchBlock, pos, Params().MessageStart()));
+    BOOST_CHECK(vchBlock == Serialize(block));
+
+    // The bytes in the mapping itself, when the file is mapped
+    std::shared_ptr<const CMappedBlockFile> mapping;
+    const unsigned char* pchBlock = nullptr;
+    unsigned int nBlockSize = 0;
+    if (MapRawBlockFromDisk(mapping, pchBlock, nBlockSize, pos, Params().MessageStart())) {
+        BOOST_CHECK(std::vector<unsigned char>(pchBlock, pchBlock + nBlockSize) == vchBlock);
+    } else {
+        BOOST_CHECK(!mapping);
+        BOOST_CHECK_EQUAL(blockFileMapCache.Size(), 0U);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(blockfilemap_read)
+{
+    const CBlock block1 = BuildTestBlock(10);
+    const CBlock block2 = BuildTestBlock(500);
+    const CDiskBlockPos pos1 = AppendBlock(block1);
+
+    blockFileMapCache.Clear();
+    CheckRead(block1, pos1);
+    BOOST_CHECK_EQUAL(blockFileMapCache.Size(), 1U);
+
+    // The file grows past the existing mapping
+    const CDiskBlockPos pos2 = AppendBlock(block2);
+    CheckRead(block2, pos2);
+    CheckRead(block1, pos1);
+    BOOST_CHECK_EQUAL(blockFileMapCache.Size(), 1U);
+
+    // Same results through regular file reads
+    blockFileMapCache.SetMaxFiles(0);
+    CheckRead(block1, pos1);
+    CheckRead(block2, pos2);
+    BOOST_CHECK_EQUAL(blockFileMapCache.Size(), 0U);
+    blockFileMapCache.SetMaxFiles(DEFAULT_BLOCK_MAP_FILES);
+
+    // Wrong network magic is refused
+    std::vector<unsigned char> vchBlock;
+    CMessageHeader::MessageStartChars wrongStart = {0, 1, 2, 3};
+    BOOST_CHECK(!ReadRawBlockFromDisk(vchBlock, pos1, wrongStart));
+    // So is a position without room for the magic and size in front of it
+    BOOST_CHECK(!ReadRawBlockFromDisk(vchBlock, CDiskBlockPos(TEST_BLOCK_FILE, 4), Params().MessageStart()));
+
+    // A mapping handed out stays readable after the cache lets go of it
+    std::shared_ptr<const CMappedBlockFile> mapping;
+    const unsigned char* pchBlock = nullptr;
+    unsigned int nBlockSize = 0;
+    BOOST_CHECK(!MapRawBlockFromDisk(mapping, pchBlock, nBlockSize, pos1, wrongStart));
+    BOOST_CHECK(!mapping);
+#ifndef WIN32
+    BOOST_CHECK(MapRawBlockFromDisk(mapping, pchBlock, nBlockSize, pos2, Params().MessageStart()));
+    blockFileMapCache.Clear();
+    BOOST_CHECK(std::vector<unsigned char>(pchBlock, pchBlock + nBlockSize) == Serialize(block2));
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(blockfilemap_cache)
+{
+    CBlockFileMapCache cache(2);
+    std::vector<fs::path> paths;
+    for (int i = 0; i < 3; i++) {
+        paths.push_back(pathTemp / strprintf("map%d.dat", i));
+        FILE* file = fsbridge::fopen(paths.back(), "wb");
+        BOOST_REQUIRE(file);
+        std::vector<unsigned char> data(100 * (i + 1), i);
+        fwrite(data.data(), 1, data.size(), file);
+        fclose(file);
+    }
+
+    std::shared_ptr<const CMappedBlockFile> mapping0 = cache.Get(0, paths[0], 100);
+    BOOST_REQUIRE(mapping0);
+    BOOST_CHECK_EQUAL(mapping0->size(), 100U);
+    BOOST_CHECK(cache.Get(0, paths[0], 50) == mapping0);
+    BOOST_CHECK(!cache.Get(0, paths[0], 101));
+    BOOST_CHECK(!cache.Get(5, pathTemp / "missing.dat", 0));
+
+    BOOST_CHECK(cache.Get(1, paths[1], 200));
+    BOOST_CHECK(cache.Get(2, paths[2], 300));
+    BOOST_CHECK_EQUAL(cache.Size(), 2U);
+    // A mapping that was evicted stays valid for its holder
+    BOOST_CHECK_EQUAL(mapping0->data()[99], 0);
+
+    cache.Invalidate(2);
+    BOOST_CHECK_EQUAL(cache.Size(), 1U);
+    cache.SetMaxFiles(0);
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+    BOOST_CHECK(!cache.Get(1, paths[1], 0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,130 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <key.h>
+#include <masternodeman.h>
+#include <netbase.h>
+#include <test/test_bitcoin.h>
+#include <utiltime.h>
+#include <version.h>
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(masternodeman_tests, TestingSetup)
+
+static CMasternode MakeTestMasternode(int n)
+{
+    CKey keyCollateral, keyMasternode;
+    keyCollateral.MakeNewKey(true);
+    keyMasternode.MakeNewKey(true);
+    const CService addr = LookupNumeric(strprintf("10.0.0.%d", n).c_str(), 9999);
+    return CMasternode(addr, COutPoint(InsecureRand256(), n), keyCollateral.GetPubKey(), keyMasternode.GetPubKey(), PROTOCOL_VERSION);
+}
+
+/** A snapshot has to show each masternode of the list as it is, in outpoint order */
+static void CheckSnapshot(CMasternodeMan& man, const CMasternodeListSnapshot& snapshot)
+{
+    BOOST_CHECK_EQUAL(snapshot.vMasternodes.size(), (size_t)man.size());
+    for (size_t i = 0; i < snapshot.vMasternodes.size(); i++) {
+        const CMasternodeListEntry& entry = snapshot.vMasternodes[i];
+        if (i > 0)
+            BOOST_CHECK(snapshot.vMasternodes[i - 1].info.outpoint < entry.info.outpoint);
+        CMasternode mn;
+        BOOST_CHECK(man.Get(entry.info.outpoint, mn));
+        BOOST_CHECK(entry.info.addr == mn.addr);
+        BOOST_CHECK(entry.info.pubKeyMasternode == mn.pubKeyMasternode);
+        BOOST_CHECK_EQUAL(entry.info.nActiveState, mn.nActiveState);
+        BOOST_CHECK_EQUAL(entry.nBlockLastPaid, mn.GetLastPaidBlock());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(masternode_list_snapshot)
+{
+    const int64_t nTime = GetTime();
+    SetMockTime(nTime);
+    CMasternodeMan man;
+    for (int i = 0; i < 10; i++) {
+        CMasternode mn = MakeTestMasternode(i);
+        BOOST_CHECK(man.Add(mn));
+    }
+    CMasternodeListSnapshotRef snapshot = man.GetMasternodeListSnapshot();
+    CheckSnapshot(man, *snapshot);
+
+    // Without a change the published snapshot is kept, however old it is
+    SetMockTime(nTime + 60);
+    BOOST_CHECK(man.GetMasternodeListSnapshot() == snapshot);
+
+    // A change is only seen in a newer snapshot, the published one stays as it was
+    CMasternode mn = MakeTestMasternode(10);
+    BOOST_CHECK(man.Add(mn));
+    BOOST_CHECK_EQUAL(snapshot->vMasternodes.size(), 10U);
+    SetMockTime(nTime + 120);
+    CMasternodeListSnapshotRef snapshotNew = man.GetMasternodeListSnapshot();
+    BOOST_CHECK(snapshotNew != snapshot);
+    BOOST_CHECK_EQUAL(snapshotNew->vMasternodes.size(), 11U);
+    CheckSnapshot(man, *snapshotNew);
+
+    SetMockTime(0);
+}
+
+static CMasternodeListEntry MakeTestEntry(const COutPoint& outpoint, int nActiveState)
+{
+    CMasternodeListEntry entry;
+    entry.info.outpoint = outpoint;
+    entry.info.nActiveState = nActiveState;
+    entry.nDaemonVersion = 0;
+    entry.nBlockLastPaid = 0;
+    return entry;
+}
+
+BOOST_AUTO_TEST_CASE(masternode_list_diff)
+{
+    std::vector<COutPoint> vOutpoints;
+    for (int i = 0; i < 6; i++)
+        vOutpoints.emplace_back(InsecureRand256(), i);
+    std::sort(vOutpoints.begin(), vOutpoints.end());
+
+    CMasternodeListSnapshot snapshotOld, snapshotNew;
+    // 0 stays the same, 1 is removed, 2 changes its state, 3 is added, 4 is removed, 5 is added
+    snapshotOld.vMasternodes.push_back(MakeTestEntry(vOutpoints[0], CMasternode::MASTERNODE_ENABLED));
+    snapshotOld.vMasternodes.push_back(MakeTestEntry(vOutpoints[1], CMasternode::MASTERNODE_ENABLED));
+    snapshotOld.vMasternodes.push_back(MakeTestEntry(vOutpoints[2], CMasternode::MASTERNODE_PRE_ENABLED));
+    snapshotOld.vMasternodes.push_back(MakeTestEntry(vOutpoints[4], CMasternode::MASTERNODE_EXPIRED));
+    snapshotNew.vMasternodes.push_back(MakeTestEntry(vOutpoints[0], CMasternode::MASTERNODE_ENABLED));
+    snapshotNew.vMasternodes.push_back(MakeTestEntry(vOutpoints[2], CMasternode::MASTERNODE_ENABLED));
+    snapshotNew.vMasternodes.push_back(MakeTestEntry(vOutpoints[3], CMasternode::MASTERNODE_PRE_ENABLED));
+    snapshotNew.vMasternodes.push_back(MakeTestEntry(vOutpoints[5], CMasternode::MASTERNODE_ENABLED));
+    // Only other last paid blocks are no change
+    snapshotNew.vMasternodes[0].nBlockLastPaid = 100;
+
+    const masternode_list_changes_t vChanges = DiffMasternodeListSnapshots(snapshotOld, snapshotNew);
+    BOOST_CHECK_EQUAL(vChanges.size(), 5U);
+    if (vChanges.size() == 5) {
+        // In outpoint order, removed entries pointing into the old snapshot and the others into the new one
+        BOOST_CHECK(vChanges[0].first == MasternodeListChange::REMOVED);
+        BOOST_CHECK_EQUAL(vChanges[0].second, &snapshotOld.vMasternodes[1]);
+        BOOST_CHECK(vChanges[1].first == MasternodeListChange::STATE);
+        BOOST_CHECK_EQUAL(vChanges[1].second, &snapshotNew.vMasternodes[1]);
+        BOOST_CHECK(vChanges[2].first == MasternodeListChange::ADDED);
+        BOOST_CHECK_EQUAL(vChanges[2].second, &snapshotNew.vMasternodes[2]);
+        BOOST_CHECK(vChanges[3].first == MasternodeListChange::REMOVED);
+        BOOST_CHECK_EQUAL(vChanges[3].second, &snapshotOld.vMasternodes[3]);
+        BOOST_CHECK(vChanges[4].first == MasternodeListChange::ADDED);
+        BOOST_CHECK_EQUAL(vChanges[4].second, &snapshotNew.vMasternodes[3]);
+    }
+
+    // From or to an empty list everything is added or removed, and nothing changes between equal lists
+    CMasternodeListSnapshot snapshotEmpty;
+    for (const auto& change : DiffMasternodeListSnapshots(snapshotEmpty, snapshotNew))
+        BOOST_CHECK(change.first == MasternodeListChange::ADDED);
+    BOOST_CHECK_EQUAL(DiffMasternodeListSnapshots(snapshotEmpty, snapshotNew).size(), snapshotNew.vMasternodes.size());
+    for (const auto& change : DiffMasternodeListSnapshots(snapshotOld, snapshotEmpty))
+        BOOST_CHECK(change.first == MasternodeListChange::REMOVED);
+    BOOST_CHECK_EQUAL(DiffMasternodeListSnapshots(snapshotOld, snapshotEmpty).size(), snapshotOld.vMasternodes.size());
+    BOOST_CHECK(DiffMasternodeListSnapshots(snapshotNew, snapshotNew).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -520,4 +520,52 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     fCheckpointsEnabled = true;
 }
 
+static std::unique_ptr<CBlockTemplate> MakeAuxBlockTemplate(uint8_t nAlgo)
+{
+    std::unique_ptr<CBlockTemplate> pblocktemplate(new CBlockTemplate());
+    pblocktemplate->block.SetAlgo(nAlgo);
+    pblocktemplate->block.SetAuxpowVersion(true);
+    pblocktemplate->block.hashMerkleRoot = InsecureRand256();
+    return pblocktemplate;
+}
+
+BOOST_AUTO_TEST_CASE(AuxBlockTemplateCache_eviction)
+{
+    CAuxBlockTemplateCache cache;
+    const int64_t nNow = 1000000;
+
+    CBlock* pblockSha = cache.Add(MakeAuxBlockTemplate(ALGO_SHA256D), nNow);
+    CBlock* pblockScrypt = cache.Add(MakeAuxBlockTemplate(ALGO_SCRYPT), nNow);
+    BOOST_CHECK(cache.GetCurrent(ALGO_SHA256D) == pblockSha);
+    BOOST_CHECK(cache.GetCurrent(ALGO_SCRYPT) == pblockScrypt);
+    BOOST_CHECK(cache.GetCurrent(ALGO_X11) == nullptr);
+    BOOST_CHECK(cache.Find(pblockSha->GetHash()) == pblockSha);
+
+    // A replaced block can still be submitted until it expires
+    const uint256 hashReplaced = pblockSha->GetHash();
+    CBlock* pblockNew = cache.Add(MakeAuxBlockTemplate(ALGO_SHA256D), nNow);
+    BOOST_CHECK(cache.GetCurrent(ALGO_SHA256D) == pblockNew);
+    BOOST_CHECK(cache.Find(hashReplaced) == pblockSha);
+    cache.Add(MakeAuxBlockTemplate(ALGO_X11), nNow + AUXBLOCK_TEMPLATE_EXPIRY);
+    BOOST_CHECK(cache.Find(hashReplaced) == pblockSha);
+    cache.Add(MakeAuxBlockTemplate(ALGO_X11), nNow + AUXBLOCK_TEMPLATE_EXPIRY + 1);
+    BOOST_CHECK(cache.Find(hashReplaced) == nullptr);
+    BOOST_CHECK(cache.GetCurrent(ALGO_SCRYPT) == pblockScrypt);
+
+    // However often new blocks are requested, the oldest replaced ones are evicted
+    uint256 hashLastReplaced;
+    for (int i = 0; i < 1000; i++) {
+        const uint8_t nAlgo = i % 2 ? ALGO_SHA256D : ALGO_X11;
+        hashLastReplaced = cache.GetCurrent(nAlgo)->GetHash();
+        cache.Add(MakeAuxBlockTemplate(nAlgo), nNow + AUXBLOCK_TEMPLATE_EXPIRY + 1 + i / 10);
+    }
+    BOOST_CHECK_EQUAL(cache.Size(), MAX_AUXBLOCK_TEMPLATES);
+    BOOST_CHECK(cache.Find(hashLastReplaced) != nullptr);
+    BOOST_CHECK(cache.GetCurrent(ALGO_SCRYPT) == pblockScrypt);
+
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+    BOOST_CHECK(cache.GetCurrent(ALGO_SCRYPT) == nullptr);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+// Copyright (c) 2018-2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <msgworkerpool.h>
+#include <net.h>
+
+#include <test/test_bitcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(msgworkerpool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(msgworkerpool_per_peer_order)
+{
+    std::atomic<int> nWakes(0);
+    CMessageWorkerPool pool([&nWakes] { nWakes++; });
+    pool.Start(3);
+    BOOST_CHECK_EQUAL(pool.GetThreadCount(), 3);
+
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr = CAddress(CService(ipv4Addr, 7777), NODE_NETWORK);
+
+    std::vector<std::unique_ptr<CNode>> vNodes;
+    for (NodeId id = 0; id < 5; id++)
+        vNodes.emplace_back(new CNode(id, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", false));
+
+    std::mutex mutex;
+    std::vector<std::vector<int>> vSeen(vNodes.size());
+    const int nPerNode = 200;
+    for (int i = 0; i < nPerNode; i++) {
+        for (size_t n = 0; n < vNodes.size(); n++) {
+            pool.Enqueue(vNodes[n].get(), i % MSG_WORKER_CATEGORY_MAX, [&mutex, &vSeen, n, i] {
+                std::lock_guard<std::mutex> lock(mutex);
+                vSeen[n].push_back(i);
+            });
+        }
+    }
+
+    // Wait until every peer has been drained
+    for (int nTries = 0; nTries < 1000; nTries++) {
+        bool fDone = true;
+        for (const auto& pnode : vNodes)
+            fDone &= pnode->nPendingWorkerMsgs == 0;
+        if (fDone)
+            break;
+        MilliSleep(10);
+    }
+    pool.Interrupt();
+    pool.Stop();
+
+    for (size_t n = 0; n < vNodes.size(); n++) {
+        BOOST_CHECK_EQUAL(vNodes[n]->nPendingWorkerMsgs, 0);
+        BOOST_CHECK_EQUAL(vNodes[n]->GetRefCount(), 0);
+        BOOST_REQUIRE_EQUAL(vSeen[n].size(), (size_t)nPerNode);
+        for (int i = 0; i < nPerNode; i++)
+            BOOST_CHECK_EQUAL(vSeen[n][i], i);
+    }
+    BOOST_CHECK(nWakes >= (int)vNodes.size());
+
+    std::vector<CMessageWorkerCategoryStats> vStats;
+    pool.GetStats(vStats);
+    BOOST_REQUIRE_EQUAL(vStats.size(), (size_t)MSG_WORKER_CATEGORY_MAX);
+    uint64_t nProcessed = 0;
+    for (const CMessageWorkerCategoryStats& stats : vStats) {
+        BOOST_CHECK_EQUAL(stats.nQueued, 0U);
+        nProcessed += stats.nProcessed;
+    }
+    BOOST_CHECK_EQUAL(nProcessed, (uint64_t)(nPerNode * vNodes.size()));
+}
+
+BOOST_AUTO_TEST_CASE(msgworkerpool_disabled)
+{
+    CMessageWorkerPool pool([] {});
+    pool.Start(0);
+    BOOST_CHECK(!pool.IsRunning());
+    pool.Interrupt();
+    pool.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,378 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/algos/argon2/argon2.h>
+#include <crypto/algos/argon2/hashargon.h>
+#include <crypto/algos/hashlib/hashchain.h>
+#include <crypto/algos/hashlib/multihash.h>
+#include <crypto/algos/neoscrypt/neoscrypt.h>
+#include <crypto/algos/scrypt/scrypt.h>
+#include <globaltoken/multihasher.h>
+#include <primitives/mining_block.h>
+#include <random.h>
+#include <streams.h>
+#include <test/test_bitcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(multihasher_tests, BasicTestingSetup)
+
+static CDefaultBlockHeader RandomHeader()
+{
+    CDefaultBlockHeader header;
+    header.nVersion = InsecureRand32();
+    header.hashPrevBlock = InsecureRand256();
+    header.hashMerkleRoot = InsecureRand256();
+    header.nTime = InsecureRand32();
+    header.nBits = InsecureRand32();
+    header.nNonce = InsecureRand32();
+    return header;
+}
+
+BOOST_AUTO_TEST_CASE(midstate_matches_full_hash)
+{
+    int nSupported = 0;
+    for (int algo = 0; algo < NUM_ALGOS; algo++) {
+        if (!CMultihashMidstate::IsSupported(algo)) continue;
+        nSupported++;
+
+        CDefaultBlockHeader header = RandomHeader();
+        const CMultihashMidstate midstate = SerializeMultiAlgoMidstate(header, algo);
+        BOOST_CHECK_EQUAL(midstate.GetAlgo(), algo);
+        BOOST_CHECK(midstate.GetHash(header.nNonce) == header.GetPoWHash(algo, SER_GETHASH, PROTOCOL_VERSION));
+
+        for (int i = 0; i < 8; i++) {
+            header.nNonce = InsecureRand32();
+            BOOST_CHECK(midstate.GetHash(header.nNonce) == header.GetPoWHash(algo, SER_GETHASH, PROTOCOL_VERSION));
+        }
+        for (int i = 0; i < 8; i++) {
+            header.nTime = InsecureRand32();
+            header.nNonce = InsecureRand32();
+            BOOST_CHECK(midstate.GetHash(header.nTime, header.nNonce) == header.GetPoWHash(algo, SER_GETHASH, PROTOCOL_VERSION));
+        }
+    }
+    BOOST_CHECK(nSupported > 0);
+    BOOST_CHECK(CMultihashMidstate::IsSupported(ALGO_SHA256D));
+    BOOST_CHECK(!CMultihashMidstate::IsSupported(ALGO_SCRYPT));
+    BOOST_CHECK(!CMultihashMidstate::IsSupported(ALGO_X16R));
+}
+
+BOOST_AUTO_TEST_CASE(midstate_state)
+{
+    const CDefaultBlockHeader header = RandomHeader();
+    CDefaultBlockHeader other = header;
+    other.nTime++;
+    other.nNonce++;
+
+    // Only the prefix goes into the state
+    const std::vector<unsigned char> vchSHA256 = SerializeMultiAlgoMidstate(header, ALGO_SHA256D).GetState();
+    BOOST_CHECK_EQUAL(vchSHA256.size(), 32U);
+    BOOST_CHECK(vchSHA256 == SerializeMultiAlgoMidstate(other, ALGO_SHA256D).GetState());
+    other.hashPrevBlock = InsecureRand256();
+    BOOST_CHECK(vchSHA256 != SerializeMultiAlgoMidstate(other, ALGO_SHA256D).GetState());
+
+    BOOST_CHECK_EQUAL(SerializeMultiAlgoMidstate(header, ALGO_QUBIT).GetState().size(), 160U);
+    // Blake-512 has not compressed a block after 64 bytes
+    BOOST_CHECK(SerializeMultiAlgoMidstate(header, ALGO_X11).GetState().empty());
+}
+
+BOOST_AUTO_TEST_CASE(hashchain_matches_reference)
+{
+    for (int i = 0; i < 4; i++) {
+        const std::vector<unsigned char> data = insecure_rand_ctx.randbytes(80 + i * 13);
+        const unsigned char* pbegin = data.data();
+        const unsigned char* pend = data.data() + data.size();
+
+        BOOST_CHECK(HASHCHAIN_X11.Hash(pbegin, data.size()) == HashX11(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_X12.Hash(pbegin, data.size()) == HashX12(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_X13.Hash(pbegin, data.size()) == HashX13(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_X14.Hash(pbegin, data.size()) == HashX14(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_X15.Hash(pbegin, data.size()) == HashX15(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_X17.Hash(pbegin, data.size()) == HashX17(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_C11.Hash(pbegin, data.size()) == HashC11(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_NIST5.Hash(pbegin, data.size()) == NIST5(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_QUBIT.Hash(pbegin, data.size()) == HashQubit(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_GROESTL.Hash(pbegin, data.size()) == HashGroestl(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_SKEIN.Hash(pbegin, data.size()) == HashSkein(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_PHI1612.Hash(pbegin, data.size()) == Phi1612(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_SKUNKHASH.Hash(pbegin, data.size()) == SkunkHash5(pbegin, pend));
+        BOOST_CHECK(HASHCHAIN_TRIBUS.Hash(pbegin, data.size()) == Tribus(pbegin, pend));
+    }
+
+    for (int i = 0; i < 8; i++) {
+        const std::vector<unsigned char> data = insecure_rand_ctx.randbytes(80);
+        const unsigned char* pbegin = data.data();
+        const unsigned char* pend = data.data() + data.size();
+        const uint256 hashPrevBlock = InsecureRand256();
+
+        BOOST_CHECK(GetX16RHashChain(hashPrevBlock).Hash(pbegin, data.size()) == HashX16R(pbegin, pend, hashPrevBlock));
+        BOOST_CHECK(GetX16SHashChain(hashPrevBlock).Hash(pbegin, data.size()) == HashX16s(pbegin, pend, hashPrevBlock));
+        BOOST_CHECK(GetX21SHashChain(hashPrevBlock).Hash(pbegin, data.size()) == HashX21S(pbegin, pend, hashPrevBlock));
+        BOOST_CHECK(GetCPU23RHashChain(hashPrevBlock).Hash(pbegin, data.size()) == HashCPU23R(pbegin, pend, hashPrevBlock));
+    }
+}
+
+/** The Ravencoin genesis header, with another previous block hash if given */
+static CDefaultBlockHeader RavencoinGenesisHeader(int32_t nVersion, uint32_t nTime, uint32_t nNonce, const uint256& hashPrevBlock = uint256())
+{
+    CDefaultBlockHeader header;
+    header.nVersion = nVersion;
+    header.hashPrevBlock = hashPrevBlock;
+    header.hashMerkleRoot = uint256S("28ff00a867739a352523808d301f504bc4547699398d70faf2266a8bae5f3516");
+    header.nTime = nTime;
+    header.nBits = 0x1e00ffff;
+    header.nNonce = nNonce;
+    return header;
+}
+
+BOOST_AUTO_TEST_CASE(hashchain_known_vectors)
+{
+    // The Ravencoin mainnet and testnet genesis blocks, hashed with X16R
+    const CDefaultBlockHeader mainGenesis = RavencoinGenesisHeader(4, 1514999494, 25023712);
+    const CDefaultBlockHeader testGenesis = RavencoinGenesisHeader(2, 1537466400, 15615880);
+    const uint256 hashMainGenesis = uint256S("0000006b444bc2f2ffe627be9d9e7e7a0730000870ef6eb6da46c8eae389df90");
+    const uint256 hashTestGenesis = uint256S("000000ecfc5e6324a079542221d00e10362bdc894d56500c414060eea8a3ad5a");
+    BOOST_CHECK_EQUAL(mainGenesis.GetPoWHash(ALGO_X16R, SER_GETHASH, PROTOCOL_VERSION).GetHex(), hashMainGenesis.GetHex());
+    BOOST_CHECK_EQUAL(testGenesis.GetPoWHash(ALGO_X16R, SER_GETHASH, PROTOCOL_VERSION).GetHex(), hashTestGenesis.GetHex());
+
+    // The genesis header built on either genesis block, so that the order is
+    // not all Blake. Taken from the implementations the chains replaced.
+    struct {
+        uint8_t nAlgo;
+        const char* pszMain;
+        const char* pszTest;
+    } vectors[] = {
+        {ALGO_X16R, "0bf4bc4789d2326544b71918ad45da81e0cbfc445f02584a685ad9003f530a12", "d980b87c6ea0b0b2892851a05b1a388c9e3b7750ec24647bab4ea8b7b6625951"},
+        {ALGO_X16RT, "51e73056d2fa8c47273ed3a415bcc34b3d4e40aaeb1b4699254a8b883dd60c2f", "ae8e9fa5a16a9c5b19409dd4acd1c30c00f52df4047509c1056ca87061a27984"},
+        {ALGO_X16S, "fe6e0057e5d5d353940311ae52a8654dc7f3fa5531d29a669a436540186455bd", "ae98c50734dc19f3a2e9a57257d12347c80f68de5465f27766ddf930d44fa795"},
+        {ALGO_X21S, "73a19e907205955d45085372890bcb42c3287c75f6f4df94b0ba8d88af1823cd", "cb6ece04057629ff10497203bbe5db43eabcefa641146e6dfd90d967be1a529c"},
+        {ALGO_CPU23R, "9643694a907eca24a2073e7910c77ebd48e281793ddbd42a87afa3ba005b0e4e", "db5eae043d7430c1df997bbe9ee872ed5bb0f41050a57ba5e03a5c9f396e041f"},
+    };
+    const CDefaultBlockHeader onMain = RavencoinGenesisHeader(4, 1514999494, 25023712, hashMainGenesis);
+    const CDefaultBlockHeader onTest = RavencoinGenesisHeader(4, 1514999494, 25023712, hashTestGenesis);
+    for (const auto& vector : vectors) {
+        BOOST_CHECK_EQUAL(onMain.GetPoWHash(vector.nAlgo, SER_GETHASH, PROTOCOL_VERSION).GetHex(), vector.pszMain);
+        BOOST_CHECK_EQUAL(onTest.GetPoWHash(vector.nAlgo, SER_GETHASH, PROTOCOL_VERSION).GetHex(), vector.pszTest);
+    }
+}
+
+/** A previous block hash with the given X16S order, by replaying the moves to the front that make it */
+static uint256 X16SPrevBlockForOrder(const unsigned char* order)
+{
+    const std::string strHex = "0123456789abcdef";
+    std::string strOrder = strHex;
+    std::string strHash(64, 'e');
+    for (int i = 0; i < 16; i++) {
+        // The element moved last ends up first
+        const size_t nOffset = strOrder.find(strHex[order[15 - i]]);
+        strHash[48 + i] = strHex[nOffset];
+        strOrder.insert(0, 1, strOrder[nOffset]);
+        strOrder.erase(nOffset + 1, 1);
+    }
+    return uint256S(strHash);
+}
+
+BOOST_AUTO_TEST_CASE(hashchain_stage_sweep)
+{
+    // Rotated orders put every function at every position once. X16RT orders
+    // by the block time, which can not pick an order, but runs X16R chains.
+    const std::string strHex = "0123456789abcdef";
+    CDefaultBlockHeader header = RandomHeader();
+    for (int k = 0; k < 16; k++) {
+        unsigned char order[16];
+        std::string strHash(64, 'e');
+        for (int i = 0; i < 16; i++) {
+            order[i] = (k + i) % 16;
+            strHash[48 + i] = strHex[order[i]];
+        }
+
+        header.hashPrevBlock = uint256S(strHash);
+        const CHashChain chainX16R = GetX16RHashChain(header.hashPrevBlock);
+        for (int i = 0; i < 16; i++)
+            BOOST_CHECK_EQUAL((int)chainX16R.stages[i].nFunc, (int)order[i]);
+        CDataStream ss(SER_GETHASH, PROTOCOL_VERSION);
+        ss << header;
+        const unsigned char* pbegin = (const unsigned char*)ss.data();
+        BOOST_CHECK(header.GetPoWHash(ALGO_X16R, SER_GETHASH, PROTOCOL_VERSION) == HashX16R(pbegin, pbegin + ss.size(), header.hashPrevBlock));
+
+        header.hashPrevBlock = X16SPrevBlockForOrder(order);
+        const CHashChain chainX16S = GetX16SHashChain(header.hashPrevBlock);
+        for (int i = 0; i < 16; i++)
+            BOOST_CHECK_EQUAL((int)chainX16S.stages[i].nFunc, (int)order[i]);
+        ss.clear();
+        ss << header;
+        pbegin = (const unsigned char*)ss.data();
+        BOOST_CHECK(header.GetPoWHash(ALGO_X16S, SER_GETHASH, PROTOCOL_VERSION) == HashX16s(pbegin, pbegin + ss.size(), header.hashPrevBlock));
+        BOOST_CHECK(header.GetPoWHash(ALGO_X21S, SER_GETHASH, PROTOCOL_VERSION) == HashX21S(pbegin, pbegin + ss.size(), header.hashPrevBlock));
+    }
+
+    for (int k = 0; k < 23; k++) {
+        header.hashPrevBlock = InsecureRand256();
+        for (int i = 0; i < 23; i++)
+            *(header.hashPrevBlock.end() - 23 + i) = (k + i) % 23;
+        const CHashChain chain = GetCPU23RHashChain(header.hashPrevBlock);
+        for (int i = 0; i < 23; i++)
+            BOOST_CHECK_EQUAL((int)chain.stages[i].nFunc, (k + i) % 23);
+        CDataStream ss(SER_GETHASH, PROTOCOL_VERSION);
+        ss << header;
+        const unsigned char* pbegin = (const unsigned char*)ss.data();
+        BOOST_CHECK(header.GetPoWHash(ALGO_CPU23R, SER_GETHASH, PROTOCOL_VERSION) == HashCPU23R(pbegin, pbegin + ss.size(), header.hashPrevBlock));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(hashchain_batch)
+{
+    const size_t nLanes = 5;
+    std::vector<std::vector<unsigned char>> vData;
+    std::vector<const unsigned char*> vLanes;
+    for (size_t i = 0; i < nLanes; i++) {
+        vData.push_back(insecure_rand_ctx.randbytes(80));
+        vLanes.push_back(vData.back().data());
+    }
+
+    const CHashChain chains[] = {HASHCHAIN_X17, HASHCHAIN_GROESTL, GetX21SHashChain(InsecureRand256())};
+    for (const CHashChain& chain : chains) {
+        std::vector<uint256> vHash(nLanes);
+        chain.HashBatch(vLanes.data(), 80, vHash.data(), nLanes);
+        for (size_t i = 0; i < nLanes; i++) {
+            BOOST_CHECK(vHash[i] == chain.Hash(vData[i].data(), 80));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(multihash_batch)
+{
+    // More headers than lanes, so the last group is partial
+    std::vector<CDefaultBlockHeader> vHeaders;
+    std::vector<const CDefaultBlockHeader*> vpHeaders;
+    for (size_t i = 0; i < 2 * MULTIHASH_BATCH_LANES + 3; i++)
+        vHeaders.push_back(RandomHeader());
+    for (const CDefaultBlockHeader& header : vHeaders)
+        vpHeaders.push_back(&header);
+
+    // Hash chains, multi-buffer kernels, and algorithms hashed one at a time
+    const uint8_t algos[] = {ALGO_X11, ALGO_QUBIT, ALGO_X16R, ALGO_SHA256D, ALGO_SCRYPT, ALGO_NEOSCRYPT};
+    for (uint8_t algo : algos) {
+        std::vector<uint256> vHash(vHeaders.size());
+        SerializeMultiAlgoHashBatch(vpHeaders.data(), vpHeaders.size(), algo, vHash.data());
+        for (size_t i = 0; i < vHeaders.size(); i++)
+            BOOST_CHECK(vHash[i] == vHeaders[i].GetPoWHash(algo, SER_GETHASH, PROTOCOL_VERSION));
+    }
+
+    // Streams of different sizes fall back to hashing them one by one
+    std::vector<CMultihasher> vHashers;
+    for (size_t i = 0; i < 3; i++) {
+        vHashers.emplace_back(SER_GETHASH, PROTOCOL_VERSION, ALGO_X13);
+        const std::vector<unsigned char> data = insecure_rand_ctx.randbytes(80 + i);
+        vHashers.back().write((const char*)data.data(), data.size());
+    }
+    uint256 hashes[3];
+    CMultihasher::GetHashBatch(vHashers.data(), vHashers.size(), hashes);
+    for (size_t i = 0; i < 3; i++)
+        BOOST_CHECK(hashes[i] == vHashers[i].GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(prevblock_ordered_chains)
+{
+    const uint256 hashA = InsecureRand256();
+    const uint256 hashB = InsecureRand256();
+    const std::vector<unsigned char> data = insecure_rand_ctx.randbytes(80);
+
+    // Switching between parents gets the order of the one asked for
+    for (const uint256& hash : {hashA, hashB, hashA}) {
+        BOOST_CHECK(GetCachedX16RHashChain(hash).Hash(data.data(), 80) == GetX16RHashChain(hash).Hash(data.data(), 80));
+        BOOST_CHECK(GetCachedX16SHashChain(hash).Hash(data.data(), 80) == GetX16SHashChain(hash).Hash(data.data(), 80));
+        BOOST_CHECK(GetCachedX21SHashChain(hash).Hash(data.data(), 80) == GetX21SHashChain(hash).Hash(data.data(), 80));
+        BOOST_CHECK_EQUAL(GetCachedCPU23RHashChain(hash).nStages, 23U);
+    }
+
+    // Siblings batch through the cached chain, other headers one at a time
+    std::vector<CDefaultBlockHeader> vHeaders;
+    std::vector<const CDefaultBlockHeader*> vpHeaders;
+    for (size_t i = 0; i < MULTIHASH_BATCH_LANES + 3; i++) {
+        vHeaders.push_back(RandomHeader());
+        vHeaders.back().hashPrevBlock = hashA;
+    }
+    for (const CDefaultBlockHeader& header : vHeaders)
+        vpHeaders.push_back(&header);
+
+    const uint8_t algos[] = {ALGO_X16R, ALGO_X16S, ALGO_X21S};
+    for (uint8_t algo : algos) {
+        BOOST_CHECK(CMultihasher::HasBatchKernel(algo));
+        for (int nRound = 0; nRound < 2; nRound++) {
+            std::vector<uint256> vHash(vHeaders.size());
+            SerializeMultiAlgoHashBatch(vpHeaders.data(), vpHeaders.size(), algo, vHash.data());
+            for (size_t i = 0; i < vHeaders.size(); i++)
+                BOOST_CHECK(vHash[i] == vHeaders[i].GetPoWHash(algo, SER_GETHASH, PROTOCOL_VERSION));
+            vHeaders[1].hashPrevBlock = hashB;
+        }
+        vHeaders[1].hashPrevBlock = hashA;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(multibuffer_kernels)
+{
+    std::vector<std::vector<unsigned char>> vData;
+    std::vector<const unsigned char*> vInputs;
+    for (size_t i = 0; i < 13; i++) {
+        vData.push_back(insecure_rand_ctx.randbytes(80));
+        vInputs.push_back(vData.back().data());
+    }
+
+    // Counts covering full groups of each kernel width and single remainders
+    const unsigned int counts[] = {1, 3, 4, 8, 13};
+    for (unsigned int nCount : counts) {
+        std::vector<uint256> vHash(nCount);
+        scrypt_1024_1_1_256_multi((const char* const*)vInputs.data(), (char*)vHash.data(), nCount);
+        for (size_t i = 0; i < nCount; i++) {
+            uint256 hash;
+            scrypt_1024_1_1_256((const char*)vInputs[i], (char*)hash.begin());
+            BOOST_CHECK(vHash[i] == hash);
+        }
+
+        neoscrypt_multi(vInputs.data(), (unsigned char*)vHash.data(), 0x0, nCount);
+        for (size_t i = 0; i < nCount; i++) {
+            uint256 hash;
+            neoscrypt(vInputs[i], hash.begin(), 0x0);
+            BOOST_CHECK(vHash[i] == hash);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(argon2_kernels)
+{
+    std::vector<std::vector<unsigned char>> vData;
+    std::vector<uint256> vExpected;
+    argon2_use_base();
+    for (size_t i = 0; i < 8; i++) {
+        vData.push_back(insecure_rand_ctx.randbytes(80));
+        const unsigned char* data = vData.back().data();
+        uint256 hash;
+        Argon2dHash(data, 80, hash.begin(), 32, data, 80, data, 80);
+        vExpected.push_back(hash);
+        Argon2iHash(data, 80, hash.begin(), 32, data, 80, data, 80);
+        vExpected.push_back(hash);
+        cpu23R_hash_argon2d(hash.begin(), 32, data, 80, data, 80, 2, 16);
+        vExpected.push_back(hash);
+    }
+    argon2_autodetect();
+
+    // The selected kernel, alone and with its lanes filled on helper threads
+    for (int nThreads = 0; nThreads <= 2; nThreads++) {
+        Argon2StartLaneThreads(nThreads);
+        for (size_t i = 0; i < vData.size(); i++) {
+            const unsigned char* data = vData[i].data();
+            uint256 hash;
+            Argon2dHash(data, 80, hash.begin(), 32, data, 80, data, 80);
+            BOOST_CHECK(hash == vExpected[3 * i]);
+            Argon2iHash(data, 80, hash.begin(), 32, data, 80, data, 80);
+            BOOST_CHECK(hash == vExpected[3 * i + 1]);
+            cpu23R_hash_argon2d(hash.begin(), 32, data, 80, data, 80, 2, 16);
+            BOOST_CHECK(hash == vExpected[3 * i + 2]);
+        }
+    }
+    Argon2StopLaneThreads();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,258 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/algos/argon2/argon2.h>
+#include <crypto/algos/argon2/hashargon.h>
+#include <crypto/algos/hashlib/hashchain.h>
+#include <crypto/algos/hashlib/hashchain-multi.h>
+#include <crypto/algos/hashlib/sph_aesni.h>
+#include <crypto/algos/hashlib/sph_blake.h>
+#include <crypto/algos/hashlib/sph_bmw.h>
+#include <crypto/algos/hashlib/sph_echo.h>
+#include <crypto/algos/hashlib/sph_groestl.h>
+#include <crypto/algos/hashlib/sph_keccak.h>
+#include <crypto/algos/hashlib/sph_shavite.h>
+#include <crypto/algos/hashlib/sph_skein.h>
+#include <crypto/algos/scrypt/scrypt.h>
+#include <crypto/algos/yescrypt/yescrypt.h>
+#include <crypto/algos/yespower/yespower.h>
+#include <test/test_bitcoin.h>
+#include <utilstrencodings.h>
+
+#include <functional>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+/**
+ * Cross-checks of the optimized proof of work kernels against the reference
+ * build of the same algorithm. The reference hashes a set of random inputs,
+ * the kernel picked at startup hashes them again, and every output has to
+ * match.
+ *
+ * The default input counts keep the suite quick. Set
+ * POW_KERNEL_TEST_SCALE=<n> to hash n times as many inputs, for a long run
+ * before landing a change to a kernel. bench_bitcoin reports the
+ * throughput of each kernel (the _BASE and _REF benchmarks).
+ */
+BOOST_FIXTURE_TEST_SUITE(pow_kernel_tests, BasicTestingSetup)
+
+typedef std::function<void(const std::vector<unsigned char>& data, unsigned char* out)> HashFn;
+typedef std::function<void()> SelectFn;
+/** Hash messages of len bytes, in[l] into out[l], and return how many lanes it hashed */
+typedef std::function<size_t(const unsigned char* const* in, size_t len, unsigned char* const* out)> LanesFn;
+
+static size_t ScaledCount(size_t nDefault)
+{
+    const char* scale = getenv("POW_KERNEL_TEST_SCALE");
+    int64_t nScale;
+    if (scale && ParseInt64(scale, &nScale) && nScale > 0)
+        return nDefault * nScale;
+    return nDefault;
+}
+
+/** Hash nInputs random inputs of nMinLen to nMaxLen bytes with both kernels and compare. */
+static void CrossCheck(const std::string& strName, size_t nInputs, size_t nMinLen, size_t nMaxLen,
+                       const HashFn& hash, const SelectFn& useRef, const SelectFn& useOpt)
+{
+    std::vector<std::vector<unsigned char>> vData;
+    std::vector<std::vector<unsigned char>> vExpected;
+    useRef();
+    for (size_t i = 0; i < nInputs; i++) {
+        const size_t nLen = nMinLen + InsecureRandRange(nMaxLen - nMinLen + 1);
+        vData.push_back(insecure_rand_ctx.randbytes(nLen));
+        vExpected.emplace_back(64);
+        hash(vData.back(), vExpected.back().data());
+    }
+    useOpt();
+    for (size_t i = 0; i < nInputs; i++) {
+        std::vector<unsigned char> vOut(64);
+        hash(vData[i], vOut.data());
+        BOOST_CHECK_MESSAGE(vOut == vExpected[i], strName << " differs from the reference on " << HexStr(vData[i]));
+    }
+}
+
+static void CrossCheckHeaders(const std::string& strName, size_t nInputs, const HashFn& hash,
+                              const SelectFn& useRef, const SelectFn& useOpt)
+{
+    CrossCheck(strName, nInputs, 80, 80, hash, useRef, useOpt);
+}
+
+/**
+ * Hash nGroups groups of nLanes random inputs through a multi-buffer
+ * kernel, every group with its own length of nMinLen to nMaxLen bytes, and
+ * compare each lane the kernel hashed with the one at a time function.
+ */
+static void CrossCheckLanes(const std::string& strName, size_t nGroups, size_t nLanes, size_t nMinLen, size_t nMaxLen,
+                            const HashFn& hash, const LanesFn& hashLanes)
+{
+    for (size_t i = 0; i < nGroups; i++) {
+        const size_t nLen = nMinLen + InsecureRandRange(nMaxLen - nMinLen + 1);
+        std::vector<std::vector<unsigned char>> vData, vOut;
+        std::vector<const unsigned char*> vIn;
+        std::vector<unsigned char*> vpOut;
+        for (size_t l = 0; l < nLanes; l++) {
+            vData.push_back(insecure_rand_ctx.randbytes(nLen));
+            vOut.emplace_back(64);
+        }
+        for (size_t l = 0; l < nLanes; l++) {
+            vIn.push_back(vData[l].data());
+            vpOut.push_back(vOut[l].data());
+        }
+        const size_t nHashed = hashLanes(vIn.data(), nLen, vpOut.data());
+        BOOST_CHECK(nHashed <= nLanes);
+        for (size_t l = 0; l < nHashed; l++) {
+            std::vector<unsigned char> vExpected(64);
+            hash(vData[l], vExpected.data());
+            BOOST_CHECK_MESSAGE(vOut[l] == vExpected, strName << " lane " << l << " differs from the reference on " << HexStr(vData[l]));
+        }
+    }
+}
+
+static HashFn HeaderHash(void (*fn)(const char*, char*))
+{
+    return [fn](const std::vector<unsigned char>& data, unsigned char* out) {
+        fn((const char*)data.data(), (char*)out);
+    };
+}
+
+BOOST_AUTO_TEST_CASE(scrypt_kernels)
+{
+    // scrypt picks its kernel at compile time, so the generic one is called directly
+    const size_t nInputs = ScaledCount(64);
+    std::vector<char> scratchpad(SCRYPT_SCRATCHPAD_SIZE);
+    for (size_t i = 0; i < nInputs; i++) {
+        const std::vector<unsigned char> data = insecure_rand_ctx.randbytes(80);
+        uint256 hash, hashRef;
+        scrypt_1024_1_1_256((const char*)data.data(), (char*)hash.begin());
+        scrypt_1024_1_1_256_sp_generic((const char*)data.data(), (char*)hashRef.begin(), scratchpad.data());
+        BOOST_CHECK_MESSAGE(hash == hashRef, "scrypt differs from the generic kernel on " << HexStr(data));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(yescrypt_kernels)
+{
+    const SelectFn useRef = [] { yescrypt_use_ref(); };
+    const SelectFn useOpt = [] { yescrypt_autodetect(); };
+    CrossCheckHeaders("yescrypt", ScaledCount(8), HeaderHash(yescrypt_hash), useRef, useOpt);
+    CrossCheckHeaders("yescrypt-r8", ScaledCount(2), HeaderHash(yescrypt_r8_hash), useRef, useOpt);
+    CrossCheckHeaders("yescrypt-r16v2", ScaledCount(2), HeaderHash(yescrypt_r16v2_hash), useRef, useOpt);
+    CrossCheckHeaders("yescrypt-r24", ScaledCount(2), HeaderHash(yescrypt_r24_hash), useRef, useOpt);
+    CrossCheckHeaders("yescrypt-r32", ScaledCount(2), HeaderHash(yescrypt_r32_hash), useRef, useOpt);
+}
+
+BOOST_AUTO_TEST_CASE(yespower_kernels)
+{
+    CrossCheckHeaders("yespower", ScaledCount(2), HeaderHash([](const char* in, char* out) { yespower_hash(in, out); }),
+        [] { yespower_use_ref(); }, [] { yespower_autodetect(); });
+}
+
+BOOST_AUTO_TEST_CASE(argon2_kernels)
+{
+    const SelectFn useRef = [] { argon2_use_ref(); };
+    const SelectFn useOpt = [] { argon2_autodetect(); };
+    CrossCheckHeaders("Argon2d", ScaledCount(16), [](const std::vector<unsigned char>& data, unsigned char* out) {
+        Argon2dHash(data.data(), data.size(), out, 32, data.data(), data.size(), data.data(), data.size());
+    }, useRef, useOpt);
+    CrossCheckHeaders("Argon2i", ScaledCount(16), [](const std::vector<unsigned char>& data, unsigned char* out) {
+        Argon2iHash(data.data(), data.size(), out, 32, data.data(), data.size(), data.data(), data.size());
+    }, useRef, useOpt);
+    CrossCheck("CPU23R Argon2d", ScaledCount(16), 32, 64, [](const std::vector<unsigned char>& data, unsigned char* out) {
+        cpu23R_hash_argon2d(out, data.size(), data.data(), data.size(), data.data(), data.size(), 2, 16);
+    }, useRef, useOpt);
+    CrossCheck("CPU23R Argon2i", ScaledCount(16), 32, 64, [](const std::vector<unsigned char>& data, unsigned char* out) {
+        cpu23R_hash_argon2i(out, data.size(), data.data(), data.size(), data.data(), data.size(), 2, 16);
+    }, useRef, useOpt);
+}
+
+BOOST_AUTO_TEST_CASE(sph_aesni_kernels)
+{
+    const SelectFn useRef = [] { sph_aesni_use_base(); };
+    const SelectFn useOpt = [] { sph_aesni_autodetect(); };
+    // Lengths from empty to several blocks, to cover the padding and final rounds
+    CrossCheck("Groestl-512", ScaledCount(256), 0, 300, [](const std::vector<unsigned char>& data, unsigned char* out) {
+        sph_groestl512_context ctx;
+        sph_groestl512_init(&ctx);
+        sph_groestl512(&ctx, data.data(), data.size());
+        sph_groestl512_close(&ctx, out);
+    }, useRef, useOpt);
+    CrossCheck("ECHO-512", ScaledCount(256), 0, 300, [](const std::vector<unsigned char>& data, unsigned char* out) {
+        sph_echo512_context ctx;
+        sph_echo512_init(&ctx);
+        sph_echo512(&ctx, data.data(), data.size());
+        sph_echo512_close(&ctx, out);
+    }, useRef, useOpt);
+    CrossCheck("SHAvite-512", ScaledCount(256), 0, 300, [](const std::vector<unsigned char>& data, unsigned char* out) {
+        sph_shavite512_context ctx;
+        sph_shavite512_init(&ctx);
+        sph_shavite512(&ctx, data.data(), data.size());
+        sph_shavite512_close(&ctx, out);
+    }, useRef, useOpt);
+}
+
+BOOST_AUTO_TEST_CASE(hashchain_multi_kernels)
+{
+    struct MultiFunc {
+        const char* name;
+        uint8_t nFunc;
+        HashFn hash;
+    };
+    const MultiFunc funcs[] = {
+        {"BLAKE-512", CHAIN_BLAKE512, [](const std::vector<unsigned char>& data, unsigned char* out) {
+            sph_blake512_context ctx;
+            sph_blake512_init(&ctx);
+            sph_blake512(&ctx, data.data(), data.size());
+            sph_blake512_close(&ctx, out);
+        }},
+        {"BMW-512", CHAIN_BMW512, [](const std::vector<unsigned char>& data, unsigned char* out) {
+            sph_bmw512_context ctx;
+            sph_bmw512_init(&ctx);
+            sph_bmw512(&ctx, data.data(), data.size());
+            sph_bmw512_close(&ctx, out);
+        }},
+        {"Keccak-512", CHAIN_KECCAK512, [](const std::vector<unsigned char>& data, unsigned char* out) {
+            sph_keccak512_context ctx;
+            sph_keccak512_init(&ctx);
+            sph_keccak512(&ctx, data.data(), data.size());
+            sph_keccak512_close(&ctx, out);
+        }},
+        {"Skein-512", CHAIN_SKEIN512, [](const std::vector<unsigned char>& data, unsigned char* out) {
+            sph_skein512_context ctx;
+            sph_skein512_init(&ctx);
+            sph_skein512(&ctx, data.data(), data.size());
+            sph_skein512_close(&ctx, out);
+        }},
+    };
+#if defined(__SSE2__)
+    // The kernels are templates over the lane width, so the two lane SSE2
+    // build checks the round code the wider builds share on every CPU.
+    typedef void (*LanesKernel)(const unsigned char* const*, size_t, unsigned char* const*);
+    const LanesKernel sse2[] = {blake512_lanes<Lanes64SSE2>, bmw512_lanes<Lanes64SSE2>,
+                                keccak512_lanes<Lanes64SSE2>, skein512_lanes<Lanes64SSE2>};
+#endif
+
+    for (size_t f = 0; f < sizeof(funcs) / sizeof(funcs[0]); f++) {
+        const MultiFunc& func = funcs[f];
+        // Hash chain stage lengths, then empty to several blocks for the padding
+        const uint8_t nFunc = func.nFunc;
+        const LanesFn picked = [nFunc](const unsigned char* const* in, size_t len, unsigned char* const* out) {
+            return HashChainMulti(nFunc, in, len, out, 8);
+        };
+        CrossCheckLanes(func.name, ScaledCount(16), 8, 64, 64, func.hash, picked);
+        CrossCheckLanes(func.name, ScaledCount(16), 8, 80, 80, func.hash, picked);
+        CrossCheckLanes(func.name, ScaledCount(64), 8, 0, 300, func.hash, picked);
+#if defined(__SSE2__)
+        const LanesKernel kernel = sse2[f];
+        CrossCheckLanes(std::string(func.name) + " sse2", ScaledCount(64), 2, 0, 300, func.hash,
+            [kernel](const unsigned char* const* in, size_t len, unsigned char* const* out) {
+                kernel(in, len, out);
+                return (size_t)2;
+            });
+#endif
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
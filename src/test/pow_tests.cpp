@@ -5,6 +5,8 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <pow.h>
+#include <powcache.h>
+#include <primitives/block.h>
 #include <random.h>
 #include <util.h>
 #include <test/test_bitcoin.h>
@@ -83,4 +85,51 @@ BOOST_AUTO_TEST_CASE(GetBlockProofEquivalentTime_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(pow_hash_cache)
+{
+    const uint256 hashBlock = InsecureRand256();
+    const uint256 hashPoW = InsecureRand256();
+    uint256 hashCached;
+
+    BOOST_CHECK(!GetCachedPoWHash(hashBlock, ALGO_X11, 0, hashCached));
+    AddCachedPoWHash(hashBlock, ALGO_X11, 0, hashPoW);
+    BOOST_CHECK(GetCachedPoWHash(hashBlock, ALGO_X11, 0, hashCached));
+    BOOST_CHECK(hashCached == hashPoW);
+
+    // The algorithm and the hasher flags are part of the key
+    BOOST_CHECK(!GetCachedPoWHash(hashBlock, ALGO_SCRYPT, 0, hashCached));
+    BOOST_CHECK(!GetCachedPoWHash(hashBlock, ALGO_X11, 1, hashCached));
+
+    // SHA256D is cheaper to hash than to look up
+    AddCachedPoWHash(hashBlock, ALGO_SHA256D, 0, hashPoW);
+    BOOST_CHECK(!GetCachedPoWHash(hashBlock, ALGO_SHA256D, 0, hashCached));
+
+    CBlockHeader header;
+    header.SetAlgo(ALGO_X13);
+    header.hashPrevBlock = InsecureRand256();
+    header.nTime = InsecureRand32();
+    const uint256 hashHeader = header.GetPoWHash(SER_GETHASH, 0);
+    BOOST_CHECK(GetCachedPoWHash(header, 0) == hashHeader);
+    BOOST_CHECK(GetCachedPoWHash(header.GetHash(), ALGO_X13, 0, hashCached));
+    BOOST_CHECK(hashCached == hashHeader);
+    BOOST_CHECK(GetCachedPoWHash(header, 0) == hashHeader);
+
+    // The smallest cache holds two entries
+    gArgs.ForceSetArg("-maxpowcachesize", "0");
+    InitPoWCache();
+    BOOST_CHECK(!GetCachedPoWHash(hashBlock, ALGO_X11, 0, hashCached));
+    std::vector<uint256> vBlocks;
+    for (int i = 0; i < 16; i++) {
+        vBlocks.push_back(InsecureRand256());
+        AddCachedPoWHash(vBlocks.back(), ALGO_X11, 0, hashPoW);
+    }
+    int nCached = 0;
+    for (const uint256& hash : vBlocks)
+        nCached += GetCachedPoWHash(hash, ALGO_X11, 0, hashCached);
+    BOOST_CHECK(nCached >= 1 && nCached <= 2);
+    BOOST_CHECK(GetCachedPoWHash(vBlocks.back(), ALGO_X11, 0, hashCached));
+    gArgs.ForceSetArg("-maxpowcachesize", std::to_string(DEFAULT_MAX_POW_CACHE_SIZE));
+    InitPoWCache();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,13 +4,20 @@
 
 #include <rpc/server.h>
 #include <rpc/client.h>
+#include <rpc/jsonstream.h>
+#include <rpc/mining.h>
 
 #include <base58.h>
 #include <core_io.h>
+#include <index/txindex.h>
+#include <miner.h>
 #include <netbase.h>
+#include <validation.h>
 
 #include <test/test_bitcoin.h>
 
+#include <thread>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/test/unit_test.hpp>
 
@@ -337,4 +344,336 @@ BOOST_AUTO_TEST_CASE(rpc_convert_values_generatetoaddress)
     BOOST_CHECK_EQUAL(result[2].get_int(), 9);
 }
 
+/** Runs each dispatched function on a thread of its own */
+class TestBatchInterface : public RPCBatchInterface
+{
+public:
+    std::vector<std::thread> threads;
+
+    ~TestBatchInterface()
+    {
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+    const char* Name() override
+    {
+        return "test";
+    }
+    bool Dispatch(const std::function<void(void)>& func) override
+    {
+        threads.emplace_back(func);
+        return true;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(rpc_batch)
+{
+    if (RPCIsInWarmup(nullptr))
+        SetRPCWarmupFinished();
+    TestBatchInterface batchInterface;
+    RPCSetBatchInterface(&batchInterface);
+
+    UniValue vReq(UniValue::VARR);
+    for (int i = 0; i < 100; i++) {
+        UniValue req(UniValue::VOBJ);
+        req.pushKV("id", i);
+        req.pushKV("method", i % 10 == 9 ? "nosuchmethod" : i % 2 ? "getblockcount" : "getbestblockhash");
+        req.pushKV("params", UniValue(UniValue::VARR));
+        vReq.push_back(req);
+    }
+
+    JSONRPCRequest jreq;
+    for (const char* threads : {"0", "3"}) {
+        for (const char* lockgroups : {"0", "1"}) {
+            gArgs.ForceSetArg("-rpcbatchthreads", threads);
+            gArgs.ForceSetArg("-rpcbatchlockgroups", lockgroups);
+            UniValue ret;
+            BOOST_CHECK(ret.read(JSONRPCExecBatch(jreq, vReq)));
+            BOOST_CHECK_EQUAL(ret.size(), vReq.size());
+            for (int i = 0; i < (int)ret.size(); i++) {
+                // Replies come in request order, whichever thread ran them
+                BOOST_CHECK_EQUAL(find_value(ret[i], "id").get_int(), i);
+                if (i % 10 == 9) {
+                    BOOST_CHECK_EQUAL(find_value(find_value(ret[i], "error"), "code").get_int(), RPC_METHOD_NOT_FOUND);
+                } else if (i % 2) {
+                    BOOST_CHECK_EQUAL(find_value(ret[i], "result").get_int(), chainActive.Height());
+                } else {
+                    BOOST_CHECK_EQUAL(find_value(ret[i], "result").get_str(), chainActive.Tip()->GetBlockHash().GetHex());
+                }
+            }
+        }
+    }
+
+    gArgs.ForceSetArg("-rpcbatchmaxsize", "99");
+    BOOST_CHECK_THROW(JSONRPCExecBatch(jreq, vReq), UniValue);
+    gArgs.ForceSetArg("-rpcbatchmaxsize", "100");
+    BOOST_CHECK_NO_THROW(JSONRPCExecBatch(jreq, vReq));
+
+    gArgs.ForceSetArg("-rpcbatchthreads", "0");
+    gArgs.ForceSetArg("-rpcbatchlockgroups", "0");
+    gArgs.ForceSetArg("-rpcbatchmaxsize", std::to_string(DEFAULT_RPC_BATCH_MAX_SIZE));
+    RPCUnsetBatchInterface(&batchInterface);
+}
+
+BOOST_AUTO_TEST_CASE(rpc_batch_order)
+{
+    if (RPCIsInWarmup(nullptr))
+        SetRPCWarmupFinished();
+    TestBatchInterface batchInterface;
+    RPCSetBatchInterface(&batchInterface);
+    BOOST_CHECK_NO_THROW(CallRPC(std::string("clearbanned")));
+
+    // Reads between the entries that change state, which have to see every change before them
+    UniValue vReq(UniValue::VARR);
+    for (int i = 0; i < 20; i++) {
+        for (const char* strMethod : {"getblockcount", "setban", "listbanned", "getbestblockhash"}) {
+            UniValue params(UniValue::VARR);
+            if (strMethod == std::string("setban")) {
+                params.push_back(strprintf("127.0.0.%d", i));
+                params.push_back("add");
+            }
+            UniValue req(UniValue::VOBJ);
+            req.pushKV("id", (int)vReq.size());
+            req.pushKV("method", strMethod);
+            req.pushKV("params", params);
+            vReq.push_back(req);
+        }
+    }
+
+    JSONRPCRequest jreq;
+    gArgs.ForceSetArg("-rpcbatchthreads", "3");
+    UniValue ret;
+    BOOST_CHECK(ret.read(JSONRPCExecBatch(jreq, vReq)));
+    BOOST_CHECK_EQUAL(ret.size(), vReq.size());
+    for (int i = 0; i < 20; i++) {
+        BOOST_CHECK(find_value(ret[4 * i + 1], "error").isNull());
+        BOOST_CHECK_EQUAL(find_value(ret[4 * i + 2], "result").size(), (size_t)i + 1);
+    }
+
+    BOOST_CHECK_NO_THROW(CallRPC(std::string("clearbanned")));
+    gArgs.ForceSetArg("-rpcbatchthreads", "0");
+    RPCUnsetBatchInterface(&batchInterface);
+}
+
+BOOST_FIXTURE_TEST_CASE(rpc_batch_lockgroups_txindex, TestChain100Setup)
+{
+    if (RPCIsInWarmup(nullptr))
+        SetRPCWarmupFinished();
+    TestBatchInterface batchInterface;
+    RPCSetBatchInterface(&batchInterface);
+
+    g_txindex = MakeUnique<TxIndex>(1 << 20, true);
+    g_txindex->Start();
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!g_txindex->BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+    // The index may be behind this block when the batch runs, so getrawtransaction has to wait for it
+    CScript scriptPubKey = GetScriptForDestination(coinbaseKey.GetPubKey().GetID());
+    coinbaseTxns.push_back(*CreateAndProcessBlock({}, scriptPubKey).vtx[0]);
+
+    // Lookups through the index between chain state reads, and lookups in a given block
+    UniValue vReq(UniValue::VARR);
+    for (size_t i = 0; i < coinbaseTxns.size(); i += 10) {
+        const bool fBlockHash = i % 20 == 0;
+        for (const char* strMethod : {"getblockcount", "getrawtransaction", "getbestblockhash"}) {
+            UniValue params(UniValue::VARR);
+            if (strMethod == std::string("getrawtransaction")) {
+                params.push_back(coinbaseTxns[i].GetHash().GetHex());
+                if (fBlockHash) {
+                    params.push_back(false);
+                    params.push_back(chainActive[i + 1]->GetBlockHash().GetHex());
+                }
+            }
+            UniValue req(UniValue::VOBJ);
+            req.pushKV("id", (int)vReq.size());
+            req.pushKV("method", strMethod);
+            req.pushKV("params", params);
+            vReq.push_back(req);
+        }
+    }
+    // The last block, whose coinbase may not be indexed yet
+    UniValue params(UniValue::VARR);
+    params.push_back(coinbaseTxns.back().GetHash().GetHex());
+    UniValue req(UniValue::VOBJ);
+    req.pushKV("id", (int)vReq.size());
+    req.pushKV("method", "getrawtransaction");
+    req.pushKV("params", params);
+    vReq.push_back(req);
+
+    JSONRPCRequest jreq;
+    for (const char* threads : {"0", "3"}) {
+        gArgs.ForceSetArg("-rpcbatchthreads", threads);
+        gArgs.ForceSetArg("-rpcbatchlockgroups", "1");
+        UniValue ret;
+        BOOST_CHECK(ret.read(JSONRPCExecBatch(jreq, vReq)));
+        BOOST_CHECK_EQUAL(ret.size(), vReq.size());
+        size_t nEntry = 0;
+        for (size_t i = 0; i < coinbaseTxns.size(); i += 10, nEntry += 3) {
+            BOOST_CHECK_EQUAL(find_value(ret[nEntry], "result").get_int(), chainActive.Height());
+            BOOST_CHECK_EQUAL(find_value(ret[nEntry + 1], "result").get_str(), EncodeHexTx(coinbaseTxns[i]));
+        }
+        BOOST_CHECK_EQUAL(find_value(ret[nEntry], "result").get_str(), EncodeHexTx(coinbaseTxns.back()));
+    }
+
+    g_txindex->Stop();
+    g_txindex.reset();
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+
+    gArgs.ForceSetArg("-rpcbatchthreads", "0");
+    gArgs.ForceSetArg("-rpcbatchlockgroups", "0");
+    RPCUnsetBatchInterface(&batchInterface);
+}
+
+/** Write a value through a stream writer, taking objects and arrays apart */
+static void StreamValue(JSONStreamWriter& writer, const UniValue& value)
+{
+    if (value.isObject()) {
+        writer.BeginObject();
+        for (size_t i = 0; i < value.size(); i++) {
+            writer.Key(value.getKeys()[i]);
+            StreamValue(writer, value.getValues()[i]);
+        }
+        writer.EndObject();
+    } else if (value.isArray()) {
+        writer.BeginArray();
+        for (size_t i = 0; i < value.size(); i++)
+            StreamValue(writer, value[i]);
+        writer.EndArray();
+    } else {
+        writer.Value(value);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rpc_jsonstream)
+{
+    UniValue value;
+    BOOST_CHECK(value.read("{\"a\":[1,2.5,{},[],\"x\\\"y\\n\"],\"b\":{\"c\":null,\"d\":[true,false,[[]]]},\"\":\"\",\"e\\u0001\":-7}"));
+    for (size_t nChunkSize : {1, 7, 1000}) {
+        std::string str;
+        size_t nLargest = 0;
+        JSONStreamWriter writer([&str, &nLargest](const char* data, size_t size) {
+            str.append(data, size);
+            nLargest = std::max(nLargest, size);
+        }, nChunkSize);
+        StreamValue(writer, value);
+        BOOST_CHECK(nLargest <= nChunkSize + value.write().size());
+        writer.Flush();
+        BOOST_CHECK_EQUAL(str, value.write());
+    }
+
+    const std::vector<unsigned char> vch = ParseHex("00ff10abcdef");
+    std::string str;
+    JSONStreamWriter writer([&str](const char* data, size_t size) { str.append(data, size); });
+    writer.BeginArray();
+    writer.HexValue(vch.data(), vch.data() + vch.size());
+    writer.HexValue(vch.data(), vch.data());
+    writer.Value(UniValue(3));
+    writer.RawValue("{\"k\":[]}");
+    writer.EndArray();
+    BOOST_CHECK(str.empty());
+    writer.Flush();
+    BOOST_CHECK_EQUAL(str, "[\"00ff10abcdef\",\"\",3,{\"k\":[]}]");
+}
+
+BOOST_AUTO_TEST_CASE(rpc_gbt_template)
+{
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vout.resize(1);
+    CMutableTransaction tx1;
+    tx1.vin.resize(1);
+    tx1.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+    tx1.vout.resize(1);
+    CMutableTransaction tx2;
+    tx2.vin.resize(2);
+    tx2.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+    tx2.vin[1].prevout = COutPoint(tx1.GetHash(), 0);
+    tx2.vout.resize(1);
+
+    std::unique_ptr<CBlockTemplate> pblocktemplate(new CBlockTemplate());
+    pblocktemplate->block.vtx = {MakeTransactionRef(coinbase), MakeTransactionRef(tx1), MakeTransactionRef(tx2)};
+    pblocktemplate->vTxFees = {-300, 100, 200};
+    pblocktemplate->vTxSigOpsCost = {0, 8, 12};
+
+    CGBTTemplate gbt;
+    gbt.Set(std::move(pblocktemplate), true);
+    const UniValue& transactions = gbt.GetTransactions();
+    BOOST_CHECK_EQUAL(transactions.write(), gbt.GetTransactionsJSON());
+    BOOST_CHECK_EQUAL(transactions.size(), 2U);
+    BOOST_CHECK_EQUAL(find_value(transactions[0], "data").get_str(), EncodeHexTx(tx1));
+    BOOST_CHECK_EQUAL(find_value(transactions[0], "depends").size(), 0U);
+    BOOST_CHECK_EQUAL(find_value(transactions[1], "txid").get_str(), tx2.GetHash().GetHex());
+    BOOST_CHECK_EQUAL(find_value(transactions[1], "depends").write(), "[1]");
+    BOOST_CHECK_EQUAL(find_value(transactions[1], "fee").get_int64(), 200);
+    BOOST_CHECK_EQUAL(find_value(transactions[1], "sigops").get_int64(), 3);
+
+    // A new template replaces both forms of the transactions of the old one
+    pblocktemplate.reset(new CBlockTemplate());
+    pblocktemplate->block.vtx = {MakeTransactionRef(coinbase), MakeTransactionRef(tx1)};
+    pblocktemplate->vTxFees = {-100, 100};
+    pblocktemplate->vTxSigOpsCost = {0, 8};
+    gbt.Set(std::move(pblocktemplate), false);
+    BOOST_CHECK_EQUAL(gbt.GetTransactionsJSON(), gbt.GetTransactions().write());
+    BOOST_CHECK_EQUAL(gbt.GetTransactions().size(), 1U);
+    BOOST_CHECK_EQUAL(find_value(gbt.GetTransactions()[0], "sigops").get_int64(), 8);
+
+    gbt.Release();
+    BOOST_CHECK(!gbt.pblocktemplate);
+    BOOST_CHECK(gbt.pindexPrev == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(rpc_getrpcinfo)
+{
+    BOOST_CHECK_NO_THROW(CallRPC("getblockcount"));
+    BOOST_CHECK_NO_THROW(CallRPC("getblockcount"));
+    BOOST_CHECK_THROW(CallRPC("getblockhash 1000000"), std::runtime_error);
+
+    UniValue r;
+    BOOST_CHECK_NO_THROW(r = CallRPC("getrpcinfo"));
+    // No HTTP server runs in the tests
+    BOOST_CHECK(find_value(r.get_obj(), "workqueue").isNull());
+    const UniValue& methods = find_value(r.get_obj(), "methods");
+
+    const UniValue& blockcount = find_value(methods, "getblockcount");
+    BOOST_CHECK(find_value(blockcount, "calls").get_int64() >= 2);
+    BOOST_CHECK_EQUAL(find_value(blockcount, "errors").get_int64(), 0);
+    const UniValue& latency = find_value(blockcount, "latency_ms");
+    BOOST_CHECK_EQUAL(latency.size(), RPC_LATENCY_BUCKETS);
+    int64_t nCalls = 0;
+    for (size_t i = 0; i < latency.size(); i++)
+        nCalls += latency[i].get_int64();
+    BOOST_CHECK_EQUAL(nCalls, find_value(blockcount, "calls").get_int64());
+    BOOST_CHECK(!find_value(latency, "inf").isNull());
+
+    BOOST_CHECK(find_value(find_value(methods, "getblockhash"), "errors").get_int64() >= 1);
+    BOOST_CHECK(find_value(methods, "getrpcinfo").isNull());
+}
+
+BOOST_AUTO_TEST_CASE(rpc_getlockinfo)
+{
+    CCriticalSection cs;
+    ProfileLock(cs, "rpc_tests.cs");
+    for (int i = 0; i < 3; i++) {
+        LOCK(cs);
+    }
+
+    UniValue r;
+    BOOST_CHECK_NO_THROW(r = CallRPC("getlockinfo 0"));
+    const UniValue& lock = find_value(r.get_obj(), "rpc_tests.cs");
+    BOOST_CHECK_EQUAL(find_value(lock, "acquired").get_int64(), 3);
+    BOOST_CHECK_EQUAL(find_value(lock, "contended").get_int64(), 0);
+    BOOST_CHECK_EQUAL(find_value(lock, "sites").size(), 1U);
+    BOOST_CHECK_EQUAL(find_value(find_value(lock, "sites")[0], "name").get_str(), "cs");
+    BOOST_CHECK_THROW(CallRPC("getlockinfo -1"), std::runtime_error);
+
+    UnprofileLock(cs);
+    BOOST_CHECK_NO_THROW(r = CallRPC("getlockinfo 0"));
+    BOOST_CHECK(find_value(r.get_obj(), "rpc_tests.cs").isNull());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
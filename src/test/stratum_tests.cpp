@@ -0,0 +1,141 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <chainparams.h>
+#include <consensus/merkle.h>
+#include <primitives/block.h>
+#include <random.h>
+#include <script/script.h>
+#include <stratum.h>
+#include <test/test_bitcoin.h>
+#include <utilstrencodings.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(stratum_tests, BasicTestingSetup)
+
+/** A block like CreateNewBlock makes, with a witness commitment and a few other transactions */
+static CBlock MakeTestBlock(int nHeight, size_t nTx)
+{
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << nHeight << OP_0;
+    coinbase.vin[0].scriptWitness.stack.resize(1);
+    coinbase.vin[0].scriptWitness.stack[0] = std::vector<unsigned char>(32, 0);
+    coinbase.vout.resize(2);
+    coinbase.vout[0].nValue = 50 * COIN;
+    coinbase.vout[0].scriptPubKey = CScript() << OP_DUP << OP_HASH160 << insecure_rand_ctx.randbytes(20) << OP_EQUALVERIFY << OP_CHECKSIG;
+    coinbase.vout[1].scriptPubKey = CScript() << OP_RETURN << ToByteVector(InsecureRand256());
+    block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+    for (size_t i = 0; i < nTx; i++) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+        tx.vout.resize(1);
+        tx.vout[0].nValue = InsecureRandRange(COIN);
+        block.vtx.push_back(MakeTransactionRef(std::move(tx)));
+    }
+    return block;
+}
+
+BOOST_AUTO_TEST_CASE(stratum_coinbase)
+{
+    for (int nHeight : {1, 16, 17, 1000, 500000}) {
+        for (size_t nTx : {0, 1, 2, 5, 16}) {
+            CBlock block = MakeTestBlock(nHeight, nTx);
+            CMutableTransaction coinbase(*block.vtx[0]);
+            std::vector<unsigned char> vchCoinb1, vchCoinb2;
+            BOOST_CHECK(SplitStratumCoinbase(coinbase, nHeight, vchCoinb1, vchCoinb2));
+            block.vtx[0] = MakeTransactionRef(coinbase);
+            const std::vector<uint256> vMerkleBranch = BlockMerkleBranch(block, 0);
+
+            // What a miner hashes for an extranonce has to be the coinbase of the block it submits
+            const std::vector<unsigned char> vchExtraNonce = insecure_rand_ctx.randbytes(STRATUM_EXTRANONCE1_SIZE + STRATUM_EXTRANONCE2_SIZE);
+            CTransactionRef tx;
+            BOOST_CHECK(AssembleStratumCoinbase(vchCoinb1, vchExtraNonce, vchCoinb2, *block.vtx[0], tx));
+            BOOST_CHECK(tx->vin[0].scriptSig == ((CScript() << nHeight << vchExtraNonce) + COINBASE_FLAGS));
+            BOOST_CHECK(tx->vout == block.vtx[0]->vout);
+            BOOST_CHECK(tx->vin[0].scriptWitness.stack == block.vtx[0]->vin[0].scriptWitness.stack);
+
+            const uint256 hashMerkleRoot = ComputeMerkleRootFromBranch(tx->GetHash(), vMerkleBranch, 0);
+            block.vtx[0] = tx;
+            BOOST_CHECK(hashMerkleRoot == BlockMerkleRoot(block));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(stratum_prevhash)
+{
+    const uint256 hash = uint256S("000000001e920b44c0c6771b61e57a48786fe66d2aae448f19e2f65af8b6164d");
+    BOOST_CHECK_EQUAL(StratumPrevHash(hash), "f8b6164d19e2f65a2aae448f786fe66d61e57a48c0c6771b1e920b4400000000");
+}
+
+BOOST_AUTO_TEST_CASE(stratum_share_target)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    for (uint8_t nAlgo : {ALGO_SHA256D, ALGO_SCRYPT, ALGO_EQUIHASH}) {
+        const arith_uint256 powLimit = params.aPOWAlgos[nAlgo].GetArithPowLimit();
+        // Difficulty 1 is the pow limit, less the 16 bits of fraction
+        BOOST_CHECK(StratumShareTarget(nAlgo, 1.0, params) == (powLimit >> 16) << 16);
+        BOOST_CHECK(StratumShareTarget(nAlgo, 256.0, params) == ((powLimit >> 8) >> 16) << 16);
+        // Easier than the pow limit, without wrapping around
+        BOOST_CHECK(StratumShareTarget(nAlgo, 0.5, params) > powLimit);
+        BOOST_CHECK(StratumShareTarget(nAlgo, 1e-9, params) > powLimit);
+    }
+    BOOST_CHECK(StratumShareTarget(ALGO_SHA256D, 1.0, params) < StratumShareTarget(ALGO_EQUIHASH, 1.0, params));
+}
+
+BOOST_AUTO_TEST_CASE(stratum_share_pow)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    const uint8_t nAlgo = ALGO_SHA256D;
+    const arith_uint256 powLimit = params.aPOWAlgos[nAlgo].GetArithPowLimit();
+    const uint32_t nBits = arith_uint256(powLimit >> 12).GetCompact();
+    const arith_uint256 shareTarget = StratumShareTarget(nAlgo, 16.0, params);
+
+    BOOST_CHECK(CheckStratumSharePoW(ArithToUint256(powLimit >> 14), nBits, nAlgo, shareTarget, params) == StratumShareResult::BLOCK);
+    BOOST_CHECK(CheckStratumSharePoW(ArithToUint256(powLimit >> 6), nBits, nAlgo, shareTarget, params) == StratumShareResult::VALID);
+    BOOST_CHECK(CheckStratumSharePoW(ArithToUint256(shareTarget), nBits, nAlgo, shareTarget, params) == StratumShareResult::VALID);
+    BOOST_CHECK(CheckStratumSharePoW(ArithToUint256(shareTarget + 1), nBits, nAlgo, shareTarget, params) == StratumShareResult::LOW_DIFFICULTY);
+    BOOST_CHECK(CheckStratumSharePoW(ArithToUint256(powLimit >> 2), nBits, nAlgo, shareTarget, params) == StratumShareResult::LOW_DIFFICULTY);
+    // Even a hash below the share target is no block for bits above the pow limit
+    BOOST_CHECK(CheckStratumSharePoW(ArithToUint256(powLimit >> 14), arith_uint256(powLimit << 1).GetCompact(), nAlgo, shareTarget, params) == StratumShareResult::VALID);
+}
+
+BOOST_AUTO_TEST_CASE(stratum_share_duplicate_stale)
+{
+    const uint256 hashTip = InsecureRand256();
+    const uint256 hashShare = InsecureRand256();
+    CStratumShareSet shares;
+
+    BOOST_CHECK(CheckStratumShare(hashTip, hashTip, hashShare, shares) == StratumShareResult::VALID);
+    BOOST_CHECK(CheckStratumShare(hashTip, hashTip, hashShare, shares) == StratumShareResult::DUPLICATE);
+    BOOST_CHECK(CheckStratumShare(hashTip, hashTip, InsecureRand256(), shares) == StratumShareResult::VALID);
+
+    // A job on an earlier tip, even for a share that was never submitted
+    BOOST_CHECK(CheckStratumShare(InsecureRand256(), hashTip, InsecureRand256(), shares) == StratumShareResult::STALE);
+    BOOST_CHECK(CheckStratumShare(InsecureRand256(), hashTip, hashShare, shares) == StratumShareResult::STALE);
+    BOOST_CHECK_EQUAL(shares.size(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(stratum_share_set_limit)
+{
+    CStratumShareSet shares(8);
+    std::vector<uint256> vHashes;
+    for (int i = 0; i < 100; i++) {
+        vHashes.push_back(InsecureRand256());
+        BOOST_CHECK(shares.Insert(vHashes.back()));
+        BOOST_CHECK(shares.size() <= 8);
+    }
+    // The newest shares are remembered, the oldest ones are forgotten
+    for (size_t i = vHashes.size() - 4; i < vHashes.size(); i++)
+        BOOST_CHECK(!shares.Insert(vHashes[i]));
+    BOOST_CHECK(shares.Insert(vHashes[0]));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+// Copyright (c) 2019 The Globaltoken Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <sync.h>
+#include <test/test_bitcoin.h>
+#include <utiltime.h>
+
+#include <atomic>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(sync_tests, BasicTestingSetup)
+
+static CLockSiteStats GetSite(const std::string& strLock, int nLine)
+{
+    for (const CLockProfileStats& profile : GetLockProfiles()) {
+        if (profile.strName != strLock)
+            continue;
+        for (const CLockSiteStats& site : profile.vSites) {
+            if (site.nLine == nLine && site.strFile.find("sync_tests.cpp") != std::string::npos)
+                return site;
+        }
+    }
+    CLockSiteStats site{};
+    return site;
+}
+
+BOOST_AUTO_TEST_CASE(lock_profile)
+{
+    CCriticalSection cs;
+    BOOST_CHECK(ProfileLock(cs, "sync_tests.cs"));
+    BOOST_CHECK(!ProfileLock(cs, "sync_tests.again"));
+
+    int64_t nWaitBefore, nHoldBefore;
+    GetThreadLockTimes(nWaitBefore, nHoldBefore);
+
+    const int nLineHold = __LINE__ + 2;
+    for (int i = 0; i < 3; i++) {
+        LOCK(cs);
+        LOCK(cs); // Recursive locks are part of the outer hold
+        MilliSleep(2);
+    }
+    CLockSiteStats site = GetSite("sync_tests.cs", nLineHold);
+    BOOST_CHECK_EQUAL(site.strName, "cs");
+    BOOST_CHECK_EQUAL(site.nAcquired, 3U);
+    BOOST_CHECK_EQUAL(site.nContended, 0U);
+    BOOST_CHECK(site.nHoldMicros >= 6000);
+    BOOST_CHECK(site.nMaxHoldMicros >= 2000);
+    BOOST_CHECK_EQUAL(GetSite("sync_tests.cs", nLineHold + 1).nAcquired, 0U);
+
+    // Wait for a lock another thread holds
+    std::atomic<bool> fLocked(false);
+    std::thread thread([&] {
+        LOCK(cs);
+        fLocked = true;
+        MilliSleep(20);
+    });
+    while (!fLocked)
+        std::this_thread::yield();
+    const int nLineWait = __LINE__ + 1;
+    { LOCK(cs); }
+    thread.join();
+    site = GetSite("sync_tests.cs", nLineWait);
+    BOOST_CHECK_EQUAL(site.nAcquired, 1U);
+    BOOST_CHECK_EQUAL(site.nContended, 1U);
+    BOOST_CHECK(site.nWaitMicros > 0);
+    BOOST_CHECK_EQUAL(site.nWaitMicros, site.nMaxWaitMicros);
+
+    int64_t nWaitAfter, nHoldAfter;
+    GetThreadLockTimes(nWaitAfter, nHoldAfter);
+    BOOST_CHECK_EQUAL(nWaitAfter - nWaitBefore, site.nWaitMicros);
+    BOOST_CHECK(nHoldAfter - nHoldBefore >= 6000);
+
+    const int nLineTry = __LINE__ + 2;
+    {
+        TRY_LOCK(cs, lockTry);
+        BOOST_CHECK(bool(lockTry));
+    }
+    BOOST_CHECK_EQUAL(GetSite("sync_tests.cs", nLineTry).nAcquired, 1U);
+
+    const int nLineEnter = __LINE__ + 1;
+    ENTER_CRITICAL_SECTION(cs);
+    LEAVE_CRITICAL_SECTION(cs);
+    BOOST_CHECK_EQUAL(GetSite("sync_tests.cs", nLineEnter).nAcquired, 1U);
+
+    // The statistics go away with the profile, and cs can be profiled again
+    UnprofileLock(cs);
+    BOOST_CHECK_EQUAL(GetSite("sync_tests.cs", nLineHold).nAcquired, 0U);
+    { LOCK(cs); }
+    BOOST_CHECK(ProfileLock(cs, "sync_tests.again"));
+    UnprofileLock(cs);
+    UnprofileLock(cs);
+    for (const CLockProfileStats& profile : GetLockProfiles())
+        BOOST_CHECK(profile.strName.compare(0, 11, "sync_tests.") != 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
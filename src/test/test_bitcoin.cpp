@@ -7,10 +7,18 @@
 #include <chainparams.h>
 #include <consensus/consensus.h>
 #include <consensus/validation.h>
+#include <crypto/algos/argon2/argon2.h>
+#include <crypto/algos/hashlib/hashchain.h>
+#include <crypto/algos/hashlib/sph_aesni.h>
+#include <crypto/algos/neoscrypt/neoscrypt.h>
+#include <crypto/algos/scrypt/scrypt.h>
+#include <crypto/algos/yescrypt/yescrypt.h>
+#include <crypto/algos/yespower/yespower.h>
 #include <crypto/sha256.h>
 #include <validation.h>
 #include <miner.h>
 #include <net_processing.h>
+#include <powcache.h>
 #include <ui_interface.h>
 #include <streams.h>
 #include <rpc/server.h>
@@ -43,12 +51,20 @@ extern void noui_connect();
 BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
 {
         SHA256AutoDetect();
+        sph_aesni_autodetect();
+        yescrypt_autodetect();
+        yespower_autodetect();
+        argon2_autodetect();
+        scrypt_multi_autodetect();
+        neoscrypt_multi_autodetect();
+        hashchain_multi_autodetect();
         RandomInit();
         ECC_Start();
         SetupEnvironment();
         SetupNetworking();
         InitSignatureCache();
         InitScriptExecutionCache();
+        InitPoWCache();
         fPrintToDebugLog = false; // don't want to write to debug.log file
         fCheckBlockIndex = true;
         SelectParams(chainName);
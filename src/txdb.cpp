@@ -22,7 +22,6 @@
 static const char DB_COIN = 'C';
 static const char DB_COINS = 'c';
 static const char DB_BLOCK_FILES = 'f';
-static const char DB_TXINDEX = 't';
 static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
@@ -31,6 +30,9 @@ static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 
+/** Block index entries whose proof of work is checked together while loading */
+static const size_t POW_CHECK_BATCH_SIZE = 1000;
+
 std::vector<uint256> vAuxpowValidation;
 
 namespace {
@@ -239,17 +241,6 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     return WriteBatch(batch, true);
 }
 
-bool CBlockTreeDB::ReadTxIndex(const uint256 &txid, CDiskTxPos &pos) {
-    return Read(std::make_pair(DB_TXINDEX, txid), pos);
-}
-
-bool CBlockTreeDB::WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<uint256,CDiskTxPos> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Write(std::make_pair(DB_TXINDEX, it->first), it->second);
-    return WriteBatch(batch);
-}
-
 bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
     return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
 }
@@ -268,6 +259,35 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
 
     pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
 
+    // Proof of work is checked in batches, so that headers of the same
+    // algorithm are hashed together.
+    std::vector<CBlockIndex*> vPoWCheck;
+    auto checkPoW = [&]() {
+        std::vector<CBlockHeader> vHeaders;
+        std::vector<const CBlockHeader*> vpHeaders;
+        vHeaders.reserve(vPoWCheck.size());
+        for (const CBlockIndex* pindex : vPoWCheck) {
+            vHeaders.push_back(pindex->GetBlockHeader(consensusParams));
+            vpHeaders.push_back(&vHeaders.back());
+        }
+        const std::vector<uint256> vPoWHash = GetPoWHashBatch(vpHeaders, consensusParams);
+
+        for (size_t i = 0; i < vPoWCheck.size(); i++) {
+            const CBlockIndex* pindex = vPoWCheck[i];
+            bool equihashvalidator;
+            bool checkresult = CheckProofOfWork(vHeaders[i], consensusParams, equihashvalidator, &vPoWHash[i]);
+
+            if (IsEquihashBasedAlgo(pindex->GetAlgo()) && !equihashvalidator) {
+                return error("%s: %s solution invalid at: %s", __func__, GetAlgoName(pindex->GetAlgo()), pindex->ToString());
+            }
+
+            if (!checkresult)
+                return error("%s: CheckProofOfWork failed: %s", __func__, pindex->ToString());
+        }
+        vPoWCheck.clear();
+        return true;
+    };
+
     // Load mapBlockIndex
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
@@ -309,15 +329,9 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
                     continue;
                 }
 				
-                bool equihashvalidator;
-                bool checkresult = CheckProofOfWork(pindexNew->GetBlockHeader(consensusParams), consensusParams, equihashvalidator);
-                
-                if (IsEquihashBasedAlgo(pindexNew->GetAlgo()) && !equihashvalidator) {
-                    return error("%s: %s solution invalid at: %s", __func__, GetAlgoName(pindexNew->GetAlgo()), pindexNew->ToString());
-                }
-
-                if (!checkresult)
-                    return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
+                vPoWCheck.push_back(pindexNew);
+                if (vPoWCheck.size() >= POW_CHECK_BATCH_SIZE && !checkPoW())
+                    return false;
 
                 pcursor->Next();
             } else {
@@ -328,7 +342,7 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
         }
     }
 
-    return true;
+    return checkPoW();
 }
 
 namespace {
@@ -258,6 +258,7 @@ const CLogCategoryDesc LogCategories[] =
     {BCLog::QT, "qt"},
     {BCLog::LEVELDB, "leveldb"},
 	{BCLog::POW, "pow"},
+    {BCLog::STRATUM, "stratum"},
     {BCLog::INSTANTSEND, "instantsend"},
     {BCLog::MASTERNODE, "masternode"},
     {BCLog::MNPAYMENTS, "mnpayments"},
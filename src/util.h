@@ -128,6 +128,7 @@ namespace BCLog {
         QT          = (1 << 25),
         LEVELDB     = (1 << 26),
         POW         = (1 << 27),
+        STRATUM     = (1 << 28),
         ALL         = ~(uint32_t)0,
     };
 }
@@ -8,6 +8,7 @@
 #include <validation.h>
 
 #include <arith_uint256.h>
+#include <blockfilemap.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -16,9 +17,12 @@
 #include <consensus/merkle.h>
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
 #include <cuckoocache.h>
 #include <globaltoken/hardfork.h>
+#include <globaltoken/multihasher.h>
 #include <hash.h>
+#include <index/txindex.h>
 #include <init.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
@@ -162,7 +166,7 @@ public:
 
     bool ActivateBestChain(CValidationState &state, const CChainParams& chainparams, std::shared_ptr<const CBlock> pblock);
 
-    bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex);
+    bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, const uint256* phashPoW = nullptr);
     bool AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, bool fRequested, const CDiskBlockPos* dbp, bool* fNewBlock);
 
     // Block (dis)connection on a given view:
@@ -218,10 +222,10 @@ CConditionVariable cvBlockChange;
 int nScriptCheckThreads = 0;
 std::atomic_bool fImporting(false);
 std::atomic_bool fReindex(false);
-bool fTxIndex = false;
 bool fHavePruned = false;
 bool fPruneMode = false;
 bool fIsBareMultisigStd = DEFAULT_PERMIT_BAREMULTISIG;
+CBlockFileMapCache blockFileMapCache(DEFAULT_BLOCK_MAP_FILES);
 bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
@@ -1077,28 +1081,13 @@ bool GetTransaction(const uint256& hash, CTransactionRef& txOut, const Consensus
             return true;
         }
 
-        if (fTxIndex) {
-            CDiskTxPos postx;
-            if (pblocktree->ReadTxIndex(hash, postx)) {
-                CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
-                if (file.IsNull())
-                    return error("%s: OpenBlockFile failed", __func__);
-                CBlockHeader header;
-                try {
-                    file >> header;
-                    fseek(file.Get(), postx.nTxOffset, SEEK_CUR);
-                    file >> txOut;
-                } catch (const std::exception& e) {
-                    return error("%s: Deserialize or I/O error - %s", __func__, e.what());
-                }
-                hashBlock = header.GetHash();
-                if (txOut->GetHash() != hash)
-                    return error("%s: txid mismatch", __func__);
+        if (g_txindex) {
+            if (g_txindex->FindTx(hash, hashBlock, txOut))
                 return true;
-            }
 
-            // transaction not found in index, nothing more can be done
-            return false;
+            // transaction not found in a fully built index, nothing more can be done
+            if (g_txindex->IsSynced())
+                return false;
         }
 
         if (fAllowSlow) { // use coin database to locate block that contains transaction, and scan it
@@ -1154,19 +1143,49 @@ static bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMes
     return true;
 }
 
+/**
+ * Map the block file containing the block at pos. Every block on disk is
+ * preceded by the network magic and its size, which is returned in
+ * nBlockSize; the mapping covers at least the whole block.
+ */
+static std::shared_ptr<const CMappedBlockFile> MapBlockFromDisk(const CDiskBlockPos& pos, unsigned int& nBlockSize)
+{
+    if (pos.nPos < CMessageHeader::MESSAGE_START_SIZE + sizeof(nBlockSize))
+        return nullptr;
+
+    const fs::path path = GetBlockPosFilename(pos, "blk");
+    std::shared_ptr<const CMappedBlockFile> mapping = blockFileMapCache.Get(pos.nFile, path, pos.nPos);
+    if (!mapping)
+        return nullptr;
+
+    nBlockSize = ReadLE32(mapping->data() + pos.nPos - sizeof(nBlockSize));
+    if (nBlockSize > MAX_SIZE)
+        return nullptr;
+    if ((uint64_t)pos.nPos + nBlockSize > mapping->size())
+        mapping = blockFileMapCache.Get(pos.nFile, path, (uint64_t)pos.nPos + nBlockSize);
+    return mapping;
+}
+
 template<typename T>
 static bool ReadBlockOrHeader(T& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams)
 {    
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull())
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
-
-    // Read block
+    // Read block, straight from the mapped block file if we can
     try {
-        filein >> block;
+        unsigned int nBlockSize = 0;
+        std::shared_ptr<const CMappedBlockFile> mapping = MapBlockFromDisk(pos, nBlockSize);
+        if (mapping) {
+            const unsigned char* pbegin = mapping->data() + pos.nPos;
+            CSpanReader filein(SER_DISK, CLIENT_VERSION, pbegin, pbegin + nBlockSize);
+            filein >> block;
+        } else {
+            // Open history file to read
+            CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+            if (filein.IsNull())
+                return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+            filein >> block;
+        }
     }
     catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
@@ -1212,6 +1231,78 @@ bool ReadBlockHeaderFromDisk(CBlockHeader& block, const CBlockIndex* pindex, con
     return ReadBlockOrHeader(block, pindex, consensusParams);
 }
 
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& vchBlock, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart)
+{
+    vchBlock.clear();
+
+    unsigned int nBlockSize = 0;
+    std::shared_ptr<const CMappedBlockFile> mapping = MapBlockFromDisk(pos, nBlockSize);
+    if (mapping) {
+        const unsigned char* pbegin = mapping->data() + pos.nPos;
+        if (memcmp(pbegin - sizeof(nBlockSize) - CMessageHeader::MESSAGE_START_SIZE, messageStart, CMessageHeader::MESSAGE_START_SIZE))
+            return error("%s: Block magic mismatch for %s", __func__, pos.ToString());
+        vchBlock.assign(pbegin, pbegin + nBlockSize);
+        return true;
+    }
+
+    if (pos.nPos < CMessageHeader::MESSAGE_START_SIZE + sizeof(nBlockSize))
+        return error("%s: Invalid block position %s", __func__, pos.ToString());
+
+    // Open history file at the start of the block's magic and size
+    CDiskBlockPos posHeader(pos.nFile, pos.nPos - CMessageHeader::MESSAGE_START_SIZE - sizeof(nBlockSize));
+    CAutoFile filein(OpenBlockFile(posHeader, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+
+    try {
+        CMessageHeader::MessageStartChars blockStart;
+        filein >> FLATDATA(blockStart) >> nBlockSize;
+        if (memcmp(blockStart, messageStart, CMessageHeader::MESSAGE_START_SIZE))
+            return error("%s: Block magic mismatch for %s", __func__, pos.ToString());
+        if (nBlockSize > MAX_SIZE)
+            return error("%s: Block data is larger than maximum deserialization size for %s", __func__, pos.ToString());
+        vchBlock.resize(nBlockSize);
+        filein.read((char*)vchBlock.data(), nBlockSize);
+    }
+    catch (const std::exception& e) {
+        return error("%s: Read from block file failed - %s at %s", __func__, e.what(), pos.ToString());
+    }
+    return true;
+}
+
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& vchBlock, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& messageStart)
+{
+    CDiskBlockPos blockPos;
+    {
+        LOCK(cs_main);
+        blockPos = pindex->GetBlockPos();
+    }
+    return ReadRawBlockFromDisk(vchBlock, blockPos, messageStart);
+}
+
+bool MapRawBlockFromDisk(std::shared_ptr<const CMappedBlockFile>& mapping, const unsigned char*& pchBlock, unsigned int& nBlockSize, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart)
+{
+    mapping = MapBlockFromDisk(pos, nBlockSize);
+    if (!mapping)
+        return false;
+    pchBlock = mapping->data() + pos.nPos;
+    if (memcmp(pchBlock - sizeof(nBlockSize) - CMessageHeader::MESSAGE_START_SIZE, messageStart, CMessageHeader::MESSAGE_START_SIZE)) {
+        mapping.reset();
+        return error("%s: Block magic mismatch for %s", __func__, pos.ToString());
+    }
+    return true;
+}
+
+bool MapRawBlockFromDisk(std::shared_ptr<const CMappedBlockFile>& mapping, const unsigned char*& pchBlock, unsigned int& nBlockSize, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& messageStart)
+{
+    CDiskBlockPos blockPos;
+    {
+        LOCK(cs_main);
+        blockPos = pindex->GetBlockPos();
+    }
+    return MapRawBlockFromDisk(mapping, pchBlock, nBlockSize, blockPos, messageStart);
+}
+
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams)
 {
     int halvings = nHeight / consensusParams.nSubsidyHalvingInterval;
@@ -1554,7 +1645,9 @@ bool UndoWriteToDisk(const CBlockUndo& blockundo, CDiskBlockPos& pos, const uint
     return true;
 }
 
-static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
+} // namespace
+
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
 {
     CDiskBlockPos pos = pindex->GetUndoPos();
     if (pos.IsNull()) {
@@ -1585,6 +1678,8 @@ static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
     return true;
 }
 
+namespace {
+
 /** Abort with a message */
 bool AbortNode(const std::string& strMessage, const std::string& userMessage="")
 {
@@ -1742,26 +1837,6 @@ static bool WriteUndoDataForBlock(const CBlockUndo& blockundo, CValidationState&
     return true;
 }
 
-static bool WriteTxIndexDataForBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex)
-{
-    if (!fTxIndex) return true;
-
-    CDiskTxPos pos(pindex->GetBlockPos(), GetSizeOfCompactSize(block.vtx.size()));
-    std::vector<std::pair<uint256, CDiskTxPos> > vPos;
-    vPos.reserve(block.vtx.size());
-    for (const CTransactionRef& tx : block.vtx)
-    {
-        vPos.push_back(std::make_pair(tx->GetHash(), pos));
-        pos.nTxOffset += ::GetSerializeSize(*tx, SER_DISK, CLIENT_VERSION);
-    }
-
-    if (!pblocktree->WriteTxIndex(vPos)) {
-        return AbortNode(state, "Failed to write transaction index");
-    }
-
-    return true;
-}
-
 static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
 
 void ThreadScriptCheck() {
@@ -2151,9 +2226,6 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
         setDirtyBlockIndex.insert(pindex);
     }
 
-    if (!WriteTxIndexDataForBlock(block, state, pindex))
-        return false;
-
     assert(pindex->phashBlock);
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
@@ -3175,7 +3247,7 @@ static bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos,
     return true;
 }
 
-static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
+static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, const uint256* phashPoW = nullptr)
 {
     bool equihashvalidator;
     bool checkresult;
@@ -3192,7 +3264,7 @@ static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state,
     }
     
     if (fCheckPOW)
-        checkresult = CheckProofOfWork(block, consensusParams, equihashvalidator);
+        checkresult = CheckProofOfWork(block, consensusParams, equihashvalidator, phashPoW);
     
     if (fCheckPOW && IsEquihashBasedAlgo(nAlgo) && !equihashvalidator) 
     {
@@ -3506,7 +3578,7 @@ static bool ContextualCheckBlock(const CBlock& block, CValidationState& state, c
     return true;
 }
 
-bool CChainState::AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex)
+bool CChainState::AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, const uint256* phashPoW)
 {
     AssertLockHeld(cs_main);
     // Check for duplicate
@@ -3525,7 +3597,7 @@ bool CChainState::AcceptBlockHeader(const CBlockHeader& block, CValidationState&
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus()))
+        if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), true, phashPoW))
             return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, hash.ToString(), FormatStateMessage(state));
 
         // Get prev block index
@@ -3568,15 +3640,63 @@ bool CChainState::AcceptBlockHeader(const CBlockHeader& block, CValidationState&
     return true;
 }
 
+//! Most headers of a message whose proof of work is hashed in one batch
+static const size_t HEADERS_POW_BATCH_SIZE = 4 * MULTIHASH_BATCH_LANES;
+
+/**
+ * Hash the proof of work of the headers from nStart on in one batch, and
+ * return where the batch ends. The first header has to pass the checks that
+ * need no hashing, and the batch ends at a header that does not follow the
+ * one before it, so a bad header costs at most HEADERS_POW_BATCH_SIZE hashes.
+ * Only algos with a batch kernel are hashed here; AcceptBlockHeader hashes
+ * the others (and the auxpow headers) one at a time, when it gets to them.
+ */
+static size_t HashHeadersBatch(const std::vector<CBlockHeader>& headers, size_t nStart, const CChainParams& chainparams, std::vector<uint256>& vPoWHash, std::vector<bool>& vHashed)
+{
+    AssertLockHeld(cs_main);
+    const CBlockHeader& first = headers[nStart];
+    BlockMap::iterator mi = mapBlockIndex.find(first.hashPrevBlock);
+    CValidationState stateDummy;
+    if (mi == mapBlockIndex.end() || (mi->second->nStatus & BLOCK_FAILED_MASK) || mapBlockIndex.count(first.GetHash()) ||
+        !ContextualCheckBlockHeader(first, stateDummy, chainparams, mi->second, GetAdjustedTime()))
+        return nStart + 1;
+
+    std::vector<const CBlockHeader*> vBatch;
+    std::vector<size_t> vBatchIndex;
+    size_t nEnd = nStart;
+    for (; nEnd < headers.size() && nEnd - nStart < HEADERS_POW_BATCH_SIZE; nEnd++) {
+        const CBlockHeader& header = headers[nEnd];
+        if (nEnd > nStart && header.hashPrevBlock != headers[nEnd - 1].GetHash())
+            break;
+        if (header.auxpow || !CMultihasher::HasBatchKernel(header.GetAlgo()))
+            continue;
+        vBatch.push_back(&header);
+        vBatchIndex.push_back(nEnd);
+    }
+    const std::vector<uint256> vBatchHash = GetPoWHashBatch(vBatch, chainparams.GetConsensus());
+    for (size_t i = 0; i < vBatch.size(); i++) {
+        vPoWHash[vBatchIndex[i]] = vBatchHash[i];
+        vHashed[vBatchIndex[i]] = true;
+    }
+    return nEnd;
+}
+
 // Exposed wrapper for AcceptBlockHeader
 bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex, CBlockHeader *first_invalid)
 {
     if (first_invalid != nullptr) first_invalid->SetNull();
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        // Hashed a batch at a time as the headers before are accepted
+        std::vector<uint256> vPoWHash(headers.size());
+        std::vector<bool> vHashed(headers.size(), false);
+        size_t nBatchEnd = 0;
+        for (size_t i = 0; i < headers.size(); i++) {
+            const CBlockHeader& header = headers[i];
+            if (i >= nBatchEnd)
+                nBatchEnd = HashHeadersBatch(headers, i, chainparams, vPoWHash, vHashed);
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
-            if (!g_chainstate.AcceptBlockHeader(header, state, chainparams, &pindex)) {
+            if (!g_chainstate.AcceptBlockHeader(header, state, chainparams, &pindex, vHashed[i] ? &vPoWHash[i] : nullptr)) {
                 if (first_invalid) *first_invalid = header;
                 return false;
             }
@@ -3801,6 +3921,7 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune)
 {
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
         CDiskBlockPos pos(*it, 0);
+        blockFileMapCache.Invalidate(*it);
         fs::remove(GetBlockPosFilename(pos, "blk"));
         fs::remove(GetBlockPosFilename(pos, "rev"));
         LogPrintf("Prune: %s deleted blk/rev (%05u)\n", __func__, *it);
@@ -4067,10 +4188,6 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     pblocktree->ReadReindexing(fReindexing);
     if(fReindexing) fReindex = true;
 
-    // Check whether we have a transaction index
-    pblocktree->ReadFlag("txindex", fTxIndex);
-    LogPrintf("%s: transaction index %s\n", __func__, fTxIndex ? "enabled" : "disabled");
-
     return true;
 }
 
@@ -4508,9 +4625,6 @@ bool LoadBlockIndex(const CChainParams& chainparams)
         // needs_init.
 
         LogPrintf("Initializing databases...\n");
-        // Use the provided setting for -txindex in the new database
-        fTxIndex = gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX);
-        pblocktree->WriteFlag("txindex", fTxIndex);
     }
     return true;
 }
@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <exception>
 #include <map>
+#include <memory>
 #include <set>
 #include <stdint.h>
 #include <string>
@@ -31,7 +32,10 @@
 
 #include <atomic>
 
+class CBlockFileMapCache;
+class CMappedBlockFile;
 class CBlockIndex;
+class CBlockUndo;
 class CBlockTreeDB;
 class CChainParams;
 class CCoinsViewDB;
@@ -161,16 +165,17 @@ extern CBlockPolicyEstimator feeEstimator;
 extern CTxMemPool mempool;
 typedef std::unordered_map<uint256, CBlockIndex*, BlockHasher> BlockMap;
 extern BlockMap& mapBlockIndex;
-extern uint64_t nLastBlockTx;
-extern uint64_t nLastBlockWeight;
+extern std::atomic<uint64_t> nLastBlockTx;
+extern std::atomic<uint64_t> nLastBlockWeight;
 extern const std::string strMessageMagic;
 extern CWaitableCriticalSection csBestBlock;
 extern CConditionVariable cvBlockChange;
 extern std::atomic_bool fImporting;
 extern std::atomic_bool fReindex;
 extern int nScriptCheckThreads;
-extern bool fTxIndex;
 extern bool fIsBareMultisigStd;
+/** Memory mapped block files used for reading blocks (-blockmapfiles) */
+extern CBlockFileMapCache blockFileMapCache;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
@@ -412,6 +417,18 @@ void InitScriptExecutionCache();
 bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
 bool ReadBlockHeaderFromDisk(CBlockHeader& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+/** Read the serialized bytes of a block as stored on disk, without deserializing them */
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& vchBlock, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& vchBlock, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& messageStart);
+/**
+ * Point pchBlock at the bytes of a block inside its mapped block file, which
+ * stay valid for as long as mapping is held. Fails when the file can not be
+ * mapped, where ReadRawBlockFromDisk still reads a copy.
+ */
+bool MapRawBlockFromDisk(std::shared_ptr<const CMappedBlockFile>& mapping, const unsigned char*& pchBlock, unsigned int& nBlockSize, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
+bool MapRawBlockFromDisk(std::shared_ptr<const CMappedBlockFile>& mapping, const unsigned char*& pchBlock, unsigned int& nBlockSize, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& messageStart);
+/** Read the undo data (spent outputs) written when a block was connected */
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -6,8 +6,11 @@
 #include <validationinterface.h>
 
 #include <init.h>
+#include <masternodeman.h>
+#include <masternode-payments.h>
 #include <primitives/block.h>
 #include <scheduler.h>
+#include <spork.h>
 #include <sync.h>
 #include <txmempool.h>
 #include <util.h>
@@ -25,6 +28,9 @@ struct MainSignalsInstance {
     boost::signals2::signal<void (const CBlockIndex *, const CBlockIndex *, bool fInitialDownload)> UpdatedBlockTip;
     boost::signals2::signal<void (const CTransactionRef &)> TransactionAddedToMempool;
     boost::signals2::signal<void (const CTransactionRef &)> NotifyTransactionLock;
+    boost::signals2::signal<void (const std::shared_ptr<const CMasternodeListSnapshot> &, const std::shared_ptr<const CMasternodeListSnapshot> &)> NotifyMasternodeListChanged;
+    boost::signals2::signal<void (const CMasternodePaymentVote &)> NotifyMasternodePaymentVote;
+    boost::signals2::signal<void (const CSporkMessage &)> NotifySpork;
     boost::signals2::signal<void (const std::shared_ptr<const CBlock> &, const CBlockIndex *pindex, const std::vector<CTransactionRef>&)> BlockConnected;
     boost::signals2::signal<void (const std::shared_ptr<const CBlock> &)> BlockDisconnected;
     boost::signals2::signal<void (const CTransactionRef &)> TransactionRemovedFromMempool;
@@ -83,6 +89,9 @@ void RegisterValidationInterface(CValidationInterface* pwalletIn) {
     g_signals.m_internals->UpdatedBlockTip.connect(boost::bind(&CValidationInterface::UpdatedBlockTip, pwalletIn, _1, _2, _3));
     g_signals.m_internals->TransactionAddedToMempool.connect(boost::bind(&CValidationInterface::TransactionAddedToMempool, pwalletIn, _1));
     g_signals.m_internals->NotifyTransactionLock.connect(boost::bind(&CValidationInterface::NotifyTransactionLock, pwalletIn, _1));
+    g_signals.m_internals->NotifyMasternodeListChanged.connect(boost::bind(&CValidationInterface::NotifyMasternodeListChanged, pwalletIn, _1, _2));
+    g_signals.m_internals->NotifyMasternodePaymentVote.connect(boost::bind(&CValidationInterface::NotifyMasternodePaymentVote, pwalletIn, _1));
+    g_signals.m_internals->NotifySpork.connect(boost::bind(&CValidationInterface::NotifySpork, pwalletIn, _1));
     g_signals.m_internals->BlockConnected.connect(boost::bind(&CValidationInterface::BlockConnected, pwalletIn, _1, _2, _3));
     g_signals.m_internals->BlockDisconnected.connect(boost::bind(&CValidationInterface::BlockDisconnected, pwalletIn, _1));
     g_signals.m_internals->TransactionRemovedFromMempool.connect(boost::bind(&CValidationInterface::TransactionRemovedFromMempool, pwalletIn, _1));
@@ -100,6 +109,9 @@ void UnregisterValidationInterface(CValidationInterface* pwalletIn) {
     g_signals.m_internals->SetBestChain.disconnect(boost::bind(&CValidationInterface::SetBestChain, pwalletIn, _1));
     g_signals.m_internals->TransactionAddedToMempool.disconnect(boost::bind(&CValidationInterface::TransactionAddedToMempool, pwalletIn, _1));
     g_signals.m_internals->NotifyTransactionLock.disconnect(boost::bind(&CValidationInterface::NotifyTransactionLock, pwalletIn, _1));
+    g_signals.m_internals->NotifyMasternodeListChanged.disconnect(boost::bind(&CValidationInterface::NotifyMasternodeListChanged, pwalletIn, _1, _2));
+    g_signals.m_internals->NotifyMasternodePaymentVote.disconnect(boost::bind(&CValidationInterface::NotifyMasternodePaymentVote, pwalletIn, _1));
+    g_signals.m_internals->NotifySpork.disconnect(boost::bind(&CValidationInterface::NotifySpork, pwalletIn, _1));
     g_signals.m_internals->BlockConnected.disconnect(boost::bind(&CValidationInterface::BlockConnected, pwalletIn, _1, _2, _3));
     g_signals.m_internals->BlockDisconnected.disconnect(boost::bind(&CValidationInterface::BlockDisconnected, pwalletIn, _1));
     g_signals.m_internals->TransactionRemovedFromMempool.disconnect(boost::bind(&CValidationInterface::TransactionRemovedFromMempool, pwalletIn, _1));
@@ -119,6 +131,9 @@ void UnregisterAllValidationInterfaces() {
     g_signals.m_internals->SetBestChain.disconnect_all_slots();
     g_signals.m_internals->TransactionAddedToMempool.disconnect_all_slots();
     g_signals.m_internals->NotifyTransactionLock.disconnect_all_slots();
+    g_signals.m_internals->NotifyMasternodeListChanged.disconnect_all_slots();
+    g_signals.m_internals->NotifyMasternodePaymentVote.disconnect_all_slots();
+    g_signals.m_internals->NotifySpork.disconnect_all_slots();
     g_signals.m_internals->BlockConnected.disconnect_all_slots();
     g_signals.m_internals->BlockDisconnected.disconnect_all_slots();
     g_signals.m_internals->TransactionRemovedFromMempool.disconnect_all_slots();
@@ -180,6 +195,24 @@ void CMainSignals::NotifyTransactionLock(const CTransactionRef &ptx) {
     });
 }
 
+void CMainSignals::NotifyMasternodeListChanged(const std::shared_ptr<const CMasternodeListSnapshot> &snapshotOld, const std::shared_ptr<const CMasternodeListSnapshot> &snapshotNew) {
+    m_internals->m_schedulerClient.AddToProcessQueue([snapshotOld, snapshotNew, this] {
+        m_internals->NotifyMasternodeListChanged(snapshotOld, snapshotNew);
+    });
+}
+
+void CMainSignals::NotifyMasternodePaymentVote(const CMasternodePaymentVote &vote) {
+    m_internals->m_schedulerClient.AddToProcessQueue([vote, this] {
+        m_internals->NotifyMasternodePaymentVote(vote);
+    });
+}
+
+void CMainSignals::NotifySpork(const CSporkMessage &spork) {
+    m_internals->m_schedulerClient.AddToProcessQueue([spork, this] {
+        m_internals->NotifySpork(spork);
+    });
+}
+
 void CMainSignals::BlockConnected(const std::shared_ptr<const CBlock> &pblock, const CBlockIndex *pindex, const std::shared_ptr<const std::vector<CTransactionRef>>& pvtxConflicted) {
     m_internals->m_schedulerClient.AddToProcessQueue([pblock, pindex, pvtxConflicted, this] {
         m_internals->BlockConnected(pblock, pindex, *pvtxConflicted);
@@ -14,6 +14,9 @@
 class CBlock;
 class CBlockIndex;
 struct CBlockLocator;
+struct CMasternodeListSnapshot;
+class CMasternodePaymentVote;
+class CSporkMessage;
 class CBlockIndex;
 class CConnman;
 class CReserveScript;
@@ -79,6 +82,25 @@ protected:
      * Called on a background thread.
      */
     virtual void NotifyTransactionLock(const CTransactionRef &ptx) {}
+    /**
+     * Notifies listeners of a new masternode list snapshot, with the one it
+     * replaces (null for the first one).
+     *
+     * Called on a background thread.
+     */
+    virtual void NotifyMasternodeListChanged(const std::shared_ptr<const CMasternodeListSnapshot> &snapshotOld, const std::shared_ptr<const CMasternodeListSnapshot> &snapshotNew) {}
+    /**
+     * Notifies listeners of a masternode payment vote having been accepted.
+     *
+     * Called on a background thread.
+     */
+    virtual void NotifyMasternodePaymentVote(const CMasternodePaymentVote &vote) {}
+    /**
+     * Notifies listeners of a new or updated spork.
+     *
+     * Called on a background thread.
+     */
+    virtual void NotifySpork(const CSporkMessage &spork) {}
     /**
      * Notifies listeners of a transaction having been added to mempool.
      *
@@ -170,6 +192,9 @@ public:
     void NotifyHeaderTip(const CBlockIndex *pindexNew, bool fInitialDownload);
     void UpdatedBlockTip(const CBlockIndex *, const CBlockIndex *, bool fInitialDownload);
     void NotifyTransactionLock(const CTransactionRef &);
+    void NotifyMasternodeListChanged(const std::shared_ptr<const CMasternodeListSnapshot> &, const std::shared_ptr<const CMasternodeListSnapshot> &);
+    void NotifyMasternodePaymentVote(const CMasternodePaymentVote &);
+    void NotifySpork(const CSporkMessage &);
     void TransactionAddedToMempool(const CTransactionRef &);
     void BlockConnected(const std::shared_ptr<const CBlock> &, const CBlockIndex *pindex, const std::shared_ptr<const std::vector<CTransactionRef>> &);
     void BlockDisconnected(const std::shared_ptr<const CBlock> &);
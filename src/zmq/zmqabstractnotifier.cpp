@@ -22,6 +22,21 @@ bool CZMQAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/
 }
 
 bool CZMQAbstractNotifier::NotifyTransactionLock(const CTransactionRef &/*transaction*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyMasternodeListChanged(const CMasternodeListSnapshot &/*snapshotOld*/, const CMasternodeListSnapshot &/*snapshotNew*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyMasternodePaymentVote(const CMasternodePaymentVote &/*vote*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifySpork(const CSporkMessage &/*spork*/)
 {
     return true;
 }
\ No newline at end of file
@@ -7,7 +7,12 @@
 
 #include <zmq/zmqconfig.h>
 
+#include <memory>
+
 class CBlockIndex;
+struct CMasternodeListSnapshot;
+class CMasternodePaymentVote;
+class CSporkMessage;
 class CZMQAbstractNotifier;
 
 typedef CZMQAbstractNotifier* (*CZMQNotifierFactory)();
@@ -35,6 +40,9 @@ public:
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     virtual bool NotifyTransaction(const CTransaction &transaction);
     virtual bool NotifyTransactionLock(const CTransactionRef &transaction);
+    virtual bool NotifyMasternodeListChanged(const CMasternodeListSnapshot &snapshotOld, const CMasternodeListSnapshot &snapshotNew);
+    virtual bool NotifyMasternodePaymentVote(const CMasternodePaymentVote &vote);
+    virtual bool NotifySpork(const CSporkMessage &spork);
 
 protected:
     void *psocket;
@@ -5,6 +5,7 @@
 #include <zmq/zmqnotificationinterface.h>
 #include <zmq/zmqpublishnotifier.h>
 
+#include <masternodeman.h>
 #include <version.h>
 #include <validation.h>
 #include <streams.h>
@@ -35,10 +36,16 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     std::map<std::string, CZMQNotifierFactory> factories;
     std::list<CZMQAbstractNotifier*> notifiers;
 
+    factories["pubauxblock"] = CZMQAbstractNotifier::Create<CZMQPublishAuxBlockNotifier>;
     factories["pubhashblock"] = CZMQAbstractNotifier::Create<CZMQPublishHashBlockNotifier>;
+    factories["pubhashblockalgo"] = CZMQAbstractNotifier::Create<CZMQPublishHashBlockAlgoNotifier>;
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubhashtxlock"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionLockNotifier>;
+    factories["pubmasternode"] = CZMQAbstractNotifier::Create<CZMQPublishMasternodeNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
+    factories["pubrawblockheader"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockHeaderNotifier>;
+    factories["pubrawmnpaymentvote"] = CZMQAbstractNotifier::Create<CZMQPublishRawMasternodePaymentVoteNotifier>;
+    factories["pubrawspork"] = CZMQAbstractNotifier::Create<CZMQPublishRawSporkNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
     factories["pubrawtxlock"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionLockNotifier>;
 
@@ -199,3 +206,58 @@ void CZMQNotificationInterface::NotifyTransactionLock(const CTransactionRef &ptx
         }
     }
 }
+
+void CZMQNotificationInterface::NotifyMasternodeListChanged(const std::shared_ptr<const CMasternodeListSnapshot> &snapshotOld, const std::shared_ptr<const CMasternodeListSnapshot> &snapshotNew)
+{
+    // The first snapshot is the list loaded at startup, not a change
+    if (!snapshotOld)
+        return;
+
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (notifier->NotifyMasternodeListChanged(*snapshotOld, *snapshotNew))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
+
+void CZMQNotificationInterface::NotifyMasternodePaymentVote(const CMasternodePaymentVote &vote)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (notifier->NotifyMasternodePaymentVote(vote))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
+
+void CZMQNotificationInterface::NotifySpork(const CSporkMessage &spork)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (notifier->NotifySpork(spork))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
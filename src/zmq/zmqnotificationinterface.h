@@ -30,6 +30,9 @@ protected:
     void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) override;
     void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
     void NotifyTransactionLock(const CTransactionRef &ptx) override;
+    void NotifyMasternodeListChanged(const std::shared_ptr<const CMasternodeListSnapshot> &snapshotOld, const std::shared_ptr<const CMasternodeListSnapshot> &snapshotNew) override;
+    void NotifyMasternodePaymentVote(const CMasternodePaymentVote &vote) override;
+    void NotifySpork(const CSporkMessage &spork) override;
 
 private:
     CZMQNotificationInterface();
@@ -4,18 +4,28 @@
 
 #include <chain.h>
 #include <chainparams.h>
+#include <masternodeman.h>
+#include <masternode-payments.h>
+#include <pow.h>
+#include <spork.h>
 #include <streams.h>
 #include <zmq/zmqpublishnotifier.h>
 #include <validation.h>
 #include <util.h>
 #include <rpc/server.h>
+#include <timedata.h>
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
+static const char *MSG_AUXBLOCK  = "auxblock";
 static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_HASHTXLOCK = "hashtxlock";
+static const char *MSG_MASTERNODE = "masternode";
 static const char *MSG_RAWBLOCK  = "rawblock";
+static const char *MSG_RAWBLOCKHEADER = "rawblockheader";
+static const char *MSG_RAWMNPAYMENTVOTE = "rawmnpaymentvote";
+static const char *MSG_RAWSPORK  = "rawspork";
 static const char *MSG_RAWTX     = "rawtx";
 static const char *MSG_RAWTXLOCK  = "rawtxlock";
 
@@ -158,6 +168,51 @@ bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
     return SendMessage(MSG_HASHBLOCK, data, 32);
 }
 
+bool CZMQPublishHashBlockAlgoNotifier::NotifyBlock(const CBlockIndex *pindex)
+{
+    uint256 hash = pindex->GetBlockHash();
+    const std::string command = std::string(MSG_HASHBLOCK) + "-" + GetAlgoName(pindex->GetAlgo());
+    LogPrint(BCLog::ZMQ, "zmq: Publish %s %s\n", command, hash.GetHex());
+    char data[32];
+    for (unsigned int i = 0; i < 32; i++)
+        data[31 - i] = hash.begin()[i];
+    return SendMessage(command.c_str(), data, 32);
+}
+
+bool CZMQPublishAuxBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+{
+    // Merge mining starts with the first hardfork, see AuxMiningCheck
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    if (!consensusParams.Hardfork1.IsActivated(pindex->nTime))
+        return true;
+
+    uint256 hash = pindex->GetBlockHash();
+    char data[32];
+    for (unsigned int i = 0; i < 32; i++)
+        data[31 - i] = hash.begin()[i];
+
+    const int64_t nTime = std::max(pindex->GetMedianTimePast() + 1, GetAdjustedTime());
+    for (uint8_t nAlgo = 0; nAlgo < NUM_ALGOS; nAlgo++)
+    {
+        if (!consensusParams.Hardfork2.IsActivated(nTime) && !IsAlgoAllowedBeforeHF2(nAlgo))
+            continue;
+
+        // The header of an auxpow block of this algo on top of the new tip
+        CBlockHeader header;
+        header.nTime = nTime;
+        header.SetAlgo(nAlgo);
+        header.SetAuxpowVersion(true);
+        if (!IsAuxPowAllowed(pindex, &header, consensusParams, nAlgo))
+            continue;
+
+        const std::string command = std::string(MSG_AUXBLOCK) + "-" + GetAlgoName(nAlgo);
+        LogPrint(BCLog::ZMQ, "zmq: Publish %s %s\n", command, hash.GetHex());
+        if (!SendMessage(command.c_str(), data, 32))
+            return false;
+    }
+    return true;
+}
+
 bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash();
@@ -200,6 +255,20 @@ bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
     return SendMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
 }
 
+bool CZMQPublishRawBlockHeaderNotifier::NotifyBlock(const CBlockIndex *pindex)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish rawblockheader %s\n", pindex->GetBlockHash().GetHex());
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+    {
+        // The auxpow of a merge mined header is read from disk
+        LOCK(cs_main);
+        ss << pindex->GetBlockHeader(Params().GetConsensus());
+    }
+
+    return SendMessage(MSG_RAWBLOCKHEADER, &(*ss.begin()), ss.size());
+}
+
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash();
@@ -218,3 +287,45 @@ bool CZMQPublishRawTransactionLockNotifier::NotifyTransactionLock(const CTransac
     ss << tx;
     return SendMessage(MSG_RAWTXLOCK, &(*ss.begin()), ss.size());
 }
+
+bool CZMQPublishMasternodeNotifier::NotifyMasternodeListChanged(const CMasternodeListSnapshot &snapshotOld, const CMasternodeListSnapshot &snapshotNew)
+{
+    for (const auto& change : DiffMasternodeListSnapshots(snapshotOld, snapshotNew))
+    {
+        const CMasternodeListEntry& entry = *change.second;
+        std::string command(MSG_MASTERNODE);
+        switch (change.first) {
+        case MasternodeListChange::ADDED:   command += "-added"; break;
+        case MasternodeListChange::REMOVED: command += "-removed"; break;
+        case MasternodeListChange::STATE:   command += "-state"; break;
+        }
+        const std::string strStatus = entry.GetStatus();
+        LogPrint(BCLog::ZMQ, "zmq: Publish %s %s %s\n", command, entry.info.outpoint.ToStringShort(), strStatus);
+
+        /* the collateral txid as for hashtx, its LE 4byte index and the status */
+        std::vector<unsigned char> data(32 + sizeof(uint32_t));
+        for (unsigned int i = 0; i < 32; i++)
+            data[31 - i] = entry.info.outpoint.hash.begin()[i];
+        WriteLE32(&data[32], entry.info.outpoint.n);
+        data.insert(data.end(), strStatus.begin(), strStatus.end());
+        if (!SendMessage(command.c_str(), data.data(), data.size()))
+            return false;
+    }
+    return true;
+}
+
+bool CZMQPublishRawMasternodePaymentVoteNotifier::NotifyMasternodePaymentVote(const CMasternodePaymentVote &vote)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish rawmnpaymentvote %s\n", vote.GetHash().GetHex());
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << vote;
+    return SendMessage(MSG_RAWMNPAYMENTVOTE, &(*ss.begin()), ss.size());
+}
+
+bool CZMQPublishRawSporkNotifier::NotifySpork(const CSporkMessage &spork)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish rawspork %s\n", spork.GetHash().GetHex());
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << spork;
+    return SendMessage(MSG_RAWSPORK, &(*ss.begin()), ss.size());
+}
@@ -34,6 +34,20 @@ public:
     bool NotifyBlock(const CBlockIndex *pindex) override;
 };
 
+/** Publishes hashblock-<algo> with the new tip, for the algo it was mined with */
+class CZMQPublishHashBlockAlgoNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlock(const CBlockIndex *pindex) override;
+};
+
+/** Publishes auxblock-<algo> for every algo that can be merge mined on top of a new tip */
+class CZMQPublishAuxBlockNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlock(const CBlockIndex *pindex) override;
+};
+
 class CZMQPublishHashTransactionNotifier : public CZMQAbstractPublishNotifier
 {
 public:
@@ -52,6 +66,12 @@ public:
     bool NotifyBlock(const CBlockIndex *pindex) override;
 };
 
+class CZMQPublishRawBlockHeaderNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlock(const CBlockIndex *pindex) override;
+};
+
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier
 {
 public:
@@ -64,4 +84,23 @@ public:
     bool NotifyTransactionLock(const CTransactionRef &ptransaction) override;
 };
 
+/** Publishes masternode-added, masternode-removed and masternode-state for the changes of the masternode list */
+class CZMQPublishMasternodeNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyMasternodeListChanged(const CMasternodeListSnapshot &snapshotOld, const CMasternodeListSnapshot &snapshotNew) override;
+};
+
+class CZMQPublishRawMasternodePaymentVoteNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyMasternodePaymentVote(const CMasternodePaymentVote &vote) override;
+};
+
+class CZMQPublishRawSporkNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifySpork(const CSporkMessage &spork) override;
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
@@ -34,6 +34,16 @@ class ZMQSubscriber:
         return body
 
 
+class ZMQAlgoSubscriber(ZMQSubscriber):
+    """Subscribes to every topic starting with its topic, like hashblock-<algo>."""
+    def receive(self):
+        topic, body, seq = self.socket.recv_multipart()
+        assert topic.startswith(self.topic)
+        assert_equal(struct.unpack('<I', seq)[-1], self.sequence)
+        self.sequence += 1
+        return topic[len(self.topic):].decode(), body
+
+
 class ZMQTest (BitcoinTestFramework):
     def set_test_params(self):
         self.num_nodes = 2
@@ -71,7 +81,15 @@ class ZMQTest (BitcoinTestFramework):
         self.rawblock = ZMQSubscriber(socket, b"rawblock")
         self.rawtx = ZMQSubscriber(socket, b"rawtx")
 
-        self.extra_args = [["-zmqpub%s=%s" % (sub.topic.decode(), address) for sub in [self.hashblock, self.hashtx, self.rawblock, self.rawtx]], []]
+        # The per-algo block topics start with hashblock, so they get a socket of their own
+        address_algo = "tcp://127.0.0.1:29320"
+        socket_algo = self.zmq_context.socket(zmq.SUB)
+        socket_algo.set(zmq.RCVTIMEO, 60000)
+        socket_algo.connect(address_algo)
+        self.hashblockalgo = ZMQAlgoSubscriber(socket_algo, b"hashblock-")
+
+        self.extra_args = [["-zmqpub%s=%s" % (sub.topic.decode(), address) for sub in [self.hashblock, self.hashtx, self.rawblock, self.rawtx]] +
+                           ["-zmqpubhashblockalgo=%s" % address_algo], []]
         self.add_nodes(self.num_nodes, self.extra_args)
         self.start_nodes()
 
@@ -110,6 +128,11 @@ class ZMQTest (BitcoinTestFramework):
             block = self.rawblock.receive()
             assert_equal(genhashes[x], bytes_to_hex_str(hash256(block[:80])))
 
+            # Should receive the block hash under the topic of its algo.
+            algo, body = self.hashblockalgo.receive()
+            assert_equal(genhashes[x], bytes_to_hex_str(body))
+            assert_equal(self.nodes[1].getblock(hash)["algo"], algo)
+
         self.log.info("Wait for tx from second node")
         payment_txid = self.nodes[1].sendtoaddress(self.nodes[0].getnewaddress(), 1.0)
         self.sync_all()
@@ -122,5 +145,12 @@ class ZMQTest (BitcoinTestFramework):
         hex = self.rawtx.receive()
         assert_equal(payment_txid, bytes_to_hex_str(hash256(hex)))
 
+        self.log.info("Generate blocks of other algos")
+        for algo in ["scrypt", "sha256d"]:
+            genhash = self.nodes[0].generate(1, 1000000, algo)[0]
+            topic_algo, body = self.hashblockalgo.receive()
+            assert_equal(algo, topic_algo)
+            assert_equal(genhash, bytes_to_hex_str(body))
+
 if __name__ == '__main__':
     ZMQTest().main()